@@ -35,7 +35,8 @@ public class AutobattlerPlugin : ModuleRules
 				"AIModule",
 				"GameplayTasks",
 				"OnlineSubsystem",
-				"NavigationSystem"
+				"NavigationSystem",
+				"NetCore"
 			}
 		);
 			
@@ -44,9 +45,17 @@ public class AutobattlerPlugin : ModuleRules
 			new string[]
 			{
 				"CoreUObject",
-				"Engine"
+				"Engine",
+				"RenderCore",
+				"RHI"
 			}
 		);
+
+		// Registers the grid's generated cell state material with the content browser.
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.Add("AssetRegistry");
+		}
 		
 		
 		DynamicallyLoadedModuleNames.AddRange(
@@ -6,22 +6,29 @@
 
 /* Autobattler includes. */
 #include "AI/GetTarget.h"
+#include "AI/GetTargetDerived/GetFurthestTarget.h"
+#include "AI/GetTargetDerived/GetLowestHealthTarget.h"
+#include "AI/GetTargetDerived/GetNearestTarget.h"
 #include "AI/GetTargetDerived/GetSelfAsTarget.h"
 #include "Core/AutobattlerManager.h"
 #include "DataAssets/AutobattlerConfiguration.h"
 #include "DataAssets/AutobattlerAbility.h"
 #include "DataAssets/AutobattlerAttack.h"
 #include "DataAssets/AutobattlerSkill.h"
+#include "Game/Grid/AutobattlerGrid.h"
 #include "Game/Units/AutobattlerCharacter.h"
 #include "Game/Skills/ExecuteSkill.h"
 #include "Utility/AutobattlerFunctionLibrary.h"
+#include "Utility/AutobattlerStats.h"
 
 /* Engine includes. */
 #include "BehaviorTree/BehaviorTree.h"
 #include "Components/CapsuleComponent.h"
 #include "DrawDebugHelpers.h"
+#include "GameFramework/CharacterMovementComponent.h"
 #include "EnvironmentQuery/EnvQuery.h"
 #include "EnvironmentQuery/EQSRenderingComponent.h"
+#include "Misc/ScopeExit.h"
 #include "Navigation/CrowdFollowingComponent.h"
 
 AAutobattlerAIController::AAutobattlerAIController(const FObjectInitializer& ObjectInitializer) 
@@ -64,21 +71,29 @@ void AAutobattlerAIController::BeginPlay()
         else UAutobattlerFunctionLibrary::PrintErrorToLog(FString::Printf(TEXT("%s : [BeginPlay] Could not get Game Subsystem!"), *GetName()));
 
         bool PreferNativeUpdate = true;
-        if (const UAutobattlerConfiguration* Configuration = UAutobattlerConfiguration::GetConfigurationAsset(this))
+        const UAutobattlerConfiguration* Configuration = UAutobattlerConfiguration::GetConfigurationAsset(this);
+        if (Configuration != nullptr && Configuration->UseBehaviorTree && IsValid(Configuration->AutobattlerBehaviorTree))
         {
-            if (Configuration->UseBehaviorTree && IsValid(Configuration->AutobattlerBehaviorTree))
-            {
-                PreferNativeUpdate = !RunBehaviorTree(Configuration->AutobattlerBehaviorTree);
-            }
+            PreferNativeUpdate = !RunBehaviorTree(Configuration->AutobattlerBehaviorTree);
         }
 
         if (PreferNativeUpdate)
         {
-            FTimerHandle Handle;
-            FTimerDelegate Delegate;
-            Delegate.BindUObject(this, &AAutobattlerAIController::AIUpdate);
+            // The scheduler only runs updates which are due; this controller sleeps until the fight starts.
+            AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this);
+            if (Configuration != nullptr && Configuration->UseAIScheduler && IsValid(Manager))
+            {
+                Manager->GetAIScheduler().Register(this);
+                UsesAIScheduler = true;
+            }
+            else
+            {
+                FTimerHandle Handle;
+                FTimerDelegate Delegate;
+                Delegate.BindUObject(this, &AAutobattlerAIController::AIUpdate);
 
-            GetWorldTimerManager().SetTimer(Handle, Delegate, 0.2f, true);
+                GetWorldTimerManager().SetTimer(Handle, Delegate, Configuration != nullptr ? FMath::Max(Configuration->AIHighRateUpdateInterval, 0.01f) : 0.2f, true);
+            }
         }
 
         FTimerHandle DebugHandle;
@@ -89,6 +104,25 @@ void AAutobattlerAIController::BeginPlay()
     }
 }
 
+void AAutobattlerAIController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UsesAIScheduler)
+    {
+        if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this)) Manager->GetAIScheduler().Unregister(this);
+        UsesAIScheduler = false;
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void AAutobattlerAIController::SetShouldUpdate(bool NewShouldUpdate)
+{
+    ShouldUpdate = NewShouldUpdate;
+    if (!ShouldUpdate || !UsesAIScheduler) return;
+
+    if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this)) Manager->GetAIScheduler().Wake(this, GetWorld()->GetTimeSeconds());
+}
+
 void AAutobattlerAIController::SetDebugEnabled(bool NewEnabled)
 {
     IsDebugEnabled = NewEnabled;
@@ -104,6 +138,8 @@ bool AAutobattlerAIController::GetAIShouldEverUpdate() const
 
 FAbilityTargetingProperties AAutobattlerAIController::GetAbilityTargetingProperties(const UAutobattlerSkill* Skill)
 {
+    AUTOBATTLER_SCOPE_CYCLE_COUNTER(STAT_AutobattlerTargeting);
+
     if (Skill == nullptr) return FAbilityTargetingProperties();
 	if (Skill->GetTargetImplementationClass.Get() == nullptr && Skill->PrimaryTargetFilter != EAbilityFilterType::Self)
 	{
@@ -117,19 +153,38 @@ FAbilityTargetingProperties AAutobattlerAIController::GetAbilityTargetingPropert
 
 	AAutobattlerCharacter* TargetCharacter = nullptr;
 	FVector TargetLocation = FVector::ZeroVector;
-	TArray<AAutobattlerCharacter*> FilteredCharacters;
     ESkillTargetingMode SkillTargetingMode = ESkillTargetingMode::None;
-    if (Skill->PrimaryTargetFilter == EAbilityFilterType::Self)
+
+    // Native strategies are matched by exact class, as a Blueprint child may override GetTarget. None of them create UObjects.
+    const UClass* GetTargetClass = Skill->GetTargetImplementationClass.Get();
+    if (Skill->PrimaryTargetFilter == EAbilityFilterType::Self || GetTargetClass == UGetSelfAsTarget::StaticClass())
+    {
+        TargetCharacter = GetControlledCharacter();
+        SkillTargetingMode = IsValid(TargetCharacter) ? ESkillTargetingMode::Actor : ESkillTargetingMode::None;
+    }
+    else if (GetTargetClass == UGetNearestTarget::StaticClass() && Skill->PrimaryTargetFilter != EAbilityFilterType::SelfAndAllies)
     {
-        UGetTarget* GetTargetImplementation = NewObject<UGetSelfAsTarget>(this, UGetSelfAsTarget::StaticClass());
-        SkillTargetingMode = GetTargetImplementation->GetTarget(GetControlledCharacter(), FilteredCharacters, TargetCharacter, TargetLocation);
+        // Native nearest targeting is answered by the manager's spatial hash, rather than by filtering every character first.
+        TargetCharacter = UAutobattlerFunctionLibrary::GetNearestCharacterFiltered(GetControlledCharacter(), Skill->PrimaryTargetFilter);
+        SkillTargetingMode = IsValid(TargetCharacter) ? ESkillTargetingMode::Actor : ESkillTargetingMode::None;
     }
     else
     {
-        UAutobattlerFunctionLibrary::GetCharactersFiltered(FilteredCharacters, GetControlledCharacter(), Skill->PrimaryTargetFilter);
+        UAutobattlerFunctionLibrary::GetCharactersFiltered(FilteredCharactersScratch, GetControlledCharacter(), Skill->PrimaryTargetFilter);
 
-	    UGetTarget* GetTargetImplementation = NewObject<UGetTarget>(this, Skill->GetTargetImplementationClass);
-	    SkillTargetingMode = GetTargetImplementation->GetTarget(GetControlledCharacter(), FilteredCharacters, TargetCharacter, TargetLocation);
+        if (GetTargetClass == UGetLowestHealthTarget::StaticClass() || GetTargetClass == UGetFurthestTarget::StaticClass())
+        {
+            TargetCharacter = GetTargetClass == UGetLowestHealthTarget::StaticClass()
+                ? UGetLowestHealthTarget::FindLowestHealthTarget(GetControlledCharacter(), FilteredCharactersScratch)
+                : UGetFurthestTarget::FindFurthestTarget(GetControlledCharacter(), FilteredCharactersScratch);
+            SkillTargetingMode = IsValid(TargetCharacter) ? ESkillTargetingMode::Actor : ESkillTargetingMode::None;
+        }
+        else
+        {
+            // Blueprint (and other) strategies run on an instance cached per class, instead of a new object per update.
+            UGetTarget* GetTargetImplementation = GetCachedGetTargetInstance(Skill->GetTargetImplementationClass);
+            SkillTargetingMode = GetTargetImplementation->GetTarget(GetControlledCharacter(), FilteredCharactersScratch, TargetCharacter, TargetLocation);
+        }
     }
 
     float ModifiedRange = 0.0f; 
@@ -146,9 +201,27 @@ FAbilityTargetingProperties AAutobattlerAIController::GetAbilityTargetingPropert
 	return NewTargetingProperties;
 }
 
+UGetTarget* AAutobattlerAIController::GetCachedGetTargetInstance(TSubclassOf<UGetTarget> GetTargetClass)
+{
+    if (UGetTarget** CachedInstance = CachedGetTargetInstances.Find(GetTargetClass.Get()))
+    {
+        if (IsValid(*CachedInstance)) return *CachedInstance;
+    }
+
+    UGetTarget* NewInstance = NewObject<UGetTarget>(this, GetTargetClass);
+    CachedGetTargetInstances.Add(GetTargetClass.Get(), NewInstance);
+    NumGetTargetInstancesCreated++;
+    return NewInstance;
+}
+
+const FAutobattlerCharacterDefinition* AAutobattlerAIController::GetCharacterDefinition()
+{
+    return UAutobattlerFunctionLibrary::GetCharacterDefinitionByHandle(this, CharacterDefinitionHandle, CharacterListingName);
+}
+
 const UAutobattlerSkill* AAutobattlerAIController::GetRelevantSkill(EAbilityType SkillType)
 {
-    if (FAutobattlerCharacterDefinition* CharacterDefinition = UAutobattlerFunctionLibrary::GetCharacterDefinitionFromConfigurationDatatable(this, CharacterListingName))
+    if (const FAutobattlerCharacterDefinition* CharacterDefinition = GetCharacterDefinition())
 	{
         if (SkillType == EAbilityType::Skill) return CharacterDefinition->AbilityImplementation;
 		else if (SkillType == EAbilityType::Attack) return CharacterDefinition->AttackImplementation;
@@ -173,7 +246,7 @@ void AAutobattlerAIController::OnGamePhaseChanged(EAutobattlerPhase NewGamePhase
     CurrentPhase = NewGamePhase;
     if (NewGamePhase == EAutobattlerPhase::Fight)
     {
-        if (FAutobattlerCharacterDefinition* CharacterDefinition = UAutobattlerFunctionLibrary::GetCharacterDefinitionFromConfigurationDatatable(this, CharacterListingName))
+        if (const FAutobattlerCharacterDefinition* CharacterDefinition = GetCharacterDefinition())
 	    {
             if (const UAutobattlerAbility* Ability = CharacterDefinition->AbilityImplementation)
             {
@@ -210,17 +283,28 @@ void AAutobattlerAIController::OnGamePhaseChanged(EAutobattlerPhase NewGamePhase
             }
 	    }
         AIUpdate();
+        RescheduleAIUpdate();
     }
     else
     {
         StopMovement();
         IsMovingToTarget = false;
         ShouldUpdate = false;
+        RescheduleAIUpdate();
     }
 }
 
 void AAutobattlerAIController::AIUpdate()
 {
+    AUTOBATTLER_SCOPE_CYCLE_COUNTER(STAT_AutobattlerAIUpdate);
+
+    // The update returns early in several places, so its cost is added to the battle stats on the way out.
+    const uint64 StartCycles = FPlatformTime::Cycles64();
+    ON_SCOPE_EXIT
+    {
+        if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this)) Manager->GetBattleStats().RecordAITick(FPlatformTime::Cycles64() - StartCycles);
+    };
+
     // EQS implementation
     
     if (GetAIShouldEverUpdate())
@@ -230,6 +314,12 @@ void AAutobattlerAIController::AIUpdate()
         EAbilityType RelevantAbilityType = IsAbilityQueued || UsesAbilityOnly ? EAbilityType::Skill : EAbilityType::Attack;
         const UAutobattlerSkill* RelevantSkill = GetRelevantSkill(RelevantAbilityType);
         TargetingProperties = GetAbilityTargetingProperties(RelevantSkill);
+        HasTargetChanged = TargetingProperties.TargetCharacter != PreviousTargetingProperties.TargetCharacter || !TargetingProperties.TargetLocation.Equals(PreviousTargetingProperties.TargetLocation, 1.0f);
+
+        if (TargetingProperties.TargetCharacter != PreviousTargetingProperties.TargetCharacter)
+        {
+            if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this)) Manager->RecordBattleTarget(GetControlledCharacter(), TargetingProperties.TargetCharacter);
+        }
 
         if (TargetingProperties.TargetingMode == ESkillTargetingMode::None || !IsValid(GetControlledCharacter())) ResetMovementState();
         if (TargetingProperties.TargetingMode == ESkillTargetingMode::Actor)
@@ -256,6 +346,12 @@ void AAutobattlerAIController::AIUpdate()
 
         if (!InRange && !IsMovingToTarget)
         {
+            if (TryMoveAlongGrid())
+            {
+                PreviousTargetingProperties = TargetingProperties;
+                return;
+            }
+
             // TODO: How do we move to a target location rather than target actor?
             if (!IsValid(TargetingProperties.TargetCharacter)) return;
             if (UEnvQuery* SurroundingPointsQuery = TargetingProperties.TargetCharacter->GetSurroundingPointsQuery())
@@ -287,13 +383,51 @@ void AAutobattlerAIController::AIUpdate()
 void AAutobattlerAIController::OnAbilityCooldownEnd()
 {
     IsAbilityQueued = true;
+
+    // The ability may have a different range than the attack, so the next update should not wait for the low rate.
+    if (UsesAIScheduler)
+    {
+        if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this)) Manager->GetAIScheduler().Promote(this, GetWorld()->GetTimeSeconds());
+    }
+}
+
+EAutobattlerAIUpdateTier AAutobattlerAIController::GetAIUpdateTier(const FAutobattlerAIScheduler::FSettings& Settings) const
+{
+    AAutobattlerCharacter* ControlledCharacter = GetControlledCharacter();
+    if (!GetAIShouldEverUpdate()) return FAutobattlerAIScheduler::ChooseTier(false, false, false, false, 0.0f, 0.0f, Settings);
+
+    bool HasTarget = false;
+    float DistanceToRange = 0.0f;
+    if (TargetingProperties.TargetingMode == ESkillTargetingMode::Actor && IsValid(TargetingProperties.TargetCharacter))
+    {
+        HasTarget = true;
+        DistanceToRange = UAutobattlerFunctionLibrary::CartesianDistance(ControlledCharacter->GetActorLocation(), TargetingProperties.TargetCharacter->GetActorLocation())
+            - (TargetingProperties.Range + TargetingProperties.TargetCharacter->GetCapsuleComponent()->GetScaledCapsuleRadius());
+    }
+    else if (TargetingProperties.TargetingMode == ESkillTargetingMode::Location)
+    {
+        HasTarget = true;
+        DistanceToRange = UAutobattlerFunctionLibrary::CartesianDistance(ControlledCharacter->GetActorLocation(), TargetingProperties.TargetLocation) - TargetingProperties.Range;
+    }
+
+    // A grid step only covers one cell, so the next one has to be taken soon however far the target is.
+    return FAutobattlerAIScheduler::ChooseTier(true, HasTarget, HasTargetChanged, HasGridReservation, DistanceToRange, ControlledCharacter->GetCharacterMovement()->MaxWalkSpeed, Settings);
+}
+
+void AAutobattlerAIController::RescheduleAIUpdate()
+{
+    if (!UsesAIScheduler) return;
+
+    if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this)) Manager->GetAIScheduler().Reschedule(this, GetWorld()->GetTimeSeconds());
 }
 
 void AAutobattlerAIController::PathAroundQueryFinished(TSharedPtr<FEnvQueryResult> Result)
 {
+    AUTOBATTLER_SCOPE_CYCLE_COUNTER(STAT_AutobattlerEQSCallback);
+
     if (FEnvQueryResult* QueryResult = Result.Get())
     {
-        UE_LOG(LogTemp, Log, TEXT("%s returned %d items when running path around query"), *GetName(), QueryResult->Items.Num());
+        UE_LOG(LogAutobattler, Verbose, TEXT("%s returned %d items when running path around query"), *GetName(), QueryResult->Items.Num());
         if (QueryResult->Items.IsValidIndex(0))
         {
             MoveToLocation(QueryResult->GetItemAsLocation(0), 1.0f, false); // TODO: Configuration.
@@ -322,9 +456,11 @@ void AAutobattlerAIController::PathAroundQueryFinished(TSharedPtr<FEnvQueryResul
 
 void AAutobattlerAIController::SurroundingPointsQueryFinished(TSharedPtr<FEnvQueryResult> Result)
 {
+    AUTOBATTLER_SCOPE_CYCLE_COUNTER(STAT_AutobattlerEQSCallback);
+
     if (FEnvQueryResult* QueryResult = Result.Get())
     {
-        UE_LOG(LogTemp, Log, TEXT("%s returned %d items when running surrounding points query"), *GetName(), QueryResult->Items.Num());
+        UE_LOG(LogAutobattler, Verbose, TEXT("%s returned %d items when running surrounding points query"), *GetName(), QueryResult->Items.Num());
         if (QueryResult->Items.IsValidIndex(0))
         {
             FCollisionQueryParams QueryParams;
@@ -420,12 +556,93 @@ void AAutobattlerAIController::ResetState()
     if (LastRelevantActionType == EAbilityType::Skill) IsAbilityQueued = false;
     ShouldUpdate = true;
     AIUpdate();
+    RescheduleAIUpdate();
 }
 
 void AAutobattlerAIController::ResetMovementState()
 {
     StopMovement();
     IsMovingToTarget = false;
+
+    if (HasGridReservation)
+    {
+        HasGridReservation = false;
+        if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this))
+        {
+            if (IsValid(GetControlledCharacter())) Manager->GetGridPathfinder().ReleaseReservation(GetControlledCharacter()->GetID());
+        }
+    }
+}
+
+bool AAutobattlerAIController::TryMoveAlongGrid()
+{
+    const UAutobattlerConfiguration* Configuration = UAutobattlerConfiguration::GetConfigurationAsset(this);
+    if (Configuration == nullptr || !Configuration->UseGridPathfinding) return false;
+
+    AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this);
+    AAutobattlerCharacter* ControlledCharacter = GetControlledCharacter();
+    if (!IsValid(Manager) || !IsValid(ControlledCharacter)) return false;
+
+    const AAutobattlerGrid* Grid = Manager->GetAutobattlerGrid();
+    if (!IsValid(Grid)) return false;
+
+    const bool IsTargetingActor = TargetingProperties.TargetingMode == ESkillTargetingMode::Actor && IsValid(TargetingProperties.TargetCharacter);
+    if (!IsTargetingActor && TargetingProperties.TargetingMode != ESkillTargetingMode::Location) return false;
+
+    const FVector GoalLocation = IsTargetingActor ? TargetingProperties.TargetCharacter->GetActorLocation() : TargetingProperties.TargetLocation;
+    FIntPair StartCell, GoalCell;
+    if (!Grid->LocationToGridIndex(ControlledCharacter->GetActorLocation(), StartCell) || !Grid->LocationToGridIndex(GoalLocation, GoalCell)) return false;
+
+    FAutobattlerGridPathfinder& Pathfinder = Manager->GetGridPathfinder();
+    const int32 CharacterID = ControlledCharacter->GetID();
+
+    FIntPair NextCell = GoalCell;
+    if (StartCell != GoalCell)
+    {
+        // The flow field leads to the nearest enemy, which need not be the target (e.g. with LowestHealth or Furthest targeting).
+        // Its step is only taken if the target is as close as the nearest enemy can be, or if the step still closes on the target.
+        const bool IsTargetingEnemy = IsTargetingActor && UAutobattlerFunctionLibrary::IsEnemy(ControlledCharacter->GetOwnerIdentity(), TargetingProperties.TargetCharacter->GetOwnerIdentity());
+        const int32 DistanceToGoal = FAutobattlerGridPathfinder::GetOctileDistance(StartCell, GoalCell);
+        const bool HasFlowFieldStep = IsTargetingEnemy
+            && Pathfinder.GetNextStep(StartCell, ControlledCharacter->GetOwnerIdentity(), NextCell)
+            && (NextCell == GoalCell || Pathfinder.IsCellFree(NextCell, CharacterID))
+            && (DistanceToGoal <= Pathfinder.GetCostToNearestEnemy(StartCell, ControlledCharacter->GetOwnerIdentity())
+                || FAutobattlerGridPathfinder::GetOctileDistance(NextCell, GoalCell) < DistanceToGoal);
+
+        if (!HasFlowFieldStep)
+        {
+            TArray<FIntPair> Path;
+            if (!Pathfinder.FindPath(StartCell, GoalCell, CharacterID, Path) || Path.Num() == 0) return false;
+            NextCell = Path[0];
+        }
+    }
+
+    // On (or next to) the goal's grid index, close the remaining distance directly.
+    if (NextCell == GoalCell)
+    {
+        if (IsTargetingActor)
+        {
+            MoveToActor(TargetingProperties.TargetCharacter, 5.0f, true, false); // TODO: Configuration.
+            DesiredMoveToLocation = GoalLocation;
+            if (TargetingProperties.TargetCharacter != ControlledCharacter) SetFocus(TargetingProperties.TargetCharacter);
+        }
+        else
+        {
+            MoveToLocation(GoalLocation, 5.0f, true, false); // TODO: Configuration.
+            DesiredMoveToLocation = GoalLocation;
+            SetFocalPoint(GoalLocation);
+        }
+        return true;
+    }
+
+    if (!Pathfinder.ReserveCell(NextCell, CharacterID)) return false;
+    HasGridReservation = true;
+
+    DesiredMoveToLocation = Grid->GetGridIndexCenter(NextCell);
+    DesiredMoveToLocation.Z = ControlledCharacter->GetActorLocation().Z;
+    MoveToLocation(DesiredMoveToLocation, 5.0f, true, false); // TODO: Configuration.
+    SetFocalPoint(DesiredMoveToLocation);
+    return true;
 }
 
 void AAutobattlerAIController::TryExecuteRelevantSkill()
@@ -468,9 +685,6 @@ void AAutobattlerAIController::ExecuteSkill(EAbilityType AbilityTypeTriggered)
 		return;
 	}
 
-	FActorSpawnParameters ActorSpawnParams;
-	ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-
 	if (Skill->ExecuteSkillClass.Get() == nullptr)
 	{
 		UAutobattlerFunctionLibrary::PrintErrorToLog(
@@ -485,15 +699,16 @@ void AAutobattlerAIController::ExecuteSkill(EAbilityType AbilityTypeTriggered)
 	FTransform SkillTransform;
 	GetNextSkillSpawnLocation(SkillTransform, Skill->OnSkillTriggerEnd, Skill->ProjectileSocketSpawnName);
 
-	AExecuteSkill* SkillActor = GetWorld()->SpawnActor<AExecuteSkill>(
-		Skill->ExecuteSkillClass,
-		SkillTransform,
-		ActorSpawnParams
-	);
-
-	if (Skill->OnSkillTriggerEnd == ESkillTriggerEnd::Instant) SkillActor->InitialiseAsInstant(Skill, GetControlledCharacter(), PreviousTargetingProperties);
-	else if (Skill->OnSkillTriggerEnd == ESkillTriggerEnd::Projectile) SkillActor->InitialiseAsProjectile(Skill, GetControlledCharacter(), PreviousTargetingProperties);
-	else if (Skill->OnSkillTriggerEnd == ESkillTriggerEnd::Effect) SkillActor->InitialiseAsEffect(Skill, GetControlledCharacter(), PreviousTargetingProperties);
+	if (Skill->OnSkillTriggerEnd == ESkillTriggerEnd::Instant)
+	{
+		AExecuteSkill::ExecuteInstant(this, Skill, GetControlledCharacter(), PreviousTargetingProperties, SkillTransform);
+	}
+	else if (AExecuteSkill* SkillActor = AExecuteSkill::AcquireFromPool(this, Skill->ExecuteSkillClass, SkillTransform))
+	{
+		if (Skill->OnSkillTriggerEnd == ESkillTriggerEnd::Projectile) SkillActor->InitialiseAsProjectile(Skill, GetControlledCharacter(), PreviousTargetingProperties);
+		else if (Skill->OnSkillTriggerEnd == ESkillTriggerEnd::Effect) SkillActor->InitialiseAsEffect(Skill, GetControlledCharacter(), PreviousTargetingProperties);
+		else SkillActor->ReleaseToPool();
+	}
 
     if (const UAutobattlerAbility* Ability = Cast<UAutobattlerAbility>(Skill))
     {
@@ -0,0 +1,167 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+/* Class header. */
+#include "AI/AutobattlerAIScheduler.h"
+
+/* Autobattler includes. */
+#include "AI/AutobattlerAIController.h"
+#include "DataAssets/AutobattlerConfiguration.h"
+#include "Utility/AutobattlerStats.h"
+
+EAutobattlerAIUpdateTier FAutobattlerAIScheduler::ChooseTier(bool CanUpdate, bool HasTarget, bool TargetChanged, bool IsSteppingAlongGrid, float DistanceToRange, float MovementSpeed, const FSettings& Settings)
+{
+	if (!CanUpdate) return EAutobattlerAIUpdateTier::Asleep;
+	if (TargetChanged || IsSteppingAlongGrid) return EAutobattlerAIUpdateTier::High;
+	if (!HasTarget) return EAutobattlerAIUpdateTier::Low;
+
+	const float DistanceBeforeLowRateUpdate = DistanceToRange - FMath::Max(MovementSpeed, 0.0f) * Settings.LowRateInterval;
+	return DistanceBeforeLowRateUpdate <= Settings.PromotionDistance ? EAutobattlerAIUpdateTier::High : EAutobattlerAIUpdateTier::Low;
+}
+
+double FAutobattlerAIScheduler::GetTierInterval(EAutobattlerAIUpdateTier Tier, const FSettings& Settings)
+{
+	switch (Tier)
+	{
+		case EAutobattlerAIUpdateTier::High: return Settings.HighRateInterval;
+		case EAutobattlerAIUpdateTier::Low: return FMath::Max(Settings.LowRateInterval, Settings.HighRateInterval);
+		default: return MAX_dbl;
+	}
+}
+
+void FAutobattlerAIScheduler::ApplyConfiguration(const UAutobattlerConfiguration* Configuration)
+{
+	if (Configuration == nullptr) return;
+
+	Settings.HighRateInterval = FMath::Max(Configuration->AIHighRateUpdateInterval, 0.01f);
+	Settings.LowRateInterval = FMath::Max(Configuration->AILowRateUpdateInterval, Settings.HighRateInterval);
+	Settings.PromotionDistance = Configuration->AIPromotionDistance;
+	Settings.MaxUpdatesPerFrame = FMath::Max(Configuration->AIMaxUpdatesPerFrame, 1);
+	Settings.FrameBudgetMs = Configuration->AIUpdateFrameBudgetMs;
+}
+
+void FAutobattlerAIScheduler::Register(AAutobattlerAIController* Controller)
+{
+	if (Controller == nullptr || IndicesByController.Contains(Controller)) return;
+
+	IndicesByController.Add(Controller, Controllers.Num());
+	Controllers.Add(Controller);
+	Tiers.Add(EAutobattlerAIUpdateTier::Asleep);
+	NextUpdateTimes.Add(MAX_dbl);
+}
+
+void FAutobattlerAIScheduler::Unregister(AAutobattlerAIController* Controller)
+{
+	RemoveEntry(Controller);
+}
+
+void FAutobattlerAIScheduler::Reschedule(AAutobattlerAIController* Controller, double Now)
+{
+	const int32* Index = IndicesByController.Find(Controller);
+	if (Index == nullptr || !IsValid(Controller)) return;
+
+	const EAutobattlerAIUpdateTier Tier = Controller->GetAIUpdateTier(Settings);
+	SetEntry(*Index, Tier, Now + GetTierInterval(Tier, Settings));
+}
+
+void FAutobattlerAIScheduler::Wake(AAutobattlerAIController* Controller, double Now)
+{
+	if (const int32* Index = IndicesByController.Find(Controller)) SetEntry(*Index, EAutobattlerAIUpdateTier::High, Now);
+}
+
+void FAutobattlerAIScheduler::Promote(AAutobattlerAIController* Controller, double Now)
+{
+	const int32* Index = IndicesByController.Find(Controller);
+	if (Index == nullptr || Tiers[*Index] == EAutobattlerAIUpdateTier::Asleep) return;
+
+	SetEntry(*Index, EAutobattlerAIUpdateTier::High, FMath::Min(NextUpdateTimes[*Index], Now + Settings.HighRateInterval));
+}
+
+void FAutobattlerAIScheduler::WakeTargetersOf(const AAutobattlerCharacter* Target, double Now)
+{
+	if (Target == nullptr) return;
+
+	for (int32 i = 0; i < Controllers.Num(); i++)
+	{
+		const AAutobattlerAIController* Controller = Controllers[i].Get();
+		if (Controller != nullptr && Controller->TargetingProperties.TargetCharacter == Target) SetEntry(i, EAutobattlerAIUpdateTier::High, Now);
+	}
+}
+
+void FAutobattlerAIScheduler::Tick(double Now)
+{
+	AUTOBATTLER_SCOPE_CYCLE_COUNTER(STAT_AutobattlerAIScheduler);
+
+	DueScratch.Reset();
+	for (int32 i = 0; i < Controllers.Num(); i++)
+	{
+		if (NextUpdateTimes[i] <= Now) DueScratch.Emplace(NextUpdateTimes[i], Controllers[i]);
+	}
+	if (DueScratch.Num() == 0) return;
+
+	DueScratch.Sort([](const TPair<double, TWeakObjectPtr<AAutobattlerAIController>>& A, const TPair<double, TWeakObjectPtr<AAutobattlerAIController>>& B) { return A.Key < B.Key; });
+
+	const double StartTime = FPlatformTime::Seconds();
+	int32 NumRun = 0;
+	int32 DueIndex = 0;
+	for (; DueIndex < DueScratch.Num(); DueIndex++)
+	{
+		if (NumRun > 0 && (NumRun >= Settings.MaxUpdatesPerFrame || (FPlatformTime::Seconds() - StartTime) * 1000.0 >= Settings.FrameBudgetMs)) break;
+
+		AAutobattlerAIController* Controller = DueScratch[DueIndex].Value.Get();
+		if (!IsValid(Controller))
+		{
+			RemoveEntry(DueScratch[DueIndex].Value);
+			continue;
+		}
+
+		// The update may have been rescheduled by an event earlier this frame, or the controller removed.
+		const int32* Index = IndicesByController.Find(Controller);
+		if (Index == nullptr || NextUpdateTimes[*Index] > Now) continue;
+
+		Controller->AIUpdate();
+		Reschedule(Controller, Now);
+		NumRun++;
+	}
+
+	const int32 NumLeft = DueScratch.Num() - DueIndex;
+	NumUpdates += NumRun;
+	NumDeferred += NumLeft;
+	INC_DWORD_STAT_BY(STAT_AutobattlerAIUpdatesDeferred, NumLeft);
+}
+
+void FAutobattlerAIScheduler::Reset()
+{
+	Controllers.Empty();
+	Tiers.Empty();
+	NextUpdateTimes.Empty();
+	IndicesByController.Empty();
+	NumUpdates = 0;
+	NumDeferred = 0;
+}
+
+int32 FAutobattlerAIScheduler::GetNumAtTier(EAutobattlerAIUpdateTier Tier) const
+{
+	int32 Count = 0;
+	for (auto EntryTier : Tiers) Count += EntryTier == Tier ? 1 : 0;
+	return Count;
+}
+
+void FAutobattlerAIScheduler::RemoveEntry(const TWeakObjectPtr<AAutobattlerAIController>& Controller)
+{
+	int32 Index = INDEX_NONE;
+	if (!IndicesByController.RemoveAndCopyValue(Controller, Index)) return;
+
+	Controllers.RemoveAtSwap(Index, 1, false);
+	Tiers.RemoveAtSwap(Index, 1, false);
+	NextUpdateTimes.RemoveAtSwap(Index, 1, false);
+
+	// The last entry was moved into the removed one's place.
+	if (Controllers.IsValidIndex(Index)) IndicesByController.Add(Controllers[Index], Index);
+}
+
+void FAutobattlerAIScheduler::SetEntry(int32 Index, EAutobattlerAIUpdateTier Tier, double NextUpdateTime)
+{
+	Tiers[Index] = Tier;
+	NextUpdateTimes[Index] = NextUpdateTime;
+}
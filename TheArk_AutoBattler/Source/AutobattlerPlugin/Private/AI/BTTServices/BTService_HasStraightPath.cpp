@@ -5,6 +5,8 @@
 #include "AI/BTTServices/BTService_HasStraightPath.h"
 
 /* Autobattler includes. */
+#include "Core/AutobattlerManager.h"
+#include "Game/Grid/AutobattlerGrid.h"
 #include "Game/Units/AutobattlerCharacter.h"
 
 /* Engine includes. */
@@ -18,6 +20,7 @@ UBTService_HasStraightPath::UBTService_HasStraightPath()
 	TargetKey.AddVectorFilter(this, GET_MEMBER_NAME_CHECKED(UBTService_HasStraightPath, TargetKey));
 	HasStraightPathKey.AddBoolFilter(this, GET_MEMBER_NAME_CHECKED(UBTService_HasStraightPath, HasStraightPathKey));
 
+    UseGridOccupancy = false;
     SphereTraceRadius = 34.0f;
     TraceType = ETraceType::Profile;
     TraceChannel = ECollisionChannel::ECC_Visibility;
@@ -47,6 +50,19 @@ void UBTService_HasStraightPath::TickAutobattlerNode(UBehaviorTreeComponent& Own
         TargetLocation = TargetActor->GetActorLocation();
     }
 
+    if (UseGridOccupancy && ControlledCharacter->HasAuthority())
+    {
+        AAutobattlerManager* Manager = AAutobattlerManager::GetManager(ControlledCharacter);
+        const AAutobattlerGrid* Grid = IsValid(Manager) ? Manager->GetAutobattlerGrid() : nullptr;
+
+        FIntPair StartCell, TargetCell;
+        if (IsValid(Grid) && Grid->LocationToGridIndex(ControlledCharacter->GetActorLocation(), StartCell) && Grid->LocationToGridIndex(TargetLocation, TargetCell))
+        {
+            BlackboardComp->SetValueAsBool(HasStraightPathKey.SelectedKeyName, Manager->GetGridPathfinder().HasClearLine(StartCell, TargetCell));
+            return;
+        }
+    }
+
     if (TraceType == ETraceType::Channel)
     {
         HitOccurred = GetWorld()->SweepSingleByChannel(
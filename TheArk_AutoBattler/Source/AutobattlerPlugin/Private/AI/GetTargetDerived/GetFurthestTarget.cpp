@@ -0,0 +1,36 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+/* Class header. */
+#include "AI/GetTargetDerived/GetFurthestTarget.h"
+
+/* Autobattler includes. */
+#include "Game/Units/AutobattlerCharacter.h"
+
+ESkillTargetingMode UGetFurthestTarget::GetTarget_Implementation(AAutobattlerCharacter* OwningCharacter, const TArray<AAutobattlerCharacter*>& FilteredCharacters, AAutobattlerCharacter*& TargetCharacter, FVector& TargetLocation)
+{
+    TargetCharacter = FindFurthestTarget(OwningCharacter, FilteredCharacters);
+    return TargetCharacter != nullptr ? ESkillTargetingMode::Actor : ESkillTargetingMode::None;
+}
+
+AAutobattlerCharacter* UGetFurthestTarget::FindFurthestTarget(const AAutobattlerCharacter* OwningCharacter, const TArray<AAutobattlerCharacter*>& FilteredCharacters)
+{
+    if (!IsValid(OwningCharacter)) return nullptr;
+
+    const FVector OwningLocation = OwningCharacter->GetActorLocation();
+    AAutobattlerCharacter* FurthestCharacter = nullptr;
+    double LargestDistanceSquared = -1.0;
+    for (auto Character : FilteredCharacters)
+    {
+        if (Character == OwningCharacter || !IsValid(Character)) continue;
+
+        const double DistanceSquared = FVector::DistSquared(OwningLocation, Character->GetActorLocation());
+        if (DistanceSquared > LargestDistanceSquared)
+        {
+            FurthestCharacter = Character;
+            LargestDistanceSquared = DistanceSquared;
+        }
+    }
+
+    return FurthestCharacter;
+}
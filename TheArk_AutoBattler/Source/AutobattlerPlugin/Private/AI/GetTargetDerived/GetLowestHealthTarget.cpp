@@ -0,0 +1,32 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+/* Class header. */
+#include "AI/GetTargetDerived/GetLowestHealthTarget.h"
+
+/* Autobattler includes. */
+#include "Game/Units/AutobattlerCharacter.h"
+
+ESkillTargetingMode UGetLowestHealthTarget::GetTarget_Implementation(AAutobattlerCharacter* OwningCharacter, const TArray<AAutobattlerCharacter*>& FilteredCharacters, AAutobattlerCharacter*& TargetCharacter, FVector& TargetLocation)
+{
+    TargetCharacter = FindLowestHealthTarget(OwningCharacter, FilteredCharacters);
+    return TargetCharacter != nullptr ? ESkillTargetingMode::Actor : ESkillTargetingMode::None;
+}
+
+AAutobattlerCharacter* UGetLowestHealthTarget::FindLowestHealthTarget(const AAutobattlerCharacter* OwningCharacter, const TArray<AAutobattlerCharacter*>& FilteredCharacters)
+{
+    AAutobattlerCharacter* LowestHealthCharacter = nullptr;
+    float LowestHealth = TNumericLimits<float>::Max();
+    for (auto Character : FilteredCharacters)
+    {
+        if (Character == OwningCharacter || !IsValid(Character)) continue;
+
+        if (Character->GetCurrentHealth() < LowestHealth)
+        {
+            LowestHealthCharacter = Character;
+            LowestHealth = Character->GetCurrentHealth();
+        }
+    }
+
+    return LowestHealthCharacter;
+}
@@ -17,16 +17,17 @@ ESkillTargetingMode UGetNearestTarget::GetTarget_Implementation(AAutobattlerChar
 
     if (CharactersToChooseFrom.Num() < 1) return ESkillTargetingMode::None;
 
-    float LargestRange = MAX_FLT;
+    const FVector OwningLocation = OwningCharacter->GetActorLocation();
+    double SmallestDistanceSquared = TNumericLimits<double>::Max();
     for (auto Character : CharactersToChooseFrom)
     {
         if (!IsValid(Character)) continue;
 
-        float Distance = UAutobattlerFunctionLibrary::CartesianDistance(OwningCharacter->GetActorLocation(), Character->GetActorLocation());
-        if (Distance < LargestRange)
+        const double DistanceSquared = FVector::DistSquared(OwningLocation, Character->GetActorLocation());
+        if (DistanceSquared < SmallestDistanceSquared)
         {
             TargetCharacter = Character;
-            LargestRange = Distance;
+            SmallestDistanceSquared = DistanceSquared;
         }
     }
     
@@ -6,6 +6,7 @@
 
 /* Autobattler includes. */
 #include "Core/AutobattlerManager.h"
+#include "DataAssets/AutobattlerAttack.h"
 #include "DataAssets/AutobattlerConfiguration.h"
 #include "Game/Grid/AutobattlerGrid.h"
 #include "Game/Misc/RedeployPreview.h"
@@ -172,6 +173,7 @@ void UAutobattlerControllerComponent::Server_ExecutePrimaryAction_Implementation
 				LastRedeploymentLocation.Y,
 				LastRedeploymentLocation.Z + CurrentDraggedCharacter->GetCapsuleComponent()->GetScaledCapsuleHalfHeight())
 			);
+			Manager->RefreshCharacterGridOccupancy(CurrentDraggedCharacter);
 		}
 		CurrentDraggedCharacter = nullptr;
 		if (IsValid(RedeployPreview)) 
@@ -736,7 +738,7 @@ bool UAutobattlerControllerComponent::SpawnPreviewCharacter(const FCharacterList
 		return false;
 	}
 
-	if (FAutobattlerCharacterDefinition* CharacterDefinition = UAutobattlerFunctionLibrary::GetCharacterDefinitionFromConfigurationDatatable(this, CharacterListing.CharacterRowName))
+	if (const FAutobattlerCharacterDefinition* CharacterDefinition = UAutobattlerFunctionLibrary::GetCharacterDefinitionFromConfigurationDatatable(this, CharacterListing.CharacterRowName))
 	{
 		if (CharacterDefinition->PreviewCharacterClass.Get() == nullptr) 
 		{
@@ -764,7 +766,8 @@ bool UAutobattlerControllerComponent::SpawnPreviewCharacter(const FCharacterList
 			SpawnParams
 		);
 
-		PreviewCharacter->ConfigurePreviewCharacter(CharacterDefinition->DeploymentOffset, ID, CharacterDefinition->BudgetCost);
+		const float AttackRange = CharacterDefinition->AttackImplementation != nullptr ? CharacterDefinition->AttackImplementation->Range : 0.0f;
+		PreviewCharacter->ConfigurePreviewCharacter(CharacterDefinition->DeploymentOffset, ID, CharacterDefinition->BudgetCost, AttackRange);
 
 		return true;
 	}
@@ -5,13 +5,16 @@
 #include "Core/AutobattlerManager.h"
 
 /* Autobattler includes. */
+#include "AI/AutobattlerAIController.h"
 #include "Core/AutobattlerControllerComponent.h"
 #include "Core/AutobattlerSettings.h"
+#include "Core/AutobattlerWorldSubsystem.h"
 #include "DataAssets/AutobattlerConfiguration.h"
 #include "Game/Components/CharacterPanelComponent.h"
 #include "Game/Grid/AutobattlerGrid.h"
 #include "Game/Player/AutobattlerPawn.h"
 #include "Game/Misc/CharacterPanelActor.h"
+#include "Game/Skills/ExecuteSkill.h"
 #include "Game/Units/AutobattlerCharacter.h"
 #include "Game/Units/AutobattlerPreviewCharacter.h"
 #include "Game/WinCondition/WinConditionBase.h"
@@ -21,8 +24,32 @@
 #include "Components/BillboardComponent.h"
 #include "Components/BoxComponent.h"
 #include "Components/CapsuleComponent.h"
+#include "Engine/NetDriver.h"
 #include "EngineUtils.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Net/UnrealNetwork.h"
 
+namespace AutobattlerManagerNetworking
+{
+	/**
+	 * Rough size of a replicated name: names not hardcoded in the engine are sent as strings.
+	 */
+	int32 EstimateNameBytes(const FName& Name)
+	{
+		return 4 + Name.GetStringLength();
+	}
+
+	/**
+	 * Rough size of a replicated character listing.
+	 */
+	int32 EstimateListingBytes(const FCharacterListing& Listing)
+	{
+		int32 NumBytes = 4 + EstimateNameBytes(Listing.CharacterRowName);
+		for (auto& ModifierTableRowName : Listing.ModifierTableRowNames) NumBytes += EstimateNameBytes(ModifierTableRowName);
+		return NumBytes;
+	}
+}
 
 AAutobattlerManager::AAutobattlerManager()
 {
@@ -30,9 +57,13 @@ AAutobattlerManager::AAutobattlerManager()
 	RootComponent = Billboard;
 
 	IDDispenser = INT_MIN;
+	WinConditionInstance = nullptr;
 	ShouldCheckVictoryCondition = true;
 	BattleEndDelay = 4.0f;
 
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
 	bReplicates = true;
 }
 
@@ -50,10 +81,68 @@ void AAutobattlerManager::Setup(int32 InNumberOfPlayers)
 	bAlreadySetup = true;
 }
 
+void AAutobattlerManager::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	// Set after properties are initialised, as copying them from the archetype would point the arrays at it instead.
+	ReplicatedRoster.Manager = this;
+	ReplicatedEntityStates.Manager = this;
+	ReplicatedGridCells.Manager = this;
+}
+
 void AAutobattlerManager::BeginPlay()
 {
 	Super::BeginPlay();
 
+	ReplicationStats.Reset(FPlatformTime::Seconds());
+
+	if (UAutobattlerWorldSubsystem* WorldSubsystem = UAutobattlerWorldSubsystem::Get(this)) WorldSubsystem->RegisterManager(this);
+
+	if (HasAuthority() && IsValid(AutobattlerConfigurationAsset))
+	{
+		SkillActorPool.Prewarm(GetWorld(), AExecuteSkill::StaticClass(), AutobattlerConfigurationAsset->PrewarmedExecuteSkillActors, AutobattlerConfigurationAsset->PrewarmedProjectileActors);
+	}
+}
+
+void AAutobattlerManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UAutobattlerWorldSubsystem* WorldSubsystem = UAutobattlerWorldSubsystem::Get(this)) WorldSubsystem->UnregisterManager(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AAutobattlerManager::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (!HasAuthority()) return;
+
+	{
+		AUTOBATTLER_SCOPE_CYCLE_COUNTER(STAT_AutobattlerStatusEffects);
+		EffectScheduler.Tick(DeltaSeconds);
+	}
+	{
+		AUTOBATTLER_SCOPE_CYCLE_COUNTER(STAT_AutobattlerProjectiles);
+		ProjectileSystem.Tick(DeltaSeconds, GetNetMode() != NM_DedicatedServer);
+	}
+	if (GamePhase == EAutobattlerPhase::Fight) AIScheduler.Tick(GetWorld()->GetTimeSeconds());
+
+	if (BattleReplay.GetIsRecording())
+	{
+		ReplayBattleSeconds += DeltaSeconds;
+		ReplayFrameAccumulator += DeltaSeconds;
+
+		const UAutobattlerConfiguration* Configuration = GetAutobattlerConfigurationAsset();
+		if (Configuration != nullptr && ReplayFrameAccumulator >= Configuration->ReplayFrameInterval)
+		{
+			ReplayFrameAccumulator = 0.0f;
+			RecordBattleFrame();
+		}
+	}
+
+	// Projectiles still in flight when the fight ends are allowed to land.
+	if (GamePhase != EAutobattlerPhase::Fight && ProjectileSystem.Num() == 0) SetActorTickEnabled(false);
 }
 
 void AAutobattlerManager::AssignIdentities(UWorld* WorldContext)
@@ -98,17 +187,7 @@ void AAutobattlerManager::AssignIdentities(UWorld* WorldContext)
 
 AAutobattlerManager* AAutobattlerManager::GetManager(const UObject* WorldContextObject)
 {
-	if (GEngine == nullptr) return nullptr;
-
-	if (UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull))
-	{
-		for (TActorIterator<AAutobattlerManager> ActorItr(World); ActorItr; ++ActorItr)
-		{
-			AAutobattlerManager* Manager = *ActorItr;
-			if (IsValid(Manager)) return Manager;
-		}
-	}
-
+	if (UAutobattlerWorldSubsystem* WorldSubsystem = UAutobattlerWorldSubsystem::Get(WorldContextObject)) return WorldSubsystem->GetManager();
 	return nullptr;
 }
 
@@ -124,9 +203,15 @@ int32 AAutobattlerManager::GetMaxBudgetForEntity(EEntity WhoOwns) const
 
 int32 AAutobattlerManager::GetCurrentBudgetForEntity(EEntity WhoOwns) const
 {
+	if (HasAuthority())
+	{
+		const FCharacterRegistryPartition* Partition = CharacterRegistryPartitions.Find(WhoOwns);
+		return Partition != nullptr ? Partition->DeployedBudget : 0;
+	}
+
 	int32 OutBudget = 0;
 	TArray<AAutobattlerCharacter*> OwnedCharacters;
-	GetDeployedCharactersByEntity(OwnedCharacters, WhoOwns);
+	GetDeployedCharactersFromWorld(OwnedCharacters, WhoOwns, false);
 
 	for (auto OwnedCharacter : OwnedCharacters) OutBudget += OwnedCharacter->GetBudgetCost();
 	return OutBudget;
@@ -151,15 +236,23 @@ bool AAutobattlerManager::GetCharacterListingByID(EEntity WhoOwns, int32 ID, FCh
 
 void AAutobattlerManager::GetDeployedCharactersByEntity(TArray<AAutobattlerCharacter*>& DeployedCharacters, EEntity WhoOwns) const
 {
-	DeployedCharacters.Empty();
-	for (TActorIterator<AAutobattlerCharacter> ActorItr(GetWorld()); ActorItr; ++ActorItr)
+	if (!HasAuthority())
 	{
-		AAutobattlerCharacter* Character = *ActorItr;
-		if (!IsValid(Character)) continue;
+		GetDeployedCharactersFromWorld(DeployedCharacters, WhoOwns, false);
+		return;
+	}
 
-		if (Character->GetOwnerIdentity() == WhoOwns)
+	DeployedCharacters.Empty();
+	if (const FCharacterRegistryPartition* Partition = CharacterRegistryPartitions.Find(WhoOwns))
+	{
+		DeployedCharacters.Reserve(Partition->AliveIDs.Num() + Partition->DeadIDs.Num());
+		for (const TSet<int32>* IDs : { &Partition->AliveIDs, &Partition->DeadIDs })
 		{
-			DeployedCharacters.Emplace(Character);
+			for (int32 ID : *IDs)
+			{
+				const FRegisteredCharacter* Entry = CharacterRegistry.Find(ID);
+				if (Entry != nullptr && IsValid(Entry->Character)) DeployedCharacters.Emplace(Entry->Character);
+			}
 		}
 	}
 }
@@ -167,79 +260,137 @@ void AAutobattlerManager::GetDeployedCharactersByEntity(TArray<AAutobattlerChara
 void AAutobattlerManager::GetIDsOfDeployedCharacters(TArray<int32>& DeployedCharacterIDs, EEntity WhoOwns) const
 {
 	DeployedCharacterIDs.Empty();
-	for (TActorIterator<AAutobattlerCharacter> ActorItr(GetWorld()); ActorItr; ++ActorItr)
+	if (!HasAuthority())
 	{
-		AAutobattlerCharacter* Character = *ActorItr;
-		if (!IsValid(Character)) continue;
+		TArray<AAutobattlerCharacter*> DeployedCharacters;
+		GetDeployedCharactersFromWorld(DeployedCharacters, WhoOwns, false);
+		for (auto DeployedCharacter : DeployedCharacters) DeployedCharacterIDs.Emplace(DeployedCharacter->GetID());
+		return;
+	}
 
-		if (Character->GetOwnerIdentity() == WhoOwns)
+	if (const FCharacterRegistryPartition* Partition = CharacterRegistryPartitions.Find(WhoOwns))
+	{
+		DeployedCharacterIDs.Reserve(Partition->AliveIDs.Num() + Partition->DeadIDs.Num());
+		for (int32 ID : Partition->AliveIDs) DeployedCharacterIDs.Emplace(ID);
+		for (int32 ID : Partition->DeadIDs) DeployedCharacterIDs.Emplace(ID);
+	}
+}
+
+void AAutobattlerManager::GetAliveCharactersByEntity(TArray<AAutobattlerCharacter*>& AliveCharacters, EEntity WhoOwns) const
+{
+	if (!HasAuthority())
+	{
+		GetDeployedCharactersFromWorld(AliveCharacters, WhoOwns, true);
+		return;
+	}
+
+	AliveCharacters.Empty();
+	if (const FCharacterRegistryPartition* Partition = CharacterRegistryPartitions.Find(WhoOwns))
+	{
+		AliveCharacters.Reserve(Partition->AliveIDs.Num());
+		for (int32 ID : Partition->AliveIDs)
 		{
-			DeployedCharacterIDs.Emplace(Character->GetID());
+			const FRegisteredCharacter* Entry = CharacterRegistry.Find(ID);
+			if (Entry != nullptr && IsValid(Entry->Character)) AliveCharacters.Emplace(Entry->Character);
 		}
 	}
 }
 
-bool AAutobattlerManager::GetWhoOwnsByID(int32 ID, EEntity& WhoOwns) const
+void AAutobattlerManager::GetAllDeployedCharacters(TArray<AAutobattlerCharacter*>& DeployedCharacters) const
 {
-	for (auto& IdentityConfiguration : IdentityConfigurations)
+	DeployedCharacters.Empty();
+	if (!HasAuthority())
 	{
-		TArray<int32> IDs;
-		IdentityConfiguration.Value.Characters.GetKeys(IDs);
-		if (IDs.Contains(ID))
+		for (TActorIterator<AAutobattlerCharacter> ActorItr(GetWorld()); ActorItr; ++ActorItr)
 		{
-			WhoOwns = IdentityConfiguration.Key;
-			return true;
+			AAutobattlerCharacter* Character = *ActorItr;
+			if (IsValid(Character)) DeployedCharacters.Emplace(Character);
 		}
+		return;
+	}
+
+	DeployedCharacters.Reserve(CharacterRegistry.Num());
+	for (auto& Entry : CharacterRegistry)
+	{
+		if (IsValid(Entry.Value.Character)) DeployedCharacters.Emplace(Entry.Value.Character);
+	}
+}
+
+bool AAutobattlerManager::GetWhoOwnsByID(int32 ID, EEntity& WhoOwns) const
+{
+	if (const EEntity* FoundOwner = OwnersByID.Find(ID))
+	{
+		WhoOwns = *FoundOwner;
+		return true;
 	}
 
 	return false;
 }
 
-bool AAutobattlerManager::GetIsCharacterDeployed(int32 ID, AAutobattlerCharacter*& DeployedCharacter) const
+const FAutobattlerSpatialHash& AAutobattlerManager::GetCharacterSpatialHash()
 {
-	for (TActorIterator<AAutobattlerCharacter> ActorItr(GetWorld()); ActorItr; ++ActorItr)
+	if (IsCharacterSpatialHashDirty || CharacterSpatialHashFrame != GFrameCounter)
 	{
-		AAutobattlerCharacter* Character = *ActorItr;
-		if (!IsValid(Character)) continue;
+		if (IsValid(AutobattlerGrid)) CharacterSpatialHash.Reset(AutobattlerGrid->GetGridXYSize(), AutobattlerGrid->GetActorLocation());
+		else CharacterSpatialHash.Reset(CharacterSpatialHash.GetCellSize(), FVector::ZeroVector);
+
+		TArray<AAutobattlerCharacter*> DeployedCharacters;
+		GetAllDeployedCharacters(DeployedCharacters);
+		CharacterSpatialHash.Rebuild(DeployedCharacters);
+
+		CharacterSpatialHashFrame = GFrameCounter;
+		IsCharacterSpatialHashDirty = false;
+	}
+
+	return CharacterSpatialHash;
+}
+
+FAutobattlerGridPathfinder& AAutobattlerManager::GetGridPathfinder()
+{
+	if (GridPathfinderFrame == GFrameCounter || !IsValid(AutobattlerGrid)) return GridPathfinder;
+	GridPathfinderFrame = GFrameCounter;
 
-		if (Character->GetID() == ID)
+	if (GridPathfinder.GetSizeX() != AutobattlerGrid->GetGridXSize() || GridPathfinder.GetSizeY() != AutobattlerGrid->GetGridYSize())
+	{
+		GridPathfinder.Reset(AutobattlerGrid->GetGridXSize(), AutobattlerGrid->GetGridYSize());
+	}
+
+	TArray<FAutobattlerGridPathfinder::FOccupant> Occupants;
+	Occupants.Reserve(CharacterRegistry.Num());
+	for (auto& Partition : CharacterRegistryPartitions)
+	{
+		for (int32 ID : Partition.Value.AliveIDs)
 		{
-			DeployedCharacter = Character;
-			return true;
+			const FRegisteredCharacter* Entry = CharacterRegistry.Find(ID);
+			if (Entry == nullptr || !IsValid(Entry->Character)) continue;
+
+			FIntPair Cell;
+			if (AutobattlerGrid->LocationToGridIndex(Entry->Character->GetActorLocation(), Cell)) Occupants.Add({ Cell, Entry->WhoOwns, ID });
 		}
 	}
 
-	DeployedCharacter = nullptr;
-	return false;
+	GridPathfinder.UpdateOccupancy(Occupants);
+	return GridPathfinder;
 }
 
-bool AAutobattlerManager::GetIsGridIndexOccupied(const FIntPair& IndexToTest) const
+bool AAutobattlerManager::GetIsCharacterDeployed(int32 ID, AAutobattlerCharacter*& DeployedCharacter) const
 {
-	if (!HasAuthority()) return false;
-	if (!IsValid(GetWorld()) || !IsValid(AutobattlerGrid)) return false;
-
-	FVector GridLocation;
-	FHitResult HitResult;
-	ECollisionChannel CharacterCollisionChannel = GetDefault<UAutobattlerSettings>() != nullptr ? GetDefault<UAutobattlerSettings>()->CharacterCollisionChannel.GetValue() : ECollisionChannel::ECC_Pawn;
-	if (!AutobattlerGrid->GridIndexToLocation(IndexToTest, GridLocation, HitResult, CharacterCollisionChannel)) return false;
+	if (HasAuthority())
+	{
+		const FRegisteredCharacter* Entry = CharacterRegistry.Find(ID);
+		DeployedCharacter = Entry != nullptr && IsValid(Entry->Character) ? Entry->Character : nullptr;
+	}
+	else DeployedCharacter = FindDeployedCharacterInWorld(ID);
 
-	TArray<FHitResult> HitResults;
-	FCollisionQueryParams CollisionQueryParams;
-	CollisionQueryParams.AddIgnoredActor(AutobattlerGrid);
-	CollisionQueryParams.bTraceComplex = false;
+	return DeployedCharacter != nullptr;
+}
 
-	GetWorld()->SweepMultiByChannel(
-		HitResults,
-		FVector(GridLocation.X, GridLocation.Y, GridLocation.Z + AutobattlerGrid->GetGridMaxZExtent()),
-		FVector(GridLocation.X, GridLocation.Y, GridLocation.Z - AutobattlerGrid->GetGridMaxZExtent()),
-		FQuat(AutobattlerGrid->GetActorRotation()),
-		CharacterCollisionChannel,
-		FCollisionShape::MakeBox(FVector(AutobattlerGrid->GetGridXYSize() / 2.0f, AutobattlerGrid->GetGridXYSize() / 2.0f, AutobattlerGrid->GetGridMaxZExtent()))
-	);
+bool AAutobattlerManager::GetIsGridIndexOccupied(const FIntPair& IndexToTest) const
+{
+	if (!HasAuthority()) return false;
+	if (!IsValid(AutobattlerGrid)) return false;
 
-	return HitResults.ContainsByPredicate([](const FHitResult& HitResult) {
-		return IsValid(Cast<AAutobattlerCharacter>(HitResult.GetActor()));
-		});
+	return AutobattlerGrid->GetIsIndexOccupied(IndexToTest);
 }
 
 bool AAutobattlerManager::GetIsBoundsOccupied(const FVector& BoxCenter, const FRotator& BoxRotation, const FVector& BoxExtent, TEnumAsByte<ECollisionChannel> CollisionChannel, const TArray<AActor*>& ActorsToIgnore) const
@@ -266,12 +417,56 @@ bool AAutobattlerManager::GetCanPlayerDeployOnIndex(EEntity WhoOwns, const FIntP
 {
 	if (const FIdentityConfiguration* Configuration = IdentityConfigurations.Find(WhoOwns))
 	{
-		return Configuration->AllowedDeploymentIndicies.Contains(IndexToTest);
+		return IsValid(AutobattlerGrid) && AutobattlerGrid->GetIsIndexInMask(Configuration->DeploymentZoneMask, IndexToTest);
 	}
 
 	return false;
 }
 
+void AAutobattlerManager::GetLegalDeploymentIndicies(EEntity WhoOwns, TArray<FIntPair>& LegalIndicies) const
+{
+	LegalIndicies.Reset();
+	if (!HasAuthority() || !IsValid(AutobattlerGrid)) return;
+
+	if (const FIdentityConfiguration* Configuration = IdentityConfigurations.Find(WhoOwns))
+	{
+		AutobattlerGrid->GetFreeIndicesInMask(Configuration->DeploymentZoneMask, LegalIndicies);
+	}
+}
+
+void AAutobattlerManager::RefreshCharacterGridOccupancy(AAutobattlerCharacter* Character)
+{
+	if (!HasAuthority() || !IsValid(Character) || !IsValid(AutobattlerGrid)) return;
+
+	const FRegisteredCharacter* Entry = CharacterRegistry.Find(Character->GetID());
+	if (Entry == nullptr || Entry->Character != Character) return;
+
+	FIntPair GridIndex;
+	const FVector FeetLocation = Character->GetActorLocation() - FVector(0.0f, 0.0f, Character->GetCapsuleComponent()->GetScaledCapsuleHalfHeight());
+	if (Character->GetIsDead() || !AutobattlerGrid->LocationToGridIndex(FeetLocation, GridIndex)) AutobattlerGrid->ClearIndexOccupant(Character->GetID());
+	else if (!AutobattlerGrid->SetIndexOccupant(GridIndex, Character->GetID(), Entry->WhoOwns))
+	{
+		AutobattlerGrid->ClearIndexOccupant(Character->GetID());
+		UAutobattlerFunctionLibrary::PrintWarningToLog(FString::Printf(TEXT("Autobattler Manager : [RefreshCharacterGridOccupancy] Character with ID %d was moved onto %s, which is already occupied!"), Character->GetID(), *GridIndex.ToString()));
+	}
+}
+
+void AAutobattlerManager::SetReplicatedGridCellOccupied(const FIntPair& GridIndex, bool IsOccupied)
+{
+	if (!HasAuthority() || !GetUsesFastArrayReplication() || !IsValid(AutobattlerGrid) || !AutobattlerGrid->IsValidGridIndex(GridIndex)) return;
+
+	EnsureReplicatedGridCells();
+
+	const int32 CellIndex = GridIndex.X * AutobattlerGrid->GetGridYSize() + GridIndex.Y;
+	if (!ReplicatedGridCells.Items.IsValidIndex(CellIndex)) return;
+
+	FAutobattlerGridCellItem& Cell = ReplicatedGridCells.Items[CellIndex];
+	if (Cell.IsOccupied == IsOccupied) return;
+
+	Cell.IsOccupied = IsOccupied;
+	ReplicatedGridCells.MarkItemDirty(Cell);
+}
+
 void AAutobattlerManager::AdvanceGamePhase()
 {
 	if (!HasAuthority()) return;
@@ -279,18 +474,38 @@ void AAutobattlerManager::AdvanceGamePhase()
 	if (GamePhase == EAutobattlerPhase::Setup) GamePhase = EAutobattlerPhase::Fight;
 	else if (GamePhase == EAutobattlerPhase::Fight) GamePhase = EAutobattlerPhase::Setup;
 
+	// Effects only exist during the fight; characters are rebuilt from their listings afterwards anyway.
+	if (GamePhase != EAutobattlerPhase::Fight)
+	{
+		EndBattleRecording(EWhoWins::Nobody);
+		BattleStats.EndBattle(GetWorld()->GetTimeSeconds(), EWhoWins::Nobody);
+		EffectScheduler.Reset();
+		GridPathfinder.Reset(GridPathfinder.GetSizeX(), GridPathfinder.GetSizeY());
+	}
+	SetActorTickEnabled(GamePhase == EAutobattlerPhase::Fight || ProjectileSystem.Num() > 0);
+
 	if (GamePhase != EAutobattlerPhase::Setup)
 	{
 		TArray<FIntPair> DummyArray;
 		TArray<EEntity> Entities = { EEntity::PlayerOne, EEntity::PlayerTwo };
-		for (auto Entity : Entities) Multicast_RequestIndexVisibilityChange(AutobattlerGrid, Entity, false, DummyArray);
+		for (auto Entity : Entities) RequestIndexVisibilityChange(Entity, false, DummyArray);
 	}
 
+	ApplyAdaptiveReplication();
+	if (GamePhase == EAutobattlerPhase::Fight)
+	{
+		// Controllers reschedule themselves when they are told the phase has changed, below.
+		AIScheduler.ApplyConfiguration(GetAutobattlerConfigurationAsset());
+		BattleStats.BeginBattle(GetWorld()->GetTimeSeconds(), CharacterRegistry.Num());
+		BeginBattleRecording();
+	}
 	Multicast_OnGamePhaseAdvance(GamePhase);
 }
 
 void AAutobattlerManager::CheckWinCondition()
 {
+	AUTOBATTLER_SCOPE_CYCLE_COUNTER(STAT_AutobattlerWinCheck);
+
 	if (!HasAuthority())
 	{
 		UAutobattlerFunctionLibrary::PrintWarningToLog(FString("Autobattler Manager : [CheckWinCondition] Win condition should not be checked on client!"));
@@ -307,19 +522,20 @@ void AAutobattlerManager::CheckWinCondition()
 	}
 
 	TArray<AAutobattlerCharacter*> Characters;
-	for (TActorIterator<AAutobattlerCharacter> ActorItr(GetWorld()); ActorItr; ++ActorItr)
-	{
-		AAutobattlerCharacter* Character = *ActorItr;
-		if (!IsValid(Character)) continue;
+	GetAllDeployedCharacters(Characters);
 
-		Characters.Emplace(Character);
-	}
+	if (!IsValid(WinConditionInstance) || WinConditionInstance->GetClass() != WinConditionClass.Get()) WinConditionInstance = NewObject<UWinConditionBase>(this, WinConditionClass);
 
-	UWinConditionBase* WinCondition = NewObject<UWinConditionBase>(this, WinConditionClass);
-	EWhoWins Winner = WinCondition->CheckWinCondition(Characters);
+	// The default condition is native, so it is called directly rather than dispatched as a Blueprint event.
+	EWhoWins Winner = WinConditionClass.Get() == UWinConditionBase::StaticClass()
+		? WinConditionInstance->CheckWinCondition_Implementation(Characters)
+		: WinConditionInstance->CheckWinCondition(Characters);
 
 	if (Winner != EWhoWins::Nobody)
 	{
+		EndBattleRecording(Winner);
+		BattleStats.EndBattle(GetWorld()->GetTimeSeconds(), Winner);
+
 		if (BattleEndDelay <= 0.0f)
 		{
 			AdvanceGamePhase();
@@ -353,7 +569,7 @@ void AAutobattlerManager::SetBudgetForEntity(EEntity WhoOwns, int32 NewBudget)
 		IdentityConfigurations.Emplace(WhoOwns, NewConfiguration);
 	}
 
-	Multicast_OnMaxBudgetChange(WhoOwns, ClampedBudget);
+	NotifyMaxBudgetChange(WhoOwns, ClampedBudget);
 }
 
 void AAutobattlerManager::ModifyBudgetForEntity(EEntity WhoOwns, int32 DeltaBudget)
@@ -372,7 +588,7 @@ void AAutobattlerManager::ModifyBudgetForEntity(EEntity WhoOwns, int32 DeltaBudg
 		IdentityConfigurations.Emplace(WhoOwns, NewConfiguration);
 	}
 
-	Multicast_OnMaxBudgetChange(WhoOwns, UpdatedBudget);
+	NotifyMaxBudgetChange(WhoOwns, UpdatedBudget);
 }
 
 bool AAutobattlerManager::AddDeploymentIndexForPlayer(EEntity WhoOwns, const FIntPair& NewIndex)
@@ -380,44 +596,104 @@ bool AAutobattlerManager::AddDeploymentIndexForPlayer(EEntity WhoOwns, const FIn
 	if (!HasAuthority() || !IsValid(AutobattlerGrid)) return false;
 	if (!AutobattlerGrid->IsValidGridIndex(NewIndex)) return false;
 
+	// Adding an index already in the zone is not an error; the zone is a set, so it simply stays in it.
+	AutobattlerGrid->SetIndexInMask(IdentityConfigurations.FindOrAdd(WhoOwns).DeploymentZoneMask, NewIndex, true);
+	return true;
+}
+
+bool AAutobattlerManager::RemoveDeploymentIndexForPlayer(EEntity WhoOwns, const FIntPair& IndexToRemove)
+{
+	if (!IsValid(AutobattlerGrid)) return false;
+
 	if (FIdentityConfiguration* IdentityConfiguration = IdentityConfigurations.Find(WhoOwns))
 	{
-		IdentityConfiguration->AllowedDeploymentIndicies.Emplace(NewIndex);
-	}
-	else
-	{
-		FIdentityConfiguration NewConfiguration = FIdentityConfiguration();
-		NewConfiguration.AllowedDeploymentIndicies.Emplace(NewIndex);
-		IdentityConfigurations.Emplace(WhoOwns, NewConfiguration);
+		return AutobattlerGrid->SetIndexInMask(IdentityConfiguration->DeploymentZoneMask, IndexToRemove, false);
 	}
 
+	return false;
+}
+
+bool AAutobattlerManager::ModifyDeploymentZoneByRectangle(EEntity WhoOwns, const FIntPair& Corner, const FIntPair& OppositeCorner, EDeploymentZoneOperation Operation)
+{
+	if (!HasAuthority() || !IsValid(AutobattlerGrid)) return false;
+
+	TArray<uint32> Mask;
+	AutobattlerGrid->BuildRectangleMask(Corner, OppositeCorner, Mask);
+	ApplyDeploymentZoneMask(WhoOwns, Mask, Operation);
 	return true;
 }
 
-bool AAutobattlerManager::RemoveDeploymentIndexForPlayer(EEntity WhoOwns, const FIntPair& IndexToRemove)
+bool AAutobattlerManager::ModifyDeploymentZoneByFloodFill(EEntity WhoOwns, const FIntPair& Start, const TArray<FIntPair>& Boundary, EDeploymentZoneOperation Operation)
 {
-	if (FIdentityConfiguration* IdentityConfiguration = IdentityConfigurations.Find(WhoOwns))
+	if (!HasAuthority() || !IsValid(AutobattlerGrid)) return false;
+
+	TArray<uint32> BoundaryMask;
+	AutobattlerGrid->BuildIndexMask(Boundary, BoundaryMask);
+
+	TArray<uint32> Mask;
+	AutobattlerGrid->BuildFloodFillMask(Start, BoundaryMask, Mask);
+	ApplyDeploymentZoneMask(WhoOwns, Mask, Operation);
+	return true;
+}
+
+bool AAutobattlerManager::ModifyDeploymentZoneByIndicies(EEntity WhoOwns, const TArray<FIntPair>& Indicies, EDeploymentZoneOperation Operation)
+{
+	if (!HasAuthority() || !IsValid(AutobattlerGrid)) return false;
+
+	TArray<uint32> Mask;
+	AutobattlerGrid->BuildIndexMask(Indicies, Mask);
+	ApplyDeploymentZoneMask(WhoOwns, Mask, Operation);
+	return true;
+}
+
+void AAutobattlerManager::GetDeploymentZoneForPlayer(EEntity WhoOwns, TArray<FIntPair>& OutIndicies) const
+{
+	OutIndicies.Reset();
+	if (!IsValid(AutobattlerGrid)) return;
+
+	if (const FIdentityConfiguration* IdentityConfiguration = IdentityConfigurations.Find(WhoOwns))
 	{
-		return IdentityConfiguration->AllowedDeploymentIndicies.Remove(IndexToRemove) > 0;
+		AutobattlerGrid->GetIndicesInMask(IdentityConfiguration->DeploymentZoneMask, OutIndicies);
 	}
+}
 
-	return false;
+void AAutobattlerManager::ApplyDeploymentZoneMask(EEntity WhoOwns, const TArray<uint32>& Mask, EDeploymentZoneOperation Operation)
+{
+	TArray<uint32>& ZoneMask = IdentityConfigurations.FindOrAdd(WhoOwns).DeploymentZoneMask;
+	if (ZoneMask.Num() < Mask.Num()) ZoneMask.SetNumZeroed(Mask.Num());
+
+	for (int32 Word = 0; Word < ZoneMask.Num(); Word++)
+	{
+		const uint32 MaskWord = Mask.IsValidIndex(Word) ? Mask[Word] : 0;
+		switch (Operation)
+		{
+		case EDeploymentZoneOperation::Add:       ZoneMask[Word] |= MaskWord; break;
+		case EDeploymentZoneOperation::Remove:    ZoneMask[Word] &= ~MaskWord; break;
+		case EDeploymentZoneOperation::Intersect: ZoneMask[Word] &= MaskWord; break;
+		case EDeploymentZoneOperation::Replace:   ZoneMask[Word] = MaskWord; break;
+		}
+	}
 }
 
 bool AAutobattlerManager::AddCharacterForPlayer(const FCharacterListing& NewListing, EEntity WhoOwns, int32& ID, bool GeneratePanelActor)
 {
 	if (!HasAuthority()) return false;
 
+	// Resolved once here, so every later lookup for this character indexes the baked definitions directly.
+	FCharacterListing ResolvedListing = NewListing;
+	const FAutobattlerCharacterDefinition* Definition = UAutobattlerFunctionLibrary::GetCharacterDefinitionByHandle(this, ResolvedListing.CharacterDefinitionHandle, ResolvedListing.CharacterRowName);
+
 	if (FIdentityConfiguration* IdentityConfiguration = IdentityConfigurations.Find(WhoOwns))
 	{
-		IdentityConfiguration->Characters.Emplace(IDDispenser, NewListing);
+		IdentityConfiguration->Characters.Emplace(IDDispenser, ResolvedListing);
 	}
 	else
 	{
 		FIdentityConfiguration NewConfiguration = FIdentityConfiguration();
-		NewConfiguration.Characters.Emplace(IDDispenser, NewListing);
+		NewConfiguration.Characters.Emplace(IDDispenser, ResolvedListing);
 		IdentityConfigurations.Emplace(WhoOwns, NewConfiguration);
 	}
+	OwnersByID.Emplace(IDDispenser, WhoOwns);
 
 	ID = IDDispenser;
 	IDDispenser += 1;
@@ -427,7 +703,7 @@ bool AAutobattlerManager::AddCharacterForPlayer(const FCharacterListing& NewList
 		FActorSpawnParameters SpawnParams;
 		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
 
-		if (FAutobattlerCharacterDefinition* Definition = UAutobattlerFunctionLibrary::GetCharacterDefinitionFromConfigurationDatatable(this, NewListing.CharacterRowName))
+		if (Definition != nullptr)
 		{
 			if (const UAutobattlerConfiguration* Configuration = GetAutobattlerConfigurationAsset())
 			{
@@ -437,7 +713,7 @@ bool AAutobattlerManager::AddCharacterForPlayer(const FCharacterListing& NewList
 		}
 	}
 
-	Multicast_OnAddCharacterForPlayer(ID, NewListing, WhoOwns, GeneratePanelActor);
+	NotifyCharacterAdded(ID, NewListing, WhoOwns, GeneratePanelActor);
 
 	return true;
 }
@@ -459,9 +735,10 @@ bool AAutobattlerManager::RemoveCharacterForPlayer(EEntity WhoOwns, int32 ID, bo
 		bool Found = GetIsCharacterDeployed(ID, CharacterToReturn);
 		if (IsValid(CharacterToReturn) && Found && CharacterToReturn->GetOwnerIdentity() == WhoOwns)
 		{
+			UnregisterCharacter(ID, CharacterToReturn);
 			CharacterToReturn->GetCharacterPanelComponent()->DestroyComponent();
 			CharacterToReturn->Destroy();
-			Multicast_OnRemoveCharacterForPlayer(ID, WhoOwns, ReturnToBarracks);
+			NotifyCharacterRemoved(ID, WhoOwns, ReturnToBarracks);
 			return true;
 		}
 	}
@@ -475,6 +752,7 @@ bool AAutobattlerManager::RemoveCharacterForPlayer(EEntity WhoOwns, int32 ID, bo
 				bool Found = GetIsCharacterDeployed(ID, CharacterToReturn);
 				if (IsValid(CharacterToReturn) && Found && CharacterToReturn->GetOwnerIdentity() == WhoOwns)
 				{
+					UnregisterCharacter(ID, CharacterToReturn);
 					CharacterToReturn->GetCharacterPanelComponent()->DestroyComponent();
 					CharacterToReturn->Destroy();
 				}
@@ -482,7 +760,7 @@ bool AAutobattlerManager::RemoveCharacterForPlayer(EEntity WhoOwns, int32 ID, bo
 				ACharacterPanelActor* CharacterPanelActorToRemove = ACharacterPanelActor::GetCharacterPanelActorByID(this, ID);
 				if (IsValid(CharacterPanelActorToRemove)) CharacterPanelActorToRemove->Destroy();
 
-				Multicast_OnRemoveCharacterForPlayer(ID, WhoOwns, ReturnToBarracks);
+				NotifyCharacterRemoved(ID, WhoOwns, ReturnToBarracks);
 				return true;
 			}
 		}
@@ -509,8 +787,10 @@ void AAutobattlerManager::BeginFloatingCharacterForPlayer(EEntity WhoOwns, int32
 			{
 				if (ControllerComponent->SpawnPreviewCharacter(OutListing, CharacterID))
 				{
-					Multicast_OnFloatStateChange(WhoOwns, true, CharacterID);
-					Multicast_RequestIndexVisibilityChange(AutobattlerGrid, WhoOwns, true, IdentityConfiguration->AllowedDeploymentIndicies);
+					TArray<FIntPair> DeploymentZone;
+					GetDeploymentZoneForPlayer(WhoOwns, DeploymentZone);
+					NotifyFloatBegun(WhoOwns, CharacterID);
+					RequestIndexVisibilityChange(WhoOwns, true, DeploymentZone);
 				}
 				else UAutobattlerFunctionLibrary::PrintErrorToLog(FString::Printf(TEXT("Autobattler Manager : [BeginFloatingCharacterForPlayer] Failed to spawn character for player %d with ID: %d"), (int32)WhoOwns, CharacterID));
 			}
@@ -532,10 +812,10 @@ bool AAutobattlerManager::CancelFloatingCharacterForPlayer(EEntity WhoOwns)
 			if (GetCharacterListingByID(WhoOwns, PreviewCharacterID, PreviewCharacterListing))
 			{
 				ControllerComponent->ClearPreviewCharacter();
-				Multicast_OnFloatStateCancelled(WhoOwns, PreviewCharacterListing, PreviewCharacterID);
+				NotifyFloatEnded(WhoOwns, PreviewCharacterID, true, PreviewCharacterListing);
 
 				TArray<FIntPair> DummyArray;
-				Multicast_RequestIndexVisibilityChange(AutobattlerGrid, WhoOwns, false, DummyArray);
+				RequestIndexVisibilityChange(WhoOwns, false, DummyArray);
 				return true;
 			}
 		}
@@ -576,9 +856,18 @@ bool AAutobattlerManager::DeployCharacterForPlayerByTransform(EEntity WhoOwns, i
 			FActorSpawnParameters ActorSpawnParams;
 			ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
 
+			// On the grid, occupancy is read from the grid's bitmap before anything is spawned. Off the grid, the deployment bounds are swept below.
+			FIntPair DeployGridIndex;
+			const bool IsDeployedOnGrid = IsValid(AutobattlerGrid) && AutobattlerGrid->LocationToGridIndex(DeployTransform.GetLocation(), DeployGridIndex);
+			if (IsDeployedOnGrid && AutobattlerGrid->GetIsIndexOccupied(DeployGridIndex))
+			{
+				UAutobattlerFunctionLibrary::PrintWarningToLog(FString::Printf(TEXT("Autobattler Manager : [DeployCharacterForPlayerByTransform] Character with ID %d could not be deployed, as %s is already occupied!"), CharacterID, *DeployGridIndex.ToString()));
+				return false;
+			}
+
 			FTransform ActualDeployTransform = DeployTransform;
 			UClass* AutobattlerCharacterClass = nullptr;
-			if (FAutobattlerCharacterDefinition* CharacterDefinition = UAutobattlerFunctionLibrary::GetCharacterDefinitionFromConfigurationDatatable(this, CurrentListing->CharacterRowName))
+			if (const FAutobattlerCharacterDefinition* CharacterDefinition = UAutobattlerFunctionLibrary::GetCharacterDefinitionByHandle(this, CurrentListing->CharacterDefinitionHandle, CurrentListing->CharacterRowName))
 			{
 				if (WhoOwns == EEntity::AI) ActualDeployTransform.SetLocation(ActualDeployTransform.GetLocation() + CharacterDefinition->DeploymentOffset);
 				ActualDeployTransform.SetRotation(DeployTransform.GetRotation());
@@ -592,6 +881,11 @@ bool AAutobattlerManager::DeployCharacterForPlayerByTransform(EEntity WhoOwns, i
 			);
 
 			NewCharacter->BuildCharacterFromListing(WhoOwns, CharacterID, *CurrentListing);
+			if (!IsValid(NewCharacter)) return false; // Building destroys the character if its definition does not exist.
+
+			// Registered before the bounds check so a blocked deployment can be removed through the usual path.
+			RegisterCharacter(NewCharacter, CharacterID, WhoOwns);
+			if (IsDeployedOnGrid) AutobattlerGrid->SetIndexOccupant(DeployGridIndex, CharacterID, WhoOwns);
 			NewCharacter->SetActorLocation(
 				FVector(
 					NewCharacter->GetActorLocation().X,
@@ -600,7 +894,8 @@ bool AAutobattlerManager::DeployCharacterForPlayerByTransform(EEntity WhoOwns, i
 				)
 			);
 
-			if (UBoxComponent* CharacterDeploymentBounds = NewCharacter->GetDeploymentBounds())
+			UBoxComponent* CharacterDeploymentBounds = NewCharacter->GetDeploymentBounds();
+			if (!IsDeployedOnGrid && CharacterDeploymentBounds != nullptr)
 			{
 				TArray<AActor*> IgnoreActors;
 				IgnoreActors.Emplace(NewCharacter);
@@ -621,10 +916,13 @@ bool AAutobattlerManager::DeployCharacterForPlayerByTransform(EEntity WhoOwns, i
 
 			if (!NewCharacter->ActionChanged.IsAlreadyBound(this, &AAutobattlerManager::OnAnyCharacterStateChange)) NewCharacter->ActionChanged.AddDynamic(this, &AAutobattlerManager::OnAnyCharacterStateChange);
 			if (!NewCharacter->OnDestroyed.IsAlreadyBound(this, &AAutobattlerManager::OnCharacterDestroyed)) NewCharacter->OnDestroyed.AddDynamic(this, &AAutobattlerManager::OnCharacterDestroyed);
+			if (BattleReplay.GetIsRecording()) RecordBattleCharacter(NewCharacter, WhoOwns);
+			BattleStats.RecordUnits(CharacterRegistry.Num());
 			Multicast_OnCharacterDeploy(WhoOwns, NewCharacter);
+			NotifyFloatEnded(WhoOwns, CharacterID, false, *CurrentListing);
 
 			TArray<FIntPair> DummyArray;
-			Multicast_RequestIndexVisibilityChange(AutobattlerGrid, WhoOwns, false, DummyArray);
+			RequestIndexVisibilityChange(WhoOwns, false, DummyArray);
 
 			return true;
 		}
@@ -640,11 +938,29 @@ bool AAutobattlerManager::GenerateAIFormation(const FName& FormationRowName, con
 	if (ClearPrevious)
 	{
 		TArray<AAutobattlerCharacter*> ToBeRemoved;
-		for (TActorIterator<AAutobattlerCharacter> ActorItr(GetWorld()); ActorItr; ++ActorItr)
+		GetDeployedCharactersByEntity(ToBeRemoved, EEntity::AI);
+
+		for (int32 i = 0; i < ToBeRemoved.Num(); i++)
 		{
-			AAutobattlerCharacter* PendingCharacter = *ActorItr;
-			if (IsValid(PendingCharacter) && PendingCharacter->GetOwnerIdentity() == EEntity::AI) ToBeRemoved.Emplace(PendingCharacter);
+			ToBeRemoved[i]->Destroy();
+			ToBeRemoved[i] = nullptr;
 		}
+	}
+
+	// Seeded from the global random stream, so every generated formation is different.
+	FRandomStream Stream(FMath::Rand());
+	TMap<int32, FIntPair> Placements;
+	if (!PlanAIFormation(FormationRowName, WhiteList, Blacklist, Stream, Placements)) return false;
+
+	return DeployAIFormation(Placements, false);
+}
+
+bool AAutobattlerManager::DeployAIFormation(const TMap<int32, FIntPair>& Placements, bool ClearPrevious)
+{
+	if (ClearPrevious)
+	{
+		TArray<AAutobattlerCharacter*> ToBeRemoved;
+		GetDeployedCharactersByEntity(ToBeRemoved, EEntity::AI);
 
 		for (int32 i = 0; i < ToBeRemoved.Num(); i++)
 		{
@@ -653,171 +969,118 @@ bool AAutobattlerManager::GenerateAIFormation(const FName& FormationRowName, con
 		}
 	}
 
-	if (WhiteList.Num() < 1)
+	for (auto& Placement : Placements)
+	{
+		DeployCharacterForPlayerByGridIndex(EEntity::AI, Placement.Key, Placement.Value, FRotator::ZeroRotator, FVector::OneVector);
+	}
+
+	return true;
+}
+
+bool AAutobattlerManager::EvaluateAIFormation(const FName& FormationRowName, const TArray<FName>& WhiteList, const TArray<FName>& Blacklist, int32 NumCandidates, int32 BattlesPerCandidate, int32 Seed, TArray<FAutobattlerMatchupReport>& Reports)
+{
+	Reports.Reset();
+	if (!HasAuthority()) return false;
+
+	if (NumCandidates < 1 || BattlesPerCandidate < 1)
 	{
-		UAutobattlerFunctionLibrary::PrintErrorToLog(FString("AutobattlerManager : [GenerateAIFormation] When generating AI formation, whitelist is empty!"));
+		UAutobattlerFunctionLibrary::PrintErrorToLog(FString::Printf(TEXT("Autobattler Manager : [EvaluateAIFormation] Need at least one candidate and one battle per candidate (got %d and %d)!"), NumCandidates, BattlesPerCandidate));
 		return false;
 	}
 
-	FIdentityConfiguration* AIIdentity = IdentityConfigurations.Find(EEntity::AI);
-	if (AIIdentity == nullptr)
+	if (!IsValid(AutobattlerGrid))
 	{
-		UAutobattlerFunctionLibrary::PrintErrorToLog(FString("AutobattlerManager : [GenerateAIFormation] When generating AI formation, there is no identity configuration for player 0 (aka the AI)!"));
+		UAutobattlerFunctionLibrary::PrintErrorToLog(FString("Autobattler Manager : [EvaluateAIFormation] No valid autobattler grid!"));
 		return false;
 	}
 
-	if (AIIdentity->Characters.Num() < 1)
+	// The player roster is whatever the players have deployed; candidates only differ in the AI characters.
+	FAutobattlerSimulationSetup PlayerSetup;
+	if (!BuildSimulationSetupFromBattlefield(PlayerSetup, false))
 	{
-		UAutobattlerFunctionLibrary::PrintErrorToLog(FString("AutobattlerManager : [GenerateAIFormation] When generating AI formation, player 0 (aka the AI) has no characters to deploy!"));
+		UAutobattlerFunctionLibrary::PrintErrorToLog(FString("Autobattler Manager : [EvaluateAIFormation] Could not get configuration asset!"));
 		return false;
 	}
+	PlayerSetup.Settings.RecordEvents = false;
 
-	if (const UAutobattlerConfiguration* Configuration = GetAutobattlerConfigurationAsset())
+	TArray<FAutobattlerSimulationSetup> Candidates;
+	TArray<TMap<int32, FIntPair>> CandidatePlacements;
+	TArray<int32> CandidateSeeds;
+	TMap<FIntPair, FVector> GridLocations;
+	for (int32 i = 0; i < NumCandidates; i++)
 	{
-		if (const UDataTable* Formations = Configuration->AIFormationsDatatable)
+		const int32 CandidateSeed = (int32)HashCombine((uint32)Seed, (uint32)i);
+		FRandomStream Stream(CandidateSeed);
+		TMap<int32, FIntPair> Placements;
+		if (!PlanAIFormation(FormationRowName, WhiteList, Blacklist, Stream, Placements)) return false;
+
+		// Small formations and rosters often produce the same placements more than once, only simulate each of them once.
+		bool IsDuplicate = false;
+		for (auto& Other : CandidatePlacements)
 		{
-			if (FAIFormation* AIFormation = Formations->FindRow<FAIFormation>(FormationRowName, FString("AI Formation")))
+			if (Other.OrderIndependentCompareEqual(Placements))
 			{
-				if (const UDataTable* AllCharacters = Configuration->AllCharactersDataTable)
-				{
-					// First, get ALL characters owned by the AI
-					TMap<int32, FAutobattlerCharacterDefinition> AllDefinitions;
-					for (auto& Character : AIIdentity->Characters)
-					{
-						if (FAutobattlerCharacterDefinition* CharacterDefinition = AllCharacters->FindRow<FAutobattlerCharacterDefinition>(Character.Value.CharacterRowName, FString("AI Formation")))
-						{
-							AllDefinitions.Add(Character.Key, *CharacterDefinition);
-						}
-						else UAutobattlerFunctionLibrary::PrintWarningToLog(FString::Printf(TEXT("AutobattlerManager : [GenerateAIFormation] When generating AI formation, character with row name %s was not found and was skipped!"), *Character.Value.CharacterRowName.ToString()));
-					}
-
-					// Next, pick only characters which have a tag on the white list
-					TMap<int32, FAutobattlerCharacterDefinition> BlackWhiteListFiltered;
-					for (auto& Definition : AllDefinitions)
-					{
-						for (auto& Tag : Definition.Value.BlackWhiteListTags)
-						{
-							if (WhiteList.Contains(Tag))
-							{
-								BlackWhiteListFiltered.Emplace(Definition.Key, Definition.Value);
-								break;
-							}
-						}
-					}
+				IsDuplicate = true;
+				break;
+			}
+		}
+		if (IsDuplicate) continue;
 
-					// Next, remove characters which have a tag on the black list (if a blacklist exists)
-					if (Blacklist.Num() > 0)
-					{
-						TArray<int32> Keys;
-						BlackWhiteListFiltered.GenerateKeyArray(Keys);
-
-						for (auto Key : Keys)
-						{
-							if (FAutobattlerCharacterDefinition* Definition = BlackWhiteListFiltered.Find(Key))
-							{
-								for (auto& Tag : Definition->BlackWhiteListTags)
-								{
-									if (Blacklist.Contains(Tag))
-									{
-										BlackWhiteListFiltered.Remove(Key);
-										break;
-									}
-								}
-							}
-						}
-					}
-
-					// Next, create a final definition from the budget.
-					TMap<int32, FAutobattlerCharacterDefinition> Final;
-					int32 AIBudget = GetMaxBudgetForEntity(EEntity::AI);
-					TArray<int32> Keys;
-					BlackWhiteListFiltered.GenerateKeyArray(Keys);
-
-					// Shuffle key array.
-					int32 LastIndex = Keys.Num() - 1;
-					for (int32 i = 0; i <= LastIndex; i++)
-					{
-						int32 NewIndex = FMath::RandRange(i, LastIndex);
-						if (i != NewIndex) Keys.Swap(i, NewIndex);
-					}
-
-					int32 PendingBudget = 0;
-					for (auto Key : Keys)
-					{
-						if (FAutobattlerCharacterDefinition* Definition = BlackWhiteListFiltered.Find(Key))
-						{
-							if (PendingBudget + Definition->BudgetCost > AIBudget) continue;
-							else
-							{
-								Final.Emplace(Key, *Definition);
-								PendingBudget += Definition->BudgetCost;
-							}
-						}
-					}
-
-					TMap<int32, FAutobattlerCharacterDefinition> ToBeDeployedRandomly;
-					TMap<FIntPair, FName> FormationMap = AIFormation->FormationMap;
-
-					// Deploy characters first on their preferred deployment location
-					while (Final.Num() != 0)
-					{
-						if (FormationMap.Num() == 0) return true; // This occurs if we have run out of spaces to deploy
-						TArray<int32> KeyArray;
-						Final.GenerateKeyArray(KeyArray);
-
-						int32 ActiveKey = KeyArray[0];
-						FAutobattlerCharacterDefinition* Definition = Final.Find(ActiveKey);
-
-						bool DidFindDeploymentLocation = false;
-						for (auto& DeploymentLocation : FormationMap)
-						{
-							if (DeploymentLocation.Value.IsEqual(Definition->PreferedDeploymentLocation))
-							{
-								DidFindDeploymentLocation = true;
-								DeployCharacterForPlayerByGridIndex(EEntity::AI, ActiveKey, DeploymentLocation.Key, FRotator::ZeroRotator, FVector::OneVector);
-								FormationMap.Remove(DeploymentLocation.Key);
-								break;
-							}
-						}
-
-						if (!DidFindDeploymentLocation) ToBeDeployedRandomly.Emplace(ActiveKey, *Definition);
-						Final.Remove(ActiveKey);
-					}
-
-					// Otherwise, deploy characters randomly.
-					if (ToBeDeployedRandomly.Num() > 0)
-					{
-						while (ToBeDeployedRandomly.Num() != 0)
-						{
-							if (FormationMap.Num() == 0) return true; // This occurs if we have run out of spaces to deploy
-							TArray<int32> KeyArray;
-							ToBeDeployedRandomly.GenerateKeyArray(KeyArray);
+		// PlanAIFormation succeeding means the AI identity exists.
+		const FIdentityConfiguration* AIIdentity = IdentityConfigurations.Find(EEntity::AI);
+		FAutobattlerSimulationSetup& Setup = Candidates.Add_GetRef(PlayerSetup);
+		for (auto& Placement : Placements)
+		{
+			const FCharacterListing* Listing = AIIdentity->Characters.Find(Placement.Key);
+			int32 DefinitionHandle = Listing ? Listing->CharacterDefinitionHandle : INDEX_NONE;
+			const FAutobattlerCharacterDefinition* Definition = Listing ? UAutobattlerFunctionLibrary::GetCharacterDefinitionByHandle(this, DefinitionHandle, Listing->CharacterRowName) : nullptr;
+			if (Definition == nullptr) continue;
+
+			// Same location as DeployCharacterForPlayerByGridIndex would use, traced once per grid index.
+			FVector* Location = GridLocations.Find(Placement.Value);
+			if (Location == nullptr)
+			{
+				FVector GridLocation;
+				FHitResult HitResult;
+				if (!AutobattlerGrid->GridIndexToLocation(Placement.Value, GridLocation, HitResult)) continue;
+				Location = &GridLocations.Add(Placement.Value, HitResult.Location);
+			}
 
-							int32 ActiveKey = KeyArray[0];
-							FAutobattlerCharacterDefinition* Definition = Final.Find(ActiveKey);
+			Setup.AddCharacter(*Definition, EEntity::AI, *Location + Definition->DeploymentOffset, Placement.Key);
+		}
 
-							TArray<FIntPair> DeploymentLocations;
-							FormationMap.GenerateKeyArray(DeploymentLocations);
+		CandidatePlacements.Add(MoveTemp(Placements));
+		CandidateSeeds.Add(CandidateSeed);
+	}
 
-							FIntPair RandomLocation = DeploymentLocations[FMath::RandRange(0, DeploymentLocations.Num() - 1)];
-							DeployCharacterForPlayerByGridIndex(EEntity::AI, ActiveKey, RandomLocation, FRotator::ZeroRotator, FVector::OneVector);
+	const double StartTime = FPlatformTime::Seconds();
+	FAutobattlerMatchupEvaluator::Evaluate(Candidates, BattlesPerCandidate, Seed, Reports);
+	const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
 
-							FormationMap.Remove(RandomLocation);
-							ToBeDeployedRandomly.Remove(ActiveKey);
-						}
-					}
+	for (int32 i = 0; i < Reports.Num(); i++)
+	{
+		Reports[i].CandidateSeed = CandidateSeeds[i];
+		Reports[i].Placements = CandidatePlacements[i];
+	}
+	FAutobattlerMatchupEvaluator::RankByAIStrength(Reports);
 
-					return true;
-				}
-				else UAutobattlerFunctionLibrary::PrintErrorToLog(FString("AutobattlerManager : [GenerateAIFormation] When generating AI formation, All Characters DataTable is invalid!"));
-			}
-			else UAutobattlerFunctionLibrary::PrintErrorToLog(FString::Printf(TEXT("AutobattlerManager : [GenerateAIFormation] When generating AI formation, could not find formation with row name %s!"), *FormationRowName.ToString()));
-		}
-		else UAutobattlerFunctionLibrary::PrintErrorToLog(FString("AutobattlerManager : [GenerateAIFormation] When generating AI formation, AI Formation Datatable is invalid!"));
+	UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Autobattler Manager : [EvaluateAIFormation] Evaluated %d distinct candidates for formation %s, %d battles each, in %.1f ms. Hardest first:"),
+		Reports.Num(), *FormationRowName.ToString(), BattlesPerCandidate, ElapsedMs));
+	for (auto& Report : Reports)
+	{
+		UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Autobattler Manager : [EvaluateAIFormation] Seed %d : AI wins %.1f%% [%.1f%%, %.1f%%], %d draws, battles last %.1f +/- %.1f s%s"),
+			Report.CandidateSeed,
+			Report.AIWinRate * 100.0f,
+			Report.AIWinRateLower * 100.0f,
+			Report.AIWinRateUpper * 100.0f,
+			Report.Draws,
+			Report.MeanBattleDuration,
+			Report.BattleDurationConfidence,
+			Report.IsApproximate ? TEXT(" (approximate)") : TEXT("")
+		));
 	}
-	else UAutobattlerFunctionLibrary::PrintErrorToLog(FString("AutobattlerManager : [GenerateAIFormation] When generating AI formation, could not get configuration asset!"));
 
-	return false;
+	return true;
 }
 
 bool AAutobattlerManager::GenerateBattleFromDebugConfig(const FName& DebugBattleRowName)
@@ -914,13 +1177,7 @@ bool AAutobattlerManager::GenerateAIFormationFromDatatable(const UDataTable* For
 void AAutobattlerManager::ClearBattlefield(bool ReturnToBarracks)
 {
 	TArray<AAutobattlerCharacter*> DeployedCharacters;
-	for (TActorIterator<AAutobattlerCharacter> ActorItr(GetWorld()); ActorItr; ++ActorItr)
-	{
-		AAutobattlerCharacter* Character = *ActorItr;
-		if (!IsValid(Character)) continue;
-
-		DeployedCharacters.Emplace(Character);
-	}
+	GetAllDeployedCharacters(DeployedCharacters);
 
 	for (int32 i = 0; i < DeployedCharacters.Num(); i++)
 	{
@@ -948,6 +1205,7 @@ void AAutobattlerManager::ClearAutobattlerState()
 	}
 
 	IdentityConfigurations.Empty();
+	OwnersByID.Empty();
 }
 
 void AAutobattlerManager::ClearStateForEntity(EEntity WhoOwns)
@@ -964,18 +1222,11 @@ void AAutobattlerManager::ClearStateForEntity(EEntity WhoOwns)
 		for (int32 i = 0; i < IDArray.Num(); i++)
 		{
 			RemoveCharacterForPlayer(WhoOwns, IDArray[i]);
+			OwnersByID.Remove(IDArray[i]);
 		}
 
 		IdentityConfiguration->Characters.Empty();
-
-		TArray<FIntPair> AllowedDeploymentIndiciesTemp = IdentityConfiguration->AllowedDeploymentIndicies;
-
-		for (int32 i = 0; i < AllowedDeploymentIndiciesTemp.Num(); i++)
-		{
-			RemoveDeploymentIndexForPlayer(WhoOwns, AllowedDeploymentIndiciesTemp[i]);
-		}
-
-		IdentityConfiguration->AllowedDeploymentIndicies.Empty();
+		IdentityConfiguration->DeploymentZoneMask.Empty();
 	}
 }
 
@@ -983,7 +1234,17 @@ void AAutobattlerManager::RequestChangeGridVisualisationForEntity(EEntity WhoOwn
 {
 	if (FIdentityConfiguration* IdentityConfiguration = IdentityConfigurations.Find(WhoOwns))
 	{
-		Multicast_RequestIndexVisibilityChange(AutobattlerGrid, WhoOwns, bGridVisible, IdentityConfiguration->AllowedDeploymentIndicies);
+		if (!bGridVisible || !IsValid(AutobattlerGrid))
+		{
+			TArray<FIntPair> DeploymentZone;
+			GetDeploymentZoneForPlayer(WhoOwns, DeploymentZone);
+			RequestIndexVisibilityChange(WhoOwns, bGridVisible, DeploymentZone);
+			return;
+		}
+
+		TArray<FIntPair> LegalIndicies;
+		GetLegalDeploymentIndicies(WhoOwns, LegalIndicies);
+		RequestIndexVisibilityChange(WhoOwns, bGridVisible, LegalIndicies);
 	}
 }
 
@@ -995,6 +1256,11 @@ void AAutobattlerManager::SetNumberOfPlayers(int32 InNumberOfPlayers)
 void AAutobattlerManager::OnAnyCharacterStateChange(EActionType NewAction, AAutobattlerCharacter* UpdatedCharacter)
 {
 	if (!HasAuthority()) return;
+	if (IsValid(UpdatedCharacter)) SetRegisteredCharacterDead(UpdatedCharacter->GetID(), NewAction == EActionType::Dead);
+
+	// Recorded before the win condition is checked, as that may end the recording.
+	if (NewAction == EActionType::Dead && IsValid(UpdatedCharacter)) RecordBattleEvent(EAutobattlerSimulationEventType::Died, nullptr, UpdatedCharacter, 0.0f);
+
 	if (GetGamePhase() == EAutobattlerPhase::Fight)
 	{
 		CheckWinCondition();
@@ -1002,6 +1268,9 @@ void AAutobattlerManager::OnAnyCharacterStateChange(EActionType NewAction, AAuto
 
 	if (NewAction == EActionType::Dead && IsValid(UpdatedCharacter))
 	{
+		AIScheduler.WakeTargetersOf(UpdatedCharacter, GetWorld()->GetTimeSeconds());
+		EffectScheduler.CancelAllOnTarget(UpdatedCharacter);
+		GridPathfinder.ReleaseReservation(UpdatedCharacter->GetID());
 		Multicast_OnCharacterDeath(UpdatedCharacter->GetOwnerIdentity(), UpdatedCharacter->GetID(), UpdatedCharacter);
 	}
 }
@@ -1015,6 +1284,15 @@ void AAutobattlerManager::DelayedBattleEnd()
 
 void AAutobattlerManager::OnCharacterDestroyed(AActor* DestoryedActor)
 {
+	// Cast rather than IsValid, as the actor is already pending kill at this point.
+	if (HasAuthority())
+	{
+		if (AAutobattlerCharacter* DestroyedCharacter = Cast<AAutobattlerCharacter>(DestoryedActor))
+		{
+			UnregisterCharacter(DestroyedCharacter->GetID(), DestroyedCharacter);
+		}
+	}
+
 	Multicast_ClearInvalidCharacterPanels();
 }
 
@@ -1027,6 +1305,107 @@ void AAutobattlerManager::GenerateFormationTags(TArray<FName>& ChosenTags, const
 	}
 }
 
+void AAutobattlerManager::RegisterCharacter(AAutobattlerCharacter* Character, int32 ID, EEntity WhoOwns)
+{
+	if (!HasAuthority() || !IsValid(Character)) return;
+
+	UnregisterCharacter(ID);
+
+	FRegisteredCharacter NewEntry;
+	NewEntry.Character = Character;
+	NewEntry.WhoOwns = WhoOwns;
+	NewEntry.BudgetCost = Character->GetBudgetCost();
+	CharacterRegistry.Emplace(ID, NewEntry);
+
+	FCharacterRegistryPartition& Partition = CharacterRegistryPartitions.FindOrAdd(WhoOwns);
+	if (Character->GetIsDead()) Partition.DeadIDs.Emplace(ID);
+	else Partition.AliveIDs.Emplace(ID);
+	Partition.DeployedBudget += NewEntry.BudgetCost;
+
+	IsCharacterSpatialHashDirty = true;
+}
+
+bool AAutobattlerManager::UnregisterCharacter(int32 ID, const AAutobattlerCharacter* ExpectedCharacter)
+{
+	const FRegisteredCharacter* Entry = CharacterRegistry.Find(ID);
+	if (Entry == nullptr) return false;
+	if (ExpectedCharacter != nullptr && Entry->Character != ExpectedCharacter) return false;
+
+	if (FCharacterRegistryPartition* Partition = CharacterRegistryPartitions.Find(Entry->WhoOwns))
+	{
+		Partition->AliveIDs.Remove(ID);
+		Partition->DeadIDs.Remove(ID);
+		Partition->DeployedBudget -= Entry->BudgetCost;
+	}
+
+	CharacterRegistry.Remove(ID);
+	if (IsValid(AutobattlerGrid)) AutobattlerGrid->ClearIndexOccupant(ID);
+	IsCharacterSpatialHashDirty = true;
+	return true;
+}
+
+void AAutobattlerManager::SetRegisteredCharacterDead(int32 ID, bool IsDead)
+{
+	const FRegisteredCharacter* Entry = CharacterRegistry.Find(ID);
+	if (Entry == nullptr) return;
+
+	bool WasRevived = false;
+	if (FCharacterRegistryPartition* Partition = CharacterRegistryPartitions.Find(Entry->WhoOwns))
+	{
+		if (IsDead)
+		{
+			Partition->AliveIDs.Remove(ID);
+			Partition->DeadIDs.Emplace(ID);
+		}
+		else
+		{
+			WasRevived = Partition->DeadIDs.Remove(ID) > 0;
+			Partition->AliveIDs.Emplace(ID);
+			if (WasRevived)
+			{
+				RecordBattleEvent(EAutobattlerSimulationEventType::Ressurected, nullptr, Entry->Character, 0.0f);
+
+				// Dead characters sleep in the AI scheduler, as they cannot update.
+				if (IsValid(Entry->Character)) AIScheduler.Wake(Cast<AAutobattlerAIController>(Entry->Character->GetController()), GetWorld()->GetTimeSeconds());
+			}
+		}
+	}
+
+	// Dead characters no longer hold their grid index; a revived character claims the index it stands on again.
+	if (IsDead)
+	{
+		if (IsValid(AutobattlerGrid)) AutobattlerGrid->ClearIndexOccupant(ID);
+	}
+	else if (WasRevived) RefreshCharacterGridOccupancy(Entry->Character);
+}
+
+void AAutobattlerManager::GetDeployedCharactersFromWorld(TArray<AAutobattlerCharacter*>& DeployedCharacters, EEntity WhoOwns, bool AliveOnly) const
+{
+	DeployedCharacters.Empty();
+	for (TActorIterator<AAutobattlerCharacter> ActorItr(GetWorld()); ActorItr; ++ActorItr)
+	{
+		AAutobattlerCharacter* Character = *ActorItr;
+		if (!IsValid(Character)) continue;
+		if (AliveOnly && Character->GetIsDead()) continue;
+
+		if (Character->GetOwnerIdentity() == WhoOwns)
+		{
+			DeployedCharacters.Emplace(Character);
+		}
+	}
+}
+
+AAutobattlerCharacter* AAutobattlerManager::FindDeployedCharacterInWorld(int32 ID) const
+{
+	for (TActorIterator<AAutobattlerCharacter> ActorItr(GetWorld()); ActorItr; ++ActorItr)
+	{
+		AAutobattlerCharacter* Character = *ActorItr;
+		if (IsValid(Character) && Character->GetID() == ID) return Character;
+	}
+
+	return nullptr;
+}
+
 void AAutobattlerManager::Multicast_OnAddCharacterForPlayer_Implementation(int32 ID, const FCharacterListing& NewCharacterListing, EEntity WhoOwns, bool DidGeneratePanelActor)
 {
 	OnAddedCharacterForPlayer.Broadcast(ID, NewCharacterListing, WhoOwns, DidGeneratePanelActor);
@@ -1100,20 +1479,1221 @@ void AAutobattlerManager::Multicast_ClearInvalidCharacterPanels_Implementation()
 	UAutobattlerFunctionLibrary::ClearInvalidCharacterPanels(this);
 }
 
-void AAutobattlerManager::PrintEntityConfigurationToLog(EEntity WhoOwns)
+bool AAutobattlerManager::GetUsesFastArrayReplication() const
 {
-	FString WhoOwnsString = UEnum::GetValueAsString(WhoOwns);
-	if (FIdentityConfiguration* IdentityConfiguration = IdentityConfigurations.Find(WhoOwns))
+	return !IsValid(AutobattlerConfigurationAsset) || AutobattlerConfigurationAsset->UseFastArrayReplication;
+}
+
+void AAutobattlerManager::NotifyCharacterAdded(int32 ID, const FCharacterListing& NewCharacterListing, EEntity WhoOwns, bool DidGeneratePanelActor)
+{
+	RecordMulticastPayload(4 + AutobattlerManagerNetworking::EstimateListingBytes(NewCharacterListing) + 2);
+
+	if (!GetUsesFastArrayReplication() || !HasAuthority())
 	{
-		UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Printing entity configuration for %s : "), *WhoOwnsString));
-		UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Entity %s has budget : %d"), *WhoOwnsString, IdentityConfiguration->Budget));
-		UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Entity %s can deploy on the following incidies : "), *WhoOwnsString));
-		for (auto AllowedDeploymentIndex : IdentityConfiguration->AllowedDeploymentIndicies) UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("%s"), *AllowedDeploymentIndex.ToString()));
-		UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Entity %s has the following soldiers registered : "), *WhoOwnsString));
-		for (auto Character : IdentityConfiguration->Characters) UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("%s with ID : %d "), *Character.Value.CharacterRowName.ToString(), Character.Key));
+		Multicast_OnAddCharacterForPlayer(ID, NewCharacterListing, WhoOwns, DidGeneratePanelActor);
+		return;
 	}
-	else
+
+	FAutobattlerRosterItem& NewItem = ReplicatedRoster.Items.AddDefaulted_GetRef();
+	NewItem.ID = ID;
+	NewItem.WhoOwns = WhoOwns;
+	NewItem.DidGeneratePanelActor = DidGeneratePanelActor;
+	NewItem.Listing = NewCharacterListing;
+	ReplicatedRoster.MarkItemDirty(NewItem);
+
+	OnAddedCharacterForPlayer.Broadcast(ID, NewCharacterListing, WhoOwns, DidGeneratePanelActor);
+}
+
+void AAutobattlerManager::NotifyCharacterRemoved(int32 ID, EEntity WhoOwns, bool WasReturnedToBarracks)
+{
+	RecordMulticastPayload(6);
+
+	if (!GetUsesFastArrayReplication() || !HasAuthority() || WasReturnedToBarracks)
 	{
-		UAutobattlerFunctionLibrary::PrintWarningToLog(FString::Printf(TEXT("When printing entity configuration to log, no configuration found for player %s!"), *WhoOwnsString));
+		Multicast_OnRemoveCharacterForPlayer(ID, WhoOwns, WasReturnedToBarracks);
+		return;
+	}
+
+	const int32 Index = ReplicatedRoster.Items.IndexOfByPredicate([ID](const FAutobattlerRosterItem& Item) { return Item.ID == ID; });
+	if (Index != INDEX_NONE)
+	{
+		ReplicatedRoster.Items.RemoveAtSwap(Index);
+		ReplicatedRoster.MarkArrayDirty();
+	}
+
+	OnRemovedCharacterForPlayer.Broadcast(ID, WhoOwns, WasReturnedToBarracks);
+}
+
+void AAutobattlerManager::NotifyFloatBegun(EEntity WhoOwns, int32 CharacterID)
+{
+	RecordMulticastPayload(6);
+
+	if (!GetUsesFastArrayReplication() || !HasAuthority())
+	{
+		Multicast_OnFloatStateChange(WhoOwns, true, CharacterID);
+		return;
+	}
+
+	FAutobattlerEntityStateItem& EntityState = ReplicatedEntityStates.FindOrAdd(WhoOwns);
+	EntityState.FloatingCharacterID = CharacterID;
+	EntityState.WasFloatCancelled = false;
+	ReplicatedEntityStates.MarkItemDirty(EntityState);
+
+	OnFloatBegun.Broadcast(WhoOwns, CharacterID);
+}
+
+void AAutobattlerManager::NotifyFloatEnded(EEntity WhoOwns, int32 CharacterID, bool WasCancelled, const FCharacterListing& FloatedCharacterListing)
+{
+	// Only cancelling is announced; a float ending in a deployment is announced by the deployment itself.
+	if (WasCancelled) RecordMulticastPayload(5 + AutobattlerManagerNetworking::EstimateListingBytes(FloatedCharacterListing));
+
+	if (!GetUsesFastArrayReplication() || !HasAuthority())
+	{
+		if (WasCancelled) Multicast_OnFloatStateCancelled(WhoOwns, FloatedCharacterListing, CharacterID);
+		return;
+	}
+
+	for (auto& EntityState : ReplicatedEntityStates.Items)
+	{
+		if (EntityState.WhoOwns != WhoOwns || EntityState.FloatingCharacterID != CharacterID) continue;
+
+		EntityState.FloatingCharacterID = INDEX_NONE;
+		EntityState.WasFloatCancelled = WasCancelled;
+		ReplicatedEntityStates.MarkItemDirty(EntityState);
+	}
+
+	if (WasCancelled) OnFloatCancelled.Broadcast(WhoOwns, CharacterID, FloatedCharacterListing);
+}
+
+void AAutobattlerManager::NotifyMaxBudgetChange(EEntity WhoOwns, int32 NewBudget)
+{
+	RecordMulticastPayload(5);
+
+	if (!GetUsesFastArrayReplication() || !HasAuthority())
+	{
+		Multicast_OnMaxBudgetChange(WhoOwns, NewBudget);
+		return;
+	}
+
+	FAutobattlerEntityStateItem& EntityState = ReplicatedEntityStates.FindOrAdd(WhoOwns);
+	if (EntityState.MaxBudget != NewBudget)
+	{
+		EntityState.MaxBudget = NewBudget;
+		ReplicatedEntityStates.MarkItemDirty(EntityState);
+	}
+
+	OnMaxBudgetChanged.Broadcast(WhoOwns, NewBudget);
+}
+
+void AAutobattlerManager::RequestIndexVisibilityChange(EEntity WhoOwns, bool Show, const TArray<FIntPair>& IndiciesToShow)
+{
+	AUTOBATTLER_SCOPE_CYCLE_COUNTER(STAT_AutobattlerReplication);
+	RecordMulticastPayload(10 + IndiciesToShow.Num() * sizeof(FIntPair));
+
+	if (!GetUsesFastArrayReplication() || !HasAuthority())
+	{
+		Multicast_RequestIndexVisibilityChange(AutobattlerGrid, WhoOwns, Show, IndiciesToShow);
+		return;
+	}
+
+	FAutobattlerEntityStateItem& EntityState = ReplicatedEntityStates.FindOrAdd(WhoOwns);
+	if (EntityState.IsGridShown != Show)
+	{
+		EntityState.IsGridShown = Show;
+		ReplicatedEntityStates.MarkItemDirty(EntityState);
+	}
+
+	// Hiding keeps the shown cells as they are, as the multicast did. Only cells whose bit flips are sent.
+	if (Show && IsValid(AutobattlerGrid))
+	{
+		EnsureReplicatedGridCells();
+
+		const int32 GridYSize = AutobattlerGrid->GetGridYSize();
+		TBitArray<> ShouldShowCell(false, ReplicatedGridCells.Items.Num());
+		for (auto& Index : IndiciesToShow)
+		{
+			if (AutobattlerGrid->IsValidGridIndex(Index)) ShouldShowCell[Index.X * GridYSize + Index.Y] = true;
+		}
+
+		const uint8 EntityBit = 1 << static_cast<uint8>(WhoOwns);
+		for (int32 i = 0; i < ReplicatedGridCells.Items.Num(); i++)
+		{
+			FAutobattlerGridCellItem& Cell = ReplicatedGridCells.Items[i];
+			if (((Cell.VisibleForMask & EntityBit) != 0) == ShouldShowCell[i]) continue;
+
+			Cell.VisibleForMask ^= EntityBit;
+			ReplicatedGridCells.MarkItemDirty(Cell);
+		}
 	}
+
+	ApplyReplicatedGridVisibility();
+}
+
+void AAutobattlerManager::EnsureReplicatedGridCells()
+{
+	AUTOBATTLER_SCOPE_CYCLE_COUNTER(STAT_AutobattlerReplication);
+	if (!IsValid(AutobattlerGrid)) return;
+
+	const int32 GridXSize = AutobattlerGrid->GetGridXSize();
+	const int32 GridYSize = AutobattlerGrid->GetGridYSize();
+	if (ReplicatedGridCells.Items.Num() == GridXSize * GridYSize) return;
+
+	ReplicatedGridCells.Items.Reset(GridXSize * GridYSize);
+	for (int32 x = 0; x < GridXSize; x++)
+	{
+		for (int32 y = 0; y < GridYSize; y++)
+		{
+			FAutobattlerGridCellItem& Cell = ReplicatedGridCells.Items.AddDefaulted_GetRef();
+			Cell.GridIndex = FIntPair(x, y);
+			ReplicatedGridCells.MarkItemDirty(Cell);
+		}
+	}
+
+	ReplicatedGridCells.MarkArrayDirty();
+}
+
+void AAutobattlerManager::ApplyReplicatedGridVisibility()
+{
+	AUTOBATTLER_SCOPE_CYCLE_COUNTER(STAT_AutobattlerReplication);
+	IsReplicatedGridVisibilityDirty = false;
+	if (!IsValid(AutobattlerGrid)) return;
+
+	// The server's grid highlights its own occupancy as it changes.
+	if (!HasAuthority())
+	{
+		TArray<FIntPair> OccupiedIndicies;
+		for (auto& Cell : ReplicatedGridCells.Items)
+		{
+			if (Cell.IsOccupied) OccupiedIndicies.Emplace(Cell.GridIndex);
+		}
+		AutobattlerGrid->SetIndexHighlight(OccupiedIndicies, EGridHighlight::Occupied);
+	}
+
+	APlayerController* Controller = UAutobattlerControllerComponent::GetLocalPlayerController(AutobattlerGrid);
+	UAutobattlerControllerComponent* ControllerComponent = Controller != nullptr ? UAutobattlerFunctionLibrary::GetFirstComponent<UAutobattlerControllerComponent>(Controller) : nullptr;
+	if (ControllerComponent == nullptr) return;
+
+	const EEntity WhoOwns = ControllerComponent->GetIdentity();
+	const FAutobattlerEntityStateItem* EntityState = ReplicatedEntityStates.Find(WhoOwns);
+	if (EntityState == nullptr || !EntityState->IsGridShown)
+	{
+		AutobattlerGrid->ToggleGridVisibility(false);
+		return;
+	}
+
+	const uint8 EntityBit = 1 << static_cast<uint8>(WhoOwns);
+	TArray<FIntPair> IndiciesToShow;
+	for (auto& Cell : ReplicatedGridCells.Items)
+	{
+		if ((Cell.VisibleForMask & EntityBit) != 0) IndiciesToShow.Emplace(Cell.GridIndex);
+	}
+
+	AutobattlerGrid->ToggleGridVisibility(true);
+	AutobattlerGrid->ShowOnlyIndicies(IndiciesToShow);
+}
+
+void AAutobattlerManager::RecordMulticastPayload(int32 PayloadBytes)
+{
+	if (!HasAuthority()) return;
+
+	UNetDriver* NetDriver = GetNetDriver();
+	const int32 NumConnections = NetDriver != nullptr ? NetDriver->ClientConnections.Num() : 0;
+	ReplicationStats.RecordMulticastBytes(PayloadBytes * NumConnections);
+}
+
+void AAutobattlerManager::ApplyAdaptiveReplication()
+{
+	AUTOBATTLER_SCOPE_CYCLE_COUNTER(STAT_AutobattlerReplication);
+	if (!HasAuthority()) return;
+
+	const UAutobattlerConfiguration* Configuration = GetAutobattlerConfigurationAsset();
+	const bool ShouldReduce = Configuration != nullptr && GamePhase == EAutobattlerPhase::Fight && CharacterRegistry.Num() >= Configuration->LargeBattleCharacterThreshold;
+
+	for (auto& Entry : CharacterRegistry)
+	{
+		if (IsValid(Entry.Value.Character)) Entry.Value.Character->SetUsesReducedReplication(ShouldReduce);
+	}
+}
+
+void AAutobattlerManager::RecordBattleEvent(EAutobattlerSimulationEventType EventType, const AAutobattlerCharacter* Source, const AAutobattlerCharacter* Target, float Value)
+{
+	if (!BattleReplay.GetIsRecording() || !IsValid(GetWorld())) return;
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	BattleReplay.RecordEvent(
+		GetWorld()->GetTimeSeconds(),
+		EventType,
+		IsValid(Source) ? Source->GetID() : INDEX_NONE,
+		IsValid(Target) ? Target->GetID() : INDEX_NONE,
+		Value
+	);
+	ReplayRecordingCycles += FPlatformTime::Cycles64() - StartCycles;
+}
+
+void AAutobattlerManager::RecordBattleHealth(const AAutobattlerCharacter* Character)
+{
+	if (!BattleReplay.GetIsRecording() || !IsValid(GetWorld()) || Character == nullptr) return;
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	BattleReplay.RecordHealth(GetWorld()->GetTimeSeconds(), Character->GetID(), Character->GetCurrentHealth(), Character->GetMaxHealth());
+	ReplayRecordingCycles += FPlatformTime::Cycles64() - StartCycles;
+}
+
+void AAutobattlerManager::RecordBattleTarget(const AAutobattlerCharacter* Character, const AAutobattlerCharacter* Target)
+{
+	if (!BattleReplay.GetIsRecording() || !IsValid(GetWorld()) || Character == nullptr) return;
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	BattleReplay.RecordTarget(GetWorld()->GetTimeSeconds(), Character->GetID(), IsValid(Target) ? Target->GetID() : INDEX_NONE);
+	ReplayRecordingCycles += FPlatformTime::Cycles64() - StartCycles;
+}
+
+void AAutobattlerManager::BeginBattleRecording()
+{
+	const UAutobattlerConfiguration* Configuration = GetAutobattlerConfigurationAsset();
+	if (!HasAuthority() || !IsValid(GetWorld()) || Configuration == nullptr || !Configuration->RecordBattles) return;
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	const FVector Origin = IsValid(AutobattlerGrid) ? AutobattlerGrid->GetActorLocation() : GetActorLocation();
+	BattleReplay.BeginRecording(Origin, GetWorld()->GetTimeSeconds(), Configuration->ReplaySnapshotInterval);
+	ReplayFrameAccumulator = 0.0f;
+	ReplayBattleSeconds = 0.0;
+
+	for (auto& Entry : CharacterRegistry) RecordBattleCharacter(Entry.Value.Character, Entry.Value.WhoOwns);
+
+	ReplayRecordingCycles = FPlatformTime::Cycles64() - StartCycles;
+}
+
+void AAutobattlerManager::RecordBattleCharacter(const AAutobattlerCharacter* Character, EEntity WhoOwns)
+{
+	if (!IsValid(Character) || !IsValid(GetWorld())) return;
+
+	FCharacterListing Listing;
+	GetCharacterListingByID(WhoOwns, Character->GetID(), Listing);
+
+	BattleReplay.RecordCharacter(
+		GetWorld()->GetTimeSeconds(),
+		Character->GetID(),
+		WhoOwns,
+		Listing.CharacterRowName,
+		Character->GetMaxHealth(),
+		Character->GetCurrentHealth(),
+		Character->GetActorLocation()
+	);
+}
+
+void AAutobattlerManager::RecordBattleFrame()
+{
+	AUTOBATTLER_SCOPE_CYCLE_COUNTER(STAT_AutobattlerReplayRecording);
+	if (!IsValid(GetWorld())) return;
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	for (auto& Entry : CharacterRegistry)
+	{
+		const AAutobattlerCharacter* Character = Entry.Value.Character;
+		if (IsValid(Character) && !Character->GetIsDead()) BattleReplay.RecordLocation(Entry.Key, Character->GetActorLocation());
+	}
+	BattleReplay.RecordFrame(GetWorld()->GetTimeSeconds());
+
+	ReplayRecordingCycles += FPlatformTime::Cycles64() - StartCycles;
+}
+
+void AAutobattlerManager::EndBattleRecording(EWhoWins Winner)
+{
+	if (!BattleReplay.GetIsRecording() || !IsValid(GetWorld())) return;
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	BattleReplay.EndRecording(GetWorld()->GetTimeSeconds(), Winner);
+	ReplayRecordingCycles += FPlatformTime::Cycles64() - StartCycles;
+}
+
+void AAutobattlerManager::OnReplicatedRosterAdd(const FAutobattlerRosterItem& Item)
+{
+	OnAddedCharacterForPlayer.Broadcast(Item.ID, Item.Listing, Item.WhoOwns, Item.DidGeneratePanelActor);
+}
+
+void AAutobattlerManager::OnReplicatedRosterRemove(const FAutobattlerRosterItem& Item)
+{
+	OnRemovedCharacterForPlayer.Broadcast(Item.ID, Item.WhoOwns, false);
+}
+
+void AAutobattlerManager::OnReplicatedEntityStateChange(FAutobattlerEntityStateItem& Item)
+{
+	if (Item.MaxBudget != Item.LastMaxBudget)
+	{
+		Item.LastMaxBudget = Item.MaxBudget;
+		OnMaxBudgetChanged.Broadcast(Item.WhoOwns, Item.MaxBudget);
+	}
+
+	if (Item.FloatingCharacterID != Item.LastFloatingCharacterID)
+	{
+		const int32 PreviousFloatingCharacterID = Item.LastFloatingCharacterID;
+		Item.LastFloatingCharacterID = Item.FloatingCharacterID;
+
+		if (PreviousFloatingCharacterID != INDEX_NONE && Item.FloatingCharacterID == INDEX_NONE && Item.WasFloatCancelled)
+		{
+			const FAutobattlerRosterItem* RosterItem = ReplicatedRoster.FindByID(PreviousFloatingCharacterID);
+			OnFloatCancelled.Broadcast(Item.WhoOwns, PreviousFloatingCharacterID, RosterItem != nullptr ? RosterItem->Listing : FCharacterListing());
+		}
+
+		if (Item.FloatingCharacterID != INDEX_NONE) OnFloatBegun.Broadcast(Item.WhoOwns, Item.FloatingCharacterID);
+	}
+
+	MarkReplicatedGridVisibilityDirty();
+}
+
+void AAutobattlerManager::MarkReplicatedGridVisibilityDirty()
+{
+	if (IsReplicatedGridVisibilityDirty) return;
+
+	IsReplicatedGridVisibilityDirty = true;
+	GetWorldTimerManager().SetTimerForNextTick(this, &AAutobattlerManager::ApplyReplicatedGridVisibility);
+}
+
+void AAutobattlerManager::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AAutobattlerManager, ReplicatedRoster);
+	DOREPLIFETIME(AAutobattlerManager, ReplicatedEntityStates);
+	DOREPLIFETIME(AAutobattlerManager, ReplicatedGridCells);
+}
+
+void AAutobattlerManager::PrintEntityConfigurationToLog(EEntity WhoOwns)
+{
+	FString WhoOwnsString = UEnum::GetValueAsString(WhoOwns);
+	if (FIdentityConfiguration* IdentityConfiguration = IdentityConfigurations.Find(WhoOwns))
+	{
+		UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Printing entity configuration for %s : "), *WhoOwnsString));
+		UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Entity %s has budget : %d"), *WhoOwnsString, IdentityConfiguration->Budget));
+		UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Entity %s can deploy on the following incidies : "), *WhoOwnsString));
+		TArray<FIntPair> DeploymentZone;
+		GetDeploymentZoneForPlayer(WhoOwns, DeploymentZone);
+		for (auto& DeploymentIndex : DeploymentZone) UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("%s"), *DeploymentIndex.ToString()));
+		UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Entity %s has the following soldiers registered : "), *WhoOwnsString));
+		for (auto Character : IdentityConfiguration->Characters) UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("%s with ID : %d "), *Character.Value.CharacterRowName.ToString(), Character.Key));
+	}
+	else
+	{
+		UAutobattlerFunctionLibrary::PrintWarningToLog(FString::Printf(TEXT("When printing entity configuration to log, no configuration found for player %s!"), *WhoOwnsString));
+	}
+}
+
+void AAutobattlerManager::BenchmarkCharacterRegistry(const TArray<int32>& UnitCounts, int32 Iterations)
+{
+	if (!HasAuthority() || !IsValid(GetWorld())) return;
+
+	const TArray<int32> Counts = UnitCounts.Num() > 0 ? UnitCounts : TArray<int32>({ 50, 500, 5000 });
+	const int32 NumIterations = FMath::Max(Iterations, 1);
+
+	FActorSpawnParameters ActorSpawnParams;
+	ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	for (int32 Count : Counts)
+	{
+		// Bare characters are registered under IDs counting down from INT_MAX so they cannot collide with dispensed IDs. IDs follow the
+		// characters actually spawned, so character i always has ID INT_MAX - i even if some spawns fail.
+		TArray<AAutobattlerCharacter*> SpawnedCharacters;
+		SpawnedCharacters.Reserve(Count);
+		for (int32 i = 0; i < Count; i++)
+		{
+			AAutobattlerCharacter* NewCharacter = GetWorld()->SpawnActor<AAutobattlerCharacter>(AAutobattlerCharacter::StaticClass(), FTransform::Identity, ActorSpawnParams);
+			if (!IsValid(NewCharacter)) continue;
+
+			RegisterCharacter(NewCharacter, INT_MAX - SpawnedCharacters.Num(), NewCharacter->GetOwnerIdentity());
+			SpawnedCharacters.Emplace(NewCharacter);
+		}
+
+		if (SpawnedCharacters.Num() == 0) continue;
+
+		const EEntity BenchmarkEntity = SpawnedCharacters[0]->GetOwnerIdentity();
+		const int32 LookupID = INT_MAX - (SpawnedCharacters.Num() - 1);
+		TArray<AAutobattlerCharacter*> Results;
+		int32 BudgetSink = 0;
+
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumIterations; i++)
+		{
+			GetDeployedCharactersFromWorld(Results, BenchmarkEntity, false);
+			for (auto Result : Results) BudgetSink += Result->GetBudgetCost();
+			BudgetSink += FindDeployedCharacterInWorld(LookupID) != nullptr ? 1 : 0;
+		}
+		const double WorldMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumIterations;
+
+		StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumIterations; i++)
+		{
+			GetDeployedCharactersByEntity(Results, BenchmarkEntity);
+			BudgetSink += GetCurrentBudgetForEntity(BenchmarkEntity);
+			AAutobattlerCharacter* FoundCharacter = nullptr;
+			BudgetSink += GetIsCharacterDeployed(LookupID, FoundCharacter) ? 1 : 0;
+		}
+		const double RegistryMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumIterations;
+
+		UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Autobattler Manager : [BenchmarkCharacterRegistry] %d units : world scan %.4f ms, registry %.4f ms per query set (%.1fx faster, checksum %d)"),
+			SpawnedCharacters.Num(),
+			WorldMs,
+			RegistryMs,
+			RegistryMs > 0.0 ? WorldMs / RegistryMs : 0.0,
+			BudgetSink
+		));
+
+		for (int32 i = 0; i < SpawnedCharacters.Num(); i++)
+		{
+			UnregisterCharacter(INT_MAX - i, SpawnedCharacters[i]);
+			SpawnedCharacters[i]->Destroy();
+		}
+	}
+}
+
+void AAutobattlerManager::BenchmarkAITargeting(int32 Iterations)
+{
+	if (!HasAuthority()) return;
+
+	// Counts every UObject created while it is registered.
+	struct FObjectCreateCounter : public FUObjectArray::FUObjectCreateListener
+	{
+		int32 NumCreated = 0;
+		virtual void NotifyUObjectCreated(const UObjectBase* Object, int32 Index) override { NumCreated++; }
+		virtual void OnUObjectArrayShutdown() override {}
+	};
+
+	TArray<AAutobattlerAIController*> AIControllers;
+	for (auto& Entry : CharacterRegistry)
+	{
+		if (!IsValid(Entry.Value.Character)) continue;
+		if (AAutobattlerAIController* AIController = Cast<AAutobattlerAIController>(Entry.Value.Character->GetController())) AIControllers.Emplace(AIController);
+	}
+
+	if (AIControllers.Num() == 0)
+	{
+		UAutobattlerFunctionLibrary::PrintWarningToLog(FString("Autobattler Manager : [BenchmarkAITargeting] No deployed AI controlled characters to benchmark!"));
+		return;
+	}
+
+	const int32 NumIterations = FMath::Max(Iterations, 1);
+	int32 NumUpdates = 0;
+	int32 Checksum = 0;
+	auto RunTargeting = [&AIControllers, &NumUpdates, &Checksum]()
+	{
+		for (auto AIController : AIControllers)
+		{
+			for (EAbilityType SkillType : { EAbilityType::Attack, EAbilityType::Skill })
+			{
+				const UAutobattlerSkill* Skill = AIController->GetRelevantSkill(SkillType);
+				if (Skill == nullptr) continue;
+
+				Checksum += AIController->GetAbilityTargetingProperties(Skill).TargetCharacter != nullptr ? 1 : 0;
+				NumUpdates++;
+			}
+		}
+	};
+
+	RunTargeting();
+	NumUpdates = 0;
+
+	FObjectCreateCounter ObjectCreateCounter;
+	GUObjectArray.AddUObjectCreateListener(&ObjectCreateCounter);
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < NumIterations; i++) RunTargeting();
+	const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	GUObjectArray.RemoveUObjectCreateListener(&ObjectCreateCounter);
+
+	UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Autobattler Manager : [BenchmarkAITargeting] %d AI characters, %d targeting updates : %.4f ms per update, %d UObjects created (%.3f per update, checksum %d)"),
+		AIControllers.Num(),
+		NumUpdates,
+		NumUpdates > 0 ? ElapsedMs / NumUpdates : 0.0,
+		ObjectCreateCounter.NumCreated,
+		NumUpdates > 0 ? (double)ObjectCreateCounter.NumCreated / NumUpdates : 0.0,
+		Checksum
+	));
+}
+
+void AAutobattlerManager::PrintReplicationBandwidth(bool Reset)
+{
+	if (!HasAuthority()) return;
+
+	const double Now = FPlatformTime::Seconds();
+	float FastArrayBytesPerSecond = 0.0f;
+	float MulticastBytesPerSecond = 0.0f;
+	ReplicationStats.GetBytesPerSecond(Now, FastArrayBytesPerSecond, MulticastBytesPerSecond);
+
+	UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Autobattler Manager : [PrintReplicationBandwidth] Over %.1f s (%s) : fast arrays %.1f B/s (%lld B), multicasts %.1f B/s (%lld B, estimated)"),
+		Now - ReplicationStats.WindowStartTime,
+		GetUsesFastArrayReplication() ? TEXT("fast arrays in use") : TEXT("multicasts in use"),
+		FastArrayBytesPerSecond,
+		ReplicationStats.FastArrayBytes,
+		MulticastBytesPerSecond,
+		ReplicationStats.MulticastBytes
+	));
+
+	if (Reset) ReplicationStats.Reset(Now);
+}
+
+void AAutobattlerManager::BenchmarkReplicationSoak(int32 NumCharacters, float Duration)
+{
+	if (!HasAuthority() || !IsValid(GetWorld())) return;
+
+	if (SoakCharacters.Num() > 0)
+	{
+		UAutobattlerFunctionLibrary::PrintWarningToLog(FString("Autobattler Manager : [BenchmarkReplicationSoak] A soak benchmark is already running!"));
+		return;
+	}
+
+	const UAutobattlerConfiguration* Configuration = GetAutobattlerConfigurationAsset();
+	const UDataTable* AllCharacters = Configuration != nullptr ? Configuration->AllCharactersDataTable : nullptr;
+	if (AllCharacters == nullptr || AllCharacters->GetRowNames().Num() == 0)
+	{
+		UAutobattlerFunctionLibrary::PrintErrorToLog(FString("Autobattler Manager : [BenchmarkReplicationSoak] No characters in AllCharactersDataTable to spawn!"));
+		return;
+	}
+
+	UNetDriver* NetDriver = GetNetDriver();
+	if (NetDriver == nullptr || NetDriver->ClientConnections.Num() == 0)
+	{
+		UAutobattlerFunctionLibrary::PrintWarningToLog(FString("Autobattler Manager : [BenchmarkReplicationSoak] No clients are connected, so nothing will be replicated!"));
+	}
+
+	const FCharacterListing Listing(AllCharacters->GetRowNames()[0]);
+	const int32 Count = FMath::Max(NumCharacters, 1);
+	const bool ShouldReduce = Count >= Configuration->LargeBattleCharacterThreshold;
+
+	FActorSpawnParameters ActorSpawnParams;
+	ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	// Characters are laid out in a square around the grid (or the manager), 200 units apart. Like BenchmarkCharacterRegistry, they are
+	// registered under IDs counting down from INT_MAX so they cannot collide with dispensed IDs.
+	const int32 Columns = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Count)));
+	const FVector Origin = IsValid(AutobattlerGrid) ? AutobattlerGrid->GetActorLocation() : GetActorLocation();
+	for (int32 i = 0; i < Count; i++)
+	{
+		const FVector Location = Origin + FVector((i % Columns - Columns / 2) * 200.0f, (i / Columns - Columns / 2) * 200.0f, 0.0f);
+		AAutobattlerCharacter* NewCharacter = GetWorld()->SpawnActor<AAutobattlerCharacter>(AAutobattlerCharacter::StaticClass(), FTransform(Location), ActorSpawnParams);
+		if (!IsValid(NewCharacter)) continue;
+
+		const EEntity WhoOwns = i % 2 == 0 ? EEntity::PlayerOne : EEntity::AI;
+		NewCharacter->BuildCharacterFromListing(WhoOwns, INT_MAX - i, Listing);
+		if (!IsValid(NewCharacter)) continue; // Building destroys the character if its definition does not exist.
+
+		RegisterCharacter(NewCharacter, INT_MAX - i, WhoOwns);
+		NewCharacter->SetUsesReducedReplication(ShouldReduce);
+		SoakCharacters.Emplace(NewCharacter);
+	}
+
+	NumSoakSamples = 0;
+	SoakBytesPerConnectionSum = 0.0;
+	SoakGameThreadMsPerConnectionSum = 0.0;
+	SoakMaxConnections = 0;
+
+	UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Autobattler Manager : [BenchmarkReplicationSoak] Spawned %d characters (%s replication), running for %.1f s"),
+		SoakCharacters.Num(),
+		ShouldReduce ? TEXT("reduced") : TEXT("default"),
+		Duration
+	));
+
+	GetWorldTimerManager().SetTimer(SoakChurnTimerHandle, this, &AAutobattlerManager::ChurnReplicationSoak, 0.1f, true);
+	GetWorldTimerManager().SetTimer(SoakSampleTimerHandle, this, &AAutobattlerManager::SampleReplicationSoak, 1.0f, true);
+	GetWorldTimerManager().SetTimer(SoakEndTimerHandle, this, &AAutobattlerManager::EndReplicationSoak, FMath::Max(Duration, 1.0f), false);
+}
+
+void AAutobattlerManager::ChurnReplicationSoak()
+{
+	// Roughly what a fight does every 0.1 s: some characters take damage, most move a little, a few start attacking.
+	for (auto& SoakCharacter : SoakCharacters)
+	{
+		AAutobattlerCharacter* Character = SoakCharacter.Get();
+		if (!IsValid(Character)) continue;
+
+		if (FMath::FRand() < 0.3f) Character->SetCurrentHealth(Character->GetMaxHealth() * FMath::FRandRange(0.2f, 1.0f));
+		if (FMath::FRand() < 0.8f) Character->AddActorWorldOffset(FVector(FMath::FRandRange(-10.0f, 10.0f), FMath::FRandRange(-10.0f, 10.0f), 0.0f));
+		if (FMath::FRand() < 0.1f) Character->SetAnimationActionType(FMath::RandBool() ? EActionType::Attacking : EActionType::Idle);
+	}
+}
+
+void AAutobattlerManager::SampleReplicationSoak()
+{
+	UNetDriver* NetDriver = GetNetDriver();
+	const int32 NumConnections = NetDriver != nullptr ? NetDriver->ClientConnections.Num() : 0;
+	if (NumConnections == 0) return;
+
+	int64 BytesPerSecond = 0;
+	for (auto Connection : NetDriver->ClientConnections)
+	{
+		if (Connection != nullptr) BytesPerSecond += Connection->OutBytesPerSecond;
+	}
+
+	NumSoakSamples++;
+	SoakBytesPerConnectionSum += static_cast<double>(BytesPerSecond) / NumConnections;
+	SoakGameThreadMsPerConnectionSum += FPlatformTime::ToMilliseconds(GGameThreadTime) / NumConnections;
+	SoakMaxConnections = FMath::Max(SoakMaxConnections, NumConnections);
+}
+
+void AAutobattlerManager::EndReplicationSoak()
+{
+	GetWorldTimerManager().ClearTimer(SoakChurnTimerHandle);
+	GetWorldTimerManager().ClearTimer(SoakSampleTimerHandle);
+	GetWorldTimerManager().ClearTimer(SoakEndTimerHandle);
+
+	UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Autobattler Manager : [BenchmarkReplicationSoak] %d characters, up to %d connections, %d samples : %.1f B/s and %.4f ms game thread per connection"),
+		SoakCharacters.Num(),
+		SoakMaxConnections,
+		NumSoakSamples,
+		NumSoakSamples > 0 ? SoakBytesPerConnectionSum / NumSoakSamples : 0.0,
+		NumSoakSamples > 0 ? SoakGameThreadMsPerConnectionSum / NumSoakSamples : 0.0
+	));
+
+	for (auto& SoakCharacter : SoakCharacters)
+	{
+		AAutobattlerCharacter* Character = SoakCharacter.Get();
+		if (!IsValid(Character)) continue;
+
+		UnregisterCharacter(Character->GetID(), Character);
+		Character->Destroy();
+	}
+	SoakCharacters.Reset();
+}
+
+bool AAutobattlerManager::SaveBattleReplay(const FString& FileName)
+{
+	if (!HasAuthority()) return false;
+
+	if (BattleReplay.GetIsRecording() || BattleReplay.GetData().Num() == 0)
+	{
+		UAutobattlerFunctionLibrary::PrintWarningToLog(FString("Autobattler Manager : [SaveBattleReplay] No finished battle recording to save!"));
+		return false;
+	}
+
+	const FString FilePath = FPaths::ProjectSavedDir() / TEXT("Replays") / FileName + TEXT(".abreplay");
+	if (!FFileHelper::SaveArrayToFile(BattleReplay.GetData(), *FilePath))
+	{
+		UAutobattlerFunctionLibrary::PrintErrorToLog(FString::Printf(TEXT("Autobattler Manager : [SaveBattleReplay] Could not write %s!"), *FilePath));
+		return false;
+	}
+
+	UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Autobattler Manager : [SaveBattleReplay] Saved %d bytes to %s"), BattleReplay.GetData().Num(), *FilePath));
+	return true;
+}
+
+bool AAutobattlerManager::LoadBattleReplay(const FString& FileName)
+{
+	if (!HasAuthority()) return false;
+
+	if (BattleReplay.GetIsRecording())
+	{
+		UAutobattlerFunctionLibrary::PrintWarningToLog(FString("Autobattler Manager : [LoadBattleReplay] Cannot load a recording while a battle is being recorded!"));
+		return false;
+	}
+
+	const FString FilePath = FPaths::ProjectSavedDir() / TEXT("Replays") / FileName + TEXT(".abreplay");
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *FilePath))
+	{
+		UAutobattlerFunctionLibrary::PrintErrorToLog(FString::Printf(TEXT("Autobattler Manager : [LoadBattleReplay] Could not read %s!"), *FilePath));
+		return false;
+	}
+
+	if (!BattleReplay.LoadFromBytes(MoveTemp(Bytes)))
+	{
+		UAutobattlerFunctionLibrary::PrintErrorToLog(FString::Printf(TEXT("Autobattler Manager : [LoadBattleReplay] %s is not a valid battle recording!"), *FilePath));
+		return false;
+	}
+
+	// Recording stats describe the last recorded battle, not a loaded one.
+	ReplayRecordingCycles = 0;
+	ReplayBattleSeconds = 0.0;
+	return true;
+}
+
+void AAutobattlerManager::PlayBackBattleReplay(float Speed)
+{
+	if (!HasAuthority()) return;
+
+	if (!BattleReplay.BeginPlayback())
+	{
+		UAutobattlerFunctionLibrary::PrintWarningToLog(FString("Autobattler Manager : [PlayBackBattleReplay] No finished battle recording to play back!"));
+		return;
+	}
+
+	const float StepSize = FMath::Max(Speed, 1.0f) / 60.0f;
+	TArray<FAutobattlerSimulationEvent> Events;
+	int32 NumFrames = 0;
+
+	const double StartTime = FPlatformTime::Seconds();
+	while (BattleReplay.Advance(StepSize, &Events)) NumFrames++;
+	const double PlaybackMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	int32 SurvivingCharacters[2] = { 0, 0 };
+	for (auto& State : BattleReplay.GetCharacterStates())
+	{
+		if (State.IsDeployed && !State.IsDead) SurvivingCharacters[State.WhoOwns == EEntity::AI ? 1 : 0]++;
+	}
+
+	const double SeekStartTime = FPlatformTime::Seconds();
+	BattleReplay.SeekTo(BattleReplay.GetDuration() * 0.5f);
+	const double SeekMs = (FPlatformTime::Seconds() - SeekStartTime) * 1000.0;
+
+	UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Autobattler Manager : [PlayBackBattleReplay] %.1f s battle won by %s : %d events and %d frames at %.0fx in %.3f ms (%.4f ms per frame), %d player and %d AI characters surviving, seeking to the middle took %.3f ms"),
+		BattleReplay.GetDuration(),
+		*UEnum::GetValueAsString(BattleReplay.GetWinner()),
+		Events.Num(),
+		NumFrames,
+		Speed,
+		PlaybackMs,
+		NumFrames > 0 ? PlaybackMs / NumFrames : 0.0,
+		SurvivingCharacters[0],
+		SurvivingCharacters[1],
+		SeekMs
+	));
+}
+
+void AAutobattlerManager::PrintBattleReplayStats()
+{
+	if (!HasAuthority()) return;
+
+	const int32 NumBytes = BattleReplay.GetData().Num();
+	const double RecordingSeconds = FPlatformTime::ToSeconds64(ReplayRecordingCycles);
+
+	UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Autobattler Manager : [PrintBattleReplayStats] %d bytes over %.1f s of battle (%.1f KB per minute), recording took %.3f ms (%.3f%% of server frame time)%s"),
+		NumBytes,
+		ReplayBattleSeconds,
+		ReplayBattleSeconds > 0.0 ? NumBytes / 1024.0 / (ReplayBattleSeconds / 60.0) : 0.0,
+		RecordingSeconds * 1000.0,
+		ReplayBattleSeconds > 0.0 ? RecordingSeconds / ReplayBattleSeconds * 100.0 : 0.0,
+		BattleReplay.GetIsRecording() ? TEXT(", still recording") : TEXT("")
+	));
+}
+
+bool AAutobattlerManager::DumpBattleStats(const FString& FileName)
+{
+	if (!HasAuthority() || !IsValid(GetWorld())) return false;
+
+	const FString BaseName = FileName.IsEmpty() ? FString::Printf(TEXT("BattleStats-%s"), *FDateTime::Now().ToString()) : FileName;
+	const FString FilePath = FPaths::ProfilingDir() / TEXT("Autobattler") / BaseName + TEXT(".csv");
+	if (!BattleStats.WriteCSV(FilePath, GetWorld()->GetTimeSeconds()))
+	{
+		UAutobattlerFunctionLibrary::PrintErrorToLog(FString::Printf(TEXT("Autobattler Manager : [DumpBattleStats] Could not write %s!"), *FilePath));
+		return false;
+	}
+
+	UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Autobattler Manager : [DumpBattleStats] Wrote %d finished battle(s)%s to %s"),
+		BattleStats.GetFinishedBattles().Num(),
+		BattleStats.GetIsBattleActive() ? TEXT(" and the current one") : TEXT(""),
+		*FilePath
+	));
+	return true;
+}
+
+EWhoWins AAutobattlerManager::SimulateCurrentBattle(int32 Seed, FAutobattlerSimulationResult& Result)
+{
+	Result = FAutobattlerSimulationResult();
+	if (!HasAuthority()) return EWhoWins::Nobody;
+
+	FAutobattlerSimulationSetup Setup;
+	if (!BuildSimulationSetupFromBattlefield(Setup))
+	{
+		UAutobattlerFunctionLibrary::PrintErrorToLog(FString("Autobattler Manager : [SimulateCurrentBattle] Could not get configuration asset!"));
+		return EWhoWins::Nobody;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	FAutobattlerSimulation::Run(Setup, Seed, Result);
+	const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Autobattler Manager : [SimulateCurrentBattle] Seed %d : %s won after %.2f s (%d steps, %d events, %d player and %d AI characters surviving) in %.3f ms%s"),
+		Seed,
+		Result.Winner == EWhoWins::Players ? TEXT("Players") : Result.Winner == EWhoWins::Enemy ? TEXT("Enemy") : TEXT("Nobody"),
+		Result.BattleDuration,
+		Result.Steps,
+		Result.Events.Num(),
+		Result.SurvivingPlayerCharacters,
+		Result.SurvivingAICharacters,
+		ElapsedMs,
+		Setup.GetIsApproximate() ? TEXT(" (approximate, some skills use Blueprint behaviour)") : TEXT("")
+	));
+
+	return Result.Winner;
+}
+
+float AAutobattlerManager::CompareAIUpdateTiers(int32 NumSeeds)
+{
+	if (!HasAuthority() || NumSeeds <= 0) return 0.0f;
+
+	FAutobattlerSimulationSetup Setup;
+	if (!BuildSimulationSetupFromBattlefield(Setup))
+	{
+		UAutobattlerFunctionLibrary::PrintErrorToLog(FString("Autobattler Manager : [CompareAIUpdateTiers] Could not get configuration asset!"));
+		return 0.0f;
+	}
+	Setup.Settings.RecordEvents = false;
+
+	FAutobattlerSimulationSetup TieredSetup = Setup;
+	Setup.Settings.UseAIUpdateTiers = false;
+	TieredSetup.Settings.UseAIUpdateTiers = true;
+
+	int32 NumMatchingWinners = 0;
+	int64 FixedAIUpdates = 0;
+	int64 TieredAIUpdates = 0;
+	double DurationDifference = 0.0;
+	double SurvivorDifference = 0.0;
+	double FixedMs = 0.0;
+	double TieredMs = 0.0;
+
+	for (int32 Seed = 0; Seed < NumSeeds; Seed++)
+	{
+		FAutobattlerSimulationResult FixedResult;
+		FAutobattlerSimulationResult TieredResult;
+
+		double StartTime = FPlatformTime::Seconds();
+		FAutobattlerSimulation::Run(Setup, Seed, FixedResult);
+		FixedMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		StartTime = FPlatformTime::Seconds();
+		FAutobattlerSimulation::Run(TieredSetup, Seed, TieredResult);
+		TieredMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		if (FixedResult.Winner == TieredResult.Winner) NumMatchingWinners++;
+		FixedAIUpdates += FixedResult.AIUpdates;
+		TieredAIUpdates += TieredResult.AIUpdates;
+		DurationDifference += FMath::Abs(FixedResult.BattleDuration - TieredResult.BattleDuration);
+		SurvivorDifference += FMath::Abs((FixedResult.SurvivingPlayerCharacters + FixedResult.SurvivingAICharacters) - (TieredResult.SurvivingPlayerCharacters + TieredResult.SurvivingAICharacters));
+	}
+
+	const float MatchingShare = (float)NumMatchingWinners / NumSeeds;
+	UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Autobattler Manager : [CompareAIUpdateTiers] %d seeds : same winner in %d (%.1f%%), average difference of %.2f s duration and %.2f survivors. AI updates : %lld fixed rate, %lld tiered (%.1f%%). Simulated in %.2f ms fixed rate, %.2f ms tiered%s"),
+		NumSeeds,
+		NumMatchingWinners,
+		MatchingShare * 100.0f,
+		DurationDifference / NumSeeds,
+		SurvivorDifference / NumSeeds,
+		FixedAIUpdates,
+		TieredAIUpdates,
+		FixedAIUpdates > 0 ? 100.0 * TieredAIUpdates / FixedAIUpdates : 0.0,
+		FixedMs,
+		TieredMs,
+		Setup.GetIsApproximate() ? TEXT(" (approximate, some skills use Blueprint behaviour)") : TEXT("")
+	));
+
+	UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Autobattler Manager : [CompareAIUpdateTiers] AI scheduler : %d controllers (%d high rate, %d low rate, %d asleep), %d updates run and %d deferred to a later frame since begin play"),
+		AIScheduler.Num(),
+		AIScheduler.GetNumAtTier(EAutobattlerAIUpdateTier::High),
+		AIScheduler.GetNumAtTier(EAutobattlerAIUpdateTier::Low),
+		AIScheduler.GetNumAtTier(EAutobattlerAIUpdateTier::Asleep),
+		AIScheduler.GetNumUpdates(),
+		AIScheduler.GetNumDeferred()
+	));
+
+	return MatchingShare;
+}
+
+bool AAutobattlerManager::CompareReplayWithSimulation(int32 Seed)
+{
+	if (!HasAuthority()) return false;
+
+	const UAutobattlerConfiguration* Configuration = UAutobattlerConfiguration::GetConfigurationAsset(this);
+	if (!IsValid(Configuration))
+	{
+		UAutobattlerFunctionLibrary::PrintErrorToLog(FString("Autobattler Manager : [CompareReplayWithSimulation] Could not get configuration asset!"));
+		return false;
+	}
+
+	if (!BattleReplay.BeginPlayback())
+	{
+		UAutobattlerFunctionLibrary::PrintWarningToLog(FString("Autobattler Manager : [CompareReplayWithSimulation] No finished battle recording to compare!"));
+		return false;
+	}
+
+	TArray<FAutobattlerSimulationEvent> LiveEvents;
+	while (BattleReplay.Advance(60.0f, &LiveEvents)) {}
+
+	// Characters recorded when the battle began make up the starting roster.
+	FAutobattlerSimulationSetup Setup;
+	Setup.ApplyConfiguration(Configuration);
+	if (Configuration->UseGridPathfinding && IsValid(AutobattlerGrid)) Setup.Settings.GridCellSize = AutobattlerGrid->GetGridXYSize();
+
+	BattleReplay.SeekTo(0.0f);
+	for (auto& State : BattleReplay.GetCharacterStates())
+	{
+		if (!State.IsDeployed || State.IsDead) continue;
+
+		const FAutobattlerCharacterDefinition* Definition = UAutobattlerFunctionLibrary::GetCharacterDefinitionFromConfigurationDatatable(this, State.CharacterRowName);
+		if (Definition == nullptr)
+		{
+			UAutobattlerFunctionLibrary::PrintErrorToLog(FString::Printf(TEXT("Autobattler Manager : [CompareReplayWithSimulation] Recorded character %d has no row %s in AllCharactersDataTable!"), State.ID, *State.CharacterRowName.ToString()));
+			return false;
+		}
+
+		Setup.AddCharacter(*Definition, State.WhoOwns, State.Location, State.ID);
+	}
+
+	FAutobattlerSimulationResult Result;
+	FAutobattlerSimulation::Run(Setup, Seed, Result);
+
+	// Only events the live game records are compared. Deaths and ressurections are recorded live without a source.
+	auto IsCompared = [](const FAutobattlerSimulationEvent& Event)
+	{
+		switch (Event.EventType)
+		{
+			case EAutobattlerSimulationEventType::SkillTriggered:
+			case EAutobattlerSimulationEventType::Damage:
+			case EAutobattlerSimulationEventType::Heal:
+			case EAutobattlerSimulationEventType::PoisonApplied:
+			case EAutobattlerSimulationEventType::Died:
+			case EAutobattlerSimulationEventType::Ressurected:
+				return true;
+			default:
+				return false;
+		}
+	};
+	auto IsSameEvent = [](const FAutobattlerSimulationEvent& Live, const FAutobattlerSimulationEvent& Simulated)
+	{
+		const bool HasSource = Live.EventType != EAutobattlerSimulationEventType::Died && Live.EventType != EAutobattlerSimulationEventType::Ressurected;
+		return Live.EventType == Simulated.EventType && Live.TargetID == Simulated.TargetID && (!HasSource || Live.SourceID == Simulated.SourceID);
+	};
+	auto DescribeEvent = [](const FAutobattlerSimulationEvent* Event)
+	{
+		if (Event == nullptr) return FString(TEXT("nothing"));
+		return FString::Printf(TEXT("%s from %d to %d at %.2f s"), *UEnum::GetValueAsString(Event->EventType), Event->SourceID, Event->TargetID, Event->Time);
+	};
+
+	TArray<const FAutobattlerSimulationEvent*> ComparedLiveEvents;
+	TArray<const FAutobattlerSimulationEvent*> ComparedSimulatedEvents;
+	for (auto& Event : LiveEvents) if (IsCompared(Event)) ComparedLiveEvents.Add(&Event);
+	for (auto& Event : Result.Events) if (IsCompared(Event)) ComparedSimulatedEvents.Add(&Event);
+
+	int32 NumMatchingEvents = 0;
+	while (NumMatchingEvents < ComparedLiveEvents.Num() && NumMatchingEvents < ComparedSimulatedEvents.Num()
+		&& IsSameEvent(*ComparedLiveEvents[NumMatchingEvents], *ComparedSimulatedEvents[NumMatchingEvents]))
+	{
+		NumMatchingEvents++;
+	}
+
+	const bool IsSameWinner = Result.Winner == BattleReplay.GetWinner();
+	const bool IsSameSequence = NumMatchingEvents == ComparedLiveEvents.Num() && NumMatchingEvents == ComparedSimulatedEvents.Num();
+
+	UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Autobattler Manager : [CompareReplayWithSimulation] Seed %d, %d characters : winner %s (live %s, simulated %s), %d of %d live and %d simulated events match%s"),
+		Seed,
+		Setup.Num(),
+		IsSameWinner ? TEXT("matches") : TEXT("differs"),
+		*UEnum::GetValueAsString(BattleReplay.GetWinner()),
+		*UEnum::GetValueAsString(Result.Winner),
+		NumMatchingEvents,
+		ComparedLiveEvents.Num(),
+		ComparedSimulatedEvents.Num(),
+		Setup.GetIsApproximate() ? TEXT(" (approximate, some skills use Blueprint behaviour)") : TEXT("")
+	));
+
+	if (!IsSameSequence)
+	{
+		UAutobattlerFunctionLibrary::PrintWarningToLog(FString::Printf(TEXT("Autobattler Manager : [CompareReplayWithSimulation] First divergence at event %d : live %s, simulated %s"),
+			NumMatchingEvents,
+			*DescribeEvent(ComparedLiveEvents.IsValidIndex(NumMatchingEvents) ? ComparedLiveEvents[NumMatchingEvents] : nullptr),
+			*DescribeEvent(ComparedSimulatedEvents.IsValidIndex(NumMatchingEvents) ? ComparedSimulatedEvents[NumMatchingEvents] : nullptr)
+		));
+	}
+
+	return IsSameWinner && IsSameSequence;
+}
+
+bool AAutobattlerManager::BuildSimulationSetupFromBattlefield(FAutobattlerSimulationSetup& Setup, bool IncludeAI) const
+{
+	const UAutobattlerConfiguration* Configuration = UAutobattlerConfiguration::GetConfigurationAsset(this);
+	if (!IsValid(Configuration)) return false;
+
+	Setup.ApplyConfiguration(Configuration);
+
+	// The grid's cell size is not part of the configuration asset, so grid movement is only modelled with a grid placed.
+	if (Configuration->UseGridPathfinding && IsValid(AutobattlerGrid)) Setup.Settings.GridCellSize = AutobattlerGrid->GetGridXYSize();
+
+	TArray<AAutobattlerCharacter*> DeployedCharacters;
+	GetAllDeployedCharacters(DeployedCharacters);
+	for (auto Character : DeployedCharacters)
+	{
+		if (!IsValid(Character) || Character->GetIsDead()) continue;
+		if (!IncludeAI && Character->GetOwnerIdentity() == EEntity::AI) continue;
+
+		AAutobattlerAIController* AIController = Cast<AAutobattlerAIController>(Character->GetController());
+		if (!IsValid(AIController)) continue;
+
+		if (const FAutobattlerCharacterDefinition* Definition = AIController->GetCharacterDefinition())
+		{
+			Setup.AddCharacter(*Definition, Character->GetOwnerIdentity(), Character->GetActorLocation(), Character->GetID());
+		}
+	}
+
+	return true;
+}
+
+bool AAutobattlerManager::PlanAIFormation(const FName& FormationRowName, const TArray<FName>& WhiteList, const TArray<FName>& Blacklist, FRandomStream& Stream, TMap<int32, FIntPair>& OutPlacements) const
+{
+	OutPlacements.Reset();
+
+	if (WhiteList.Num() < 1)
+	{
+		UAutobattlerFunctionLibrary::PrintErrorToLog(FString("AutobattlerManager : [PlanAIFormation] When generating AI formation, whitelist is empty!"));
+		return false;
+	}
+
+	const FIdentityConfiguration* AIIdentity = IdentityConfigurations.Find(EEntity::AI);
+	if (AIIdentity == nullptr)
+	{
+		UAutobattlerFunctionLibrary::PrintErrorToLog(FString("AutobattlerManager : [PlanAIFormation] When generating AI formation, there is no identity configuration for player 0 (aka the AI)!"));
+		return false;
+	}
+
+	if (AIIdentity->Characters.Num() < 1)
+	{
+		UAutobattlerFunctionLibrary::PrintErrorToLog(FString("AutobattlerManager : [PlanAIFormation] When generating AI formation, player 0 (aka the AI) has no characters to deploy!"));
+		return false;
+	}
+
+	if (const UAutobattlerConfiguration* Configuration = GetAutobattlerConfigurationAsset())
+	{
+		if (const UDataTable* Formations = Configuration->AIFormationsDatatable)
+		{
+			if (FAIFormation* AIFormation = Formations->FindRow<FAIFormation>(FormationRowName, FString("AI Formation")))
+			{
+				if (const UDataTable* AllCharacters = Configuration->AllCharactersDataTable)
+				{
+					// First, get ALL characters owned by the AI. Definitions are pointed to in the baked table rather than copied.
+					TMap<int32, const FAutobattlerCharacterDefinition*> AllDefinitions;
+					for (auto& Character : AIIdentity->Characters)
+					{
+						int32 DefinitionHandle = Character.Value.CharacterDefinitionHandle;
+						if (const FAutobattlerCharacterDefinition* CharacterDefinition = Configuration->ResolveCharacterDefinition(DefinitionHandle, Character.Value.CharacterRowName))
+						{
+							AllDefinitions.Add(Character.Key, CharacterDefinition);
+						}
+						else UAutobattlerFunctionLibrary::PrintWarningToLog(FString::Printf(TEXT("AutobattlerManager : [PlanAIFormation] When generating AI formation, character with row name %s was not found and was skipped!"), *Character.Value.CharacterRowName.ToString()));
+					}
+
+					// Next, pick only characters which have a tag on the white list
+					TMap<int32, const FAutobattlerCharacterDefinition*> BlackWhiteListFiltered;
+					for (auto& Definition : AllDefinitions)
+					{
+						for (auto& Tag : Definition.Value->BlackWhiteListTags)
+						{
+							if (WhiteList.Contains(Tag))
+							{
+								BlackWhiteListFiltered.Emplace(Definition.Key, Definition.Value);
+								break;
+							}
+						}
+					}
+
+					// Next, remove characters which have a tag on the black list (if a blacklist exists)
+					if (Blacklist.Num() > 0)
+					{
+						TArray<int32> Keys;
+						BlackWhiteListFiltered.GenerateKeyArray(Keys);
+
+						for (auto Key : Keys)
+						{
+							if (const FAutobattlerCharacterDefinition** Definition = BlackWhiteListFiltered.Find(Key))
+							{
+								for (auto& Tag : (*Definition)->BlackWhiteListTags)
+								{
+									if (Blacklist.Contains(Tag))
+									{
+										BlackWhiteListFiltered.Remove(Key);
+										break;
+									}
+								}
+							}
+						}
+					}
+
+					// Next, create a final definition from the budget.
+					TMap<int32, const FAutobattlerCharacterDefinition*> Final;
+					int32 AIBudget = GetMaxBudgetForEntity(EEntity::AI);
+					TArray<int32> Keys;
+					BlackWhiteListFiltered.GenerateKeyArray(Keys);
+
+					// Shuffle key array.
+					int32 LastIndex = Keys.Num() - 1;
+					for (int32 i = 0; i <= LastIndex; i++)
+					{
+						int32 NewIndex = Stream.RandRange(i, LastIndex);
+						if (i != NewIndex) Keys.Swap(i, NewIndex);
+					}
+
+					int32 PendingBudget = 0;
+					for (auto Key : Keys)
+					{
+						if (const FAutobattlerCharacterDefinition** Definition = BlackWhiteListFiltered.Find(Key))
+						{
+							if (PendingBudget + (*Definition)->BudgetCost > AIBudget) continue;
+							else
+							{
+								Final.Emplace(Key, *Definition);
+								PendingBudget += (*Definition)->BudgetCost;
+							}
+						}
+					}
+
+					TMap<int32, const FAutobattlerCharacterDefinition*> ToBeDeployedRandomly;
+					TMap<FIntPair, FName> FormationMap = AIFormation->FormationMap;
+
+					// Place characters first on their preferred deployment location
+					while (Final.Num() != 0)
+					{
+						if (FormationMap.Num() == 0) return true; // This occurs if we have run out of spaces to deploy
+						TArray<int32> KeyArray;
+						Final.GenerateKeyArray(KeyArray);
+
+						int32 ActiveKey = KeyArray[0];
+						const FAutobattlerCharacterDefinition* Definition = Final.FindRef(ActiveKey);
+
+						bool DidFindDeploymentLocation = false;
+						for (auto& DeploymentLocation : FormationMap)
+						{
+							if (DeploymentLocation.Value.IsEqual(Definition->PreferedDeploymentLocation))
+							{
+								DidFindDeploymentLocation = true;
+								OutPlacements.Add(ActiveKey, DeploymentLocation.Key);
+								FormationMap.Remove(DeploymentLocation.Key);
+								break;
+							}
+						}
+
+						if (!DidFindDeploymentLocation) ToBeDeployedRandomly.Emplace(ActiveKey, Definition);
+						Final.Remove(ActiveKey);
+					}
+
+					// Otherwise, place characters randomly.
+					if (ToBeDeployedRandomly.Num() > 0)
+					{
+						while (ToBeDeployedRandomly.Num() != 0)
+						{
+							if (FormationMap.Num() == 0) return true; // This occurs if we have run out of spaces to deploy
+							TArray<int32> KeyArray;
+							ToBeDeployedRandomly.GenerateKeyArray(KeyArray);
+
+							int32 ActiveKey = KeyArray[0];
+
+							TArray<FIntPair> DeploymentLocations;
+							FormationMap.GenerateKeyArray(DeploymentLocations);
+
+							FIntPair RandomLocation = DeploymentLocations[Stream.RandRange(0, DeploymentLocations.Num() - 1)];
+							OutPlacements.Add(ActiveKey, RandomLocation);
+
+							FormationMap.Remove(RandomLocation);
+							ToBeDeployedRandomly.Remove(ActiveKey);
+						}
+					}
+
+					return true;
+				}
+				else UAutobattlerFunctionLibrary::PrintErrorToLog(FString("AutobattlerManager : [PlanAIFormation] When generating AI formation, All Characters DataTable is invalid!"));
+			}
+			else UAutobattlerFunctionLibrary::PrintErrorToLog(FString::Printf(TEXT("AutobattlerManager : [PlanAIFormation] When generating AI formation, could not find formation with row name %s!"), *FormationRowName.ToString()));
+		}
+		else UAutobattlerFunctionLibrary::PrintErrorToLog(FString("AutobattlerManager : [PlanAIFormation] When generating AI formation, AI Formation Datatable is invalid!"));
+	}
+	else UAutobattlerFunctionLibrary::PrintErrorToLog(FString("AutobattlerManager : [PlanAIFormation] When generating AI formation, could not get configuration asset!"));
+
+	return false;
 }
@@ -0,0 +1,100 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+/* Class header. */
+#include "Core/AutobattlerReplicatedState.h"
+
+/* Autobattler includes. */
+#include "Core/AutobattlerManager.h"
+
+namespace AutobattlerReplicatedState
+{
+	/**
+	 * Delta serializes a fast array, recording how many bytes were written if this is the sending side.
+	 */
+	template<typename ItemType, typename ArrayType>
+	bool DeltaSerialize(TArray<ItemType>& Items, FNetDeltaSerializeInfo& DeltaParms, ArrayType& ArraySerializer)
+	{
+		const int64 BitsBefore = DeltaParms.Writer != nullptr ? DeltaParms.Writer->GetNumBits() : 0;
+		const bool Result = FFastArraySerializer::FastArrayDeltaSerialize<ItemType, ArrayType>(Items, DeltaParms, ArraySerializer);
+
+		if (DeltaParms.Writer != nullptr && IsValid(ArraySerializer.Manager))
+		{
+			ArraySerializer.Manager->RecordFastArrayBytes(static_cast<int32>(FMath::DivideAndRoundUp<int64>(DeltaParms.Writer->GetNumBits() - BitsBefore, 8)));
+		}
+
+		return Result;
+	}
+}
+
+void FAutobattlerReplicationStats::GetBytesPerSecond(double Now, float& OutFastArrayBytesPerSecond, float& OutMulticastBytesPerSecond) const
+{
+	const double Elapsed = FMath::Max(Now - WindowStartTime, 0.001);
+	OutFastArrayBytesPerSecond = static_cast<float>(FastArrayBytes / Elapsed);
+	OutMulticastBytesPerSecond = static_cast<float>(MulticastBytes / Elapsed);
+}
+
+void FAutobattlerReplicationStats::Reset(double Now)
+{
+	FastArrayBytes = 0;
+	MulticastBytes = 0;
+	WindowStartTime = Now;
+}
+
+void FAutobattlerRosterItem::PreReplicatedRemove(const FAutobattlerRosterArray& InArraySerializer)
+{
+	if (IsValid(InArraySerializer.Manager)) InArraySerializer.Manager->OnReplicatedRosterRemove(*this);
+}
+
+void FAutobattlerRosterItem::PostReplicatedAdd(const FAutobattlerRosterArray& InArraySerializer)
+{
+	if (IsValid(InArraySerializer.Manager)) InArraySerializer.Manager->OnReplicatedRosterAdd(*this);
+}
+
+bool FAutobattlerRosterArray::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	return AutobattlerReplicatedState::DeltaSerialize<FAutobattlerRosterItem, FAutobattlerRosterArray>(Items, DeltaParms, *this);
+}
+
+void FAutobattlerEntityStateItem::PostReplicatedAdd(const FAutobattlerEntityStateArray& InArraySerializer)
+{
+	if (IsValid(InArraySerializer.Manager)) InArraySerializer.Manager->OnReplicatedEntityStateChange(*this);
+}
+
+void FAutobattlerEntityStateItem::PostReplicatedChange(const FAutobattlerEntityStateArray& InArraySerializer)
+{
+	if (IsValid(InArraySerializer.Manager)) InArraySerializer.Manager->OnReplicatedEntityStateChange(*this);
+}
+
+FAutobattlerEntityStateItem& FAutobattlerEntityStateArray::FindOrAdd(EEntity WhoOwns)
+{
+	for (auto& Item : Items)
+	{
+		if (Item.WhoOwns == WhoOwns) return Item;
+	}
+
+	FAutobattlerEntityStateItem& NewItem = Items.AddDefaulted_GetRef();
+	NewItem.WhoOwns = WhoOwns;
+	MarkItemDirty(NewItem);
+	return NewItem;
+}
+
+bool FAutobattlerEntityStateArray::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	return AutobattlerReplicatedState::DeltaSerialize<FAutobattlerEntityStateItem, FAutobattlerEntityStateArray>(Items, DeltaParms, *this);
+}
+
+void FAutobattlerGridCellItem::PostReplicatedAdd(const FAutobattlerGridCellArray& InArraySerializer)
+{
+	if (IsValid(InArraySerializer.Manager)) InArraySerializer.Manager->MarkReplicatedGridVisibilityDirty();
+}
+
+void FAutobattlerGridCellItem::PostReplicatedChange(const FAutobattlerGridCellArray& InArraySerializer)
+{
+	if (IsValid(InArraySerializer.Manager)) InArraySerializer.Manager->MarkReplicatedGridVisibilityDirty();
+}
+
+bool FAutobattlerGridCellArray::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	return AutobattlerReplicatedState::DeltaSerialize<FAutobattlerGridCellItem, FAutobattlerGridCellArray>(Items, DeltaParms, *this);
+}
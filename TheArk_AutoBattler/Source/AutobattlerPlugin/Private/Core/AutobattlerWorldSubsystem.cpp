@@ -0,0 +1,108 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+/* Class header. */
+#include "Core/AutobattlerWorldSubsystem.h"
+
+/* Autobattler includes. */
+#include "Core/AutobattlerManager.h"
+#include "Utility/AutobattlerFunctionLibrary.h"
+
+/* Engine includes. */
+#include "Engine/Engine.h"
+#include "EngineUtils.h"
+
+UAutobattlerWorldSubsystem* UAutobattlerWorldSubsystem::Get(const UObject* WorldContextObject)
+{
+	if (GEngine == nullptr) return nullptr;
+
+	if (UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull))
+	{
+		return World->GetSubsystem<UAutobattlerWorldSubsystem>();
+	}
+
+	return nullptr;
+}
+
+void UAutobattlerWorldSubsystem::Deinitialize()
+{
+	CachedManager.Reset();
+	Super::Deinitialize();
+}
+
+void UAutobattlerWorldSubsystem::RegisterManager(AAutobattlerManager* Manager)
+{
+	if (!IsValid(Manager)) return;
+
+	if (CachedManager.IsValid() && CachedManager.Get() != Manager)
+	{
+		UAutobattlerFunctionLibrary::PrintWarningToLog(FString::Printf(TEXT("Autobattler World Subsystem : [RegisterManager] %s is already registered, ignoring %s! There should only be one autobattler manager per world."), *CachedManager->GetName(), *Manager->GetName()));
+		return;
+	}
+
+	CachedManager = Manager;
+}
+
+void UAutobattlerWorldSubsystem::UnregisterManager(const AAutobattlerManager* Manager)
+{
+	if (CachedManager.Get() == Manager) CachedManager.Reset();
+}
+
+AAutobattlerManager* UAutobattlerWorldSubsystem::GetManager()
+{
+	if (AAutobattlerManager* Manager = CachedManager.Get()) return Manager;
+
+	AAutobattlerManager* FoundManager = FindManagerInWorld();
+	CachedManager = FoundManager;
+	return FoundManager;
+}
+
+const UAutobattlerConfiguration* UAutobattlerWorldSubsystem::GetConfigurationAsset()
+{
+	AAutobattlerManager* Manager = GetManager();
+	return Manager != nullptr ? Manager->GetAutobattlerConfigurationAsset() : nullptr;
+}
+
+AAutobattlerGrid* UAutobattlerWorldSubsystem::GetGrid()
+{
+	AAutobattlerManager* Manager = GetManager();
+	return Manager != nullptr ? Manager->GetAutobattlerGrid() : nullptr;
+}
+
+void UAutobattlerWorldSubsystem::BenchmarkManagerLookup(int32 Iterations)
+{
+	const int32 NumIterations = FMath::Max(Iterations, 1);
+	int32 Checksum = 0;
+
+	// The world scan gets slower with every actor in the world, so the count is printed alongside the timings.
+	int32 NumActors = 0;
+	for (TActorIterator<AActor> ActorItr(GetWorld()); ActorItr; ++ActorItr) NumActors++;
+
+	double StartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < NumIterations; i++) Checksum += FindManagerInWorld() != nullptr ? 1 : 0;
+	const double WorldNs = (FPlatformTime::Seconds() - StartTime) * 1.0e9 / NumIterations;
+
+	// Goes through the same static getter as gameplay code, so the world lookup from the context object is included.
+	StartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < NumIterations; i++) Checksum += AAutobattlerManager::GetManager(this) != nullptr ? 1 : 0;
+	const double CachedNs = (FPlatformTime::Seconds() - StartTime) * 1.0e9 / NumIterations;
+
+	UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("Autobattler World Subsystem : [BenchmarkManagerLookup] %d actors : world scan %.1f ns, cached %.1f ns per lookup (%.1fx faster, checksum %d)"),
+		NumActors,
+		WorldNs,
+		CachedNs,
+		CachedNs > 0.0 ? WorldNs / CachedNs : 0.0,
+		Checksum
+	));
+}
+
+AAutobattlerManager* UAutobattlerWorldSubsystem::FindManagerInWorld() const
+{
+	for (TActorIterator<AAutobattlerManager> ActorItr(GetWorld()); ActorItr; ++ActorItr)
+	{
+		AAutobattlerManager* Manager = *ActorItr;
+		if (IsValid(Manager)) return Manager;
+	}
+
+	return nullptr;
+}
@@ -5,10 +5,14 @@
 #include "DataAssets/AutobattlerConfiguration.h"
 
 /* Autobattler includes. */
-#include "Core/AutobattlerSettings.h"
 #include "Core/AutobattlerManager.h"
+#include "Core/AutobattlerSettings.h"
+#include "Core/AutobattlerWorldSubsystem.h"
 #include "Utility/AutobattlerFunctionLibrary.h"
 
+/* Engine includes. */
+#include "Engine/DataTable.h"
+
 UAutobattlerConfiguration::UAutobattlerConfiguration()
 {
     GridSize = 200.0f;
@@ -49,11 +53,35 @@ UAutobattlerConfiguration::UAutobattlerConfiguration()
     ProjectileMinDistanceToHit = 32.0f;
     PoisonTickRate = 2.0f;
     PoisonStrengthReductionRate = 5.0f;
+
+    PrewarmedExecuteSkillActors = 8;
+    PrewarmedProjectileActors = 16;
+
+    UseFastArrayReplication = true;
+    LargeBattleCharacterThreshold = 64;
+    LargeBattleNetUpdateFrequency = 10.0f;
+    LargeBattleMinNetUpdateFrequency = 2.0f;
+    LargeBattleFullPriorityDistance = 3000.0f;
+
+    UseGridPathfinding = true;
+    UseAIScheduler = true;
+    AIHighRateUpdateInterval = 0.2f;
+    AILowRateUpdateInterval = 0.6f;
+    AIPromotionDistance = 300.0f;
+    AIMaxUpdatesPerFrame = 64;
+    AIUpdateFrameBudgetMs = 1.0f;
+
+    RecordBattles = true;
+    ReplayFrameInterval = 0.1f;
+    ReplaySnapshotInterval = 5.0f;
+
+    BakeDamageModifiers();
 }
 
 const UAutobattlerConfiguration* UAutobattlerConfiguration::GetConfigurationAsset(const UObject* WorldContextObject)
 {
-    if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(WorldContextObject))
+    UAutobattlerWorldSubsystem* WorldSubsystem = UAutobattlerWorldSubsystem::Get(WorldContextObject);
+    if (AAutobattlerManager* Manager = WorldSubsystem != nullptr ? WorldSubsystem->GetManager() : nullptr)
     {
         return Manager->GetAutobattlerConfigurationAsset();
     }
@@ -61,3 +89,113 @@ const UAutobattlerConfiguration* UAutobattlerConfiguration::GetConfigurationAsse
 
 	return nullptr;
 }
+
+void UAutobattlerConfiguration::PostLoad()
+{
+    Super::PostLoad();
+    BakeDamageModifiers();
+    BakeCharacterDefinitions();
+    BindCharactersDataTableChanged();
+}
+
+void UAutobattlerConfiguration::BeginDestroy()
+{
+    if (UDataTable* BoundTable = BoundCharactersDataTable.Get()) BoundTable->OnDataTableChanged().Remove(CharactersDataTableChangedHandle);
+    BoundCharactersDataTable.Reset();
+    CharactersDataTableChangedHandle.Reset();
+
+    Super::BeginDestroy();
+}
+
+#if WITH_EDITOR
+void UAutobattlerConfiguration::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+    Super::PostEditChangeProperty(PropertyChangedEvent);
+
+    // Edits inside the map report the inner key or value property, so the member the edit belongs to is compared instead.
+    const FName MemberPropertyName = PropertyChangedEvent.GetMemberPropertyName();
+    if (MemberPropertyName == GET_MEMBER_NAME_CHECKED(UAutobattlerConfiguration, DamageModifierMap)) BakeDamageModifiers();
+    else if (MemberPropertyName == GET_MEMBER_NAME_CHECKED(UAutobattlerConfiguration, AllCharactersDataTable))
+    {
+        BakeCharacterDefinitions();
+        BindCharactersDataTableChanged();
+    }
+}
+#endif
+
+int32 UAutobattlerConfiguration::FindCharacterDefinitionHandle(const FName& RowName) const
+{
+    const int32* Handle = CharacterDefinitionHandles.Find(RowName);
+    return Handle != nullptr ? *Handle : INDEX_NONE;
+}
+
+const FAutobattlerCharacterDefinition* UAutobattlerConfiguration::ResolveCharacterDefinition(int32& InOutHandle, const FName& RowName) const
+{
+    if (!BakedCharacterRowNames.IsValidIndex(InOutHandle) || BakedCharacterRowNames[InOutHandle] != RowName) InOutHandle = FindCharacterDefinitionHandle(RowName);
+    return GetCharacterDefinition(InOutHandle);
+}
+
+void UAutobattlerConfiguration::BakeCharacterDefinitions()
+{
+    BakedCharacterDefinitions.Reset();
+    BakedCharacterRowNames.Reset();
+    CharacterDefinitionHandles.Reset();
+
+    if (AllCharactersDataTable == nullptr || HasAnyFlags(RF_ClassDefaultObject)) return;
+
+    if (AllCharactersDataTable->GetRowStruct() == nullptr || !AllCharactersDataTable->GetRowStruct()->IsChildOf(FAutobattlerCharacterDefinition::StaticStruct()))
+    {
+        UAutobattlerFunctionLibrary::PrintErrorToLog(FString::Printf(TEXT("AutobattlerConfiguration : [BakeCharacterDefinitions] Character DT should have row structure AutobattlerCharacterDefinition but instead has %s!"), *AllCharactersDataTable->GetRowStructName().ToString()));
+        return;
+    }
+
+    const TMap<FName, uint8*>& RowMap = AllCharactersDataTable->GetRowMap();
+    BakedCharacterDefinitions.Reserve(RowMap.Num());
+    BakedCharacterRowNames.Reserve(RowMap.Num());
+    CharacterDefinitionHandles.Reserve(RowMap.Num());
+
+    for (auto& Row : RowMap)
+    {
+        CharacterDefinitionHandles.Add(Row.Key, BakedCharacterDefinitions.Num());
+        BakedCharacterRowNames.Add(Row.Key);
+        BakedCharacterDefinitions.Add(*reinterpret_cast<const FAutobattlerCharacterDefinition*>(Row.Value));
+    }
+
+    if (BakedCharacterDefinitions.Num() == 0) UAutobattlerFunctionLibrary::PrintWarningToLog(FString("AutobattlerConfiguration : [BakeCharacterDefinitions] Character DT has no rows!"));
+}
+
+void UAutobattlerConfiguration::BindCharactersDataTableChanged()
+{
+    UDataTable* CharactersDataTable = const_cast<UDataTable*>(AllCharactersDataTable);
+    if (BoundCharactersDataTable.Get() == CharactersDataTable) return;
+
+    if (UDataTable* BoundTable = BoundCharactersDataTable.Get()) BoundTable->OnDataTableChanged().Remove(CharactersDataTableChangedHandle);
+    BoundCharactersDataTable.Reset();
+    CharactersDataTableChangedHandle.Reset();
+
+    if (CharactersDataTable == nullptr || HasAnyFlags(RF_ClassDefaultObject)) return;
+
+    // Handles made stale by a re-bake are looked up again by row name, see ResolveCharacterDefinition.
+    CharactersDataTableChangedHandle = CharactersDataTable->OnDataTableChanged().AddUObject(this, &UAutobattlerConfiguration::BakeCharacterDefinitions);
+    BoundCharactersDataTable = CharactersDataTable;
+}
+
+void UAutobattlerConfiguration::BakeDamageModifiers()
+{
+    const bool ShouldReportMissing = !HasAnyFlags(RF_ClassDefaultObject);
+    for (uint8 DamageType = 0; DamageType < (uint8)EDamageType::Count; DamageType++)
+    {
+        const FResistanceContainer* ResistanceContainer = DamageModifierMap.Find((EDamageType)DamageType);
+        for (uint8 ResistanceType = 0; ResistanceType < (uint8)EResistanceType::Count; ResistanceType++)
+        {
+            const float* FoundModifier = ResistanceContainer != nullptr ? ResistanceContainer->Resistances.Find((EResistanceType)ResistanceType) : nullptr;
+            BakedDamageModifiers[DamageType][ResistanceType] = FoundModifier != nullptr ? *FoundModifier : 1.0f;
+
+            if (FoundModifier == nullptr && ShouldReportMissing) UAutobattlerFunctionLibrary::PrintWarningToLog(
+                FString::Printf(TEXT("AutobattlerConfiguration : [BakeDamageModifiers] No modifier for resistance type %s defending against damage type %s (resistances will not be applied)!"),
+                    *UAutobattlerEnums::ResistanceTypeToString((EResistanceType)ResistanceType),
+                    *UAutobattlerEnums::DamageTypeToString((EDamageType)DamageType)
+                ));
+        }
+    }
+}
@@ -5,6 +5,7 @@
 #include "Game/Components/DurationSkillComponent.h"
 
 /* Autobattler includes. */
+#include "Core/AutobattlerManager.h"
 #include "DataAssets/AutobattlerSkill.h"
 #include "Game/Units/AutobattlerCharacter.h"
 
@@ -15,7 +16,20 @@ UDurationSkillComponent::UDurationSkillComponent()
 
 void UDurationSkillComponent::ConfigureTimedSkill(AAutobattlerCharacter* Target, const UAutobattlerSkill* SkillAsset, AAutobattlerCharacter* SkillOwner, const FAbilityTargetingProperties& TargetingProperties)
 {
-	if (!IsValid(Target)) return;
+	if (!IsValid(Target) || !IsValid(SkillAsset)) return;
+
+	// Only custom duration components need to exist as components; the default behaviour runs on the manager's effect scheduler.
+	if (SkillAsset->DurationSkillComponentClass.Get() == nullptr || SkillAsset->DurationSkillComponentClass.Get() == UDurationSkillComponent::StaticClass())
+	{
+		if (Target->HasAuthority())
+		{
+			if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(Target))
+			{
+				Manager->GetEffectScheduler().AddRepeatingSkill(Target, SkillAsset, SkillOwner, TargetingProperties, SkillAsset->Interval, SkillAsset->NumRepetitions);
+			}
+		}
+		return;
+	}
 
 	if (UDurationSkillComponent* NewDurationComponent = Cast<UDurationSkillComponent>(Target->AddComponentByClass(SkillAsset->DurationSkillComponentClass, false, FTransform(), false)))
 	{
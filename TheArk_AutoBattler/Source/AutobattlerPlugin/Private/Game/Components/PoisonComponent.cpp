@@ -5,39 +5,21 @@
 #include "Game/Components/PoisonComponent.h"
 
 /* Autobattler includes. */
+#include "Core/AutobattlerManager.h"
 #include "DataAssets/AutobattlerConfiguration.h"
 #include "Game/Units/AutobattlerCharacter.h"
 
 void UPoisonComponent::ApplyPoison(float PoisonStrength)
 {
-	AAutobattlerCharacter* OwnerCharacter = Cast<AAutobattlerCharacter>(GetOwner());
-	const UAutobattlerConfiguration* Configuration = UAutobattlerConfiguration::GetConfigurationAsset(this);
-	if (ensureMsgf(IsValid(OwnerCharacter) && IsValid(Configuration), TEXT("%s : [ApplyPoison] Either configuration is invalid or owner is not autobattler character!"), *GetName()))
-	{
-		float ClampedPoisonStrength = FMath::Max(0.0f, PoisonStrength);
-		if (PoisonTimerHandle.IsValid())
-		{
-			CurrentPoisonStrength += ClampedPoisonStrength;
-		}
-		else
-		{
-			CurrentPoisonStrength = ClampedPoisonStrength;
-			FTimerDelegate PoisonTimerDelegate;
-			PoisonTimerDelegate.BindUFunction(this, FName("TickPoison"));
-			
-			GetWorld()->GetTimerManager().SetTimer(PoisonTimerHandle, PoisonTimerDelegate, Configuration->PoisonTickRate, true, 0.0f);
-		}
-	}
+	ApplyPoisonToCharacter(Cast<AAutobattlerCharacter>(GetOwner()), PoisonStrength);
 }
 
-void UPoisonComponent::TickPoison()
+void UPoisonComponent::ApplyPoisonToCharacter(AAutobattlerCharacter* Target, float PoisonStrength)
 {
-	AAutobattlerCharacter* OwnerCharacter = Cast<AAutobattlerCharacter>(GetOwner());
-	const UAutobattlerConfiguration* Configuration = UAutobattlerConfiguration::GetConfigurationAsset(this);
-	if (IsValid(Configuration) && IsValid(OwnerCharacter))
+	AAutobattlerManager* Manager = AAutobattlerManager::GetManager(Target);
+	const UAutobattlerConfiguration* Configuration = UAutobattlerConfiguration::GetConfigurationAsset(Target);
+	if (ensureMsgf(IsValid(Target) && IsValid(Manager) && IsValid(Configuration), TEXT("PoisonComponent : [ApplyPoisonToCharacter] Either configuration or manager is invalid, or target is not autobattler character!")))
 	{
-		OwnerCharacter->SetCurrentHealth(OwnerCharacter->GetCurrentHealth() - CurrentPoisonStrength);
-		CurrentPoisonStrength -= Configuration->PoisonStrengthReductionRate;
-		if (CurrentPoisonStrength <= 0.0f) DestroyComponent();
+		Manager->GetEffectScheduler().AddPoison(Target, PoisonStrength, Configuration->PoisonTickRate, Configuration->PoisonStrengthReductionRate);
 	}
 }
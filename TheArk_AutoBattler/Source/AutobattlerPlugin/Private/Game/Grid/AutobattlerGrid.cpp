@@ -6,23 +6,89 @@
 
 /* Autobattler includes. */
 #include "Core/AutobattlerManager.h"
+#include "Utility/AutobattlerFunctionLibrary.h"
 
 /* Engine includes. */
 #include "Components/DecalComponent.h"
 #include "Components/SceneComponent.h"
+#include "Engine/Texture2D.h"
+#include "Materials/MaterialInstanceDynamic.h"
 #include "Net/UnrealNetwork.h"
 
+#if WITH_EDITOR
+#include "AssetRegistryModule.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialExpressionComponentMask.h"
+#include "Materials/MaterialExpressionCustom.h"
+#include "Materials/MaterialExpressionScalarParameter.h"
+#include "Materials/MaterialExpressionTextureCoordinate.h"
+#include "Materials/MaterialExpressionTextureObjectParameter.h"
+#include "Materials/MaterialExpressionVectorParameter.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+
+namespace AutobattlerGridMaterial
+{
+	/* Package and name of the material created by CreateCellStateMaterial. */
+	static const TCHAR* PackageName = TEXT("/AutobattlerPlugin/Materials/Grid/M_GridCellStates");
+	static const TCHAR* AssetName = TEXT("M_GridCellStates");
+
+	/* Draws each cell from its texel: R shown, G occupied, B hovered, A range (see EGridHighlight). Decal V runs against the grid's
+	X axis, and the texture is laid out with X along its height. */
+	static const TCHAR* CellStateCode = TEXT(
+		"float2 CellCount = float2(GridSizeY, GridSizeX);\n"
+		"float2 GridUV = float2(UV.x, 1.0 - UV.y) * CellCount;\n"
+		"float2 Cell = floor(GridUV);\n"
+		"float2 CellOffset = abs(GridUV - Cell - 0.5);\n"
+		"float4 State = Texture2DSample(GridStateTexture, GridStateTextureSampler, (Cell + 0.5) / CellCount);\n"
+		"float Inside = step(CellOffset.x, 0.5 + CellPadding) * step(CellOffset.y, 0.5 + CellPadding);\n"
+		"float3 Color = lerp(lerp(lerp(ShownColor, RangeColor, State.a), OccupiedColor, State.g), HoveredColor, State.b);\n"
+		"return float4(Color, max(State.r, max(State.b, State.a)) * Inside * CellOpacity);"
+	);
+
+	template<typename ExpressionType>
+	ExpressionType* AddExpression(UMaterial* Material)
+	{
+		ExpressionType* Expression = NewObject<ExpressionType>(Material);
+		Material->Expressions.Add(Expression);
+		return Expression;
+	}
+
+	static UMaterialExpressionScalarParameter* AddScalarParameter(UMaterial* Material, const FName& Name, float DefaultValue)
+	{
+		UMaterialExpressionScalarParameter* Parameter = AddExpression<UMaterialExpressionScalarParameter>(Material);
+		Parameter->ParameterName = Name;
+		Parameter->DefaultValue = DefaultValue;
+		return Parameter;
+	}
+
+	static UMaterialExpressionVectorParameter* AddVectorParameter(UMaterial* Material, const FName& Name, const FLinearColor& DefaultValue)
+	{
+		UMaterialExpressionVectorParameter* Parameter = AddExpression<UMaterialExpressionVectorParameter>(Material);
+		Parameter->ParameterName = Name;
+		Parameter->DefaultValue = DefaultValue;
+		return Parameter;
+	}
+}
+#endif
+
 AAutobattlerGrid::AAutobattlerGrid()
 {
 	GridRoot = CreateDefaultSubobject<USceneComponent>(TEXT("GridRoot"));
 	RootComponent = GridRoot;
 
+	GridDecal = CreateDefaultSubobject<UDecalComponent>(TEXT("GridDecal"));
+	GridDecal->SetupAttachment(GridRoot);
+	GridDecal->SetRelativeRotation(FRotator(-90.0f, 0.0f, 0.0f));
+
 	GridXSize = 5;
 	GridYSize = 5;
 	MaxZExtent = 1000.0f;
 	XYSize = 400.0f;
 	DecalShrinkFactor = 0.0f;
 	HiddenByDefault = true;
+	GridMaterialInstance = nullptr;
+	CellStateTexture = nullptr;
 }
 
 void AAutobattlerGrid::BuildGridInEditor()
@@ -30,10 +96,97 @@ void AAutobattlerGrid::BuildGridInEditor()
 	BuildGrid();
 }
 
+void AAutobattlerGrid::CreateCellStateMaterial()
+{
+#if WITH_EDITOR
+	const FString ObjectPath = FString::Printf(TEXT("%s.%s"), AutobattlerGridMaterial::PackageName, AutobattlerGridMaterial::AssetName);
+	UMaterial* Material = LoadObject<UMaterial>(nullptr, *ObjectPath, nullptr, LOAD_NoWarn);
+	if (Material == nullptr)
+	{
+		UPackage* Package = CreatePackage(AutobattlerGridMaterial::PackageName);
+		Material = NewObject<UMaterial>(Package, FName(AutobattlerGridMaterial::AssetName), RF_Public | RF_Standalone);
+		BuildCellStateMaterial(Material);
+
+		FAssetRegistryModule::AssetCreated(Material);
+		Package->MarkPackageDirty();
+
+		const FString FileName = FPackageName::LongPackageNameToFilename(AutobattlerGridMaterial::PackageName, FPackageName::GetAssetPackageExtension());
+		if (!UPackage::SavePackage(Package, Material, RF_Public | RF_Standalone, *FileName))
+		{
+			UAutobattlerFunctionLibrary::PrintErrorToLog(FString::Printf(TEXT("%s : [CreateCellStateMaterial] Could not save %s!"), *GetName(), *FileName));
+		}
+	}
+
+	Modify();
+	DefaultDecalMaterial = Material;
+	BuildGrid();
+#endif
+}
+
+#if WITH_EDITOR
+void AAutobattlerGrid::BuildCellStateMaterial(UMaterial* Material)
+{
+	using namespace AutobattlerGridMaterial;
+
+	Material->MaterialDomain = EMaterialDomain::MD_DeferredDecal;
+	Material->BlendMode = EBlendMode::BLEND_Translucent;
+	Material->DecalBlendMode = EDecalBlendMode::DBM_Translucent;
+
+	// States are only ever 0 or 255, which read the same whether or not the texture is sRGB.
+	UMaterialExpressionTextureObjectParameter* StateTexture = AddExpression<UMaterialExpressionTextureObjectParameter>(Material);
+	StateTexture->ParameterName = FName("GridStateTexture");
+	StateTexture->Texture = LoadObject<UTexture>(nullptr, TEXT("/Engine/EngineResources/DefaultTexture.DefaultTexture"));
+	StateTexture->SamplerType = EMaterialSamplerType::SAMPLERTYPE_Color;
+
+	UMaterialExpressionTextureCoordinate* TexCoord = AddExpression<UMaterialExpressionTextureCoordinate>(Material);
+
+	UMaterialExpressionCustom* CellState = AddExpression<UMaterialExpressionCustom>(Material);
+	CellState->Code = CellStateCode;
+	CellState->OutputType = ECustomMaterialOutputType::CMOT_Float4;
+	CellState->Description = TEXT("Cell State");
+	CellState->Inputs.Reset();
+
+	const TPair<FName, UMaterialExpression*> Inputs[] = {
+		{ FName("UV"), TexCoord },
+		{ FName("GridStateTexture"), StateTexture },
+		{ FName("GridSizeX"), AddScalarParameter(Material, FName("GridSizeX"), 5.0f) },
+		{ FName("GridSizeY"), AddScalarParameter(Material, FName("GridSizeY"), 5.0f) },
+		{ FName("CellPadding"), AddScalarParameter(Material, FName("CellPadding"), 0.0f) },
+		{ FName("CellOpacity"), AddScalarParameter(Material, FName("CellOpacity"), 0.5f) },
+		{ FName("ShownColor"), AddVectorParameter(Material, FName("ShownColor"), FLinearColor(0.8f, 0.8f, 0.8f)) },
+		{ FName("OccupiedColor"), AddVectorParameter(Material, FName("OccupiedColor"), FLinearColor(0.8f, 0.2f, 0.1f)) },
+		{ FName("HoveredColor"), AddVectorParameter(Material, FName("HoveredColor"), FLinearColor(1.0f, 0.8f, 0.1f)) },
+		{ FName("RangeColor"), AddVectorParameter(Material, FName("RangeColor"), FLinearColor(0.1f, 0.4f, 1.0f)) }
+	};
+
+	for (auto& Input : Inputs)
+	{
+		FCustomInput& CustomInput = CellState->Inputs.AddDefaulted_GetRef();
+		CustomInput.InputName = Input.Key;
+		CustomInput.Input.Expression = Input.Value;
+	}
+
+	UMaterialExpressionComponentMask* Color = AddExpression<UMaterialExpressionComponentMask>(Material);
+	Color->Input.Expression = CellState;
+	Color->R = Color->G = Color->B = 1;
+
+	UMaterialExpressionComponentMask* Opacity = AddExpression<UMaterialExpressionComponentMask>(Material);
+	Opacity->Input.Expression = CellState;
+	Opacity->A = 1;
+
+	Material->BaseColor.Expression = Color;
+	Material->Opacity.Expression = Opacity;
+
+	Material->PreEditChange(nullptr);
+	Material->PostEditChange();
+}
+#endif
+
 void AAutobattlerGrid::BeginPlay()
 {
 	Super::BeginPlay();
 	BuildGrid();
+	if (HasAuthority()) ResetOccupancy();
 	BindManagerDelegates();
 	if (HiddenByDefault) ToggleGridVisibility(false);
 	IsCurrentlyHidden = HiddenByDefault;
@@ -41,41 +194,101 @@ void AAutobattlerGrid::BeginPlay()
 
 void AAutobattlerGrid::BuildGrid()
 {
-	GridIndexInfo.Empty(FMath::Max(GridXSize, 1) * FMath::Max(GridYSize, 1));
-
+	// Per-cell decals, from the fallback or from grids built before the grid was drawn by a single decal, are rebuilt below if needed.
 	TArray<UDecalComponent*> DecalComponents;
 	GetComponents<UDecalComponent>(DecalComponents);
 
 	for (int32 i = 0; i < DecalComponents.Num(); i++)
 	{
-		DecalComponents[i]->DestroyComponent();
+		if (DecalComponents[i] != GridDecal) DecalComponents[i]->DestroyComponent();
 	}
 
-	float XYSizeClamped = FMath::Max(XYSize, 1.0f);
+	CellDecals.Reset();
+
+	// With a material which reads the cell state texture, only the decal and texture are sized to the grid, so building costs the same
+	// however many cells there are.
+	const int32 SizeX = FMath::Max(GridXSize, 1);
+	const int32 SizeY = FMath::Max(GridYSize, 1);
+	const float XYSizeClamped = FMath::Max(XYSize, 1.0f);
+
+	GridDecal->SetRelativeLocation(FVector(SizeX * XYSizeClamped / 2.0f, SizeY * XYSizeClamped / 2.0f, 0.0f));
+	GridDecal->DecalSize = FVector(MaxZExtent, SizeY * XYSizeClamped / 2.0f, SizeX * XYSizeClamped / 2.0f);
+
+	// Every index is shown until told otherwise, like the per-cell decals always were.
+	CellStates.Init(0, SizeX * SizeY * 4);
+	const int32 ShownChannel = GetHighlightChannel(EGridHighlight::Shown);
+	for (int32 i = ShownChannel; i < CellStates.Num(); i += 4) CellStates[i] = MAX_uint8;
 
-	FVector InitialLocation = GetActorLocation();
-	FVector SpawnLocation = FVector::ZeroVector;
-	FHitResult HitResult;
-	FAttachmentTransformRules DecalAttachmentTransformRules = FAttachmentTransformRules(EAttachmentRule::KeepWorld, true);
+	CellStateTexture = nullptr;
+	GridMaterialInstance = nullptr;
+	GridDecal->SetDecalMaterial(nullptr);
 
-	for (int32 x = 0; x < FMath::Max(GridXSize, 1); x++)
+	// A dedicated server draws nothing, so it only keeps the states.
+	if (GetNetMode() == NM_DedicatedServer) return;
+
+	if (!CanDrawCellStates(DefaultDecalMaterial))
 	{
-		for (int32 y = 0; y < FMath::Max(GridYSize, 1); y++)
+		UAutobattlerFunctionLibrary::PrintWarningToLog(FString::Printf(TEXT("%s : [BuildGrid] Decal material cannot draw cell states, so only shown cells are drawn. Use CreateCellStateMaterial in the editor."), *GetName()));
+		GridDecal->SetVisibility(false);
+
+		FAttachmentTransformRules DecalAttachmentTransformRules = FAttachmentTransformRules(EAttachmentRule::KeepWorld, true);
+		CellDecals.Reserve(SizeX * SizeY);
+
+		for (int32 x = 0; x < SizeX; x++)
 		{
-			if (GridIndexToLocation(FIntPair(x, y), SpawnLocation, HitResult))
+			for (int32 y = 0; y < SizeY; y++)
 			{
 				UDecalComponent* NewDecalComponent = NewObject<UDecalComponent>(this, UDecalComponent::StaticClass());
 				NewDecalComponent->RegisterComponent();
 				NewDecalComponent->AttachToComponent(RootComponent, DecalAttachmentTransformRules);
-				NewDecalComponent->SetWorldLocation(SpawnLocation);
+				NewDecalComponent->SetWorldLocation(GetGridIndexCenter(FIntPair(x, y)));
 				NewDecalComponent->SetWorldRotation(FRotator(-90.0f, 0.0f, 0.0f));
 				NewDecalComponent->SetMaterial(0, DefaultDecalMaterial);
 				NewDecalComponent->DecalSize = FVector(MaxZExtent, (XYSizeClamped / 2.0f) + DecalShrinkFactor, (XYSizeClamped / 2.0f) + DecalShrinkFactor);
 
-				GridIndexInfo.Emplace(FIndexInfo(NewDecalComponent, FIntPair(x, y)));
+				CellDecals.Emplace(NewDecalComponent);
 			}
 		}
+
+		return;
+	}
+
+	GridDecal->SetVisibility(true);
+
+	// One texel per cell, laid out like CellStates: Y along the width, X along the height.
+	CellStateTexture = UTexture2D::CreateTransient(SizeY, SizeX, PF_B8G8R8A8);
+	if (IsValid(CellStateTexture))
+	{
+		CellStateTexture->Filter = TextureFilter::TF_Nearest;
+		CellStateTexture->SRGB = false;
+		CellStateTexture->AddressX = TextureAddress::TA_Clamp;
+		CellStateTexture->AddressY = TextureAddress::TA_Clamp;
+		CellStateTexture->UpdateResource();
+	}
+
+	GridMaterialInstance = UMaterialInstanceDynamic::Create(DefaultDecalMaterial, this);
+	if (IsValid(GridMaterialInstance))
+	{
+		GridMaterialInstance->SetTextureParameterValue(FName("GridStateTexture"), CellStateTexture);
+		GridMaterialInstance->SetScalarParameterValue(FName("GridSizeX"), SizeX);
+		GridMaterialInstance->SetScalarParameterValue(FName("GridSizeY"), SizeY);
+		GridMaterialInstance->SetScalarParameterValue(FName("CellPadding"), DecalShrinkFactor / XYSizeClamped);
 	}
+	GridDecal->SetDecalMaterial(GridMaterialInstance);
+
+	UploadCellStates();
+}
+
+bool AAutobattlerGrid::CanDrawCellStates(const UMaterialInterface* Material)
+{
+	if (Material == nullptr) return false;
+
+	UTexture* Texture = nullptr;
+	float Value = 0.0f;
+	return Material->GetTextureParameterValue(FMaterialParameterInfo(FName("GridStateTexture")), Texture)
+		&& Material->GetScalarParameterValue(FMaterialParameterInfo(FName("GridSizeX")), Value)
+		&& Material->GetScalarParameterValue(FMaterialParameterInfo(FName("GridSizeY")), Value)
+		&& Material->GetScalarParameterValue(FMaterialParameterInfo(FName("CellPadding")), Value);
 }
 
 void AAutobattlerGrid::BindManagerDelegates()
@@ -152,6 +365,214 @@ bool AAutobattlerGrid::GridIndexToLocation(const FIntPair& TestGridIndex, FVecto
 	return true;
 }
 
+FVector AAutobattlerGrid::GetGridIndexCenter(const FIntPair& TestGridIndex) const
+{
+	return FVector(
+		(TestGridIndex.X * XYSize + GetActorLocation().X) + (XYSize / 2.0f),
+		(TestGridIndex.Y * XYSize + GetActorLocation().Y) + (XYSize / 2.0f),
+		GetActorLocation().Z
+	);
+}
+
+void AAutobattlerGrid::GetIndicesInRadius(const FVector& Location, float Radius, TArray<FIntPair>& OutGridIndices) const
+{
+	OutGridIndices.Reset();
+	if (XYSize <= 0.0f || Radius < 0.0f) return;
+
+	// Only indices within the square around the location can be in range.
+	const FVector Local = Location - GetActorLocation();
+	const int32 MinX = FMath::Max(FMath::FloorToInt((Local.X - Radius) / XYSize), 0);
+	const int32 MaxX = FMath::Min(FMath::FloorToInt((Local.X + Radius) / XYSize), GridXSize - 1);
+	const int32 MinY = FMath::Max(FMath::FloorToInt((Local.Y - Radius) / XYSize), 0);
+	const int32 MaxY = FMath::Min(FMath::FloorToInt((Local.Y + Radius) / XYSize), GridYSize - 1);
+
+	for (int32 x = MinX; x <= MaxX; x++)
+	{
+		for (int32 y = MinY; y <= MaxY; y++)
+		{
+			const FIntPair GridIndex(x, y);
+			if (FVector2D::DistSquared(FVector2D(GetGridIndexCenter(GridIndex)), FVector2D(Location)) <= Radius * Radius) OutGridIndices.Add(GridIndex);
+		}
+	}
+}
+
+void AAutobattlerGrid::ResetOccupancy()
+{
+	const int32 NumIndices = FMath::Max(GridXSize, 0) * FMath::Max(GridYSize, 0);
+	OccupancyBits.Init(0, FMath::DivideAndRoundUp(NumIndices, 32));
+	IndexOccupantIDs.Init(INDEX_NONE, NumIndices);
+	IndexOccupantOwners.Init(EEntity::AI, NumIndices);
+	OccupiedIndexByID.Reset();
+	ClearHighlight(EGridHighlight::Occupied);
+}
+
+bool AAutobattlerGrid::SetIndexOccupant(const FIntPair& GridIndex, int32 CharacterID, EEntity WhoOwns)
+{
+	const int32 Bit = GridIndexToBit(GridIndex);
+	if (Bit == INDEX_NONE || !IndexOccupantIDs.IsValidIndex(Bit)) return false;
+	if (IndexOccupantIDs[Bit] != INDEX_NONE && IndexOccupantIDs[Bit] != CharacterID) return false;
+
+	IndexOccupantOwners[Bit] = WhoOwns;
+	if (IndexOccupantIDs[Bit] == CharacterID) return true;
+
+	ClearIndexOccupant(CharacterID);
+
+	OccupancyBits[Bit >> 5] |= 1u << (Bit & 31);
+	IndexOccupantIDs[Bit] = CharacterID;
+	OccupiedIndexByID.Add(CharacterID, Bit);
+	OnIndexOccupancyChanged(Bit, true);
+	return true;
+}
+
+void AAutobattlerGrid::ClearIndexOccupant(int32 CharacterID)
+{
+	int32 Bit;
+	if (!OccupiedIndexByID.RemoveAndCopyValue(CharacterID, Bit)) return;
+	if (!IndexOccupantIDs.IsValidIndex(Bit) || IndexOccupantIDs[Bit] != CharacterID) return;
+
+	OccupancyBits[Bit >> 5] &= ~(1u << (Bit & 31));
+	IndexOccupantIDs[Bit] = INDEX_NONE;
+	OnIndexOccupancyChanged(Bit, false);
+}
+
+void AAutobattlerGrid::OnIndexOccupancyChanged(int32 Bit, bool IsOccupied)
+{
+	const FIntPair GridIndex(Bit / FMath::Max(GridYSize, 1), Bit % FMath::Max(GridYSize, 1));
+	SetSingleIndexHighlight(GridIndex, EGridHighlight::Occupied, IsOccupied);
+
+	if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this)) Manager->SetReplicatedGridCellOccupied(GridIndex, IsOccupied);
+}
+
+bool AAutobattlerGrid::GetIsIndexOccupied(const FIntPair& GridIndex) const
+{
+	const int32 Bit = GridIndexToBit(GridIndex);
+	if (Bit == INDEX_NONE || !OccupancyBits.IsValidIndex(Bit >> 5)) return false;
+
+	return (OccupancyBits[Bit >> 5] & (1u << (Bit & 31))) != 0;
+}
+
+bool AAutobattlerGrid::GetIndexOccupant(const FIntPair& GridIndex, int32& OutCharacterID, EEntity& OutWhoOwns) const
+{
+	const int32 Bit = GridIndexToBit(GridIndex);
+	if (Bit == INDEX_NONE || !IndexOccupantIDs.IsValidIndex(Bit) || IndexOccupantIDs[Bit] == INDEX_NONE) return false;
+
+	OutCharacterID = IndexOccupantIDs[Bit];
+	OutWhoOwns = IndexOccupantOwners[Bit];
+	return true;
+}
+
+void AAutobattlerGrid::BuildIndexMask(const TArray<FIntPair>& GridIndices, TArray<uint32>& OutMask) const
+{
+	OutMask.Init(0, FMath::DivideAndRoundUp(FMath::Max(GridXSize, 0) * FMath::Max(GridYSize, 0), 32));
+	for (auto& GridIndex : GridIndices)
+	{
+		const int32 Bit = GridIndexToBit(GridIndex);
+		if (Bit != INDEX_NONE) OutMask[Bit >> 5] |= 1u << (Bit & 31);
+	}
+}
+
+void AAutobattlerGrid::GetFreeIndicesInMask(const TArray<uint32>& Mask, TArray<FIntPair>& OutGridIndices) const
+{
+	OutGridIndices.Reset();
+
+	const int32 NumWords = FMath::Min(Mask.Num(), OccupancyBits.Num());
+	for (int32 Word = 0; Word < NumWords; Word++)
+	{
+		uint32 FreeBits = Mask[Word] & ~OccupancyBits[Word];
+		while (FreeBits != 0)
+		{
+			const int32 Bit = Word * 32 + FMath::CountTrailingZeros(FreeBits);
+			OutGridIndices.Emplace(FIntPair(Bit / GridYSize, Bit % GridYSize));
+			FreeBits &= FreeBits - 1;
+		}
+	}
+}
+
+void AAutobattlerGrid::GetIndicesInMask(const TArray<uint32>& Mask, TArray<FIntPair>& OutGridIndices) const
+{
+	OutGridIndices.Reset();
+
+	const int32 NumIndices = FMath::Max(GridXSize, 0) * FMath::Max(GridYSize, 0);
+	const int32 NumWords = FMath::Min(Mask.Num(), FMath::DivideAndRoundUp(NumIndices, 32));
+	for (int32 Word = 0; Word < NumWords; Word++)
+	{
+		uint32 SetBits = Mask[Word];
+		while (SetBits != 0)
+		{
+			const int32 Bit = Word * 32 + FMath::CountTrailingZeros(SetBits);
+			if (Bit < NumIndices) OutGridIndices.Emplace(FIntPair(Bit / GridYSize, Bit % GridYSize));
+			SetBits &= SetBits - 1;
+		}
+	}
+}
+
+bool AAutobattlerGrid::GetIsIndexInMask(const TArray<uint32>& Mask, const FIntPair& GridIndex) const
+{
+	const int32 Bit = GridIndexToBit(GridIndex);
+	if (Bit == INDEX_NONE || !Mask.IsValidIndex(Bit >> 5)) return false;
+
+	return (Mask[Bit >> 5] & (1u << (Bit & 31))) != 0;
+}
+
+bool AAutobattlerGrid::SetIndexInMask(TArray<uint32>& Mask, const FIntPair& GridIndex, bool IsSet) const
+{
+	const int32 Bit = GridIndexToBit(GridIndex);
+	if (Bit == INDEX_NONE) return false;
+
+	const int32 NumWords = FMath::DivideAndRoundUp(GridXSize * GridYSize, 32);
+	if (Mask.Num() < NumWords) Mask.SetNumZeroed(NumWords);
+
+	const uint32 BitMask = 1u << (Bit & 31);
+	const bool WasSet = (Mask[Bit >> 5] & BitMask) != 0;
+	if (WasSet == IsSet) return false;
+
+	if (IsSet) Mask[Bit >> 5] |= BitMask;
+	else Mask[Bit >> 5] &= ~BitMask;
+	return true;
+}
+
+void AAutobattlerGrid::BuildRectangleMask(const FIntPair& Corner, const FIntPair& OppositeCorner, TArray<uint32>& OutMask) const
+{
+	OutMask.Init(0, FMath::DivideAndRoundUp(FMath::Max(GridXSize, 0) * FMath::Max(GridYSize, 0), 32));
+
+	const int32 MinX = FMath::Max(FMath::Min(Corner.X, OppositeCorner.X), 0);
+	const int32 MaxX = FMath::Min(FMath::Max(Corner.X, OppositeCorner.X), GridXSize - 1);
+	const int32 MinY = FMath::Max(FMath::Min(Corner.Y, OppositeCorner.Y), 0);
+	const int32 MaxY = FMath::Min(FMath::Max(Corner.Y, OppositeCorner.Y), GridYSize - 1);
+
+	for (int32 x = MinX; x <= MaxX; x++)
+	{
+		for (int32 y = MinY; y <= MaxY; y++)
+		{
+			const int32 Bit = x * GridYSize + y;
+			OutMask[Bit >> 5] |= 1u << (Bit & 31);
+		}
+	}
+}
+
+void AAutobattlerGrid::BuildFloodFillMask(const FIntPair& Start, const TArray<uint32>& BoundaryMask, TArray<uint32>& OutMask) const
+{
+	OutMask.Init(0, FMath::DivideAndRoundUp(FMath::Max(GridXSize, 0) * FMath::Max(GridYSize, 0), 32));
+	if (!IsValidGridIndex(Start) || GetIsIndexInMask(BoundaryMask, Start)) return;
+
+	// The output mask doubles as the visited set, so each index is pushed at most once.
+	TArray<FIntPair> Stack;
+	Stack.Emplace(Start);
+	SetIndexInMask(OutMask, Start, true);
+
+	const FIntPair Steps[] = { FIntPair(1, 0), FIntPair(-1, 0), FIntPair(0, 1), FIntPair(0, -1) };
+	while (Stack.Num() > 0)
+	{
+		const FIntPair Current = Stack.Pop(false);
+		for (auto& Step : Steps)
+		{
+			const FIntPair Next(Current.X + Step.X, Current.Y + Step.Y);
+			if (!IsValidGridIndex(Next) || GetIsIndexInMask(BoundaryMask, Next)) continue;
+			if (SetIndexInMask(OutMask, Next, true)) Stack.Emplace(Next);
+		}
+	}
+}
+
 void AAutobattlerGrid::ToggleGridVisibility(bool ShouldBeVisible)
 {
 	SetActorHiddenInGame(!ShouldBeVisible);
@@ -160,18 +581,86 @@ void AAutobattlerGrid::ToggleGridVisibility(bool ShouldBeVisible)
 
 void AAutobattlerGrid::ShowOnlyIndicies(const TArray<FIntPair>& IndiciesToShow)
 {
-	for (auto& IndexInfo : GridIndexInfo)
+	SetIndexHighlight(IndiciesToShow, EGridHighlight::Shown);
+}
+
+void AAutobattlerGrid::SetIndexHighlight(const TArray<FIntPair>& GridIndices, EGridHighlight Highlight)
+{
+	const int32 Channel = GetHighlightChannel(Highlight);
+	if (Channel == INDEX_NONE) return;
+
+	for (int32 i = Channel; i < CellStates.Num(); i += 4) CellStates[i] = 0;
+	for (auto& GridIndex : GridIndices)
 	{
-		if (IndiciesToShow.ContainsByPredicate([IndexInfo](const FIntPair& Index){
-			return IndexInfo.GridLocation == Index;
-		})) IndexInfo.DecalComponent->SetHiddenInGame(false);
-		else IndexInfo.DecalComponent->SetHiddenInGame(true);
+		const int32 Bit = GridIndexToBit(GridIndex);
+		if (Bit != INDEX_NONE && Bit * 4 < CellStates.Num()) CellStates[Bit * 4 + Channel] = MAX_uint8;
 	}
+
+	UploadCellStates();
+}
+
+void AAutobattlerGrid::ClearHighlight(EGridHighlight Highlight)
+{
+	SetIndexHighlight(TArray<FIntPair>(), Highlight);
+}
+
+void AAutobattlerGrid::SetSingleIndexHighlight(const FIntPair& GridIndex, EGridHighlight Highlight, bool IsHighlighted)
+{
+	const int32 Channel = GetHighlightChannel(Highlight);
+	const int32 Bit = GridIndexToBit(GridIndex);
+	if (Channel == INDEX_NONE || Bit == INDEX_NONE || !CellStates.IsValidIndex(Bit * 4 + Channel)) return;
+
+	const uint8 State = IsHighlighted ? MAX_uint8 : 0;
+	if (CellStates[Bit * 4 + Channel] == State) return;
+
+	CellStates[Bit * 4 + Channel] = State;
+	UploadCellStates();
+}
+
+int32 AAutobattlerGrid::GetHighlightChannel(EGridHighlight Highlight)
+{
+	switch (Highlight)
+	{
+	case EGridHighlight::Shown:    return 2;
+	case EGridHighlight::Occupied: return 1;
+	case EGridHighlight::Hovered:  return 0;
+	case EGridHighlight::Range:    return 3;
+	default:                       return INDEX_NONE;
+	}
+}
+
+void AAutobattlerGrid::UploadCellStates()
+{
+	// Per-cell decals can only be shown or hidden, so they ignore every other highlight.
+	if (CellDecals.Num() > 0)
+	{
+		const int32 ShownChannel = GetHighlightChannel(EGridHighlight::Shown);
+		for (int32 i = 0; i < CellDecals.Num(); i++)
+		{
+			if (IsValid(CellDecals[i]) && CellStates.IsValidIndex(i * 4 + ShownChannel)) CellDecals[i]->SetHiddenInGame(CellStates[i * 4 + ShownChannel] == 0);
+		}
+		return;
+	}
+
+	if (!IsValid(CellStateTexture) || CellStates.Num() == 0) return;
+
+	const int32 Width = FMath::Max(GridYSize, 1);
+	const int32 Height = FMath::Max(GridXSize, 1);
+	if (CellStates.Num() != Width * Height * 4) return;
+
+	// The render thread reads the data later, so it is given its own copy which it frees once uploaded.
+	uint8* Data = static_cast<uint8*>(FMemory::Malloc(CellStates.Num()));
+	FMemory::Memcpy(Data, CellStates.GetData(), CellStates.Num());
+	FUpdateTextureRegion2D* Region = new FUpdateTextureRegion2D(0, 0, 0, 0, Width, Height);
+
+	CellStateTexture->UpdateTextureRegions(0, 1, Region, Width * 4, 4, Data, [](uint8* SrcData, const FUpdateTextureRegion2D* Regions)
+	{
+		FMemory::Free(SrcData);
+		delete Regions;
+	});
 }
 
 void AAutobattlerGrid::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
-
-	DOREPLIFETIME(AAutobattlerGrid, GridIndexInfo);
 }
@@ -0,0 +1,286 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+/* Class header. */
+#include "Game/Grid/AutobattlerGridPathfinder.h"
+
+/* Engine includes. */
+#include "Algo/Reverse.h"
+
+namespace AutobattlerGridPathfinder
+{
+	/* Neighbour offsets and the cost of stepping along them. */
+	const int32 NeighbourX[] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+	const int32 NeighbourY[] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+	const int32 NeighbourCost[] = { 10, 10, 10, 10, 14, 14, 14, 14 };
+
+	/**
+	 * Octile distance, the exact cost between two cells on an empty grid.
+	 */
+	int32 OctileDistance(const FIntPair& A, const FIntPair& B)
+	{
+		const int32 DeltaX = FMath::Abs(A.X - B.X);
+		const int32 DeltaY = FMath::Abs(A.Y - B.Y);
+		return 10 * FMath::Max(DeltaX, DeltaY) + 4 * FMath::Min(DeltaX, DeltaY);
+	}
+}
+
+FAutobattlerGridPathfinder::FAutobattlerGridPathfinder()
+{
+	SizeX = 0;
+	SizeY = 0;
+	CurrentSearchStamp = 0;
+}
+
+void FAutobattlerGridPathfinder::Reset(int32 NewSizeX, int32 NewSizeY)
+{
+	SizeX = FMath::Max(NewSizeX, 0);
+	SizeY = FMath::Max(NewSizeY, 0);
+
+	const int32 NumCells = SizeX * SizeY;
+	CellFlags.Init(0, NumCells);
+	CellOccupantCounts.Init(0, NumCells);
+	CellFirstOccupants.Init(INDEX_NONE, NumCells);
+	CellReservations.Init(INDEX_NONE, NumCells);
+	ReservationsByCharacter.Reset();
+
+	for (auto& FlowField : FlowFields)
+	{
+		FlowField.Costs.Reset();
+		FlowField.NextCells.Reset();
+		FlowField.IsDirty = true;
+	}
+
+	SearchCosts.SetNumUninitialized(NumCells);
+	SearchParents.SetNumUninitialized(NumCells);
+	SearchStamps.Init(0, NumCells);
+	CurrentSearchStamp = 0;
+}
+
+bool FAutobattlerGridPathfinder::UpdateOccupancy(const TArray<FOccupant>& Occupants)
+{
+	TArray<uint8> PreviousCellFlags = MoveTemp(CellFlags);
+	CellFlags.Init(0, SizeX * SizeY);
+	FMemory::Memzero(CellOccupantCounts.GetData(), CellOccupantCounts.Num() * sizeof(int32));
+
+	for (auto& Occupant : Occupants)
+	{
+		const int32 Index = ToIndex(Occupant.Cell);
+		if (Index == INDEX_NONE) continue;
+
+		CellFlags[Index] |= Occupant.WhoOwns == EEntity::AI ? ECellFlags::AISide : ECellFlags::PlayersSide;
+		if (CellOccupantCounts[Index]++ == 0) CellFirstOccupants[Index] = Occupant.CharacterID;
+	}
+
+	if (CellFlags == PreviousCellFlags) return false;
+
+	for (auto& FlowField : FlowFields) FlowField.IsDirty = true;
+	return true;
+}
+
+bool FAutobattlerGridPathfinder::GetNextStep(const FIntPair& From, EEntity WhoOwns, FIntPair& OutNextCell)
+{
+	const int32 Index = ToIndex(From);
+	if (Index == INDEX_NONE) return false;
+
+	const FFlowField& FlowField = GetFlowField(WhoOwns);
+	if (FlowField.NextCells[Index] == INDEX_NONE) return false;
+
+	OutNextCell = ToCell(FlowField.NextCells[Index]);
+	return true;
+}
+
+int32 FAutobattlerGridPathfinder::GetCostToNearestEnemy(const FIntPair& From, EEntity WhoOwns)
+{
+	const int32 Index = ToIndex(From);
+	if (Index == INDEX_NONE) return INDEX_NONE;
+
+	const int32 Cost = GetFlowField(WhoOwns).Costs[Index];
+	return Cost != MAX_int32 ? Cost : INDEX_NONE;
+}
+
+bool FAutobattlerGridPathfinder::FindPath(const FIntPair& From, const FIntPair& To, int32 CharacterID, TArray<FIntPair>& OutPath)
+{
+	using namespace AutobattlerGridPathfinder;
+
+	OutPath.Reset();
+	const int32 StartIndex = ToIndex(From);
+	const int32 GoalIndex = ToIndex(To);
+	if (StartIndex == INDEX_NONE || GoalIndex == INDEX_NONE) return false;
+	if (StartIndex == GoalIndex) return true;
+
+	// Stamps wrapped around, so stale scores could look current.
+	if (++CurrentSearchStamp == 0)
+	{
+		FMemory::Memzero(SearchStamps.GetData(), SearchStamps.Num() * sizeof(uint32));
+		CurrentSearchStamp = 1;
+	}
+
+	SearchStamps[StartIndex] = CurrentSearchStamp;
+	SearchCosts[StartIndex] = 0;
+	SearchParents[StartIndex] = INDEX_NONE;
+
+	OpenSet.Reset();
+	OpenSet.HeapPush(FOpenEntry{ OctileDistance(From, To), StartIndex });
+
+	while (OpenSet.Num() > 0)
+	{
+		FOpenEntry Current;
+		OpenSet.HeapPop(Current);
+
+		if (Current.Cell == GoalIndex)
+		{
+			for (int32 Index = GoalIndex; Index != StartIndex; Index = SearchParents[Index]) OutPath.Add(ToCell(Index));
+			Algo::Reverse(OutPath);
+			return true;
+		}
+
+		const FIntPair CurrentCell = ToCell(Current.Cell);
+		const int32 CurrentCost = SearchCosts[Current.Cell];
+
+		// Skip entries left behind after a cheaper path to the same cell was found.
+		if (Current.Priority > CurrentCost + OctileDistance(CurrentCell, To)) continue;
+
+		for (int32 i = 0; i < UE_ARRAY_COUNT(NeighbourCost); i++)
+		{
+			const FIntPair NeighbourCell(CurrentCell.X + NeighbourX[i], CurrentCell.Y + NeighbourY[i]);
+			const int32 NeighbourIndex = ToIndex(NeighbourCell);
+			if (NeighbourIndex == INDEX_NONE) continue;
+			if (NeighbourIndex != GoalIndex && !IsCellFree(NeighbourCell, CharacterID)) continue;
+
+			const int32 NewCost = CurrentCost + NeighbourCost[i];
+			if (SearchStamps[NeighbourIndex] == CurrentSearchStamp && SearchCosts[NeighbourIndex] <= NewCost) continue;
+
+			SearchStamps[NeighbourIndex] = CurrentSearchStamp;
+			SearchCosts[NeighbourIndex] = NewCost;
+			SearchParents[NeighbourIndex] = Current.Cell;
+			OpenSet.HeapPush(FOpenEntry{ NewCost + OctileDistance(NeighbourCell, To), NeighbourIndex });
+		}
+	}
+
+	return false;
+}
+
+bool FAutobattlerGridPathfinder::ReserveCell(const FIntPair& Cell, int32 CharacterID)
+{
+	const int32 Index = ToIndex(Cell);
+	if (Index == INDEX_NONE) return false;
+	if (CellReservations[Index] != INDEX_NONE && CellReservations[Index] != CharacterID) return false;
+
+	ReleaseReservation(CharacterID);
+	CellReservations[Index] = CharacterID;
+	ReservationsByCharacter.Add(CharacterID, Index);
+	return true;
+}
+
+void FAutobattlerGridPathfinder::ReleaseReservation(int32 CharacterID)
+{
+	int32 Index;
+	if (!ReservationsByCharacter.RemoveAndCopyValue(CharacterID, Index)) return;
+	if (CellReservations.IsValidIndex(Index) && CellReservations[Index] == CharacterID) CellReservations[Index] = INDEX_NONE;
+}
+
+bool FAutobattlerGridPathfinder::IsCellFree(const FIntPair& Cell, int32 CharacterID) const
+{
+	const int32 Index = ToIndex(Cell);
+	if (Index == INDEX_NONE) return false;
+	if (CellReservations[Index] != INDEX_NONE && CellReservations[Index] != CharacterID) return false;
+
+	const int32 NumOccupants = CellOccupantCounts[Index];
+	return NumOccupants == 0 || (NumOccupants == 1 && CellFirstOccupants[Index] == CharacterID);
+}
+
+bool FAutobattlerGridPathfinder::HasClearLine(const FIntPair& From, const FIntPair& To) const
+{
+	// Bresenham; diagonal steps are treated as passable, matching the 8-way movement used everywhere else.
+	const int32 DeltaX = FMath::Abs(To.X - From.X);
+	const int32 DeltaY = -FMath::Abs(To.Y - From.Y);
+	const int32 StepX = From.X < To.X ? 1 : -1;
+	const int32 StepY = From.Y < To.Y ? 1 : -1;
+	int32 Error = DeltaX + DeltaY;
+
+	FIntPair Cell = From;
+	while (true)
+	{
+		const int32 DoubledError = 2 * Error;
+		if (DoubledError >= DeltaY)
+		{
+			if (Cell.X == To.X) break;
+			Error += DeltaY;
+			Cell.X += StepX;
+		}
+		if (DoubledError <= DeltaX)
+		{
+			if (Cell.Y == To.Y) break;
+			Error += DeltaX;
+			Cell.Y += StepY;
+		}
+
+		if (Cell == To) break;
+
+		const int32 Index = ToIndex(Cell);
+		if (Index != INDEX_NONE && CellOccupantCounts[Index] > 0) return false;
+	}
+
+	return true;
+}
+
+int32 FAutobattlerGridPathfinder::GetOctileDistance(const FIntPair& A, const FIntPair& B)
+{
+	return AutobattlerGridPathfinder::OctileDistance(A, B);
+}
+
+const FAutobattlerGridPathfinder::FFlowField& FAutobattlerGridPathfinder::GetFlowField(EEntity WhoOwns)
+{
+	const int32 SideIndex = GetSideIndex(WhoOwns);
+	if (FlowFields[SideIndex].IsDirty) BuildFlowField(SideIndex);
+	return FlowFields[SideIndex];
+}
+
+void FAutobattlerGridPathfinder::BuildFlowField(int32 SideIndex)
+{
+	using namespace AutobattlerGridPathfinder;
+
+	FFlowField& FlowField = FlowFields[SideIndex];
+	FlowField.IsDirty = false;
+
+	const int32 NumCells = SizeX * SizeY;
+	FlowField.Costs.Init(MAX_int32, NumCells);
+	FlowField.NextCells.Init(INDEX_NONE, NumCells);
+
+	const uint8 AllyFlag = SideIndex == 1 ? ECellFlags::AISide : ECellFlags::PlayersSide;
+	const uint8 EnemyFlag = SideIndex == 1 ? ECellFlags::PlayersSide : ECellFlags::AISide;
+
+	OpenSet.Reset();
+	for (int32 Index = 0; Index < NumCells; Index++)
+	{
+		if ((CellFlags[Index] & EnemyFlag) == 0) continue;
+
+		FlowField.Costs[Index] = 0;
+		OpenSet.HeapPush(FOpenEntry{ 0, Index });
+	}
+
+	// Search outwards from the enemies. A unit moves against the search direction, so stepping from Neighbour onto Current is what is paid for.
+	while (OpenSet.Num() > 0)
+	{
+		FOpenEntry Current;
+		OpenSet.HeapPop(Current);
+		if (Current.Priority > FlowField.Costs[Current.Cell]) continue;
+
+		const FIntPair CurrentCell = ToCell(Current.Cell);
+		const int32 EnterCost = (CellFlags[Current.Cell] & AllyFlag) != 0 && (CellFlags[Current.Cell] & EnemyFlag) == 0 ? AllyOccupiedCost : 0;
+
+		for (int32 i = 0; i < UE_ARRAY_COUNT(NeighbourCost); i++)
+		{
+			const int32 NeighbourIndex = ToIndex(FIntPair(CurrentCell.X + NeighbourX[i], CurrentCell.Y + NeighbourY[i]));
+			if (NeighbourIndex == INDEX_NONE) continue;
+
+			const int32 NewCost = Current.Priority + NeighbourCost[i] + EnterCost;
+			if (NewCost >= FlowField.Costs[NeighbourIndex]) continue;
+
+			FlowField.Costs[NeighbourIndex] = NewCost;
+			FlowField.NextCells[NeighbourIndex] = Current.Cell;
+			OpenSet.HeapPush(FOpenEntry{ NewCost, NeighbourIndex });
+		}
+	}
+}
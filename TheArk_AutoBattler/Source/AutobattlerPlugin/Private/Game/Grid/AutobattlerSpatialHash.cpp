@@ -0,0 +1,178 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+/* Class header. */
+#include "Game/Grid/AutobattlerSpatialHash.h"
+
+/* Autobattler includes. */
+#include "Game/Units/AutobattlerCharacter.h"
+
+FAutobattlerSpatialHash::FAutobattlerSpatialHash()
+{
+	MinCell = FIntPoint::ZeroValue;
+	MaxCell = FIntPoint::ZeroValue;
+	CellSize = 400.0f;
+	Origin = FVector::ZeroVector;
+}
+
+void FAutobattlerSpatialHash::Reset(float NewCellSize, const FVector& NewOrigin)
+{
+	CellSize = FMath::Max(NewCellSize, 1.0f);
+	Origin = NewOrigin;
+	Entries.Reset();
+	CellRanges.Reset();
+}
+
+void FAutobattlerSpatialHash::Rebuild(const TArray<AAutobattlerCharacter*>& Characters)
+{
+	Entries.Reset(Characters.Num());
+	CellRanges.Reset();
+
+	for (auto Character : Characters)
+	{
+		if (!IsValid(Character)) continue;
+
+		const FVector Location = Character->GetActorLocation();
+		Entries.Add({ Character, Location, LocationToCell(Location) });
+	}
+
+	if (Entries.Num() == 0) return;
+
+	Entries.Sort([](const FEntry& A, const FEntry& B) {
+		return A.Cell.X != B.Cell.X ? A.Cell.X < B.Cell.X : A.Cell.Y < B.Cell.Y;
+	});
+
+	MinCell = Entries[0].Cell;
+	MaxCell = Entries[0].Cell;
+	FIntPoint* CurrentRange = nullptr;
+	for (int32 i = 0; i < Entries.Num(); i++)
+	{
+		const FIntPoint& Cell = Entries[i].Cell;
+		if (i == 0 || Cell != Entries[i - 1].Cell) CurrentRange = &CellRanges.Add(Cell, FIntPoint(i, 0));
+		CurrentRange->Y++;
+
+		MinCell = FIntPoint(FMath::Min(MinCell.X, Cell.X), FMath::Min(MinCell.Y, Cell.Y));
+		MaxCell = FIntPoint(FMath::Max(MaxCell.X, Cell.X), FMath::Max(MaxCell.Y, Cell.Y));
+	}
+}
+
+void FAutobattlerSpatialHash::QueryRadius(const FVector& QueryOrigin, float Radius, FCharacterPredicate Predicate, TArray<AAutobattlerCharacter*>& OutCharacters) const
+{
+	OutCharacters.Reset();
+	if (Entries.Num() == 0 || Radius < 0.0f) return;
+
+	const double RadiusSquared = FMath::Square((double)Radius);
+	ForEachEntryInCells(
+		LocationToCell(QueryOrigin - FVector(Radius, Radius, 0.0f)),
+		LocationToCell(QueryOrigin + FVector(Radius, Radius, 0.0f)),
+		[&](const FEntry& Entry) {
+			if (FVector::DistSquared(QueryOrigin, Entry.Location) <= RadiusSquared && Predicate(Entry.Character)) OutCharacters.Add(Entry.Character);
+		});
+}
+
+void FAutobattlerSpatialHash::QueryBox(const FVector& QueryOrigin, const FVector& Extent, FCharacterPredicate Predicate, TArray<AAutobattlerCharacter*>& OutCharacters) const
+{
+	OutCharacters.Reset();
+	if (Entries.Num() == 0) return;
+
+	const FBox Box(QueryOrigin - Extent.GetAbs(), QueryOrigin + Extent.GetAbs());
+	ForEachEntryInCells(
+		LocationToCell(Box.Min),
+		LocationToCell(Box.Max),
+		[&](const FEntry& Entry) {
+			if (Box.IsInsideOrOn(Entry.Location) && Predicate(Entry.Character)) OutCharacters.Add(Entry.Character);
+		});
+}
+
+AAutobattlerCharacter* FAutobattlerSpatialHash::QueryNearest(const FVector& QueryOrigin, FCharacterPredicate Predicate, float MaxRange) const
+{
+	TArray<AAutobattlerCharacter*> Nearest;
+	QueryKNearest(QueryOrigin, 1, Predicate, Nearest, MaxRange);
+	return Nearest.Num() > 0 ? Nearest[0] : nullptr;
+}
+
+void FAutobattlerSpatialHash::QueryKNearest(const FVector& QueryOrigin, int32 Count, FCharacterPredicate Predicate, TArray<AAutobattlerCharacter*>& OutCharacters, float MaxRange) const
+{
+	OutCharacters.Reset();
+	if (Entries.Num() == 0 || Count < 1) return;
+
+	const FIntPoint Center = LocationToCell(QueryOrigin);
+	const double MaxRangeSquared = MaxRange < 0.0f ? TNumericLimits<double>::Max() : FMath::Square((double)MaxRange);
+
+	int32 MaxRing = GetMaxRing(Center);
+	if (MaxRange >= 0.0f) MaxRing = FMath::Min(MaxRing, FMath::CeilToInt(MaxRange / CellSize) + 1);
+
+	// Best candidates so far, kept sorted nearest first. Count is expected to be small, so insertion is cheap.
+	TArray<TPair<double, AAutobattlerCharacter*>, TInlineAllocator<8>> Best;
+
+	for (int32 Ring = 0; Ring <= MaxRing; Ring++)
+	{
+		// Anything in this ring or beyond is at least (Ring - 1) cells away on one axis.
+		if (Best.Num() == Count && FMath::Square((double)(Ring - 1) * CellSize) > Best.Last().Key) break;
+
+		ForEachEntryInRing(Center, Ring, [&](const FEntry& Entry) {
+			const double DistanceSquared = FVector::DistSquared(QueryOrigin, Entry.Location);
+			if (DistanceSquared > MaxRangeSquared) return;
+			if (Best.Num() == Count && DistanceSquared >= Best.Last().Key) return;
+			if (!Predicate(Entry.Character)) return;
+
+			int32 InsertIndex = Best.Num();
+			while (InsertIndex > 0 && Best[InsertIndex - 1].Key > DistanceSquared) InsertIndex--;
+			Best.Insert(TPair<double, AAutobattlerCharacter*>(DistanceSquared, Entry.Character), InsertIndex);
+			if (Best.Num() > Count) Best.RemoveAt(Best.Num() - 1);
+		});
+	}
+
+	OutCharacters.Reserve(Best.Num());
+	for (auto& Candidate : Best) OutCharacters.Add(Candidate.Value);
+}
+
+FIntPoint FAutobattlerSpatialHash::LocationToCell(const FVector& Location) const
+{
+	return FIntPoint(
+		FMath::FloorToInt((Location.X - Origin.X) / CellSize),
+		FMath::FloorToInt((Location.Y - Origin.Y) / CellSize)
+	);
+}
+
+void FAutobattlerSpatialHash::ForEachEntryInCells(const FIntPoint& CellMin, const FIntPoint& CellMax, TFunctionRef<void(const FEntry&)> Visitor) const
+{
+	const int32 MinX = FMath::Max(CellMin.X, MinCell.X);
+	const int32 MinY = FMath::Max(CellMin.Y, MinCell.Y);
+	const int32 MaxX = FMath::Min(CellMax.X, MaxCell.X);
+	const int32 MaxY = FMath::Min(CellMax.Y, MaxCell.Y);
+
+	for (int32 x = MinX; x <= MaxX; x++)
+	{
+		for (int32 y = MinY; y <= MaxY; y++)
+		{
+			if (const FIntPoint* Range = CellRanges.Find(FIntPoint(x, y)))
+			{
+				for (int32 i = Range->X; i < Range->X + Range->Y; i++) Visitor(Entries[i]);
+			}
+		}
+	}
+}
+
+void FAutobattlerSpatialHash::ForEachEntryInRing(const FIntPoint& Center, int32 Ring, TFunctionRef<void(const FEntry&)> Visitor) const
+{
+	if (Ring == 0)
+	{
+		ForEachEntryInCells(Center, Center, Visitor);
+		return;
+	}
+
+	// Top and bottom rows, then the left and right columns without their corners.
+	ForEachEntryInCells(FIntPoint(Center.X - Ring, Center.Y - Ring), FIntPoint(Center.X + Ring, Center.Y - Ring), Visitor);
+	ForEachEntryInCells(FIntPoint(Center.X - Ring, Center.Y + Ring), FIntPoint(Center.X + Ring, Center.Y + Ring), Visitor);
+	ForEachEntryInCells(FIntPoint(Center.X - Ring, Center.Y - Ring + 1), FIntPoint(Center.X - Ring, Center.Y + Ring - 1), Visitor);
+	ForEachEntryInCells(FIntPoint(Center.X + Ring, Center.Y - Ring + 1), FIntPoint(Center.X + Ring, Center.Y + Ring - 1), Visitor);
+}
+
+int32 FAutobattlerSpatialHash::GetMaxRing(const FIntPoint& Center) const
+{
+	return FMath::Max(
+		FMath::Max(FMath::Abs(Center.X - MinCell.X), FMath::Abs(Center.X - MaxCell.X)),
+		FMath::Max(FMath::Abs(Center.Y - MinCell.Y), FMath::Abs(Center.Y - MaxCell.Y))
+	);
+}
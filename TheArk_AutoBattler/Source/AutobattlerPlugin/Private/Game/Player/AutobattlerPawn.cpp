@@ -6,9 +6,11 @@
 
 /* Autobattler includes. */
 #include "Core/AutobattlerControllerComponent.h"
+#include "Core/AutobattlerManager.h"
 #include "Core/AutobattlerSettings.h"
 #include "DataAssets/AutobattlerConfiguration.h"
 #include "Game/Components/CharacterPanelComponent.h"
+#include "Game/Grid/AutobattlerGrid.h"
 #include "Game/Units/AutobattlerCharacter.h"
 #include "Game/Units/AutobattlerPreviewCharacter.h"
 #include "Interfaces/AutobattlerMouseInterface.h"
@@ -27,6 +29,7 @@ AAutobattlerPawn::AAutobattlerPawn()
 	PrimaryActorTick.bCanEverTick = true;
 	
 	MouseCollisionChannel = ECollisionChannel::ECC_Visibility;
+	HoveredGridIndex = FIntPair(-1, -1);
 }
 
 void AAutobattlerPawn::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -95,6 +98,8 @@ void AAutobattlerPawn::HandleMouseOverCharacter(bool RequestedByServer)
 			HitResult
 		);
 
+		UpdateHoveredGridIndex(Hit, HitResult.Location);
+
 		if (!Hit)
 		{
 			LastMousedOverActor = nullptr;
@@ -122,6 +127,23 @@ void AAutobattlerPawn::HandleMouseOverCharacter(bool RequestedByServer)
 	}
 }
 
+void AAutobattlerPawn::UpdateHoveredGridIndex(bool Hit, const FVector& Location)
+{
+	if (!IsLocallyControlled()) return;
+
+	AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this);
+	AAutobattlerGrid* Grid = IsValid(Manager) ? Manager->GetAutobattlerGrid() : nullptr;
+	if (!IsValid(Grid)) return;
+
+	FIntPair GridIndex(-1, -1);
+	if (Hit) Grid->LocationToGridIndex(Location, GridIndex);
+	if (GridIndex == HoveredGridIndex) return;
+
+	Grid->SetSingleIndexHighlight(HoveredGridIndex, EGridHighlight::Hovered, false);
+	Grid->SetSingleIndexHighlight(GridIndex, EGridHighlight::Hovered, true);
+	HoveredGridIndex = GridIndex;
+}
+
 void AAutobattlerPawn::ExecutePrimaryAction()
 {
 	if (UAutobattlerControllerComponent* ControllerComponent = UAutobattlerControllerComponent::GetControllerComponentByID(this, WhoOwns))
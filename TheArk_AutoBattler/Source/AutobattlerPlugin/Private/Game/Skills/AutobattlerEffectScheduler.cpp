@@ -0,0 +1,282 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+/* Class header. */
+#include "Game/Skills/AutobattlerEffectScheduler.h"
+
+/* Autobattler includes. */
+#include "DataAssets/AutobattlerSkill.h"
+#include "Game/Skills/SkillImplementation.h"
+#include "Game/Units/AutobattlerCharacter.h"
+
+FAutobattlerEffectHandle FAutobattlerEffectScheduler::AddStatModifier(AAutobattlerCharacter* Target, EAutobattlerStatType StatToModify, float ModifierScale, float ExpiryDuration)
+{
+	return AddEffect(EEffectType::StatModifier, Target, ExpiryDuration, 0.0f, ModifierScale, 0.0f, (uint8)StatToModify, 1);
+}
+
+FAutobattlerEffectHandle FAutobattlerEffectScheduler::AddResistanceOverride(AAutobattlerCharacter* Target, EResistanceType PreviousResistanceType, float ExpiryDuration)
+{
+	return AddEffect(EEffectType::ResistanceOverride, Target, ExpiryDuration, 0.0f, 0.0f, 0.0f, (uint8)PreviousResistanceType, 1);
+}
+
+FAutobattlerEffectHandle FAutobattlerEffectScheduler::AddDamageTypeOverride(AAutobattlerCharacter* Target, EDamageType PreviousDamageType, float ExpiryDuration)
+{
+	return AddEffect(EEffectType::DamageTypeOverride, Target, ExpiryDuration, 0.0f, 0.0f, 0.0f, (uint8)PreviousDamageType, 1);
+}
+
+FAutobattlerEffectHandle FAutobattlerEffectScheduler::AddPoison(AAutobattlerCharacter* Target, float PoisonStrength, float TickRate, float StrengthReductionRate)
+{
+	const float ClampedPoisonStrength = FMath::Max(0.0f, PoisonStrength);
+	if (const FAutobattlerEffectHandle* ExistingPoison = PoisonByTarget.Find(Target))
+	{
+		const int32 DenseIndex = ResolveHandle(*ExistingPoison);
+		if (DenseIndex != INDEX_NONE)
+		{
+			Magnitudes[DenseIndex] += ClampedPoisonStrength;
+			return *ExistingPoison;
+		}
+	}
+
+	const FAutobattlerEffectHandle Handle = AddEffect(EEffectType::Poison, Target, 0.0f, FMath::Max(TickRate, 0.01f), ClampedPoisonStrength, StrengthReductionRate, 0, 1);
+	if (Handle.IsValid()) PoisonByTarget.Emplace(Target, Handle);
+	return Handle;
+}
+
+FAutobattlerEffectHandle FAutobattlerEffectScheduler::AddRepeatingSkill(AAutobattlerCharacter* Target, const UAutobattlerSkill* SkillAsset, AAutobattlerCharacter* SkillOwner, const FAbilityTargetingProperties& TargetingProperties, float Interval, int32 NumRepetitions)
+{
+	if (!::IsValid(SkillAsset)) return FAutobattlerEffectHandle();
+
+	const float ClampedInterval = FMath::Max(Interval, 0.1f);
+	const FAutobattlerEffectHandle Handle = AddEffect(EEffectType::RepeatingSkill, Target, ClampedInterval, ClampedInterval, 0.0f, 0.0f, 0, FMath::Max(NumRepetitions, 1));
+	if (Handle.IsValid())
+	{
+		FRepeatingSkillPayload& Payload = RepeatingSkillPayloads.Last();
+		Payload.SkillAsset = SkillAsset;
+		Payload.SkillOwner = SkillOwner;
+		Payload.TargetingProperties = TargetingProperties;
+	}
+
+	return Handle;
+}
+
+bool FAutobattlerEffectScheduler::Cancel(const FAutobattlerEffectHandle& Handle, bool ShouldRevert)
+{
+	const int32 DenseIndex = ResolveHandle(Handle);
+	if (DenseIndex == INDEX_NONE) return false;
+
+	if (ShouldRevert) EndEffect(DenseIndex);
+	else RemoveEffect(DenseIndex);
+	return true;
+}
+
+int32 FAutobattlerEffectScheduler::CancelAllOnTarget(const AAutobattlerCharacter* Target, bool ShouldRevert)
+{
+	// Gather first, as reverting runs game code which may add or cancel effects.
+	TArray<FAutobattlerEffectHandle> ToCancel;
+	for (int32 i = 0; i < Targets.Num(); i++)
+	{
+		if (Targets[i].Get() == Target) ToCancel.Add(FAutobattlerEffectHandle{ DenseToSlot[i], SlotGenerations[DenseToSlot[i]] });
+	}
+
+	int32 NumCancelled = 0;
+	for (auto& Handle : ToCancel)
+	{
+		if (Cancel(Handle, ShouldRevert)) NumCancelled++;
+	}
+
+	return NumCancelled;
+}
+
+void FAutobattlerEffectScheduler::Reset()
+{
+	for (int32 Slot = 0; Slot < SlotToDense.Num(); Slot++)
+	{
+		if (SlotToDense[Slot] == INDEX_NONE) continue;
+		SlotToDense[Slot] = INDEX_NONE;
+		SlotGenerations[Slot]++;
+		FreeSlots.Add(Slot);
+	}
+
+	NextFireTimes.Reset();
+	Types.Reset();
+	Targets.Reset();
+	Intervals.Reset();
+	Magnitudes.Reset();
+	MagnitudeDecays.Reset();
+	Parameters.Reset();
+	RemainingRepetitions.Reset();
+	RepeatingSkillPayloads.Reset();
+	DenseToSlot.Reset();
+	PoisonByTarget.Reset();
+	CurrentTime = 0.0f;
+}
+
+void FAutobattlerEffectScheduler::Tick(float DeltaTime)
+{
+	CurrentTime += DeltaTime;
+
+	// Gather first, as firing runs game code which may add or cancel effects (and so move them around in the dense arrays).
+	DueEffects.Reset();
+	for (int32 i = 0; i < NextFireTimes.Num(); i++)
+	{
+		if (NextFireTimes[i] <= CurrentTime) DueEffects.Add(FAutobattlerEffectHandle{ DenseToSlot[i], SlotGenerations[DenseToSlot[i]] });
+	}
+
+	for (int32 i = 0; i < DueEffects.Num(); i++)
+	{
+		// Like a looping timer, an effect fires once for each interval which has elapsed.
+		int32 DenseIndex = ResolveHandle(DueEffects[i]);
+		while (DenseIndex != INDEX_NONE && NextFireTimes[DenseIndex] <= CurrentTime)
+		{
+			FireEffect(DenseIndex);
+			DenseIndex = ResolveHandle(DueEffects[i]);
+		}
+	}
+}
+
+FAutobattlerEffectHandle FAutobattlerEffectScheduler::AddEffect(EEffectType Type, AAutobattlerCharacter* Target, float Delay, float Interval, float Magnitude, float MagnitudeDecay, uint8 Parameter, int32 Repetitions)
+{
+	if (!::IsValid(Target)) return FAutobattlerEffectHandle();
+
+	int32 Slot;
+	if (FreeSlots.Num() > 0)
+	{
+		Slot = FreeSlots.Last();
+		FreeSlots.RemoveAt(FreeSlots.Num() - 1);
+	}
+	else
+	{
+		Slot = SlotToDense.Add(INDEX_NONE);
+		SlotGenerations.Add(0);
+	}
+
+	SlotToDense[Slot] = NextFireTimes.Add(CurrentTime + FMath::Max(Delay, 0.0f));
+	Types.Add(Type);
+	Targets.Add(Target);
+	Intervals.Add(Interval);
+	Magnitudes.Add(Magnitude);
+	MagnitudeDecays.Add(MagnitudeDecay);
+	Parameters.Add(Parameter);
+	RemainingRepetitions.Add(Repetitions);
+	RepeatingSkillPayloads.AddDefaulted();
+	DenseToSlot.Add(Slot);
+
+	return FAutobattlerEffectHandle{ Slot, SlotGenerations[Slot] };
+}
+
+int32 FAutobattlerEffectScheduler::ResolveHandle(const FAutobattlerEffectHandle& Handle) const
+{
+	if (!SlotToDense.IsValidIndex(Handle.Slot) || SlotGenerations[Handle.Slot] != Handle.Generation) return INDEX_NONE;
+	return SlotToDense[Handle.Slot];
+}
+
+void FAutobattlerEffectScheduler::RemoveEffect(int32 DenseIndex)
+{
+	if (Types[DenseIndex] == EEffectType::Poison) PoisonByTarget.Remove(Targets[DenseIndex]);
+
+	const int32 Slot = DenseToSlot[DenseIndex];
+	SlotToDense[Slot] = INDEX_NONE;
+	SlotGenerations[Slot]++;
+	FreeSlots.Add(Slot);
+
+	const int32 LastIndex = NextFireTimes.Num() - 1;
+	if (DenseIndex != LastIndex) SlotToDense[DenseToSlot[LastIndex]] = DenseIndex;
+
+	NextFireTimes.RemoveAtSwap(DenseIndex);
+	Types.RemoveAtSwap(DenseIndex);
+	Targets.RemoveAtSwap(DenseIndex);
+	Intervals.RemoveAtSwap(DenseIndex);
+	Magnitudes.RemoveAtSwap(DenseIndex);
+	MagnitudeDecays.RemoveAtSwap(DenseIndex);
+	Parameters.RemoveAtSwap(DenseIndex);
+	RemainingRepetitions.RemoveAtSwap(DenseIndex);
+	RepeatingSkillPayloads.RemoveAtSwap(DenseIndex);
+	DenseToSlot.RemoveAtSwap(DenseIndex);
+}
+
+void FAutobattlerEffectScheduler::EndEffect(int32 DenseIndex)
+{
+	const EEffectType Type = Types[DenseIndex];
+	AAutobattlerCharacter* Target = Targets[DenseIndex].Get();
+	const float Magnitude = Magnitudes[DenseIndex];
+	const uint8 Parameter = Parameters[DenseIndex];
+	RemoveEffect(DenseIndex);
+
+	if (!::IsValid(Target)) return;
+
+	switch (Type)
+	{
+		case EEffectType::StatModifier:
+			Target->ModifyStatisticInternal((EAutobattlerStatType)Parameter, Magnitude * -1.0f);
+			break;
+
+		case EEffectType::ResistanceOverride:
+			Target->CharacterResistanceType = (EResistanceType)Parameter;
+			Target->UpdateResistanceUI(true);
+			break;
+
+		case EEffectType::DamageTypeOverride:
+			Target->CharacterDamageType = (EDamageType)Parameter;
+			Target->UpdateDamageTypeUI(true);
+			break;
+
+		default:
+			break;
+	}
+}
+
+void FAutobattlerEffectScheduler::FireEffect(int32 DenseIndex)
+{
+	AAutobattlerCharacter* Target = Targets[DenseIndex].Get();
+	if (!::IsValid(Target))
+	{
+		RemoveEffect(DenseIndex);
+		return;
+	}
+
+	switch (Types[DenseIndex])
+	{
+		case EEffectType::Poison:
+		{
+			const float PoisonStrength = Magnitudes[DenseIndex];
+			Magnitudes[DenseIndex] -= MagnitudeDecays[DenseIndex];
+			NextFireTimes[DenseIndex] += Intervals[DenseIndex];
+			if (Magnitudes[DenseIndex] <= 0.0f) RemoveEffect(DenseIndex);
+
+			Target->SetCurrentHealth(Target->GetCurrentHealth() - PoisonStrength);
+			break;
+		}
+
+		case EEffectType::RepeatingSkill:
+		{
+			const FRepeatingSkillPayload Payload = RepeatingSkillPayloads[DenseIndex];
+			const UAutobattlerSkill* SkillAsset = Payload.SkillAsset.Get();
+			AAutobattlerCharacter* SkillOwner = Payload.SkillOwner.Get();
+			if (!::IsValid(SkillAsset) || !::IsValid(SkillOwner))
+			{
+				RemoveEffect(DenseIndex);
+				break;
+			}
+
+			NextFireTimes[DenseIndex] += Intervals[DenseIndex];
+			if (--RemainingRepetitions[DenseIndex] <= 0) RemoveEffect(DenseIndex);
+
+			for (auto Effect : SkillAsset->SkillEffects)
+			{
+				if (!::IsValid(Effect)) continue;
+
+				Effect->ExecuteSkill(
+					SkillOwner,
+					Payload.TargetingProperties.TargetingMode,
+					Target,
+					Payload.TargetingProperties.TargetLocation
+				);
+			}
+			break;
+		}
+
+		default:
+			EndEffect(DenseIndex);
+			break;
+	}
+}
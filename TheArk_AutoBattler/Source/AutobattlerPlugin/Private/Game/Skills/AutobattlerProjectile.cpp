@@ -5,6 +5,7 @@
 #include "Game/Skills/AutobattlerProjectile.h"
 
 /* Autobattler includes. */
+#include "Core/AutobattlerManager.h"
 #include "DataAssets/AutobattlerConfiguration.h"
 #include "DataAssets/AutobattlerSkill.h"
 #include "DataAssets/DefaultAttack.h"
@@ -32,96 +33,145 @@ AAutobattlerProjectile::AAutobattlerProjectile()
 
  	bReplicates = true;
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	CurrentProjectileHomingTarget = nullptr;
+	CurrentProjectileTargetLocation = FVector::ZeroVector;
+	CurrentProjectileSpeed = 0.0f;
 }
 
 void AAutobattlerProjectile::InitialiseProjectile(const UAutobattlerSkill* SkillImplementation, AAutobattlerCharacter* SkillOwner, const FAbilityTargetingProperties& TargetingProperties)
 {
-	if (TargetingProperties.TargetingMode != ESkillTargetingMode::Actor)
+	if (TargetingProperties.TargetingMode == ESkillTargetingMode::None)
 	{
-		UAutobattlerFunctionLibrary::PrintWarningToLog(FString::Printf(TEXT("%s : [InitialiseProjectile] Non-actor targeting modes are not supported for projectiles"), *GetName()));
+		UAutobattlerFunctionLibrary::PrintWarningToLog(FString::Printf(TEXT("%s : [InitialiseProjectile] Projectiles need a target character or location"), *GetName()));
+		ReleaseToPool();
 		return;
 	}
 
-	if (!IsValid(TargetingProperties.TargetCharacter))
+	if (TargetingProperties.TargetingMode == ESkillTargetingMode::Actor && !IsValid(TargetingProperties.TargetCharacter))
 	{
 		UAutobattlerFunctionLibrary::PrintErrorToLog(FString::Printf(TEXT("%s : [InitialiseProjectile] Passed invalid target character!"), *GetName()));
+		ReleaseToPool();
+		return;
+	}
+
+	// A projectile which does not move never arrives, and would keep the projectile system ticking forever.
+	if (SkillImplementation == nullptr || SkillImplementation->ProjectileSpeed <= 0.0f)
+	{
+		UAutobattlerFunctionLibrary::PrintErrorToLog(FString::Printf(TEXT("%s : [InitialiseProjectile] Projectile skill %s has no positive speed!"), *GetName(), *GetNameSafe(SkillImplementation)));
+		ReleaseToPool();
 		return;
 	}
 
-	TargetingProperties.TargetCharacter->ActionChanged.AddDynamic(this, &AAutobattlerProjectile::OnTargetCharacterStateChange);
+	AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this);
+	if (!IsValid(Manager))
+	{
+		UAutobattlerFunctionLibrary::PrintErrorToLog(FString::Printf(TEXT("%s : [InitialiseProjectile] No manager to move the projectile"), *GetName()));
+		ReleaseToPool();
+		return;
+	}
+
+	USceneComponent* HomingTarget = nullptr;
+	if (TargetingProperties.TargetingMode == ESkillTargetingMode::Actor)
+	{
+		TargetingProperties.TargetCharacter->ActionChanged.AddDynamic(this, &AAutobattlerProjectile::OnTargetCharacterStateChange);
+		HomingTarget = TargetingProperties.TargetCharacter->GetRootComponent();
+	}
 
 	const UAutobattlerConfiguration* Configuration = UAutobattlerConfiguration::GetConfigurationAsset(this);
-	MinDistanceToTarget = Configuration != nullptr ? Configuration->ProjectileMinDistanceToHit : 32.0f;
+	const float MinDistanceToTarget = Configuration != nullptr ? Configuration->ProjectileMinDistanceToHit : 32.0f;
 
-	UpdateVisuals(SkillImplementation->SkillMesh, SkillImplementation->SkillParticleEffect);
 	SkillOwnerInternal = SkillOwner;
 	SkillImplementationInternal = SkillImplementation;
 	ProjectileTargetingProperties = TargetingProperties;
-	UpdateProjectileTarget(TargetingProperties.TargetCharacter->GetRootComponent());
-	ShouldCheckDestination = true;
+	UpdateProjectileFlight(SkillImplementation->SkillMesh, SkillImplementation->SkillParticleEffect, HomingTarget, GetActorLocation(), TargetingProperties.TargetLocation, SkillImplementation->ProjectileSpeed);
+
+	Manager->GetProjectileSystem().Add(this, GetActorLocation(), HomingTarget, TargetingProperties.TargetLocation, SkillImplementation->ProjectileSpeed, MinDistanceToTarget);
+	Manager->GetBattleStats().RecordProjectile(Manager->GetProjectileSystem().Num());
+	Manager->SetActorTickEnabled(true);
 }
 
 void AAutobattlerProjectile::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
-	if (HasAuthority() && ShouldCheckDestination)
-	{
-		if (ProjectileTargetingProperties.TargetingMode == ESkillTargetingMode::Actor && IsValid(ProjectileTargetingProperties.TargetCharacter))
-		{
-			float CurrentDistance = UAutobattlerFunctionLibrary::CartesianDistance(GetActorLocation(), ProjectileTargetingProperties.TargetCharacter->GetActorLocation());
-			if (CurrentDistance <= MinDistanceToTarget)
-			{
-				OnArriveAtDestination();
-				ShouldCheckDestination = false;
-			}
-		}
-		else
-		{
-			ShouldCheckDestination = false;
-			Destroy();
-		}
-	}
 
-	if (IsValid(CurrentProjectileHomingTarget))
-	{
-		SetActorLocation(FMath::VInterpConstantTo(GetActorLocation(), CurrentProjectileHomingTarget->GetComponentLocation(), DeltaTime, 500.0f)); // TODO: 2.0f should be configurable.
-	}
+	const FVector TargetLocation = IsValid(CurrentProjectileHomingTarget) ? CurrentProjectileHomingTarget->GetComponentLocation() : CurrentProjectileTargetLocation;
+	SetActorLocation(FMath::VInterpConstantTo(GetActorLocation(), TargetLocation, DeltaTime, CurrentProjectileSpeed));
 }
 
-void AAutobattlerProjectile::UpdateVisuals_Implementation(UStaticMesh* NewMesh, UParticleSystem* NewParticleSystem)
+void AAutobattlerProjectile::UpdateProjectileFlight_Implementation(UStaticMesh* NewMesh, UParticleSystem* NewParticleSystem, USceneComponent* ProjectileHomingTarget, const FVector_NetQuantize& StartLocation, const FVector_NetQuantize& TargetLocation, float Speed)
 {
 	ProjectileMesh->SetStaticMesh(NewMesh);
-	ProjectileParticle->SetTemplate(NewParticleSystem);	
-}
+	ProjectileParticle->SetTemplate(NewParticleSystem);
 
-void AAutobattlerProjectile::UpdateProjectileTarget_Implementation(USceneComponent* ProjectileHomingTarget)
-{
+	SetActorLocation(StartLocation);
 	CurrentProjectileHomingTarget = ProjectileHomingTarget;
+	CurrentProjectileTargetLocation = TargetLocation;
+	CurrentProjectileSpeed = Speed;
+
+	// The server's projectile system moves the projectile there, so only clients tick it.
+	SetActorTickEnabled(!HasAuthority() && Speed > 0.0f);
 }
 
 void AAutobattlerProjectile::OnArriveAtDestination()
 {
-	FActorSpawnParameters ActorSpawnParams;
-	ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-
 	if (SkillImplementationInternal != nullptr)
 	{
-		AExecuteSkill* ExecuteSkill = GetWorld()->SpawnActor<AExecuteSkill>(
-			SkillImplementationInternal->ExecuteSkillClass,
-			GetActorTransform(),
-			ActorSpawnParams
-		);
-
-		ExecuteSkill->InitialiseAsInstant(SkillImplementationInternal, SkillOwnerInternal, ProjectileTargetingProperties);
+		AExecuteSkill::ExecuteInstant(this, SkillImplementationInternal, SkillOwnerInternal, ProjectileTargetingProperties, GetActorTransform());
 	}
 	
-	Destroy();
+	ReleaseToPool();
 }
 
 void AAutobattlerProjectile::OnTargetCharacterStateChange(EActionType NewAction, AAutobattlerCharacter* UpdatedCharacter)
 {
 	if (NewAction == EActionType::Dead)
 	{
-		Destroy();
+		ReleaseToPool();
 	}
 }
+
+AAutobattlerProjectile* AAutobattlerProjectile::AcquireFromPool(const UObject* WorldContextObject, const FTransform& SpawnTransform)
+{
+	if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(WorldContextObject))
+	{
+		return Manager->GetSkillActorPool().AcquireProjectile(Manager->GetWorld(), SpawnTransform);
+	}
+
+	UWorld* World = GEngine != nullptr ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull) : nullptr;
+	if (!IsValid(World)) return nullptr;
+
+	FActorSpawnParameters ProjectileSpawnParams;
+	ProjectileSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return World->SpawnActor<AAutobattlerProjectile>(AAutobattlerProjectile::StaticClass(), SpawnTransform, ProjectileSpawnParams);
+}
+
+void AAutobattlerProjectile::ReleaseToPool()
+{
+	if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this)) Manager->GetSkillActorPool().Release(this);
+	else Destroy();
+}
+
+void AAutobattlerProjectile::OnAcquiredFromPool()
+{
+	SetActorHiddenInGame(false);
+}
+
+void AAutobattlerProjectile::OnReleasedToPool()
+{
+	if (IsValid(ProjectileTargetingProperties.TargetCharacter))
+	{
+		ProjectileTargetingProperties.TargetCharacter->ActionChanged.RemoveDynamic(this, &AAutobattlerProjectile::OnTargetCharacterStateChange);
+	}
+
+	if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this)) Manager->GetProjectileSystem().Remove(this);
+
+	SkillOwnerInternal = nullptr;
+	SkillImplementationInternal = nullptr;
+	ProjectileTargetingProperties = FAbilityTargetingProperties();
+	if (CurrentProjectileSpeed > 0.0f) UpdateProjectileFlight(ProjectileMesh->GetStaticMesh(), ProjectileParticle->Template, nullptr, GetActorLocation(), GetActorLocation(), 0.0f);
+
+	SetActorHiddenInGame(true);
+	SetActorTickEnabled(false);
+}
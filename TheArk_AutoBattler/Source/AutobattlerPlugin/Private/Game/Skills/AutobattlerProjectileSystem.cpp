@@ -0,0 +1,150 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+/* Class header. */
+#include "Game/Skills/AutobattlerProjectileSystem.h"
+
+/* Autobattler includes. */
+#include "Game/Skills/AutobattlerProjectile.h"
+
+/* Engine includes. */
+#include "Components/SceneComponent.h"
+
+void FAutobattlerProjectileSystem::Add(AAutobattlerProjectile* Projectile, const FVector& StartLocation, USceneComponent* HomingTarget, const FVector& TargetLocation, float Speed, float MinDistanceToHit)
+{
+	if (!IsValid(Projectile)) return;
+
+	int32 Index = Projectile->ProjectileSystemIndex;
+	if (!Projectiles.IsValidIndex(Index) || Projectiles[Index].Get() != Projectile)
+	{
+		Index = Positions.AddUninitialized();
+		TargetLocations.AddUninitialized();
+		Speeds.AddUninitialized();
+		MinDistancesSquared.AddUninitialized();
+		HomingTargets.AddDefaulted();
+		HasHomingTargets.AddUninitialized();
+		Projectiles.Add(Projectile);
+		FlightIDs.AddUninitialized();
+		Projectile->ProjectileSystemIndex = Index;
+	}
+
+	Positions[Index] = StartLocation;
+	TargetLocations[Index] = IsValid(HomingTarget) ? HomingTarget->GetComponentLocation() : TargetLocation;
+	Speeds[Index] = FMath::Max(Speed, 0.0f);
+	MinDistancesSquared[Index] = FMath::Square(FMath::Max(MinDistanceToHit, 0.0f));
+	HomingTargets[Index] = HomingTarget;
+	HasHomingTargets[Index] = IsValid(HomingTarget);
+	FlightIDs[Index] = NextFlightID++;
+}
+
+void FAutobattlerProjectileSystem::Remove(AAutobattlerProjectile* Projectile)
+{
+	if (Projectile == nullptr) return;
+
+	const int32 Index = Projectile->ProjectileSystemIndex;
+	if (Projectiles.IsValidIndex(Index) && Projectiles[Index].Get() == Projectile) RemoveAt(Index);
+	Projectile->ProjectileSystemIndex = INDEX_NONE;
+}
+
+void FAutobattlerProjectileSystem::Reset()
+{
+	for (auto& Projectile : Projectiles)
+	{
+		if (Projectile.IsValid()) Projectile->ProjectileSystemIndex = INDEX_NONE;
+	}
+
+	Positions.Reset();
+	TargetLocations.Reset();
+	Speeds.Reset();
+	MinDistancesSquared.Reset();
+	HomingTargets.Reset();
+	HasHomingTargets.Reset();
+	Projectiles.Reset();
+	FlightIDs.Reset();
+}
+
+void FAutobattlerProjectileSystem::Tick(float DeltaTime, bool ShouldUpdateActors)
+{
+	FinishedFlights.Reset();
+
+	// Homing targets are read up front, so the movement loop below only touches the contiguous arrays.
+	// Iterating backwards means a destroyed projectile can be removed in place.
+	for (int32 i = Positions.Num() - 1; i >= 0; i--)
+	{
+		if (!Projectiles[i].IsValid())
+		{
+			RemoveAt(i);
+			continue;
+		}
+
+		if (!HasHomingTargets[i]) continue;
+
+		if (const USceneComponent* HomingTarget = HomingTargets[i].Get()) TargetLocations[i] = HomingTarget->GetComponentLocation();
+		else
+		{
+			// Freeze the projectile so it cannot also arrive below; it is released once movement is done.
+			HasHomingTargets[i] = false;
+			Speeds[i] = 0.0f;
+			MinDistancesSquared[i] = -1.0f;
+			FinishedFlights.Add(FFinishedFlight{ Projectiles[i], FlightIDs[i], false });
+		}
+	}
+
+	// Arrival is checked before moving, matching FAutobattlerSimulation.
+	const int32 NumProjectiles = Positions.Num();
+	for (int32 i = 0; i < NumProjectiles; i++)
+	{
+		const FVector ToTarget = TargetLocations[i] - Positions[i];
+		const float DistanceSquared = ToTarget.SizeSquared();
+		if (DistanceSquared <= MinDistancesSquared[i])
+		{
+			FinishedFlights.Add(FFinishedFlight{ Projectiles[i], FlightIDs[i], true });
+			continue;
+		}
+
+		const float StepSize = Speeds[i] * DeltaTime;
+		if (StepSize * StepSize >= DistanceSquared) Positions[i] = TargetLocations[i];
+		else Positions[i] += ToTarget * (StepSize * FMath::InvSqrt(DistanceSquared));
+	}
+
+	if (ShouldUpdateActors)
+	{
+		for (int32 i = 0; i < NumProjectiles; i++) Projectiles[i]->SetActorLocation(Positions[i]);
+	}
+
+	// Notifying runs game code which may release, reuse or add projectiles, so each flight is looked up again before notifying.
+	for (auto& Flight : FinishedFlights)
+	{
+		AAutobattlerProjectile* Projectile = Flight.Projectile.Get();
+		if (!IsValid(Projectile)) continue;
+
+		const int32 Index = Projectile->ProjectileSystemIndex;
+		if (!FlightIDs.IsValidIndex(Index) || FlightIDs[Index] != Flight.FlightID) continue;
+
+		if (!ShouldUpdateActors) Projectile->SetActorLocation(Positions[Index]);
+		RemoveAt(Index);
+
+		if (Flight.HasArrived) Projectile->OnArriveAtDestination();
+		else Projectile->ReleaseToPool();
+	}
+}
+
+void FAutobattlerProjectileSystem::RemoveAt(int32 Index)
+{
+	if (AAutobattlerProjectile* RemovedProjectile = Projectiles[Index].Get()) RemovedProjectile->ProjectileSystemIndex = INDEX_NONE;
+
+	const int32 LastIndex = Positions.Num() - 1;
+	if (Index != LastIndex)
+	{
+		if (AAutobattlerProjectile* MovedProjectile = Projectiles[LastIndex].Get()) MovedProjectile->ProjectileSystemIndex = Index;
+	}
+
+	Positions.RemoveAtSwap(Index);
+	TargetLocations.RemoveAtSwap(Index);
+	Speeds.RemoveAtSwap(Index);
+	MinDistancesSquared.RemoveAtSwap(Index);
+	HomingTargets.RemoveAtSwap(Index);
+	HasHomingTargets.RemoveAtSwap(Index);
+	Projectiles.RemoveAtSwap(Index);
+	FlightIDs.RemoveAtSwap(Index);
+}
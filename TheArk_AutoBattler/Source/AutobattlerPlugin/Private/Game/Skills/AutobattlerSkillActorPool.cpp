@@ -0,0 +1,132 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+/* Class header. */
+#include "Game/Skills/AutobattlerSkillActorPool.h"
+
+/* Autobattler includes. */
+#include "Game/Skills/AutobattlerProjectile.h"
+#include "Game/Skills/ExecuteSkill.h"
+
+void FAutobattlerSkillActorPool::Prewarm(UWorld* World, TSubclassOf<AExecuteSkill> ExecuteSkillClass, int32 NumExecuteSkills, int32 NumProjectiles)
+{
+	if (!IsValid(World)) return;
+
+	const TPair<UClass*, int32> Requests[] = {
+		{ ExecuteSkillClass.Get(), NumExecuteSkills },
+		{ AAutobattlerProjectile::StaticClass(), NumProjectiles }
+	};
+
+	for (auto& Request : Requests)
+	{
+		if (Request.Key == nullptr) continue;
+
+		FAutobattlerPooledActors& Pooled = AvailableActors.FindOrAdd(Request.Key);
+		while (Pooled.Actors.Num() < Request.Value)
+		{
+			AActor* NewActor = SpawnActor(World, Request.Key, FTransform::Identity);
+			if (NewActor == nullptr) break;
+
+			AddToPool(NewActor);
+		}
+	}
+}
+
+AExecuteSkill* FAutobattlerSkillActorPool::AcquireExecuteSkill(UWorld* World, TSubclassOf<AExecuteSkill> ExecuteSkillClass, const FTransform& Transform)
+{
+	AExecuteSkill* ExecuteSkill = Cast<AExecuteSkill>(Acquire(World, ExecuteSkillClass.Get(), Transform));
+	if (ExecuteSkill != nullptr) ExecuteSkill->OnAcquiredFromPool();
+	return ExecuteSkill;
+}
+
+AAutobattlerProjectile* FAutobattlerSkillActorPool::AcquireProjectile(UWorld* World, const FTransform& Transform)
+{
+	AAutobattlerProjectile* Projectile = Cast<AAutobattlerProjectile>(Acquire(World, AAutobattlerProjectile::StaticClass(), Transform));
+	if (Projectile != nullptr) Projectile->OnAcquiredFromPool();
+	return Projectile;
+}
+
+void FAutobattlerSkillActorPool::Release(AActor* Actor)
+{
+	// An actor can be released twice in one frame, e.g. a projectile whose impact kills its target releases itself on the death too.
+	if (!IsValid(Actor) || IsPooled(Actor)) return;
+
+	AddToPool(Actor);
+	NumReleased++;
+}
+
+void FAutobattlerSkillActorPool::Empty()
+{
+	for (auto& Pooled : AvailableActors)
+	{
+		for (auto Actor : Pooled.Value.Actors)
+		{
+			if (IsValid(Actor)) Actor->Destroy();
+		}
+	}
+
+	AvailableActors.Empty();
+}
+
+FAutobattlerActorPoolStats FAutobattlerSkillActorPool::GetStats() const
+{
+	FAutobattlerActorPoolStats Stats;
+	Stats.NumSpawned = NumSpawned;
+	Stats.NumReused = NumReused;
+	Stats.NumReleased = NumReleased;
+
+	for (auto& Pooled : AvailableActors) Stats.NumAvailable += Pooled.Value.Actors.Num();
+
+	Stats.HitRate = NumRequests > 0 ? (float)NumReused / NumRequests : 0.0f;
+	return Stats;
+}
+
+AActor* FAutobattlerSkillActorPool::Acquire(UWorld* World, UClass* ActorClass, const FTransform& Transform)
+{
+	if (ActorClass == nullptr) return nullptr;
+	NumRequests++;
+
+	if (FAutobattlerPooledActors* Pooled = AvailableActors.Find(ActorClass))
+	{
+		while (Pooled->Actors.Num() > 0)
+		{
+			AActor* Actor = Pooled->Actors.Last();
+			Pooled->Actors.RemoveAt(Pooled->Actors.Num() - 1);
+
+			// Pooled actors can still be destroyed from outside, e.g. on level teardown.
+			if (!IsValid(Actor)) continue;
+
+			Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::TeleportPhysics);
+			NumReused++;
+			return Actor;
+		}
+	}
+
+	return SpawnActor(World, ActorClass, Transform);
+}
+
+bool FAutobattlerSkillActorPool::IsPooled(const AActor* Actor) const
+{
+	const FAutobattlerPooledActors* Pooled = AvailableActors.Find(Actor->GetClass());
+	return Pooled != nullptr && Pooled->Actors.Contains(Actor);
+}
+
+void FAutobattlerSkillActorPool::AddToPool(AActor* Actor)
+{
+	if (AExecuteSkill* ExecuteSkill = Cast<AExecuteSkill>(Actor)) ExecuteSkill->OnReleasedToPool();
+	else if (AAutobattlerProjectile* Projectile = Cast<AAutobattlerProjectile>(Actor)) Projectile->OnReleasedToPool();
+
+	AvailableActors.FindOrAdd(Actor->GetClass()).Actors.AddUnique(Actor);
+}
+
+AActor* FAutobattlerSkillActorPool::SpawnActor(UWorld* World, UClass* ActorClass, const FTransform& Transform)
+{
+	if (!IsValid(World)) return nullptr;
+
+	FActorSpawnParameters ActorSpawnParams;
+	ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	AActor* NewActor = World->SpawnActor<AActor>(ActorClass, Transform, ActorSpawnParams);
+	if (NewActor != nullptr) NumSpawned++;
+	return NewActor;
+}
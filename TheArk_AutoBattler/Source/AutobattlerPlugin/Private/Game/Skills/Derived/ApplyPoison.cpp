@@ -5,22 +5,15 @@
 #include "Game/Skills/Derived/ApplyPoison.h"
 
 /* Autobattler includes. */
+#include "Core/AutobattlerManager.h"
 #include "Game/Components/PoisonComponent.h"
 #include "Game/Units/AutobattlerCharacter.h"
-#include "Utility/AutobattlerFunctionLibrary.h"
 
 void UApplyPoison::ExecuteSkill_Implementation(AAutobattlerCharacter* SkillOwner, ESkillTargetingMode SkillTargetingMode, AAutobattlerCharacter* Target, const FVector& TargetLocation)
 {
-    if (IsValid(Target))
-    {
-        if (UPoisonComponent* PoisonComponent = UAutobattlerFunctionLibrary::GetFirstComponent<UPoisonComponent>(Target))
-        {
-            PoisonComponent->ApplyPoison(MinMaxPoison.GetRandomValueInRange());
-        }
-        else
-        {
-            UPoisonComponent* NewPoisonComponent = Cast<UPoisonComponent>(Target->AddComponentByClass(UPoisonComponent::StaticClass(), false, FTransform::Identity, false));
-            if (IsValid(NewPoisonComponent)) NewPoisonComponent->ApplyPoison(MinMaxPoison.GetRandomValueInRange());
-        }
-    }
+    if (!IsValid(Target)) return;
+
+    const float PoisonStrength = MinMaxPoison.GetRandomValueInRange();
+    UPoisonComponent::ApplyPoisonToCharacter(Target, PoisonStrength);
+    if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(Target)) Manager->RecordBattleEvent(EAutobattlerSimulationEventType::PoisonApplied, SkillOwner, Target, PoisonStrength);
 }
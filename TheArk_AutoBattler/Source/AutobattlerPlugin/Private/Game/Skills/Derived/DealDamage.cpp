@@ -5,43 +5,44 @@
 #include "Game/Skills/Derived/DealDamage.h"
 
 /* Autobattler includes. */
+#include "Core/AutobattlerManager.h"
 #include "DataAssets/AutobattlerConfiguration.h"
 #include "Game/Units/AutobattlerCharacter.h"
 #include "Utility/AutobattlerFunctionLibrary.h"
+#include "Utility/AutobattlerStats.h"
 
 void UDealDamage::ExecuteSkill_Implementation(AAutobattlerCharacter* SkillOwner, ESkillTargetingMode SkillTargetingMode, AAutobattlerCharacter* Target, const FVector& TargetLocation)
 {
     if (SkillTargetingMode != ESkillTargetingMode::Actor || !IsValid(Target)) return;
 
-    float ResistanceModifier = 1.0f;
-    float CriticalMultiplier = 1.0f;
+    DealDamageToTarget(SkillOwner, Target, GetResistanceConfiguration(SkillOwner));
+}
 
-    if (AffectedByResistance)
+void UDealDamage::ApplyDamageBatch(AAutobattlerCharacter* SkillOwner, const TArray<AAutobattlerCharacter*>& Targets, const AAutobattlerCharacter* IgnoredTarget)
+{
+    if (Targets.Num() == 0) return;
+
+    const UAutobattlerConfiguration* ConfigurationAsset = GetResistanceConfiguration(SkillOwner);
+    for (auto Target : Targets)
     {
-        if (const UAutobattlerConfiguration* ConfigurationAsset = UAutobattlerConfiguration::GetConfigurationAsset(SkillOwner))
-        {
-            TMap<EDamageType, FResistanceContainer> DamageModifierMap = ConfigurationAsset->DamageModifierMap;
-            if (FResistanceContainer* ResistanceContainer = DamageModifierMap.Find(SkillOwner->GetDamageType()))
-            {
-                if (float* FoundModifier = ResistanceContainer->Resistances.Find(Target->GetResistanceType()))
-                {
-                    ResistanceModifier = *FoundModifier;
-                }
-                else UAutobattlerFunctionLibrary::PrintWarningToLog(
-                    FString::Printf(TEXT("When %s tried to deal damage, could not find resistance type %s defending against damage type %s (resistances not applied)!"), 
-                        *SkillOwner->GetName(),
-                        *UAutobattlerEnums::ResistanceTypeToString(Target->GetResistanceType()),
-                        *UAutobattlerEnums::DamageTypeToString(SkillOwner->GetDamageType())
-                    ));
-            }
-            else UAutobattlerFunctionLibrary::PrintWarningToLog(
-                FString::Printf(TEXT("When %s tried to deal damage, there exists no resistance definition for damage type %s (resistances not applied)!"), 
-                    *SkillOwner->GetName(),
-                    *UAutobattlerEnums::DamageTypeToString(SkillOwner->GetDamageType())
-                ));
-        }
-        else UAutobattlerFunctionLibrary::PrintWarningToLog(FString::Printf(TEXT("When %s tried to deal damage, could not get configuration asset (resistances not applied)!"), *SkillOwner->GetName()));
+        if (Target == IgnoredTarget || !IsValid(Target)) continue;
+        DealDamageToTarget(SkillOwner, Target, ConfigurationAsset);
     }
+}
+
+bool UDealDamage::IsBatchable() const
+{
+    const UFunction* ExecuteSkillFunction = GetClass()->FindFunctionByName(GET_FUNCTION_NAME_CHECKED(USkillImplementation, ExecuteSkill));
+    return ExecuteSkillFunction != nullptr && ExecuteSkillFunction->GetOuterUClass()->IsNative();
+}
+
+void UDealDamage::DealDamageToTarget(AAutobattlerCharacter* SkillOwner, AAutobattlerCharacter* Target, const UAutobattlerConfiguration* ConfigurationAsset) const
+{
+    AUTOBATTLER_SCOPE_CYCLE_COUNTER(STAT_AutobattlerDamage);
+    INC_DWORD_STAT(STAT_AutobattlerDamageEvents);
+
+    const float ResistanceModifier = ConfigurationAsset != nullptr ? ConfigurationAsset->GetDamageModifier(SkillOwner->GetDamageType(), Target->GetResistanceType()) : 1.0f;
+    float CriticalMultiplier = 1.0f;
 
     if (CanBeCritical)
     {
@@ -50,11 +51,27 @@ void UDealDamage::ExecuteSkill_Implementation(AAutobattlerCharacter* SkillOwner,
     }
 
     float DamageToDeal = FMath::RoundToFloat(MinMaxDamage.GetRandomValueInRange()) * ResistanceModifier * CriticalMultiplier;
+    if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(Target))
+    {
+        Manager->RecordBattleEvent(EAutobattlerSimulationEventType::Damage, SkillOwner, Target, DamageToDeal);
+        Manager->GetBattleStats().RecordDamage(DamageToDeal);
+    }
+
     Target->SetCurrentHealth(Target->GetCurrentHealth() - DamageToDeal);
-    UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(TEXT("%s deals %f damage to %s (%f health remaining)"),
-		*SkillOwner->GetName(),
+    AUTOBATTLER_LOG_DAMAGE(TEXT("%s deals %f damage to %s (%f health remaining)"),
+        *SkillOwner->GetName(),
         DamageToDeal,
-		*Target->GetName(),
+        *Target->GetName(),
         Target->GetCurrentHealth()
-	));
+    );
+}
+
+const UAutobattlerConfiguration* UDealDamage::GetResistanceConfiguration(const AAutobattlerCharacter* SkillOwner) const
+{
+    if (!AffectedByResistance) return nullptr;
+
+    const UAutobattlerConfiguration* ConfigurationAsset = UAutobattlerConfiguration::GetConfigurationAsset(SkillOwner);
+    if (ConfigurationAsset == nullptr) UAutobattlerFunctionLibrary::PrintWarningToLog(FString::Printf(TEXT("When %s tried to deal damage, could not get configuration asset (resistances not applied)!"), *SkillOwner->GetName()));
+
+    return ConfigurationAsset;
 }
@@ -5,10 +5,14 @@
 #include "Game/Skills/Derived/Heal.h"
 
 /* Autobattler includes. */
+#include "Core/AutobattlerManager.h"
 #include "Game/Units/AutobattlerCharacter.h"
 
 void UHeal::ExecuteSkill_Implementation(AAutobattlerCharacter* SkillOwner, ESkillTargetingMode SkillTargetingMode, AAutobattlerCharacter* Target, const FVector& TargetLocation)
 {
     if (SkillTargetingMode != ESkillTargetingMode::Actor || !IsValid(Target)) return;
+
+    const float HealthBefore = Target->GetCurrentHealth();
     Target->SetCurrentHealth(Target->GetMaxHealth() + MinMaxHeal.GetRandomValueInRange());
+    if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(Target)) Manager->RecordBattleEvent(EAutobattlerSimulationEventType::Heal, SkillOwner, Target, Target->GetCurrentHealth() - HealthBefore);
 }
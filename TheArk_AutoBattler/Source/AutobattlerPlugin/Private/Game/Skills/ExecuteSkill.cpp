@@ -5,12 +5,15 @@
 #include "Game/Skills/ExecuteSkill.h"
 
 /* Autobattler includes. */
+#include "Core/AutobattlerManager.h"
 #include "Core/AutobattlerSettings.h"
 #include "DataAssets/AutobattlerSkill.h"
 #include "Game/Components/DurationSkillComponent.h"
+#include "Game/Skills/Derived/DealDamage.h"
 #include "Game/Skills/AutobattlerProjectile.h"
 #include "Game/Skills/SkillImplementation.h"
 #include "Utility/AutobattlerFunctionLibrary.h"
+#include "Utility/AutobattlerStats.h"
 
 /* Engine includes. */
 #include "Particles/ParticleSystemComponent.h"
@@ -37,9 +40,9 @@ void AExecuteSkill::InitialiseAsInstant(const UAutobattlerSkill* SkillImplementa
 	if (HasBeenInitialised || !HasAuthority() || !IsValid(SkillImplementation)) return;
 	HasBeenInitialised = true;
 
-	ExecuteSkillList(SkillImplementation, SkillOwner, TargetingProperties);
+	ExecuteSkillList(SkillImplementation, SkillOwner, TargetingProperties, GetActorLocation());
 
-	if (DestroyOnEnd) Destroy();
+	if (DestroyOnEnd) ReleaseToPool();
 }
 
 void AExecuteSkill::InitialiseAsProjectile(const UAutobattlerSkill* SkillImplementation, AAutobattlerCharacter* SkillOwner, const FAbilityTargetingProperties& TargetingProperties)
@@ -47,15 +50,11 @@ void AExecuteSkill::InitialiseAsProjectile(const UAutobattlerSkill* SkillImpleme
 	if (HasBeenInitialised || !HasAuthority() || !IsValid(SkillImplementation)) return;
 	HasBeenInitialised = true;
 
-	FActorSpawnParameters ProjectileSpawnParams;
-	ProjectileSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AAutobattlerProjectile* AutobattlerProjectile = AAutobattlerProjectile::AcquireFromPool(this, GetActorTransform());
+	if (IsValid(AutobattlerProjectile)) AutobattlerProjectile->InitialiseProjectile(SkillImplementation, SkillOwner, TargetingProperties);
 
-	AAutobattlerProjectile* AutobattlerProjectile = GetWorld()->SpawnActor<AAutobattlerProjectile>(
-		AAutobattlerProjectile::StaticClass(),
-		GetActorTransform(),
-		ProjectileSpawnParams
-	);
-	AutobattlerProjectile->InitialiseProjectile(SkillImplementation, SkillOwner, TargetingProperties);
+	// The projectile carries the skill from here.
+	ReleaseToPool();
 }
 
 void AExecuteSkill::InitialiseAsEffect(const UAutobattlerSkill* SkillImplementation, AAutobattlerCharacter* SkillOwner, const FAbilityTargetingProperties& TargetingProperties)
@@ -63,8 +62,8 @@ void AExecuteSkill::InitialiseAsEffect(const UAutobattlerSkill* SkillImplementat
 	if (HasBeenInitialised || !HasAuthority() || !IsValid(SkillImplementation)) return;
 	HasBeenInitialised = true;
 
-	UpdateEffectVisuals(SkillImplementation->SkillMesh, SkillImplementation->SkillParticleEffect);
-	ExecuteSkillList(SkillImplementation, SkillOwner, TargetingProperties);
+	UpdateEffectVisuals(SkillImplementation->SkillMesh, SkillImplementation->SkillParticleEffect, GetActorLocation());
+	ExecuteSkillList(SkillImplementation, SkillOwner, TargetingProperties, GetActorLocation());
 
 	FTimerHandle TimerHandle;
 	FTimerDelegate TimerDelegate;
@@ -73,8 +72,25 @@ void AExecuteSkill::InitialiseAsEffect(const UAutobattlerSkill* SkillImplementat
 	GetWorldTimerManager().SetTimer(TimerHandle, TimerDelegate, SkillImplementation->EffectTimeout, false);
 }
 
-void AExecuteSkill::ExecuteSkillList(const UAutobattlerSkill* SkillImplementation, AAutobattlerCharacter* SkillOwner, const FAbilityTargetingProperties& TargetingProperties)
+void AExecuteSkill::ExecuteInstant(const UObject* WorldContextObject, const UAutobattlerSkill* SkillImplementation, AAutobattlerCharacter* SkillOwner, const FAbilityTargetingProperties& TargetingProperties, const FTransform& SkillTransform)
 {
+	if (!IsValid(SkillImplementation)) return;
+
+	if (SkillImplementation->ExecuteSkillClass.Get() == AExecuteSkill::StaticClass())
+	{
+		ExecuteSkillList(SkillImplementation, SkillOwner, TargetingProperties, SkillTransform.GetLocation());
+	}
+	else if (AExecuteSkill* ExecuteSkill = AcquireFromPool(WorldContextObject, SkillImplementation->ExecuteSkillClass, SkillTransform))
+	{
+		ExecuteSkill->InitialiseAsInstant(SkillImplementation, SkillOwner, TargetingProperties);
+	}
+}
+
+void AExecuteSkill::ExecuteSkillList(const UAutobattlerSkill* SkillImplementation, AAutobattlerCharacter* SkillOwner, const FAbilityTargetingProperties& TargetingProperties, const FVector& SkillLocation)
+{
+	AUTOBATTLER_SCOPE_CYCLE_COUNTER(STAT_AutobattlerSkillExecution);
+	INC_DWORD_STAT(STAT_AutobattlerSkillsExecuted);
+
 	const UAutobattlerSettings* Settings = GetDefault<UAutobattlerSettings>();
 	TEnumAsByte<ECollisionChannel> CharacterCollisionChannel = Settings != nullptr ? Settings->CharacterCollisionChannel : TEnumAsByte<ECollisionChannel>(ECollisionChannel::ECC_Pawn);
 
@@ -84,6 +100,12 @@ void AExecuteSkill::ExecuteSkillList(const UAutobattlerSkill* SkillImplementatio
 		ShouldExecuteSkillList = SkillImplementation->ActivatesImmediately;
 	}
 
+	if (AAutobattlerManager* Manager = IsValid(SkillOwner) ? AAutobattlerManager::GetManager(SkillOwner) : nullptr)
+	{
+		Manager->RecordBattleEvent(EAutobattlerSimulationEventType::SkillTriggered, SkillOwner, TargetingProperties.TargetCharacter, 0.0f);
+		Manager->GetBattleStats().RecordSkill();
+	}
+
 	for (auto Effect : SkillImplementation->SkillEffects)
 	{
 		if (!IsValid(Effect)) continue;
@@ -106,7 +128,7 @@ void AExecuteSkill::ExecuteSkillList(const UAutobattlerSkill* SkillImplementatio
 					SecondaryTargets,
 					SkillOwner,
 					CharacterCollisionChannel,
-					GetActorLocation(),
+					SkillLocation,
 					Effect->SkillBoxExtent,
 					Effect->SecondaryTargetFilter
 				);
@@ -117,16 +139,21 @@ void AExecuteSkill::ExecuteSkillList(const UAutobattlerSkill* SkillImplementatio
 					SecondaryTargets,
 					SkillOwner,
 					CharacterCollisionChannel,
-					GetActorLocation(),
+					SkillLocation,
 					Effect->SkillCollisionRadius,
 					Effect->SecondaryTargetFilter
 				);
 			}
 
+			// Native damage resolves every secondary target in one pass.
+			UDealDamage* DealDamage = Cast<UDealDamage>(Effect);
+			const bool ShouldBatchDamage = ShouldExecuteSkillList && TargetingProperties.TargetingMode == ESkillTargetingMode::Actor && DealDamage != nullptr && DealDamage->IsBatchable();
+			if (ShouldBatchDamage) DealDamage->ApplyDamageBatch(SkillOwner, SecondaryTargets, TargetingProperties.TargetCharacter);
+
 			for (auto SecondaryTarget : SecondaryTargets)
 			{
 				if (SecondaryTarget == TargetingProperties.TargetCharacter) continue;
-				if (ShouldExecuteSkillList) Effect->ExecuteSkill(
+				if (ShouldExecuteSkillList && !ShouldBatchDamage) Effect->ExecuteSkill(
 					SkillOwner,
 					TargetingProperties.TargetingMode,
 					SecondaryTarget,
@@ -139,13 +166,48 @@ void AExecuteSkill::ExecuteSkillList(const UAutobattlerSkill* SkillImplementatio
 	}
 }
 
-void AExecuteSkill::UpdateEffectVisuals_Implementation(UStaticMesh* NewMesh, UParticleSystem* NewTemplate)
+AExecuteSkill* AExecuteSkill::AcquireFromPool(const UObject* WorldContextObject, TSubclassOf<AExecuteSkill> ExecuteSkillClass, const FTransform& SkillTransform)
+{
+	if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(WorldContextObject))
+	{
+		return Manager->GetSkillActorPool().AcquireExecuteSkill(Manager->GetWorld(), ExecuteSkillClass, SkillTransform);
+	}
+
+	UWorld* World = GEngine != nullptr ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull) : nullptr;
+	if (!IsValid(World) || ExecuteSkillClass.Get() == nullptr) return nullptr;
+
+	FActorSpawnParameters ActorSpawnParams;
+	ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return World->SpawnActor<AExecuteSkill>(ExecuteSkillClass, SkillTransform, ActorSpawnParams);
+}
+
+void AExecuteSkill::ReleaseToPool()
+{
+	if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this)) Manager->GetSkillActorPool().Release(this);
+	else Destroy();
+}
+
+void AExecuteSkill::OnAcquiredFromPool()
+{
+	HasBeenInitialised = false;
+	SetActorHiddenInGame(false);
+}
+
+void AExecuteSkill::OnReleasedToPool()
+{
+	GetWorldTimerManager().ClearAllTimersForObject(this);
+	HasBeenInitialised = true;
+	SetActorHiddenInGame(true);
+}
+
+void AExecuteSkill::UpdateEffectVisuals_Implementation(UStaticMesh* NewMesh, UParticleSystem* NewTemplate, const FVector_NetQuantize& EffectLocation)
 {
+	SetActorLocation(EffectLocation);
 	EffectMesh->SetStaticMesh(NewMesh);
 	EffectParticle->SetTemplate(NewTemplate);	
 }
 
 void AExecuteSkill::OnEffectEnd()
 {
-	Destroy();
+	ReleaseToPool();
 }
@@ -27,6 +27,7 @@
 #include "GameFramework/CharacterMovementComponent.h"
 #include "NavAreas/NavArea_Null.h"
 #include "NavModifierComponent.h"
+#include "Net/Core/PushModel/PushModel.h"
 #include "Net/UnrealNetwork.h"
 
 AAutobattlerCharacter::AAutobattlerCharacter()
@@ -34,6 +35,13 @@ AAutobattlerCharacter::AAutobattlerCharacter()
  	AIControllerClass = AAutobattlerAIController::StaticClass();
 	AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
 	CurrentAction = EActionType::Idle;
+	AnimationActionType = EActionType::Idle;
+	ReplicatedCurrentHealth = 0;
+	ReplicatedMaxHealth = 0;
+	Charges = 0;
+	MaxCharges = 1;
+	UsesReducedReplication = false;
+	FullPriorityDistance = 0.0f;
 	bUseControllerRotationYaw = false;
 	bReplicates = true;
 
@@ -68,12 +76,16 @@ void AAutobattlerCharacter::BuildCharacterFromListing(EEntity WhoOwns, int32 Cha
 {
 	if (!HasAuthority()) return;
 
-	if (FAutobattlerCharacterDefinition* CharacterDefinition = UAutobattlerFunctionLibrary::GetCharacterDefinitionFromConfigurationDatatable(this, CharacterListing.CharacterRowName))
+	int32 CharacterDefinitionHandle = CharacterListing.CharacterDefinitionHandle;
+	if (const FAutobattlerCharacterDefinition* CharacterDefinition = UAutobattlerFunctionLibrary::GetCharacterDefinitionByHandle(this, CharacterDefinitionHandle, CharacterListing.CharacterRowName))
 	{
 		ID = CharacterID;
 		BudgetCost = CharacterDefinition->BudgetCost;
 		MaxHealth = CharacterDefinition->BaseHealth;
 		CurrentHealth = CharacterDefinition->BaseHealth;
+		UpdateReplicatedHealth();
+		MARK_PROPERTY_DIRTY_FROM_NAME(AAutobattlerCharacter, ID, this);
+		MARK_PROPERTY_DIRTY_FROM_NAME(AAutobattlerCharacter, BudgetCost, this);
 		CharacterResistanceType = CharacterDefinition->BaseResistanceType;
 		CharacterDamageType = CharacterDefinition->BaseDamageType;
 		CriticalChance = CharacterDefinition->CriticalChance;
@@ -81,6 +93,7 @@ void AAutobattlerCharacter::BuildCharacterFromListing(EEntity WhoOwns, int32 Cha
 		PathAroundQuery = CharacterDefinition->PathAroundQuery;
 		SurroundingPointsQuery = CharacterDefinition->SurroundingPointsQuery;
 		OwnerID = WhoOwns;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AAutobattlerCharacter, OwnerID, this);
 		OnOwnerIDChanged(OwnerID);
 
 		GetCharacterMovement()->MaxWalkSpeed = CharacterDefinition->MovementSpeed;
@@ -118,7 +131,7 @@ void AAutobattlerCharacter::BuildCharacterFromListing(EEntity WhoOwns, int32 Cha
 
 		if (AAutobattlerAIController* AIController = Cast<AAutobattlerAIController>(GetController()))
 		{
-			AIController->SetCharacterListingName(CharacterListing.CharacterRowName);
+			AIController->SetCharacterListingName(CharacterListing.CharacterRowName, CharacterDefinitionHandle);
 		}
 	}
 	else
@@ -157,6 +170,13 @@ void AAutobattlerCharacter::SetCurrentHealth(float NewHealth)
 	float ClampedHealth = FMath::Clamp(NewHealth, 0.0f, MaxHealth);
 	bool LostHealth = ClampedHealth < CurrentHealth;
 	CurrentHealth = ClampedHealth;
+	if (HasAuthority())
+	{
+		UpdateReplicatedHealth();
+
+		// Recorded before death is handled below, as a death may end the recording.
+		if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this)) Manager->RecordBattleHealth(this);
+	}
 	UpdateHealthBar();
 
 	if (LostHealth) OnHealthLost.Broadcast();
@@ -193,6 +213,9 @@ void AAutobattlerCharacter::Kill()
 	{
 		UE_LOG(LogTemp, Log, TEXT("Killed character with ID : %d"), GetID());
 		ActionChanged.Broadcast(CurrentAction, this);
+
+		// Dead characters no longer change; once their final state has been sent they stop being considered for replication.
+		if (UsesReducedReplication) SetNetDormancy(ENetDormancy::DORM_DormantAll);
 	}
 }
 
@@ -203,13 +226,10 @@ void AAutobattlerCharacter::ModifyStatistic(EAutobattlerStatType StatToModify, f
 
 	if (IsPermanent) return;
 
-	FTimerHandle Handle;
-	FTimerDelegate TimerDelegate;
-	TimerDelegate.BindLambda([this, StatToModify, ModifierScale, ExpiryDuration](){
-		this->ModifyStatisticInternal(StatToModify, ModifierScale * -1.0f);
-	});
-
-	GetWorldTimerManager().SetTimer(Handle, TimerDelegate, ExpiryDuration, false);
+	if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this))
+	{
+		Manager->GetEffectScheduler().AddStatModifier(this, StatToModify, ModifierScale, ExpiryDuration);
+	}
 }
 
 void AAutobattlerCharacter::ModifyResistanceType(EResistanceType NewResistanceType, bool IsPermanent, float ExpiryDuration)
@@ -222,15 +242,11 @@ void AAutobattlerCharacter::ModifyResistanceType(EResistanceType NewResistanceTy
 	}
 	else
 	{
-		FTimerHandle Handle;
-		FTimerDelegate TimerDelegate;
-		EResistanceType OldResistanceType = CharacterResistanceType;
-		TimerDelegate.BindLambda([this, OldResistanceType](){
-			this->CharacterResistanceType = OldResistanceType;
-			this->UpdateResistanceUI(true);
-		});
-
-		GetWorldTimerManager().SetTimer(Handle, TimerDelegate, ExpiryDuration, false);
+		if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this))
+		{
+			Manager->GetEffectScheduler().AddResistanceOverride(this, CharacterResistanceType, ExpiryDuration);
+		}
+
 		CharacterResistanceType = NewResistanceType;
 		UpdateResistanceUI(false);
 	}
@@ -246,15 +262,11 @@ void AAutobattlerCharacter::ModifyDamageType(EDamageType NewDamageType, bool IsP
 	}
 	else
 	{
-		FTimerHandle Handle;
-		FTimerDelegate TimerDelegate;
-		EDamageType OldDamageType = CharacterDamageType;
-		TimerDelegate.BindLambda([this, OldDamageType](){
-			this->CharacterDamageType = OldDamageType;
-			this->UpdateDamageTypeUI(true);
-		});
-
-		GetWorldTimerManager().SetTimer(Handle, TimerDelegate, ExpiryDuration, false);
+		if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this))
+		{
+			Manager->GetEffectScheduler().AddDamageTypeOverride(this, CharacterDamageType, ExpiryDuration);
+		}
+
 		CharacterDamageType = NewDamageType;
 		UpdateDamageTypeUI(false);
 	}
@@ -265,7 +277,8 @@ void AAutobattlerCharacter::ConfigureGetChargeComponent(TSubclassOf<UAutobattler
 	if (!HasAuthority()) return;
 	if (ensureAlwaysMsgf(ChargeComponentClass.Get() != nullptr, TEXT("%s : [ConfigureGetChargeComponent] Does not have valid charge component class!"), *GetName()))
 	{
-		MaxCharges = FMath::Max(ChargesToTriggerAbility, 1);
+		MaxCharges = static_cast<uint8>(FMath::Clamp(ChargesToTriggerAbility, 1, static_cast<int32>(MAX_uint8)));
+		MARK_PROPERTY_DIRTY_FROM_NAME(AAutobattlerCharacter, MaxCharges, this);
 
 		UAutobattlerChargeComponent* NewChargeComponent = NewObject<UAutobattlerChargeComponent>(this, ChargeComponentClass);
 		NewChargeComponent->RegisterComponent();
@@ -276,7 +289,8 @@ void AAutobattlerCharacter::ConfigureGetChargeComponent(TSubclassOf<UAutobattler
 void AAutobattlerCharacter::GainCharge()
 {
 	Charges += 1;
-	if (Charges == MaxCharges)
+	MARK_PROPERTY_DIRTY_FROM_NAME(AAutobattlerCharacter, Charges, this);
+	if (Charges >= MaxCharges)
 	{
 		Charges = 0;
 		AAutobattlerAIController* AIController = Cast<AAutobattlerAIController>(GetController());
@@ -452,22 +466,29 @@ void AAutobattlerCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(AAutobattlerCharacter, CurrentHealth);
-	DOREPLIFETIME(AAutobattlerCharacter, MaxHealth);
-	DOREPLIFETIME(AAutobattlerCharacter, Charges);
-	DOREPLIFETIME(AAutobattlerCharacter, MaxCharges);
-	DOREPLIFETIME(AAutobattlerCharacter, ID);
-	DOREPLIFETIME(AAutobattlerCharacter, BudgetCost);
-	DOREPLIFETIME(AAutobattlerCharacter, OwnerID);
+	// Push based, so the server only compares these when they have been marked dirty. Without push model support, they are compared every update as before.
+	FDoRepLifetimeParams PushParams;
+	PushParams.bIsPushBased = true;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(AAutobattlerCharacter, ReplicatedCurrentHealth, PushParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AAutobattlerCharacter, ReplicatedMaxHealth, PushParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AAutobattlerCharacter, Charges, PushParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AAutobattlerCharacter, MaxCharges, PushParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AAutobattlerCharacter, ID, PushParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AAutobattlerCharacter, BudgetCost, PushParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AAutobattlerCharacter, OwnerID, PushParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(AAutobattlerCharacter, AnimationActionType, PushParams);
 }
 
 void AAutobattlerCharacter::OnRep_CurrentHealth()
 {
+	CurrentHealth = ReplicatedCurrentHealth;
 	UpdateHealthBar();
 }
 
 void AAutobattlerCharacter::OnRep_MaxHealth()
 {
+	MaxHealth = ReplicatedMaxHealth;
 	UpdateHealthBar();
 }
 
@@ -491,8 +512,40 @@ void AAutobattlerCharacter::OnRep_OwnerID()
 	OnOwnerIDChanged(OwnerID);
 }
 
+void AAutobattlerCharacter::OnRep_AnimationActionType()
+{
+	ApplyAnimationActionType(AnimationActionType);
+	if (AnimationActionType == EActionType::Dead) HealthBarDisplay->SetHiddenInGame(true);
+}
+
+float AAutobattlerCharacter::GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth)
+{
+	if (!UsesReducedReplication) return Super::GetNetPriority(ViewPos, ViewDir, Viewer, ViewTarget, InChannel, Time, bLowBandwidth);
+
+	float Priority = NetPriority * Time;
+	if (CurrentAction == EActionType::Dead) return Priority * 0.25f;
+
+	const FVector ToCharacter = GetActorLocation() - ViewPos;
+	if ((ToCharacter | ViewDir) < 0.0f) Priority *= 0.5f;
+
+	const float DistanceSquared = ToCharacter.SizeSquared();
+	if (FullPriorityDistance > 0.0f && DistanceSquared > FMath::Square(FullPriorityDistance))
+	{
+		Priority *= FMath::Max(FullPriorityDistance * FMath::InvSqrt(DistanceSquared), 0.25f);
+	}
+
+	return Priority;
+}
+
 void AAutobattlerCharacter::ReplicateExecuteAbilityAnimations_Implementation(UAnimSequence* Animation, float ActionSpeed, EActionType ActionType)
 {
+	// Recorded as state too, so returning to idle afterwards is replicated even if this call is dropped.
+	if (HasAuthority() && AnimationActionType != ActionType && (ActionType == EActionType::Attacking || ActionType == EActionType::UsingSkill))
+	{
+		AnimationActionType = ActionType;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AAutobattlerCharacter, AnimationActionType, this);
+	}
+
 	if (UAutobattlerAnimInstance* AutobattlerAnimInstance = Cast<UAutobattlerAnimInstance>(GetMesh()->GetAnimInstance()))
 	{
 		if (ActionType == EActionType::Attacking)
@@ -508,7 +561,18 @@ void AAutobattlerCharacter::ReplicateExecuteAbilityAnimations_Implementation(UAn
 	}
 }
 
-void AAutobattlerCharacter::SetAnimationActionType_Implementation(EActionType NewActionType)
+void AAutobattlerCharacter::SetAnimationActionType(EActionType NewActionType)
+{
+	if (HasAuthority() && AnimationActionType != NewActionType)
+	{
+		AnimationActionType = NewActionType;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AAutobattlerCharacter, AnimationActionType, this);
+	}
+
+	ApplyAnimationActionType(NewActionType);
+}
+
+void AAutobattlerCharacter::ApplyAnimationActionType(EActionType NewActionType)
 {
 	if (UAutobattlerAnimInstance* AutobattlerAnimInstance = Cast<UAutobattlerAnimInstance>(GetMesh()->GetAnimInstance()))
 	{
@@ -516,6 +580,48 @@ void AAutobattlerCharacter::SetAnimationActionType_Implementation(EActionType Ne
 	}
 }
 
+void AAutobattlerCharacter::UpdateReplicatedHealth()
+{
+	// A living character is never rounded down to zero, so clients cannot mistake it for dead.
+	uint16 NewCurrentHealth = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt(CurrentHealth), 0, static_cast<int32>(MAX_uint16)));
+	if (NewCurrentHealth == 0 && CurrentHealth > 0.0f) NewCurrentHealth = 1;
+	const uint16 NewMaxHealth = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt(MaxHealth), 0, static_cast<int32>(MAX_uint16)));
+
+	if (ReplicatedCurrentHealth != NewCurrentHealth)
+	{
+		ReplicatedCurrentHealth = NewCurrentHealth;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AAutobattlerCharacter, ReplicatedCurrentHealth, this);
+	}
+
+	if (ReplicatedMaxHealth != NewMaxHealth)
+	{
+		ReplicatedMaxHealth = NewMaxHealth;
+		MARK_PROPERTY_DIRTY_FROM_NAME(AAutobattlerCharacter, ReplicatedMaxHealth, this);
+	}
+}
+
+void AAutobattlerCharacter::SetUsesReducedReplication(bool ShouldReduce)
+{
+	if (!HasAuthority()) return;
+
+	UsesReducedReplication = ShouldReduce;
+
+	const AActor* DefaultActor = GetClass()->GetDefaultObject<AActor>();
+	const UAutobattlerConfiguration* Configuration = UAutobattlerConfiguration::GetConfigurationAsset(this);
+	if (ShouldReduce && Configuration != nullptr)
+	{
+		NetUpdateFrequency = FMath::Min(DefaultActor->NetUpdateFrequency, Configuration->LargeBattleNetUpdateFrequency);
+		MinNetUpdateFrequency = FMath::Min(DefaultActor->MinNetUpdateFrequency, Configuration->LargeBattleMinNetUpdateFrequency);
+		FullPriorityDistance = Configuration->LargeBattleFullPriorityDistance;
+	}
+	else
+	{
+		NetUpdateFrequency = DefaultActor->NetUpdateFrequency;
+		MinNetUpdateFrequency = DefaultActor->MinNetUpdateFrequency;
+		FullPriorityDistance = 0.0f;
+	}
+}
+
 void AAutobattlerCharacter::OnGamePhaseChanged(EAutobattlerPhase NewGamePhase)
 {
 	CurrentGamePhase = NewGamePhase;
@@ -9,6 +9,7 @@
 #include "Core/AutobattlerSettings.h"
 #include "Core/AutobattlerManager.h"
 #include "DataAssets/AutobattlerConfiguration.h"
+#include "Game/Grid/AutobattlerGrid.h"
 #include "Game/Units/AutobattlerCharacter.h"
 #include "UI/HUD/AutobattlerHUD.h"
 #include "Utility/AutobattlerFunctionLibrary.h"
@@ -35,13 +36,17 @@ AAutobattlerPreviewCharacter::AAutobattlerPreviewCharacter()
 	CharacterDeploymentBounds = CreateDefaultSubobject<UBoxComponent>(TEXT("CharacterDeploymentBounds"));
 	CharacterDeploymentBounds->SetupAttachment(RootComponent);
 	CharacterDeploymentBounds->SetCollisionEnabled(ECollisionEnabled::Type::NoCollision);
+
+	PreviewRange = 0.0f;
+	PreviewOwner = EEntity::AI;
 }
 
-void AAutobattlerPreviewCharacter::ConfigurePreviewCharacter(const FVector& DeploymentOffset, int32 ID, int32 BudgetCost)
+void AAutobattlerPreviewCharacter::ConfigurePreviewCharacter(const FVector& DeploymentOffset, int32 ID, int32 BudgetCost, float AttackRange)
 {
 	if (!HasAuthority()) return;
 
 	PreviewCharacterCost = BudgetCost;
+	PreviewRange = AttackRange;
 	PlacementOffset = DeploymentOffset;
 	PreviewCharacterID = ID;
 
@@ -51,6 +56,7 @@ void AAutobattlerPreviewCharacter::ConfigurePreviewCharacter(const FVector& Depl
 	{
 		if (Manager->GetWhoOwnsByID(PreviewCharacterID, WhoOwns))
 		{
+			PreviewOwner = WhoOwns;
 			if (UAutobattlerControllerComponent* ControllerComponent = UAutobattlerControllerComponent::GetControllerComponentByID(this, WhoOwns))
 			{
 				ControllerComponent->OnMouseToGridLocationChanged.AddDynamic(this, &AAutobattlerPreviewCharacter::OnGridLocationChanged);
@@ -76,6 +82,12 @@ void AAutobattlerPreviewCharacter::BeginPlay()
 	}
 }
 
+void AAutobattlerPreviewCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UpdateRangeHighlight(false);
+	Super::EndPlay(EndPlayReason);
+}
+
 void AAutobattlerPreviewCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
@@ -84,6 +96,8 @@ void AAutobattlerPreviewCharacter::GetLifetimeReplicatedProps(TArray<FLifetimePr
 	DOREPLIFETIME(AAutobattlerPreviewCharacter, ShouldBeVisible);
 	DOREPLIFETIME(AAutobattlerPreviewCharacter, PreviewCharacterCost);
 	DOREPLIFETIME(AAutobattlerPreviewCharacter, FinalPlacementLocation);
+	DOREPLIFETIME(AAutobattlerPreviewCharacter, PreviewRange);
+	DOREPLIFETIME(AAutobattlerPreviewCharacter, PreviewOwner);
 }
 
 void AAutobattlerPreviewCharacter::OnRep_CanBePlaced()
@@ -94,11 +108,13 @@ void AAutobattlerPreviewCharacter::OnRep_CanBePlaced()
 void AAutobattlerPreviewCharacter::OnRep_ShouldBeVisible()
 {
 	ChangeSceneComponentVisibility(ShouldBeVisible);
+	UpdateRangeHighlight(true);
 }
 
 void AAutobattlerPreviewCharacter::OnRep_FinalPlacementLocation()
 {
 	SetActorLocation(FinalPlacementLocation);
+	UpdateRangeHighlight(true);
 }
 
 void AAutobattlerPreviewCharacter::OnCanBePlaceStateChanged_Implementation(bool NewCanBePlaced)
@@ -129,12 +145,14 @@ void AAutobattlerPreviewCharacter::OnGridLocationChanged(EEntity WhoChanged, boo
 		ShouldBeVisible = false;
 		ChangeSceneComponentVisibility(ShouldBeVisible);
 		ShowPendingBudgetCost(WhoChanged, false, 0);
+		UpdateRangeHighlight(false);
 	}
 	else
 	{
 		ShouldBeVisible = true;
 		ChangeSceneComponentVisibility(ShouldBeVisible);
 		ShowPendingBudgetCost(WhoChanged, true, PreviewCharacterCost);
+		UpdateRangeHighlight(true);
 
 		if (Manager->GetCurrentBudgetForEntity(WhoChanged) + PreviewCharacterCost > Manager->GetMaxBudgetForEntity(WhoChanged))
 		{
@@ -144,16 +162,7 @@ void AAutobattlerPreviewCharacter::OnGridLocationChanged(EEntity WhoChanged, boo
 			return;
 		}
 
-		TArray<AActor*> IgnoreActors;
-		IgnoreActors.Emplace(this);
-
-		if (Manager->GetIsBoundsOccupied(
-			CharacterDeploymentBounds->GetComponentLocation(),
-			CharacterDeploymentBounds->GetComponentRotation(),
-			CharacterDeploymentBounds->GetScaledBoxExtent(),
-			IsValid(Manager->GetAutobattlerConfigurationAsset()) ? Manager->GetAutobattlerConfigurationAsset()->GridOccupancyCollisionChannel : ECollisionChannel::ECC_Visibility,
-			IgnoreActors
-			))
+		if (Manager->GetIsGridIndexOccupied(NewGridIndex))
 		{
 			CanBePlaced = false;
 			UpdatePrimitiveComponentMaterials(CanBePlaced);
@@ -222,3 +231,18 @@ void AAutobattlerPreviewCharacter::UpdatePrimitiveComponentMaterials(bool CanPla
 		}
 	}
 }
+
+void AAutobattlerPreviewCharacter::UpdateRangeHighlight(bool ShouldHighlight)
+{
+	APlayerController* LocalController = UAutobattlerControllerComponent::GetLocalPlayerController(this);
+	UAutobattlerControllerComponent* ControllerComponent = LocalController != nullptr ? UAutobattlerFunctionLibrary::GetFirstComponent<UAutobattlerControllerComponent>(LocalController) : nullptr;
+	if (ControllerComponent == nullptr || ControllerComponent->GetIdentity() != PreviewOwner) return;
+
+	AAutobattlerManager* Manager = AAutobattlerManager::GetManager(this);
+	AAutobattlerGrid* Grid = IsValid(Manager) ? Manager->GetAutobattlerGrid() : nullptr;
+	if (!IsValid(Grid)) return;
+
+	TArray<FIntPair> IndiciesInRange;
+	if (ShouldHighlight && ShouldBeVisible) Grid->GetIndicesInRadius(FinalPlacementLocation, PreviewRange, IndiciesInRange);
+	Grid->SetIndexHighlight(IndiciesInRange, EGridHighlight::Range);
+}
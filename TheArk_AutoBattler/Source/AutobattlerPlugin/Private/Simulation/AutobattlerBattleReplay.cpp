@@ -0,0 +1,535 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+/* Class header. */
+#include "Simulation/AutobattlerBattleReplay.h"
+
+namespace AutobattlerBattleReplay
+{
+	/* Identifies replay data ("ABRP"), and the version of the format. */
+	const uint32 Magic = 0x50524241;
+	const uint16 Version = 2;
+
+	/**
+	 * Appends a value to the data.
+	 */
+	template<typename T>
+	void Write(TArray<uint8>& Data, const T& Value)
+	{
+		Data.Append(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+	}
+
+	/**
+	 * Reads a value from the data and moves past it.
+	 * @return False if the data ends before the value does.
+	 */
+	template<typename T>
+	bool Read(const TArray<uint8>& Data, int32& Offset, T& OutValue)
+	{
+		if (Offset < 0 || Offset + static_cast<int32>(sizeof(T)) > Data.Num()) return false;
+
+		FMemory::Memcpy(&OutValue, Data.GetData() + Offset, sizeof(T));
+		Offset += sizeof(T);
+		return true;
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+//// RECORDING
+/////////////////////////////////////////////////////////////////////////////////
+
+void FAutobattlerBattleReplay::BeginRecording(const FVector& NewOrigin, float NewStartTime, float SnapshotInterval)
+{
+	using namespace AutobattlerBattleReplay;
+
+	Data.Reset();
+	States.Reset();
+	RosterIndicesByID.Reset();
+	PendingFrame.Reset();
+	NumPendingLocations = 0;
+	LastQuantizedLocations.Reset();
+	FinalRoster.Reset();
+	Snapshots.Reset();
+
+	Origin = NewOrigin;
+	Winner = EWhoWins::Nobody;
+	StartTime = NewStartTime;
+	SnapshotIntervalMs = static_cast<uint32>(FMath::Max(FMath::RoundToInt(SnapshotInterval * 1000.0f), 100));
+	NextSnapshotMs = SnapshotIntervalMs;
+	PlaybackTime = 0.0f;
+	Duration = 0.0f;
+	IsRecording = true;
+
+	Write(Data, Magic);
+	Write(Data, Version);
+	Write(Data, static_cast<float>(Origin.X));
+	Write(Data, static_cast<float>(Origin.Y));
+	Write(Data, static_cast<float>(Origin.Z));
+}
+
+void FAutobattlerBattleReplay::RecordCharacter(float Time, int32 ID, EEntity WhoOwns, const FName& CharacterRowName, float MaxHealth, float Health, const FVector& Location)
+{
+	using namespace AutobattlerBattleReplay;
+
+	if (!IsRecording) return;
+
+	uint16 Index = GetRosterIndex(ID);
+	if (Index == NoCharacter)
+	{
+		if (States.Num() >= NoCharacter) return;
+
+		Index = static_cast<uint16>(States.AddDefaulted());
+		LastQuantizedLocations.AddDefaulted();
+		RosterIndicesByID.Add(ID, Index);
+	}
+
+	FCharacterState& State = States[Index];
+	State.ID = ID;
+	State.WhoOwns = WhoOwns;
+	State.CharacterRowName = CharacterRowName;
+	State.MaxHealth = MaxHealth;
+	State.Health = Health;
+	State.Location = Location;
+	State.IsDeployed = true;
+	State.IsDead = Health <= 0.0f;
+
+	int16 X, Y;
+	QuantizeLocation(Location, X, Y);
+	LastQuantizedLocations[Index] = FIntPoint(X, Y);
+
+	const FTCHARToUTF8 ConvertedName(*CharacterRowName.ToString());
+	const uint8 NameLength = static_cast<uint8>(FMath::Min(ConvertedName.Length(), static_cast<int32>(MAX_uint8)));
+
+	WriteRecordHeader(ERecordType::Character, Time);
+	Write(Data, Index);
+	Write(Data, ID);
+	Write(Data, static_cast<uint8>(WhoOwns));
+	Write(Data, NameLength);
+	Data.Append(reinterpret_cast<const uint8*>(ConvertedName.Get()), NameLength);
+	Write(Data, MaxHealth);
+	Write(Data, Health);
+	Write(Data, X);
+	Write(Data, Y);
+	Write(Data, static_cast<float>(Location.Z));
+}
+
+void FAutobattlerBattleReplay::RecordEvent(float Time, EAutobattlerSimulationEventType EventType, int32 SourceID, int32 TargetID, float Value)
+{
+	using namespace AutobattlerBattleReplay;
+
+	if (!IsRecording) return;
+
+	const uint16 TargetIndex = GetRosterIndex(TargetID);
+	if (TargetIndex != NoCharacter)
+	{
+		if (EventType == EAutobattlerSimulationEventType::Died) States[TargetIndex].IsDead = true;
+		else if (EventType == EAutobattlerSimulationEventType::Ressurected) States[TargetIndex].IsDead = false;
+	}
+
+	WriteRecordHeader(ERecordType::Event, Time);
+	Write(Data, static_cast<uint8>(EventType));
+	Write(Data, GetRosterIndex(SourceID));
+	Write(Data, TargetIndex);
+	Write(Data, Value);
+}
+
+void FAutobattlerBattleReplay::RecordHealth(float Time, int32 ID, float Health, float MaxHealth)
+{
+	using namespace AutobattlerBattleReplay;
+
+	if (!IsRecording) return;
+
+	const uint16 Index = GetRosterIndex(ID);
+	if (Index == NoCharacter || (States[Index].Health == Health && States[Index].MaxHealth == MaxHealth)) return;
+
+	States[Index].Health = Health;
+	States[Index].MaxHealth = MaxHealth;
+
+	WriteRecordHeader(ERecordType::Health, Time);
+	Write(Data, Index);
+	Write(Data, Health);
+	Write(Data, MaxHealth);
+}
+
+void FAutobattlerBattleReplay::RecordTarget(float Time, int32 ID, int32 TargetID)
+{
+	using namespace AutobattlerBattleReplay;
+
+	if (!IsRecording) return;
+
+	const uint16 Index = GetRosterIndex(ID);
+	if (Index == NoCharacter) return;
+
+	// Targets outside the roster are recorded as none, so they compare equal to it here too.
+	const uint16 TargetIndex = GetRosterIndex(TargetID);
+	const int32 RecordedTargetID = TargetIndex != NoCharacter ? TargetID : INDEX_NONE;
+	if (States[Index].TargetID == RecordedTargetID) return;
+
+	States[Index].TargetID = RecordedTargetID;
+
+	WriteRecordHeader(ERecordType::Target, Time);
+	Write(Data, Index);
+	Write(Data, TargetIndex);
+}
+
+void FAutobattlerBattleReplay::RecordLocation(int32 ID, const FVector& Location)
+{
+	using namespace AutobattlerBattleReplay;
+
+	if (!IsRecording || NumPendingLocations == MAX_uint16) return;
+
+	const uint16 Index = GetRosterIndex(ID);
+	if (Index == NoCharacter) return;
+
+	int16 X, Y;
+	QuantizeLocation(Location, X, Y);
+	if (LastQuantizedLocations[Index] == FIntPoint(X, Y)) return;
+
+	LastQuantizedLocations[Index] = FIntPoint(X, Y);
+	NumPendingLocations++;
+
+	Write(PendingFrame, Index);
+	Write(PendingFrame, X);
+	Write(PendingFrame, Y);
+}
+
+void FAutobattlerBattleReplay::RecordFrame(float Time)
+{
+	using namespace AutobattlerBattleReplay;
+
+	if (!IsRecording) return;
+
+	if (NumPendingLocations > 0)
+	{
+		WriteRecordHeader(ERecordType::Frame, Time);
+		Write(Data, NumPendingLocations);
+		Data.Append(PendingFrame);
+
+		PendingFrame.Reset();
+		NumPendingLocations = 0;
+	}
+
+	const uint32 TimeMs = static_cast<uint32>(FMath::Max(FMath::RoundToInt((Time - StartTime) * 1000.0f), 0));
+	if (TimeMs >= NextSnapshotMs)
+	{
+		WriteSnapshot(Time);
+		NextSnapshotMs = TimeMs + SnapshotIntervalMs;
+	}
+}
+
+void FAutobattlerBattleReplay::EndRecording(float Time, EWhoWins NewWinner)
+{
+	using namespace AutobattlerBattleReplay;
+
+	if (!IsRecording) return;
+
+	// Flush locations without a snapshot, as nothing can be seeked to past the end anyway.
+	NextSnapshotMs = MAX_uint32;
+	RecordFrame(Time);
+
+	Winner = NewWinner;
+	WriteRecordHeader(ERecordType::End, Time);
+	Write(Data, static_cast<uint8>(Winner));
+
+	IsRecording = false;
+}
+
+void FAutobattlerBattleReplay::WriteRecordHeader(ERecordType Type, float Time)
+{
+	using namespace AutobattlerBattleReplay;
+
+	Write(Data, static_cast<uint8>(Type));
+	Write(Data, static_cast<uint32>(FMath::Max(FMath::RoundToInt((Time - StartTime) * 1000.0f), 0)));
+}
+
+void FAutobattlerBattleReplay::WriteSnapshot(float Time)
+{
+	using namespace AutobattlerBattleReplay;
+
+	WriteRecordHeader(ERecordType::Snapshot, Time);
+	Write(Data, static_cast<uint16>(States.Num()));
+
+	for (int32 i = 0; i < States.Num(); i++)
+	{
+		Write(Data, States[i].Health);
+		Write(Data, States[i].MaxHealth);
+		Write(Data, GetRosterIndex(States[i].TargetID));
+		Write(Data, static_cast<int16>(LastQuantizedLocations[i].X));
+		Write(Data, static_cast<int16>(LastQuantizedLocations[i].Y));
+		Write(Data, static_cast<uint8>(States[i].IsDead));
+	}
+}
+
+uint16 FAutobattlerBattleReplay::GetRosterIndex(int32 ID) const
+{
+	const uint16* Index = ID != INDEX_NONE ? RosterIndicesByID.Find(ID) : nullptr;
+	return Index != nullptr ? *Index : NoCharacter;
+}
+
+void FAutobattlerBattleReplay::QuantizeLocation(const FVector& Location, int16& OutX, int16& OutY) const
+{
+	OutX = static_cast<int16>(FMath::Clamp(FMath::RoundToInt((Location.X - Origin.X) / LocationQuantum), static_cast<int32>(MIN_int16), static_cast<int32>(MAX_int16)));
+	OutY = static_cast<int16>(FMath::Clamp(FMath::RoundToInt((Location.Y - Origin.Y) / LocationQuantum), static_cast<int32>(MIN_int16), static_cast<int32>(MAX_int16)));
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+//// PLAYBACK
+/////////////////////////////////////////////////////////////////////////////////
+
+bool FAutobattlerBattleReplay::LoadFromBytes(TArray<uint8>&& Bytes)
+{
+	IsRecording = false;
+	Data = MoveTemp(Bytes);
+
+	if (IndexRecording()) return true;
+
+	Data.Reset();
+	States.Reset();
+	FinalRoster.Reset();
+	Snapshots.Reset();
+	return false;
+}
+
+bool FAutobattlerBattleReplay::BeginPlayback()
+{
+	if (IsRecording) return false;
+
+	return IndexRecording();
+}
+
+void FAutobattlerBattleReplay::SeekTo(float Time)
+{
+	using namespace AutobattlerBattleReplay;
+
+	Rewind();
+
+	const uint32 TimeMs = static_cast<uint32>(FMath::Max(FMath::FloorToInt(Time * 1000.0f), 0));
+	for (int32 i = Snapshots.Num() - 1; i >= 0; i--)
+	{
+		if (Snapshots[i].TimeMs > TimeMs) continue;
+
+		ReadOffset = Snapshots[i].Offset;
+		break;
+	}
+
+	while (ReadOffset < Data.Num())
+	{
+		int32 TimeOffset = ReadOffset + sizeof(uint8);
+		uint32 RecordTimeMs;
+		if (!Read(Data, TimeOffset, RecordTimeMs) || RecordTimeMs > TimeMs) break;
+		if (!ApplyRecord(nullptr)) ReadOffset = Data.Num();
+	}
+
+	PlaybackTime = FMath::Clamp(Time, 0.0f, Duration);
+}
+
+bool FAutobattlerBattleReplay::Advance(float DeltaTime, TArray<FAutobattlerSimulationEvent>* OutEvents)
+{
+	using namespace AutobattlerBattleReplay;
+
+	const float TargetTime = PlaybackTime + FMath::Max(DeltaTime, 0.0f);
+	const uint32 TargetTimeMs = static_cast<uint32>(FMath::FloorToInt(TargetTime * 1000.0f));
+
+	while (ReadOffset < Data.Num())
+	{
+		int32 TimeOffset = ReadOffset + sizeof(uint8);
+		uint32 RecordTimeMs;
+		if (!Read(Data, TimeOffset, RecordTimeMs) || RecordTimeMs > TargetTimeMs) break;
+		if (!ApplyRecord(OutEvents)) ReadOffset = Data.Num();
+	}
+
+	PlaybackTime = FMath::Min(TargetTime, Duration);
+	return ReadOffset < Data.Num();
+}
+
+bool FAutobattlerBattleReplay::IndexRecording()
+{
+	using namespace AutobattlerBattleReplay;
+
+	States.Reset();
+	FinalRoster.Reset();
+	Snapshots.Reset();
+	Winner = EWhoWins::Nobody;
+	Duration = 0.0f;
+
+	int32 Offset = 0;
+	uint32 FoundMagic;
+	uint16 FoundVersion;
+	float OriginX, OriginY, OriginZ;
+	if (!Read(Data, Offset, FoundMagic) || FoundMagic != Magic) return false;
+	if (!Read(Data, Offset, FoundVersion) || FoundVersion != Version) return false;
+	if (!Read(Data, Offset, OriginX) || !Read(Data, Offset, OriginY) || !Read(Data, Offset, OriginZ)) return false;
+
+	Origin = FVector(OriginX, OriginY, OriginZ);
+	FirstRecordOffset = Offset;
+
+	// Records are applied once up front; this validates them and leaves the roster as it is at the end of the battle.
+	ReadOffset = FirstRecordOffset;
+	while (ReadOffset < Data.Num())
+	{
+		int32 HeaderOffset = ReadOffset;
+		uint8 Type;
+		uint32 TimeMs;
+		if (!Read(Data, HeaderOffset, Type) || !Read(Data, HeaderOffset, TimeMs)) return false;
+
+		if (Type == static_cast<uint8>(ERecordType::Snapshot)) Snapshots.Add(FSnapshotEntry{ TimeMs, ReadOffset });
+		if (!ApplyRecord(nullptr)) return false;
+
+		Duration = FMath::Max(Duration, TimeMs / 1000.0f);
+	}
+
+	FinalRoster = States;
+	Rewind();
+	return true;
+}
+
+void FAutobattlerBattleReplay::Rewind()
+{
+	States = FinalRoster;
+	for (auto& State : States)
+	{
+		State.Health = State.MaxHealth;
+		State.TargetID = INDEX_NONE;
+		State.IsDeployed = false;
+		State.IsDead = false;
+	}
+
+	ReadOffset = FirstRecordOffset;
+	PlaybackTime = 0.0f;
+}
+
+bool FAutobattlerBattleReplay::ApplyRecord(TArray<FAutobattlerSimulationEvent>* OutEvents)
+{
+	using namespace AutobattlerBattleReplay;
+
+	uint8 Type;
+	uint32 TimeMs;
+	if (!Read(Data, ReadOffset, Type) || !Read(Data, ReadOffset, TimeMs)) return false;
+
+	switch (static_cast<ERecordType>(Type))
+	{
+	case ERecordType::Character:
+	{
+		uint16 Index;
+		int32 ID;
+		uint8 WhoOwns, NameLength;
+		if (!Read(Data, ReadOffset, Index) || Index == NoCharacter || !Read(Data, ReadOffset, ID) || !Read(Data, ReadOffset, WhoOwns) || !Read(Data, ReadOffset, NameLength)) return false;
+		if (ReadOffset + NameLength > Data.Num()) return false;
+
+		const FUTF8ToTCHAR ConvertedName(reinterpret_cast<const ANSICHAR*>(Data.GetData() + ReadOffset), NameLength);
+		ReadOffset += NameLength;
+
+		float MaxHealth, Health, Z;
+		int16 X, Y;
+		if (!Read(Data, ReadOffset, MaxHealth) || !Read(Data, ReadOffset, Health) || !Read(Data, ReadOffset, X) || !Read(Data, ReadOffset, Y) || !Read(Data, ReadOffset, Z)) return false;
+
+		if (!States.IsValidIndex(Index)) States.SetNum(Index + 1);
+		FCharacterState& State = States[Index];
+		State.ID = ID;
+		State.WhoOwns = static_cast<EEntity>(WhoOwns);
+		State.CharacterRowName = FName(FString(ConvertedName.Length(), ConvertedName.Get()));
+		State.MaxHealth = MaxHealth;
+		State.Health = Health;
+		State.TargetID = INDEX_NONE;
+		State.Location = FVector(Origin.X + X * LocationQuantum, Origin.Y + Y * LocationQuantum, Z);
+		State.IsDeployed = true;
+		State.IsDead = Health <= 0.0f;
+		return true;
+	}
+	case ERecordType::Event:
+	{
+		uint8 EventType;
+		uint16 SourceIndex, TargetIndex;
+		float Value;
+		if (!Read(Data, ReadOffset, EventType) || !Read(Data, ReadOffset, SourceIndex) || !Read(Data, ReadOffset, TargetIndex) || !Read(Data, ReadOffset, Value)) return false;
+		if (EventType >= static_cast<uint8>(EAutobattlerSimulationEventType::Count)) return false;
+
+		if (States.IsValidIndex(TargetIndex))
+		{
+			if (EventType == static_cast<uint8>(EAutobattlerSimulationEventType::Died)) States[TargetIndex].IsDead = true;
+			else if (EventType == static_cast<uint8>(EAutobattlerSimulationEventType::Ressurected)) States[TargetIndex].IsDead = false;
+		}
+
+		if (OutEvents != nullptr)
+		{
+			const int32 SourceID = States.IsValidIndex(SourceIndex) ? States[SourceIndex].ID : INDEX_NONE;
+			const int32 TargetID = States.IsValidIndex(TargetIndex) ? States[TargetIndex].ID : INDEX_NONE;
+			OutEvents->Add(FAutobattlerSimulationEvent(TimeMs / 1000.0f, static_cast<EAutobattlerSimulationEventType>(EventType), SourceID, TargetID, Value));
+		}
+		return true;
+	}
+	case ERecordType::Health:
+	{
+		uint16 Index;
+		float Health, MaxHealth;
+		if (!Read(Data, ReadOffset, Index) || !Read(Data, ReadOffset, Health) || !Read(Data, ReadOffset, MaxHealth)) return false;
+
+		if (States.IsValidIndex(Index))
+		{
+			States[Index].Health = Health;
+			States[Index].MaxHealth = MaxHealth;
+		}
+		return true;
+	}
+	case ERecordType::Target:
+	{
+		uint16 Index, TargetIndex;
+		if (!Read(Data, ReadOffset, Index) || !Read(Data, ReadOffset, TargetIndex)) return false;
+
+		if (States.IsValidIndex(Index)) States[Index].TargetID = States.IsValidIndex(TargetIndex) ? States[TargetIndex].ID : INDEX_NONE;
+		return true;
+	}
+	case ERecordType::Frame:
+	{
+		uint16 NumLocations;
+		if (!Read(Data, ReadOffset, NumLocations)) return false;
+
+		for (int32 i = 0; i < NumLocations; i++)
+		{
+			uint16 Index;
+			int16 X, Y;
+			if (!Read(Data, ReadOffset, Index) || !Read(Data, ReadOffset, X) || !Read(Data, ReadOffset, Y)) return false;
+
+			if (!States.IsValidIndex(Index)) continue;
+			States[Index].Location.X = Origin.X + X * LocationQuantum;
+			States[Index].Location.Y = Origin.Y + Y * LocationQuantum;
+		}
+		return true;
+	}
+	case ERecordType::Snapshot:
+	{
+		uint16 NumCharacters;
+		if (!Read(Data, ReadOffset, NumCharacters)) return false;
+
+		for (int32 i = 0; i < NumCharacters; i++)
+		{
+			float Health, MaxHealth;
+			uint16 TargetIndex;
+			int16 X, Y;
+			uint8 IsDead;
+			if (!Read(Data, ReadOffset, Health) || !Read(Data, ReadOffset, MaxHealth) || !Read(Data, ReadOffset, TargetIndex) || !Read(Data, ReadOffset, X) || !Read(Data, ReadOffset, Y) || !Read(Data, ReadOffset, IsDead)) return false;
+
+			if (!States.IsValidIndex(i)) continue;
+			FCharacterState& State = States[i];
+			State.Health = Health;
+			State.MaxHealth = MaxHealth;
+			State.TargetID = States.IsValidIndex(TargetIndex) ? States[TargetIndex].ID : INDEX_NONE;
+			State.Location.X = Origin.X + X * LocationQuantum;
+			State.Location.Y = Origin.Y + Y * LocationQuantum;
+			State.IsDeployed = true;
+			State.IsDead = IsDead != 0;
+		}
+		return true;
+	}
+	case ERecordType::End:
+	{
+		uint8 NewWinner;
+		if (!Read(Data, ReadOffset, NewWinner)) return false;
+
+		Winner = static_cast<EWhoWins>(NewWinner);
+		return true;
+	}
+	default:
+		return false;
+	}
+}
@@ -0,0 +1,83 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+/* Class header. */
+#include "Simulation/AutobattlerMatchupEvaluator.h"
+
+/* Autobattler includes. */
+#include "Simulation/AutobattlerSimulation.h"
+
+/* Engine includes. */
+#include "Async/ParallelFor.h"
+
+void FAutobattlerMatchupEvaluator::Evaluate(const TArray<FAutobattlerSimulationSetup>& Candidates, int32 NumBattles, int32 BaseSeed, TArray<FAutobattlerMatchupReport>& OutReports)
+{
+	OutReports.Reset();
+	OutReports.SetNum(Candidates.Num());
+	if (Candidates.Num() == 0 || NumBattles < 1) return;
+
+	struct FBattleOutcome
+	{
+		EWhoWins Winner;
+		float BattleDuration;
+	};
+
+	// One slot per battle; each work item only ever writes its own slot.
+	TArray<FBattleOutcome> Outcomes;
+	Outcomes.SetNumUninitialized(Candidates.Num() * NumBattles);
+
+	// Battle lengths vary a lot, so let the scheduler balance work dynamically rather than splitting it evenly up front.
+	ParallelFor(Outcomes.Num(), [&Candidates, &Outcomes, NumBattles, BaseSeed](int32 WorkIndex)
+	{
+		const int32 CandidateIndex = WorkIndex / NumBattles;
+		const int32 BattleIndex = WorkIndex % NumBattles;
+
+		FAutobattlerSimulationResult Result;
+		FAutobattlerSimulation::Run(Candidates[CandidateIndex], (int32)HashCombine((uint32)BaseSeed, (uint32)BattleIndex), Result);
+		Outcomes[WorkIndex] = { Result.Winner, Result.BattleDuration };
+	}, EParallelForFlags::Unbalanced);
+
+	const double Z = 1.96;
+	for (int32 CandidateIndex = 0; CandidateIndex < Candidates.Num(); CandidateIndex++)
+	{
+		FAutobattlerMatchupReport& Report = OutReports[CandidateIndex];
+		Report.CandidateIndex = CandidateIndex;
+		Report.NumBattles = NumBattles;
+		Report.IsApproximate = Candidates[CandidateIndex].GetIsApproximate();
+
+		// Welford's running mean/variance, as battle lengths are summed over many battles.
+		double Mean = 0.0;
+		double SumOfSquares = 0.0;
+		for (int32 BattleIndex = 0; BattleIndex < NumBattles; BattleIndex++)
+		{
+			const FBattleOutcome& Outcome = Outcomes[CandidateIndex * NumBattles + BattleIndex];
+			if (Outcome.Winner == EWhoWins::Enemy) Report.AIWins++;
+			else if (Outcome.Winner == EWhoWins::Players) Report.PlayerWins++;
+			else Report.Draws++;
+
+			const double Delta = Outcome.BattleDuration - Mean;
+			Mean += Delta / (BattleIndex + 1);
+			SumOfSquares += Delta * (Outcome.BattleDuration - Mean);
+		}
+
+		const double N = NumBattles;
+		const double WinRate = Report.AIWins / N;
+		const double Denominator = 1.0 + Z * Z / N;
+		const double Center = (WinRate + Z * Z / (2.0 * N)) / Denominator;
+		const double HalfWidth = Z * FMath::Sqrt(WinRate * (1.0 - WinRate) / N + Z * Z / (4.0 * N * N)) / Denominator;
+
+		Report.AIWinRate = WinRate;
+		Report.AIWinRateLower = FMath::Max(0.0, Center - HalfWidth);
+		Report.AIWinRateUpper = FMath::Min(1.0, Center + HalfWidth);
+		Report.MeanBattleDuration = Mean;
+		Report.BattleDurationConfidence = NumBattles > 1 ? Z * FMath::Sqrt(SumOfSquares / (N - 1.0)) / FMath::Sqrt(N) : 0.0;
+	}
+}
+
+void FAutobattlerMatchupEvaluator::RankByAIStrength(TArray<FAutobattlerMatchupReport>& Reports)
+{
+	Reports.StableSort([](const FAutobattlerMatchupReport& A, const FAutobattlerMatchupReport& B) {
+		if (A.AIWinRate != B.AIWinRate) return A.AIWinRate > B.AIWinRate;
+		return A.MeanBattleDuration < B.MeanBattleDuration;
+	});
+}
@@ -0,0 +1,261 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+/* Class header. */
+#include "Simulation/AutobattlerSimulation.h"
+
+/* Autobattler includes. */
+#include "AI/GetTargetDerived/GetFurthestTarget.h"
+#include "AI/GetTargetDerived/GetLowestHealthTarget.h"
+#include "AI/GetTargetDerived/GetNearestTarget.h"
+#include "AI/GetTargetDerived/GetSelfAsTarget.h"
+#include "Animation/TriggerSkill.h"
+#include "DataAssets/AutobattlerAbility.h"
+#include "DataAssets/AutobattlerConfiguration.h"
+#include "DataAssets/AutobattlerSkill.h"
+#include "Game/Components/ChargeComponentDerived/GainChargeOnExecuteAbility.h"
+#include "Game/Components/ChargeComponentDerived/GainChargeOnExecuteAttack.h"
+#include "Game/Components/ChargeComponentDerived/GainChargeOnLoseLife.h"
+#include "Game/Skills/Derived/ApplyPoison.h"
+#include "Game/Skills/Derived/DealDamage.h"
+#include "Game/Skills/Derived/Heal.h"
+#include "Game/Skills/Derived/ModifyStat.h"
+#include "Game/Skills/Derived/PrintMessage.h"
+#include "Game/Skills/Derived/Ressurect.h"
+#include "Game/Units/AutobattlerCharacter.h"
+#include "Types/AutobattlerStructs.h"
+
+/* Engine includes. */
+#include "Animation/AnimSequence.h"
+#include "Components/CapsuleComponent.h"
+
+/////////////////////////////////////////////////////////////////////////////////
+//// SETUP
+/////////////////////////////////////////////////////////////////////////////////
+
+// The core mirrors these enums value for value, so they are converted with a cast.
+static_assert((uint8)EDamageType::Count == FAutobattlerSimulationCore::NumDamageTypes, "FAutobattlerSimulationCore::NumDamageTypes must match EDamageType");
+static_assert((uint8)EResistanceType::Count == FAutobattlerSimulationCore::NumResistanceTypes, "FAutobattlerSimulationCore::NumResistanceTypes must match EResistanceType");
+static_assert((uint8)EAutobattlerSimulationEventType::Count == (uint8)FAutobattlerSimulationCore::EEventType::Count, "FAutobattlerSimulationCore::EEventType must match EAutobattlerSimulationEventType");
+static_assert((uint8)EAutobattlerStatType::Count == (uint8)FAutobattlerSimulationCore::EStatType::Count, "FAutobattlerSimulationCore::EStatType must match EAutobattlerStatType");
+static_assert((uint8)ESkillCollisionType::Count == (uint8)FAutobattlerSimulationCore::ECollisionType::Box + 1, "FAutobattlerSimulationCore::ECollisionType must match ESkillCollisionType");
+static_assert((uint8)EAbilityFilterType::Count == (uint8)FAutobattlerSimulationCore::EFilterType::All + 1, "FAutobattlerSimulationCore::EFilterType must match EAbilityFilterType");
+static_assert((uint8)EWhoWins::Nobody == (uint8)FAutobattlerSimulationCore::EWinner::Nobody, "FAutobattlerSimulationCore::EWinner must match EWhoWins");
+
+void FAutobattlerSimulationSetup::ApplyConfiguration(const UAutobattlerConfiguration* Configuration)
+{
+	if (Configuration == nullptr) return;
+
+	for (uint8 DamageType = 0; DamageType < (uint8)EDamageType::Count; DamageType++)
+	{
+		for (uint8 ResistanceType = 0; ResistanceType < (uint8)EResistanceType::Count; ResistanceType++)
+		{
+			Battle.ResistanceModifiers[DamageType][ResistanceType] = Configuration->GetDamageModifier((EDamageType)DamageType, (EResistanceType)ResistanceType);
+		}
+	}
+
+	Battle.PoisonTickRate = FMath::Max(Configuration->PoisonTickRate, 0.01f);
+	Battle.PoisonStrengthReductionRate = Configuration->PoisonStrengthReductionRate;
+	Battle.ProjectileMinDistanceToHit = Configuration->ProjectileMinDistanceToHit;
+
+	Settings.AIUpdateInterval = FMath::Max(Configuration->AIHighRateUpdateInterval, 0.01f);
+	Settings.UseAIUpdateTiers = Configuration->UseAIScheduler;
+	Settings.AILowRateUpdateInterval = FMath::Max(Configuration->AILowRateUpdateInterval, Settings.AIUpdateInterval);
+	Settings.AIPromotionDistance = Configuration->AIPromotionDistance;
+}
+
+bool FAutobattlerSimulationSetup::AddCharacter(const FAutobattlerCharacterDefinition& Definition, EEntity WhoOwns, const FVector& Location, int32 ID)
+{
+	FAutobattlerSimulationCore::FCharacter NewCharacter;
+	NewCharacter.ID = ID == INDEX_NONE ? Battle.Characters.Num() : ID;
+	NewCharacter.IsAI = WhoOwns == EEntity::AI;
+	NewCharacter.Location = Location;
+	NewCharacter.CapsuleRadius = -1.0f;
+	NewCharacter.MaxHealth = Definition.BaseHealth;
+	NewCharacter.MovementSpeed = Definition.MovementSpeed;
+	NewCharacter.CriticalChance = Definition.CriticalChance;
+	NewCharacter.CriticalMultiplier = Definition.CriticalMultiplier;
+	NewCharacter.DamageType = (uint8)Definition.BaseDamageType;
+	NewCharacter.ResistanceType = (uint8)Definition.BaseResistanceType;
+	NewCharacter.AttackIndex = FindOrAddSkill(Definition.AttackImplementation);
+	NewCharacter.AbilityIndex = FindOrAddSkill(Definition.AbilityImplementation);
+
+	if (Definition.CharacterClass.Get() != nullptr)
+	{
+		const AAutobattlerCharacter* CharacterCDO = Definition.CharacterClass->GetDefaultObject<AAutobattlerCharacter>();
+		if (CharacterCDO != nullptr && CharacterCDO->GetCapsuleComponent() != nullptr)
+		{
+			NewCharacter.CapsuleRadius = CharacterCDO->GetCapsuleComponent()->GetScaledCapsuleRadius();
+		}
+	}
+
+	Battle.Characters.Add(NewCharacter);
+	return true;
+}
+
+int32 FAutobattlerSimulationSetup::FindOrAddSkill(const UAutobattlerSkill* Skill)
+{
+	if (Skill == nullptr) return INDEX_NONE;
+	if (const int32* ExistingIndex = SkillIndices.Find(Skill)) return *ExistingIndex;
+
+	FAutobattlerSimulationCore::FSkill NewSkill;
+	NewSkill.ActionSpeed = Skill->ActionSpeed;
+	NewSkill.Range = Skill->Range;
+	NewSkill.PrimaryTargetFilter = (FAutobattlerSimulationCore::EFilterType)Skill->PrimaryTargetFilter;
+	NewSkill.IsProjectile = Skill->OnSkillTriggerEnd == ESkillTriggerEnd::Projectile;
+	NewSkill.ProjectileSpeed = FMath::Max(Skill->ProjectileSpeed, 0.0f);
+	NewSkill.HasDuration = Skill->HasDuration;
+	NewSkill.ActivatesImmediately = Skill->ActivatesImmediately;
+	NewSkill.Interval = FMath::Max(Skill->Interval, 0.1f);
+	NewSkill.NumRepetitions = Skill->NumRepetitions;
+
+	// Mirrors AAutobattlerAIController::GetAbilityTargetingProperties. Blueprint target implementations cannot run headless,
+	// so they are treated as nearest targeting.
+	const UClass* GetTargetClass = Skill->GetTargetImplementationClass.Get();
+	if (Skill->PrimaryTargetFilter == EAbilityFilterType::Self) NewSkill.Targeting = FAutobattlerSimulationCore::ETargeting::Self;
+	else if (GetTargetClass == nullptr) NewSkill.Targeting = FAutobattlerSimulationCore::ETargeting::None;
+	else if (GetTargetClass->IsChildOf(UGetSelfAsTarget::StaticClass())) NewSkill.Targeting = FAutobattlerSimulationCore::ETargeting::Self;
+	else if (GetTargetClass == UGetLowestHealthTarget::StaticClass()) NewSkill.Targeting = FAutobattlerSimulationCore::ETargeting::LowestHealth;
+	else if (GetTargetClass == UGetFurthestTarget::StaticClass()) NewSkill.Targeting = FAutobattlerSimulationCore::ETargeting::Furthest;
+	else
+	{
+		NewSkill.Targeting = FAutobattlerSimulationCore::ETargeting::Nearest;
+		if (GetTargetClass != UGetNearestTarget::StaticClass()) IsApproximate = true;
+	}
+
+	if (const UAutobattlerAbility* Ability = Cast<UAutobattlerAbility>(Skill))
+	{
+		NewSkill.IsAbility = true;
+		NewSkill.UsesCharges = Ability->AbilityTriggerType == EAbilityTriggerType::Charge;
+		NewSkill.StartOffCooldown = Ability->StartOffCooldown;
+		NewSkill.Cooldown = Ability->Cooldown;
+		NewSkill.ChargesNeededForTrigger = FMath::Max(Ability->ChargesNeededForTrigger, 1);
+
+		const UClass* ChargeComponentClass = Ability->ChargeComponentClass.Get();
+		if (NewSkill.UsesCharges && ChargeComponentClass != nullptr)
+		{
+			if (ChargeComponentClass->IsChildOf(UGainChargeOnExecuteAbility::StaticClass())) NewSkill.ChargeSource = FAutobattlerSimulationCore::EChargeSource::ExecuteAbility;
+			else if (ChargeComponentClass->IsChildOf(UGainChargeOnExecuteAttack::StaticClass())) NewSkill.ChargeSource = FAutobattlerSimulationCore::EChargeSource::ExecuteAttack;
+			else if (ChargeComponentClass->IsChildOf(UGainChargeOnLoseLife::StaticClass())) NewSkill.ChargeSource = FAutobattlerSimulationCore::EChargeSource::LoseLife;
+			else IsApproximate = true;
+		}
+	}
+
+	// Trigger time comes from the TriggerSkill notify. An animation without one never triggers its skill in engine either.
+	for (auto Animation : Skill->SkillAnimations)
+	{
+		if (Animation == nullptr) continue;
+
+		FAutobattlerSimulationCore::FAnimationTiming Timing;
+		Timing.TriggerTime = -1.0f;
+		Timing.Length = Animation->GetPlayLength();
+		for (auto& NotifyEvent : Animation->Notifies)
+		{
+			if (Cast<UTriggerSkill>(NotifyEvent.Notify) != nullptr)
+			{
+				Timing.TriggerTime = NotifyEvent.GetTriggerTime();
+				break;
+			}
+		}
+		NewSkill.Animations.Add(Timing);
+	}
+
+	for (auto SkillEffect : Skill->SkillEffects)
+	{
+		if (SkillEffect == nullptr) continue;
+
+		FAutobattlerSimulationCore::FEffect NewEffect;
+		NewEffect.CollisionType = (FAutobattlerSimulationCore::ECollisionType)SkillEffect->SkillCollisionType;
+		NewEffect.SecondaryTargetFilter = (FAutobattlerSimulationCore::EFilterType)SkillEffect->SecondaryTargetFilter;
+		NewEffect.CollisionRadius = SkillEffect->SkillCollisionRadius;
+		NewEffect.BoxExtent = SkillEffect->SkillBoxExtent.GetAbs();
+
+		if (const UDealDamage* DealDamage = Cast<UDealDamage>(SkillEffect))
+		{
+			NewEffect.Type = FAutobattlerSimulationCore::EEffectType::DealDamage;
+			NewEffect.Min = DealDamage->MinMaxDamage.Min;
+			NewEffect.Max = DealDamage->MinMaxDamage.Max;
+			NewEffect.AffectedByResistance = DealDamage->AffectedByResistance;
+			NewEffect.CanBeCritical = DealDamage->CanBeCritical;
+		}
+		else if (const UHeal* Heal = Cast<UHeal>(SkillEffect))
+		{
+			NewEffect.Type = FAutobattlerSimulationCore::EEffectType::Heal;
+			NewEffect.Min = Heal->MinMaxHeal.Min;
+			NewEffect.Max = Heal->MinMaxHeal.Max;
+		}
+		else if (const UApplyPoison* ApplyPoison = Cast<UApplyPoison>(SkillEffect))
+		{
+			NewEffect.Type = FAutobattlerSimulationCore::EEffectType::ApplyPoison;
+			NewEffect.Min = ApplyPoison->MinMaxPoison.Min;
+			NewEffect.Max = ApplyPoison->MinMaxPoison.Max;
+		}
+		else if (Cast<URessurect>(SkillEffect) != nullptr)
+		{
+			NewEffect.Type = FAutobattlerSimulationCore::EEffectType::Ressurect;
+		}
+		else if (const UModifyStat* ModifyStat = Cast<UModifyStat>(SkillEffect))
+		{
+			NewEffect.Type = FAutobattlerSimulationCore::EEffectType::ModifyStat;
+			NewEffect.StatToModify = (FAutobattlerSimulationCore::EStatType)ModifyStat->StatToModify;
+			NewEffect.Min = ModifyStat->ModifierScale;
+			NewEffect.Max = ModifyStat->ModifierScale;
+			NewEffect.IsPermanent = ModifyStat->IsPermanent;
+			NewEffect.ExpiryTime = FMath::Max(ModifyStat->ExpiryTime, 0.1f);
+		}
+		else if (Cast<UPrintMessage>(SkillEffect) == nullptr) IsApproximate = true;
+
+		NewSkill.Effects.Add(NewEffect);
+	}
+
+	const int32 NewIndex = Battle.Skills.Add(NewSkill);
+	SkillIndices.Add(Skill, NewIndex);
+	return NewIndex;
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+//// SIMULATION
+/////////////////////////////////////////////////////////////////////////////////
+
+void FAutobattlerSimulation::Run(const FAutobattlerSimulationSetup& Setup, int32 Seed, FAutobattlerSimulationResult& OutResult)
+{
+	FAutobattlerSimulationCore::FResult CoreResult;
+	FAutobattlerSimulationCore::Run(Setup.GetBattle(), ConvertSettings(Setup.Settings), Seed, CoreResult);
+	ConvertResult(CoreResult, OutResult);
+}
+
+FAutobattlerSimulationCore::FSettings FAutobattlerSimulation::ConvertSettings(const FAutobattlerSimulationSettings& Settings)
+{
+	FAutobattlerSimulationCore::FSettings CoreSettings;
+	CoreSettings.TimeStep = Settings.TimeStep;
+	CoreSettings.MaxBattleDuration = Settings.MaxBattleDuration;
+	CoreSettings.AIUpdateInterval = Settings.AIUpdateInterval;
+	CoreSettings.UseAIUpdateTiers = Settings.UseAIUpdateTiers;
+	CoreSettings.AILowRateUpdateInterval = Settings.AILowRateUpdateInterval;
+	CoreSettings.AIPromotionDistance = Settings.AIPromotionDistance;
+	CoreSettings.GridCellSize = Settings.GridCellSize;
+	CoreSettings.DefaultTriggerTime = Settings.DefaultTriggerTime;
+	CoreSettings.DefaultActionLength = Settings.DefaultActionLength;
+	CoreSettings.RessurectDuration = Settings.RessurectDuration;
+	CoreSettings.DefaultCapsuleRadius = Settings.DefaultCapsuleRadius;
+	CoreSettings.RecordEvents = Settings.RecordEvents;
+	return CoreSettings;
+}
+
+void FAutobattlerSimulation::ConvertResult(const FAutobattlerSimulationCore::FResult& CoreResult, FAutobattlerSimulationResult& OutResult)
+{
+	OutResult = FAutobattlerSimulationResult();
+	OutResult.Winner = (EWhoWins)CoreResult.Winner;
+	OutResult.BattleDuration = CoreResult.BattleDuration;
+	OutResult.Steps = CoreResult.Steps;
+	OutResult.AIUpdates = CoreResult.AIUpdates;
+	OutResult.SurvivingPlayerCharacters = CoreResult.SurvivingPlayerCharacters;
+	OutResult.SurvivingAICharacters = CoreResult.SurvivingAICharacters;
+	OutResult.Seed = CoreResult.Seed;
+
+	OutResult.Events.Reserve(CoreResult.Events.Num());
+	for (auto& Event : CoreResult.Events)
+	{
+		OutResult.Events.Emplace(Event.Time, (EAutobattlerSimulationEventType)Event.EventType, Event.SourceID, Event.TargetID, Event.Value);
+	}
+}
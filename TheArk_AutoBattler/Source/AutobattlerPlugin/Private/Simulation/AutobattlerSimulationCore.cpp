@@ -0,0 +1,632 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+/* Class header. */
+#include "Simulation/AutobattlerSimulationCore.h"
+
+/* Autobattler includes. */
+#include "AI/AutobattlerAIScheduler.h"
+
+FAutobattlerSimulationCore::FBattle::FBattle()
+{
+	for (uint8 DamageType = 0; DamageType < NumDamageTypes; DamageType++)
+	{
+		for (uint8 ResistanceType = 0; ResistanceType < NumResistanceTypes; ResistanceType++)
+		{
+			ResistanceModifiers[DamageType][ResistanceType] = 1.0f;
+		}
+	}
+}
+
+void FAutobattlerSimulationCore::Run(const FBattle& InBattle, const FSettings& InSettings, int32 Seed, FResult& OutResult)
+{
+	OutResult = FResult();
+	OutResult.Seed = Seed;
+
+	FAutobattlerSimulationCore Simulation(InBattle, InSettings, Seed, OutResult);
+	Simulation.Simulate();
+}
+
+FAutobattlerSimulationCore::FAutobattlerSimulationCore(const FBattle& InBattle, const FSettings& InSettings, int32 Seed, FResult& InResult)
+	: Battle(InBattle)
+	, Settings(InSettings)
+	, Stream(Seed)
+	, Result(InResult)
+	, Time(0.0f)
+{
+	States.SetNum(Battle.Characters.Num());
+	for (int32 i = 0; i < Battle.Characters.Num(); i++)
+	{
+		const FCharacter& Character = Battle.Characters[i];
+		FCharacterState& State = States[i];
+		State.Location = Character.Location;
+		State.MaxHealth = Character.MaxHealth;
+		State.CurrentHealth = Character.MaxHealth;
+		State.MovementSpeed = Character.MovementSpeed;
+		State.CriticalChance = Character.CriticalChance;
+		State.CriticalMultiplier = Character.CriticalMultiplier;
+
+		// Mirrors AAutobattlerAIController::OnGamePhaseChanged when the fight starts.
+		if (!Battle.Skills.IsValidIndex(Character.AbilityIndex)) continue;
+
+		const FSkill& Ability = Battle.Skills[Character.AbilityIndex];
+		if (Ability.UsesCharges) continue;
+
+		if (Ability.Cooldown <= 0.0f) State.UsesAbilityOnly = true;
+		else
+		{
+			if (Ability.StartOffCooldown) State.IsAbilityQueued = true;
+			State.CooldownEndTime = FMath::Max(Ability.Cooldown, 1.0f);
+		}
+	}
+}
+
+void FAutobattlerSimulationCore::Simulate()
+{
+	const float DeltaTime = FMath::Max(Settings.TimeStep, 0.001f);
+
+	EWinner Winner = CheckWinCondition();
+	while (Winner == EWinner::Nobody && Time < Settings.MaxBattleDuration)
+	{
+		Step(DeltaTime);
+		Result.Steps++;
+		Winner = CheckWinCondition();
+	}
+
+	Result.Winner = Winner;
+	Result.BattleDuration = Time;
+	for (int32 i = 0; i < States.Num(); i++)
+	{
+		if (States[i].GetIsDead()) continue;
+		if (Battle.Characters[i].IsAI) Result.SurvivingAICharacters++;
+		else Result.SurvivingPlayerCharacters++;
+	}
+
+	RecordEvent(EEventType::BattleEnded, INDEX_NONE, INDEX_NONE, (float)(uint8)Winner);
+}
+
+void FAutobattlerSimulationCore::Step(float DeltaTime)
+{
+	Time += DeltaTime;
+
+	// Timers first, as the timer manager runs before actors tick.
+	for (int32 i = 0; i < States.Num(); i++)
+	{
+		FCharacterState& State = States[i];
+		if (State.CooldownEndTime >= 0.0f && Time >= State.CooldownEndTime)
+		{
+			State.CooldownEndTime = -1.0f;
+			State.IsAbilityQueued = true;
+			PromoteAIUpdate(i);
+		}
+	}
+
+	for (int32 i = 0; i < StatExpiries.Num();)
+	{
+		if (Time >= StatExpiries[i].ExpiryTime)
+		{
+			const FStatExpiry Expiry = StatExpiries[i];
+			StatExpiries.RemoveAt(i);
+			ModifyStatistic(Expiry.TargetIndex, Expiry.Stat, Expiry.ModifierScale * -1.0f);
+		}
+		else i++;
+	}
+
+	for (int32 i = 0; i < DurationSkills.Num();)
+	{
+		if (Time < DurationSkills[i].NextActivation)
+		{
+			i++;
+			continue;
+		}
+
+		const FDurationSkill DurationSkill = DurationSkills[i];
+		for (auto& Effect : Battle.Skills[DurationSkill.SkillIndex].Effects) ExecuteEffect(DurationSkill.OwnerIndex, Effect, DurationSkill.TargetIndex);
+
+		FDurationSkill& UpdatedDurationSkill = DurationSkills[i];
+		UpdatedDurationSkill.NumIntervalsExpired++;
+		if (UpdatedDurationSkill.NumIntervalsExpired == Battle.Skills[DurationSkill.SkillIndex].NumRepetitions) DurationSkills.RemoveAt(i);
+		else
+		{
+			UpdatedDurationSkill.NextActivation += Battle.Skills[DurationSkill.SkillIndex].Interval;
+			i++;
+		}
+	}
+
+	for (int32 i = 0; i < States.Num(); i++)
+	{
+		while (States[i].NextPoisonTick >= 0.0f && Time >= States[i].NextPoisonTick)
+		{
+			States[i].NextPoisonTick += Battle.PoisonTickRate;
+			TickPoison(i);
+		}
+	}
+
+	// Projectiles check for arrival before moving, as FAutobattlerProjectileSystem does.
+	for (int32 i = 0; i < Projectiles.Num(); i++)
+	{
+		if (Projectiles[i].TargetIndex == INDEX_NONE) continue;
+
+		const FVector TargetLocation = States[Projectiles[i].TargetIndex].Location;
+		if (FVector::Dist(Projectiles[i].Location, TargetLocation) <= Battle.ProjectileMinDistanceToHit)
+		{
+			const FProjectile Projectile = Projectiles[i];
+			Projectiles[i].TargetIndex = INDEX_NONE;
+			ExecuteSkillList(Projectile.OwnerIndex, Projectile.SkillIndex, Projectile.TargetIndex);
+		}
+		else Projectiles[i].Location = FMath::VInterpConstantTo(Projectiles[i].Location, TargetLocation, DeltaTime, Battle.Skills[Projectiles[i].SkillIndex].ProjectileSpeed);
+	}
+	Projectiles.RemoveAll([](const FProjectile& Projectile) { return Projectile.TargetIndex == INDEX_NONE; });
+
+	for (int32 i = 0; i < States.Num(); i++)
+	{
+		FCharacterState& State = States[i];
+		switch (State.State)
+		{
+			case EState::Dead:
+				break;
+
+			case EState::Ressurecting:
+				// Mirrors AAutobattlerCharacter::EndRessurect.
+				if (Time >= State.EndTime)
+				{
+					State.State = EState::Idle;
+					State.NextAIUpdate = Time;
+					SetCurrentHealth(i, State.MaxHealth);
+					RecordEvent(EEventType::Ressurected, i, i, State.CurrentHealth);
+				}
+				break;
+
+			case EState::Acting:
+				if (!State.HasTriggered && State.TriggerTime >= 0.0f && Time >= State.TriggerTime)
+				{
+					State.HasTriggered = true;
+					ExecuteSkill(i);
+				}
+				if (States[i].State == EState::Acting && Time >= States[i].EndTime) ResetState(i);
+				break;
+
+			case EState::Idle:
+				if (Time >= State.NextAIUpdate)
+				{
+					const int32 PreviousTargetIndex = State.TargetIndex;
+					State.NextAIUpdate = Time + Settings.AIUpdateInterval;
+					AIUpdate(i);
+					ScheduleAIUpdate(i, PreviousTargetIndex);
+				}
+
+				// Out of range characters walk straight at their target (or their grid step); there is no navigation or collision.
+				if (States[i].State == EState::Idle && States[i].IsSteppingAlongGrid)
+				{
+					FCharacterState& MovingState = States[i];
+					MovingState.Location = FMath::VInterpConstantTo(MovingState.Location, MovingState.GridStepGoal, DeltaTime, MovingState.MovementSpeed);
+				}
+				else if (States[i].State == EState::Idle && States[i].TargetIndex != INDEX_NONE)
+				{
+					FCharacterState& MovingState = States[i];
+					const FVector ToTarget = States[MovingState.TargetIndex].Location - MovingState.Location;
+					const float Distance = ToTarget.Size();
+					const float DistanceToCover = Distance - MovingState.TargetRange + 1.0f;
+					if (DistanceToCover > 0.0f)
+					{
+						MovingState.Location += ToTarget.GetSafeNormal2D() * FMath::Min(MovingState.MovementSpeed * DeltaTime, DistanceToCover);
+					}
+				}
+				break;
+		}
+	}
+}
+
+void FAutobattlerSimulationCore::AIUpdate(int32 CharacterIndex)
+{
+	FCharacterState& State = States[CharacterIndex];
+	State.TargetIndex = INDEX_NONE;
+	State.IsSteppingAlongGrid = false;
+	Result.AIUpdates++;
+
+	const int32 SkillIndex = GetRelevantSkillIndex(CharacterIndex);
+	if (SkillIndex == INDEX_NONE) return;
+
+	const FSkill& Skill = Battle.Skills[SkillIndex];
+	const int32 TargetIndex = FindTarget(CharacterIndex, Skill);
+	if (TargetIndex == INDEX_NONE) return;
+
+	const float TargetCapsuleRadius = Battle.Characters[TargetIndex].CapsuleRadius >= 0.0f ? Battle.Characters[TargetIndex].CapsuleRadius : Settings.DefaultCapsuleRadius;
+	State.TargetIndex = TargetIndex;
+	State.TargetRange = Skill.Range + TargetCapsuleRadius;
+
+	const float Distance = FVector::Dist(State.Location, States[TargetIndex].Location);
+	if (Distance >= State.TargetRange)
+	{
+		// Mirrors AAutobattlerAIController::TryMoveAlongGrid, which moves one cell per update until next to the target's cell.
+		if (Settings.GridCellSize > 0.0f && Distance > Settings.GridCellSize)
+		{
+			State.IsSteppingAlongGrid = true;
+			State.GridStepGoal = State.Location + (States[TargetIndex].Location - State.Location).GetSafeNormal2D() * Settings.GridCellSize;
+		}
+		return;
+	}
+
+	// Mirrors AAutobattlerAIController::StartExecuteSkill; the animation is picked at random and its play rate sets the timing.
+	State.ActingSkillIndex = SkillIndex;
+	State.ActingAsSkill = State.IsAbilityQueued;
+
+	FAnimationTiming Timing = { Settings.DefaultTriggerTime, Settings.DefaultActionLength };
+	if (Skill.Animations.Num() > 0) Timing = Skill.Animations[Stream.RandRange(0, Skill.Animations.Num() - 1)];
+
+	const float PlayRate = FMath::Max(Skill.ActionSpeed + (State.ActingAsSkill ? State.SkillSpeedModifier : State.AttackSpeedModifier), 0.01f);
+	State.State = EState::Acting;
+	State.HasTriggered = false;
+	State.TriggerTime = Timing.TriggerTime >= 0.0f ? Time + Timing.TriggerTime / PlayRate : -1.0f;
+	State.EndTime = Time + Timing.Length / PlayRate;
+
+	RecordEvent(EEventType::ActionStarted, CharacterIndex, TargetIndex, State.ActingAsSkill ? 1.0f : 0.0f);
+}
+
+void FAutobattlerSimulationCore::ExecuteSkill(int32 CharacterIndex)
+{
+	FCharacterState& State = States[CharacterIndex];
+	const int32 SkillIndex = State.ActingSkillIndex;
+	const int32 TargetIndex = State.TargetIndex;
+	const bool ActedAsSkill = State.ActingAsSkill;
+	if (!Battle.Skills.IsValidIndex(SkillIndex) || TargetIndex == INDEX_NONE) return;
+
+	const FSkill& Skill = Battle.Skills[SkillIndex];
+	if (Skill.IsAbility) State.IsAbilityQueued = false;
+
+	RecordEvent(EEventType::SkillTriggered, CharacterIndex, TargetIndex, ActedAsSkill ? 1.0f : 0.0f);
+
+	// Mirrors AAutobattlerProjectile::InitialiseProjectile, which releases projectiles without a positive speed unexecuted.
+	if (Skill.IsProjectile)
+	{
+		if (Skill.ProjectileSpeed > 0.0f) Projectiles.Add({ CharacterIndex, TargetIndex, SkillIndex, State.Location });
+	}
+	else ExecuteSkillList(CharacterIndex, SkillIndex, TargetIndex);
+
+	if (Skill.IsAbility && !Skill.UsesCharges) States[CharacterIndex].CooldownEndTime = Time + FMath::Max(Skill.Cooldown, 1.0f);
+
+	GainCharge(CharacterIndex, ActedAsSkill ? EChargeSource::ExecuteAbility : EChargeSource::ExecuteAttack);
+}
+
+void FAutobattlerSimulationCore::ResetState(int32 CharacterIndex)
+{
+	FCharacterState& State = States[CharacterIndex];
+	if (State.ActingAsSkill) State.IsAbilityQueued = false;
+
+	const int32 PreviousTargetIndex = State.TargetIndex;
+	State.State = EState::Idle;
+	State.ActingSkillIndex = INDEX_NONE;
+	State.NextAIUpdate = Time + Settings.AIUpdateInterval;
+	AIUpdate(CharacterIndex);
+	ScheduleAIUpdate(CharacterIndex, PreviousTargetIndex);
+}
+
+void FAutobattlerSimulationCore::ScheduleAIUpdate(int32 CharacterIndex, int32 PreviousTargetIndex)
+{
+	FCharacterState& State = States[CharacterIndex];
+	if (!Settings.UseAIUpdateTiers || State.State != EState::Idle) return;
+
+	FAutobattlerAIScheduler::FSettings TierSettings;
+	TierSettings.HighRateInterval = Settings.AIUpdateInterval;
+	TierSettings.LowRateInterval = Settings.AILowRateUpdateInterval;
+	TierSettings.PromotionDistance = Settings.AIPromotionDistance;
+
+	const bool HasTarget = State.TargetIndex != INDEX_NONE;
+	const float DistanceToRange = HasTarget ? FVector::Dist(State.Location, States[State.TargetIndex].Location) - State.TargetRange : 0.0f;
+	const EAutobattlerAIUpdateTier Tier = FAutobattlerAIScheduler::ChooseTier(true, HasTarget, State.TargetIndex != PreviousTargetIndex, State.IsSteppingAlongGrid, DistanceToRange, State.MovementSpeed, TierSettings);
+	State.NextAIUpdate = Time + FAutobattlerAIScheduler::GetTierInterval(Tier, TierSettings);
+}
+
+void FAutobattlerSimulationCore::PromoteAIUpdate(int32 CharacterIndex)
+{
+	FCharacterState& State = States[CharacterIndex];
+	if (!Settings.UseAIUpdateTiers || State.State != EState::Idle) return;
+
+	State.NextAIUpdate = FMath::Min(State.NextAIUpdate, Time + Settings.AIUpdateInterval);
+}
+
+void FAutobattlerSimulationCore::WakeAIUpdatesTargeting(int32 TargetIndex)
+{
+	if (!Settings.UseAIUpdateTiers) return;
+
+	for (auto& State : States)
+	{
+		if (State.State == EState::Idle && State.TargetIndex == TargetIndex) State.NextAIUpdate = Time;
+	}
+}
+
+void FAutobattlerSimulationCore::ExecuteSkillList(int32 OwnerIndex, int32 SkillIndex, int32 TargetIndex)
+{
+	const FSkill& Skill = Battle.Skills[SkillIndex];
+	const bool ShouldExecuteSkillList = !Skill.HasDuration || Skill.ActivatesImmediately;
+	const FVector Origin = States[TargetIndex].Location;
+
+	// As in engine, a duration skill is configured once per effect, and each configuration repeats every effect.
+	for (auto& Effect : Skill.Effects)
+	{
+		if (ShouldExecuteSkillList) ExecuteEffect(OwnerIndex, Effect, TargetIndex);
+		if (Skill.HasDuration) DurationSkills.Add({ OwnerIndex, TargetIndex, SkillIndex, Time + Skill.Interval, 0 });
+
+		if (Effect.CollisionType == ECollisionType::Single) continue;
+
+		for (int32 i = 0; i < States.Num(); i++)
+		{
+			if (i == TargetIndex || !PassesFilter(OwnerIndex, i, Effect.SecondaryTargetFilter)) continue;
+
+			const float CapsuleRadius = Battle.Characters[i].CapsuleRadius >= 0.0f ? Battle.Characters[i].CapsuleRadius : Settings.DefaultCapsuleRadius;
+			const FVector Offset = States[i].Location - Origin;
+			const bool IsHit = Effect.CollisionType == ECollisionType::Sphere
+				? Offset.Size() <= Effect.CollisionRadius + CapsuleRadius
+				: FMath::Abs(Offset.X) <= Effect.BoxExtent.X + CapsuleRadius && FMath::Abs(Offset.Y) <= Effect.BoxExtent.Y + CapsuleRadius;
+			if (!IsHit) continue;
+
+			if (ShouldExecuteSkillList) ExecuteEffect(OwnerIndex, Effect, i);
+			if (Skill.HasDuration) DurationSkills.Add({ OwnerIndex, i, SkillIndex, Time + Skill.Interval, 0 });
+		}
+	}
+}
+
+void FAutobattlerSimulationCore::ExecuteEffect(int32 OwnerIndex, const FEffect& Effect, int32 TargetIndex)
+{
+	const FCharacterState& Owner = States[OwnerIndex];
+	FCharacterState& Target = States[TargetIndex];
+
+	switch (Effect.Type)
+	{
+		case EEffectType::DealDamage:
+		{
+			// Same order of random draws as UDealDamage: critical first, then damage.
+			float ResistanceModifier = 1.0f;
+			float CriticalMultiplier = 1.0f;
+			if (Effect.AffectedByResistance)
+			{
+				ResistanceModifier = Battle.ResistanceModifiers[Battle.Characters[OwnerIndex].DamageType][Battle.Characters[TargetIndex].ResistanceType];
+			}
+			if (Effect.CanBeCritical)
+			{
+				const bool IsCritical = Stream.FRandRange(0.0f, 1.0f) <= FMath::Clamp(Owner.CriticalChance, 0.0f, 1.0f);
+				CriticalMultiplier = IsCritical ? Owner.CriticalMultiplier : 1.0f;
+			}
+
+			const float DamageToDeal = FMath::RoundToFloat(Stream.FRandRange(Effect.Min, Effect.Max)) * ResistanceModifier * CriticalMultiplier;
+			RecordEvent(EEventType::Damage, OwnerIndex, TargetIndex, DamageToDeal);
+			SetCurrentHealth(TargetIndex, Target.CurrentHealth - DamageToDeal);
+			break;
+		}
+
+		case EEffectType::Heal:
+		{
+			const float PreviousHealth = Target.CurrentHealth;
+			SetCurrentHealth(TargetIndex, Target.MaxHealth + Stream.FRandRange(Effect.Min, Effect.Max));
+			RecordEvent(EEventType::Heal, OwnerIndex, TargetIndex, States[TargetIndex].CurrentHealth - PreviousHealth);
+			break;
+		}
+
+		case EEffectType::ApplyPoison:
+		{
+			const float PoisonStrength = FMath::Max(0.0f, Stream.FRandRange(Effect.Min, Effect.Max));
+			if (Target.NextPoisonTick >= 0.0f) Target.PoisonStrength += PoisonStrength;
+			else
+			{
+				// The poison timer has no initial delay, so the first tick happens on the next step.
+				Target.PoisonStrength = PoisonStrength;
+				Target.NextPoisonTick = Time;
+			}
+			RecordEvent(EEventType::PoisonApplied, OwnerIndex, TargetIndex, PoisonStrength);
+			break;
+		}
+
+		case EEffectType::Ressurect:
+			Target.CanRessurect = true;
+			break;
+
+		case EEffectType::ModifyStat:
+			if (!Effect.IsPermanent) StatExpiries.Add({ TargetIndex, Effect.StatToModify, Effect.Min, Time + Effect.ExpiryTime });
+			ModifyStatistic(TargetIndex, Effect.StatToModify, Effect.Min);
+			break;
+
+		default:
+			break;
+	}
+}
+
+void FAutobattlerSimulationCore::SetCurrentHealth(int32 CharacterIndex, float NewHealth)
+{
+	FCharacterState& State = States[CharacterIndex];
+	const float ClampedHealth = FMath::Clamp(NewHealth, 0.0f, State.MaxHealth);
+	const bool LostHealth = ClampedHealth < State.CurrentHealth;
+	State.CurrentHealth = ClampedHealth;
+
+	if (LostHealth) GainCharge(CharacterIndex, EChargeSource::LoseLife);
+
+	FCharacterState& UpdatedState = States[CharacterIndex];
+	if (UpdatedState.CurrentHealth != 0.0f) return;
+
+	if (UpdatedState.CanRessurect && !UpdatedState.HasRessurected)
+	{
+		UpdatedState.HasRessurected = true;
+		UpdatedState.State = EState::Ressurecting;
+		UpdatedState.EndTime = Time + Settings.RessurectDuration;
+		UpdatedState.TargetIndex = INDEX_NONE;
+		RecordEvent(EEventType::Died, INDEX_NONE, CharacterIndex, 0.0f);
+		DestroyProjectilesTargeting(CharacterIndex);
+		WakeAIUpdatesTargeting(CharacterIndex);
+	}
+	else if (UpdatedState.State != EState::Dead && UpdatedState.State != EState::Ressurecting)
+	{
+		// A character killed while ressurecting still gets back up, as EndRessurect does not check for death.
+		UpdatedState.State = EState::Dead;
+		UpdatedState.TargetIndex = INDEX_NONE;
+		RecordEvent(EEventType::Died, INDEX_NONE, CharacterIndex, 0.0f);
+		DestroyProjectilesTargeting(CharacterIndex);
+		WakeAIUpdatesTargeting(CharacterIndex);
+	}
+}
+
+void FAutobattlerSimulationCore::ModifyStatistic(int32 CharacterIndex, EStatType Stat, float ModifierScale)
+{
+	FCharacterState& State = States[CharacterIndex];
+	switch (Stat)
+	{
+		case EStatType::AttackSpeed:
+			State.AttackSpeedModifier += ModifierScale;
+			break;
+
+		case EStatType::SkillSpeed:
+			State.SkillSpeedModifier += ModifierScale;
+			break;
+
+		case EStatType::CriticalChance:
+			State.CriticalChance += ModifierScale;
+			break;
+
+		case EStatType::CriticalMultiplier:
+			State.CriticalMultiplier += ModifierScale;
+			break;
+
+		case EStatType::MovementSpeed:
+			State.MovementSpeed += ModifierScale;
+			break;
+
+		case EStatType::MaxHealth:
+			State.MaxHealth += ModifierScale;
+			SetCurrentHealth(CharacterIndex, State.CurrentHealth + ModifierScale);
+			break;
+
+		default:
+			break;
+	}
+}
+
+void FAutobattlerSimulationCore::GainCharge(int32 CharacterIndex, EChargeSource Source)
+{
+	const int32 AbilityIndex = Battle.Characters[CharacterIndex].AbilityIndex;
+	if (!Battle.Skills.IsValidIndex(AbilityIndex)) return;
+
+	const FSkill& Ability = Battle.Skills[AbilityIndex];
+	if (!Ability.UsesCharges || Ability.ChargeSource != Source) return;
+
+	FCharacterState& State = States[CharacterIndex];
+	State.Charges += 1;
+	if (State.Charges == Ability.ChargesNeededForTrigger)
+	{
+		State.Charges = 0;
+		State.IsAbilityQueued = true;
+		PromoteAIUpdate(CharacterIndex);
+	}
+
+	RecordEvent(EEventType::ChargeGained, CharacterIndex, CharacterIndex, (float)State.Charges);
+}
+
+void FAutobattlerSimulationCore::TickPoison(int32 CharacterIndex)
+{
+	const float PoisonStrength = States[CharacterIndex].PoisonStrength;
+	RecordEvent(EEventType::PoisonTick, INDEX_NONE, CharacterIndex, PoisonStrength);
+	SetCurrentHealth(CharacterIndex, States[CharacterIndex].CurrentHealth - PoisonStrength);
+
+	FCharacterState& State = States[CharacterIndex];
+	State.PoisonStrength -= Battle.PoisonStrengthReductionRate;
+	if (State.PoisonStrength <= 0.0f)
+	{
+		State.PoisonStrength = 0.0f;
+		State.NextPoisonTick = -1.0f;
+	}
+}
+
+void FAutobattlerSimulationCore::DestroyProjectilesTargeting(int32 CharacterIndex)
+{
+	for (auto& Projectile : Projectiles)
+	{
+		if (Projectile.TargetIndex == CharacterIndex) Projectile.TargetIndex = INDEX_NONE;
+	}
+}
+
+EWinner FAutobattlerSimulationCore::CheckWinCondition() const
+{
+	bool DidEnemyWin = true;
+	bool DidPlayersWin = true;
+	for (int32 i = 0; i < States.Num(); i++)
+	{
+		if (States[i].GetIsDead()) continue;
+		if (Battle.Characters[i].IsAI) DidPlayersWin = false;
+		else DidEnemyWin = false;
+	}
+
+	if (DidEnemyWin) return EWinner::Enemy;
+	if (DidPlayersWin) return EWinner::Players;
+	return EWinner::Nobody;
+}
+
+int32 FAutobattlerSimulationCore::FindTarget(int32 CharacterIndex, const FSkill& Skill) const
+{
+	if (Skill.Targeting == ETargeting::Self) return CharacterIndex;
+	if (Skill.Targeting == ETargeting::None) return INDEX_NONE;
+
+	// Targeting never picks the character itself, so Self and Allies (which filters down to self) finds nothing.
+	// Every mode keeps the lowest score, so furthest targeting scores by negated distance.
+	int32 BestIndex = INDEX_NONE;
+	double BestScore = TNumericLimits<double>::Max();
+	for (int32 i = 0; i < States.Num(); i++)
+	{
+		if (i == CharacterIndex || !PassesFilter(CharacterIndex, i, Skill.PrimaryTargetFilter)) continue;
+
+		double Score;
+		if (Skill.Targeting == ETargeting::LowestHealth) Score = States[i].CurrentHealth;
+		else
+		{
+			const double DistanceSquared = FVector::DistSquared(States[CharacterIndex].Location, States[i].Location);
+			Score = Skill.Targeting == ETargeting::Furthest ? -DistanceSquared : DistanceSquared;
+		}
+
+		if (Score < BestScore)
+		{
+			BestIndex = i;
+			BestScore = Score;
+		}
+	}
+
+	return BestIndex;
+}
+
+bool FAutobattlerSimulationCore::PassesFilter(int32 ContextIndex, int32 CandidateIndex, EFilterType FilterType) const
+{
+	if (States[CandidateIndex].GetIsDead()) return false;
+
+	// Every player is allied against the AI.
+	const bool IsEnemy = Battle.Characters[ContextIndex].IsAI != Battle.Characters[CandidateIndex].IsAI;
+
+	switch (FilterType)
+	{
+		case EFilterType::All:
+			return true;
+		case EFilterType::Self:
+		case EFilterType::SelfAndAllies:
+			return ContextIndex == CandidateIndex;
+		case EFilterType::AlliesOnly:
+			return ContextIndex != CandidateIndex && !IsEnemy;
+		case EFilterType::Enemies:
+			return ContextIndex != CandidateIndex && IsEnemy;
+		default:
+			return false;
+	}
+}
+
+int32 FAutobattlerSimulationCore::GetRelevantSkillIndex(int32 CharacterIndex) const
+{
+	const FCharacter& Character = Battle.Characters[CharacterIndex];
+	const FCharacterState& State = States[CharacterIndex];
+	return State.IsAbilityQueued || State.UsesAbilityOnly ? Character.AbilityIndex : Character.AttackIndex;
+}
+
+void FAutobattlerSimulationCore::RecordEvent(EEventType EventType, int32 SourceIndex, int32 TargetIndex, float Value)
+{
+	if (!Settings.RecordEvents) return;
+
+	Result.Events.Add({
+		Time,
+		EventType,
+		SourceIndex != INDEX_NONE ? Battle.Characters[SourceIndex].ID : INDEX_NONE,
+		TargetIndex != INDEX_NONE ? Battle.Characters[TargetIndex].ID : INDEX_NONE,
+		Value
+	});
+}
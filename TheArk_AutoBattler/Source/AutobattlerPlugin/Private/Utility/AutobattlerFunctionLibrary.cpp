@@ -7,6 +7,7 @@
 /* Autobattler includes. */
 #include "Core/AutobattlerManager.h"
 #include "DataAssets/AutobattlerConfiguration.h"
+#include "Game/Grid/AutobattlerSpatialHash.h"
 #include "Game/Units/AutobattlerCharacter.h"
 #include "UI/Deployment/CharacterPanel.h"
 
@@ -98,30 +99,22 @@ void UAutobattlerFunctionLibrary::ChangeInGameUIVisibility(const UObject* WorldC
     }
 }
 
-FAutobattlerCharacterDefinition* UAutobattlerFunctionLibrary::GetCharacterDefinitionFromConfigurationDatatable(const UObject* WorldContextObject, const FName& RowName)
+const FAutobattlerCharacterDefinition* UAutobattlerFunctionLibrary::GetCharacterDefinitionFromConfigurationDatatable(const UObject* WorldContextObject, const FName& RowName)
 {
-    const UAutobattlerConfiguration* ConfigurationAsset = UAutobattlerConfiguration::GetConfigurationAsset(WorldContextObject);
-	if (ConfigurationAsset == nullptr)
-	{
-		UAutobattlerFunctionLibrary::PrintErrorToLog(FString("AutobattlerFunctionLibrary : [InitialiseCharacterListings] Could not get configuration asset!"));
-		return nullptr;
-	}
+    int32 Handle = INDEX_NONE;
+    return GetCharacterDefinitionByHandle(WorldContextObject, Handle, RowName);
+}
 
-    const UDataTable* CharactersDT = ConfigurationAsset->AllCharactersDataTable;
-	if (CharactersDT->GetRowNames().Num() < 1)
-	{
-        #if WITH_EDITOR
-		PrintErrorToLog(
-			FString::Printf(TEXT("AutobattlerFunctionLibrary : [InitialiseCharacterListings] Character DT should have row structure AutobattlerCharacterDefinition but instead has %s and has %d rows!"), 
-			*CharactersDT->GetRowStructName().ToString(),
-			CharactersDT->GetRowNames().Num()
-			)
-		);
-        #endif
-		return nullptr;
-	}
+const FAutobattlerCharacterDefinition* UAutobattlerFunctionLibrary::GetCharacterDefinitionByHandle(const UObject* WorldContextObject, int32& InOutHandle, const FName& RowName)
+{
+    const UAutobattlerConfiguration* ConfigurationAsset = UAutobattlerConfiguration::GetConfigurationAsset(WorldContextObject);
+    if (ConfigurationAsset == nullptr)
+    {
+        UAutobattlerFunctionLibrary::PrintErrorToLog(FString("AutobattlerFunctionLibrary : [GetCharacterDefinitionByHandle] Could not get configuration asset!"));
+        return nullptr;
+    }
 
-    return CharactersDT->FindRow<FAutobattlerCharacterDefinition>(RowName, FString("Autobattler Character Definition"));
+    return ConfigurationAsset->ResolveCharacterDefinition(InOutHandle, RowName);
 }
 
 UBlackboardComponent* UAutobattlerFunctionLibrary::GetPawnBlackboardComponent(const APawn* PawnOwner)
@@ -168,11 +161,18 @@ void UAutobattlerFunctionLibrary::GetCharactersFiltered(TArray<AAutobattlerChara
     }
 
     TArray<AAutobattlerCharacter*> CharactersToChooseFrom;
-    for (TActorIterator<AAutobattlerCharacter> ActorItr(ContextCharacter->GetWorld()); ActorItr; ++ActorItr)
+    if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(ContextCharacter))
     {
-        AAutobattlerCharacter* CurrentCharacter = *ActorItr;
-        if (!IsValid(CurrentCharacter)) continue;
-        CharactersToChooseFrom.Emplace(CurrentCharacter);
+        Manager->GetAllDeployedCharacters(CharactersToChooseFrom);
+    }
+    else
+    {
+        for (TActorIterator<AAutobattlerCharacter> ActorItr(ContextCharacter->GetWorld()); ActorItr; ++ActorItr)
+        {
+            AAutobattlerCharacter* CurrentCharacter = *ActorItr;
+            if (!IsValid(CurrentCharacter)) continue;
+            CharactersToChooseFrom.Emplace(CurrentCharacter);
+        }
     }
 
     CharacterFilterAlgorithm(FilteredCharacters, CharactersToChooseFrom, ContextCharacter, FilterType, FilterDead);
@@ -263,35 +263,118 @@ void UAutobattlerFunctionLibrary::CharacterFilterAlgorithm(TArray<AAutobattlerCh
         return;
     }
 
-    EEntity ContextCharacterOwner = ContextCharacter->GetOwnerIdentity();
-
     if (FilterType == EAbilityFilterType::Self || FilterType == EAbilityFilterType::SelfAndAllies)
     {
-        FilteredCharacters.AddUnique(ContextCharacter);
+        FilteredCharacters.Emplace(ContextCharacter);
         return;
     }
 
+    // Callers pass each character at most once, so there is no need for AddUnique (which made filtering quadratic).
+    FilteredCharacters.Reserve(CharacterToChooseFrom.Num());
     for (auto CurrentCharacter : CharacterToChooseFrom)
     {
-        if (!IsValid(CurrentCharacter)) continue;
-        if (FilterDead && CurrentCharacter->GetIsDead()) continue;
+        if (PassesCharacterFilter(ContextCharacter, CurrentCharacter, FilterType, FilterDead)) FilteredCharacters.Emplace(CurrentCharacter);
+    }
+}
 
-        EEntity CurrentCharacterOwner = CurrentCharacter->GetOwnerIdentity();
+bool UAutobattlerFunctionLibrary::PassesCharacterFilter(const AAutobattlerCharacter* ContextCharacter, const AAutobattlerCharacter* CandidateCharacter, EAbilityFilterType FilterType, bool FilterDead)
+{
+    if (!IsValid(CandidateCharacter)) return false;
+    if (FilterDead && CandidateCharacter->GetIsDead()) return false;
 
-        if (FilterType == EAbilityFilterType::All)
-        {
-            FilteredCharacters.AddUnique(CurrentCharacter);
-        }
-        else if (FilterType == EAbilityFilterType::SelfAndAllies || FilterType == EAbilityFilterType::AlliesOnly)
-        {
-            if (ContextCharacter == CurrentCharacter) continue;
-            if (!IsEnemy(ContextCharacterOwner, CurrentCharacterOwner)) FilteredCharacters.AddUnique(CurrentCharacter);
-        }
-        else if (FilterType == EAbilityFilterType::Enemies)
-        {
-            if (ContextCharacter == CurrentCharacter) continue;
-            if (IsEnemy(ContextCharacterOwner, CurrentCharacterOwner)) FilteredCharacters.AddUnique(CurrentCharacter);
-        }
+    switch (FilterType)
+    {
+    case EAbilityFilterType::All:
+        return true;
+    case EAbilityFilterType::SelfAndAllies:
+    case EAbilityFilterType::AlliesOnly:
+        return ContextCharacter != CandidateCharacter && !IsEnemy(ContextCharacter->GetOwnerIdentity(), CandidateCharacter->GetOwnerIdentity());
+    case EAbilityFilterType::Enemies:
+        return ContextCharacter != CandidateCharacter && IsEnemy(ContextCharacter->GetOwnerIdentity(), CandidateCharacter->GetOwnerIdentity());
+    default:
+        return false;
+    }
+}
+
+const FAutobattlerSpatialHash* UAutobattlerFunctionLibrary::GetCharacterSpatialHash(const AAutobattlerCharacter* ContextCharacter)
+{
+    AAutobattlerManager* Manager = AAutobattlerManager::GetManager(ContextCharacter);
+    if (!IsValid(Manager))
+    {
+        PrintErrorToLog(FString("Autobattler Library : [GetCharacterSpatialHash] Could not get autobattler manager!"));
+        return nullptr;
+    }
+
+    return &Manager->GetCharacterSpatialHash();
+}
+
+AAutobattlerCharacter* UAutobattlerFunctionLibrary::GetNearestCharacterFiltered(AAutobattlerCharacter* ContextCharacter, EAbilityFilterType FilterType, bool FilterDead, float MaxRange)
+{
+    if (!IsValid(ContextCharacter)) return nullptr;
+    if (FilterType == EAbilityFilterType::Self || FilterType == EAbilityFilterType::SelfAndAllies) return ContextCharacter;
+
+    const FAutobattlerSpatialHash* SpatialHash = GetCharacterSpatialHash(ContextCharacter);
+    if (SpatialHash == nullptr) return nullptr;
+
+    return SpatialHash->QueryNearest(ContextCharacter->GetActorLocation(), [ContextCharacter, FilterType, FilterDead](const AAutobattlerCharacter* Candidate) {
+        return Candidate != ContextCharacter && PassesCharacterFilter(ContextCharacter, Candidate, FilterType, FilterDead);
+    }, MaxRange);
+}
+
+void UAutobattlerFunctionLibrary::GetNearestCharactersFiltered(TArray<AAutobattlerCharacter*>& FilteredCharacters, AAutobattlerCharacter* ContextCharacter, int32 Count, EAbilityFilterType FilterType, bool FilterDead, float MaxRange)
+{
+    FilteredCharacters.Empty();
+    if (!IsValid(ContextCharacter) || Count < 1) return;
+
+    if (FilterType == EAbilityFilterType::Self || FilterType == EAbilityFilterType::SelfAndAllies)
+    {
+        FilteredCharacters.Emplace(ContextCharacter);
+        return;
+    }
+
+    if (const FAutobattlerSpatialHash* SpatialHash = GetCharacterSpatialHash(ContextCharacter))
+    {
+        SpatialHash->QueryKNearest(ContextCharacter->GetActorLocation(), Count, [ContextCharacter, FilterType, FilterDead](const AAutobattlerCharacter* Candidate) {
+            return Candidate != ContextCharacter && PassesCharacterFilter(ContextCharacter, Candidate, FilterType, FilterDead);
+        }, FilteredCharacters, MaxRange);
+    }
+}
+
+void UAutobattlerFunctionLibrary::GetCharactersFilteredInRadius(TArray<AAutobattlerCharacter*>& FilteredCharacters, AAutobattlerCharacter* ContextCharacter, const FVector& Origin, float Radius, EAbilityFilterType FilterType, bool FilterDead)
+{
+    FilteredCharacters.Empty();
+    if (!IsValid(ContextCharacter)) return;
+
+    if (FilterType == EAbilityFilterType::Self || FilterType == EAbilityFilterType::SelfAndAllies)
+    {
+        FilteredCharacters.Emplace(ContextCharacter);
+        return;
+    }
+
+    if (const FAutobattlerSpatialHash* SpatialHash = GetCharacterSpatialHash(ContextCharacter))
+    {
+        SpatialHash->QueryRadius(Origin, Radius, [ContextCharacter, FilterType, FilterDead](const AAutobattlerCharacter* Candidate) {
+            return PassesCharacterFilter(ContextCharacter, Candidate, FilterType, FilterDead);
+        }, FilteredCharacters);
+    }
+}
+
+void UAutobattlerFunctionLibrary::GetCharactersFilteredInBounds(TArray<AAutobattlerCharacter*>& FilteredCharacters, AAutobattlerCharacter* ContextCharacter, const FVector& BoxOrigin, const FVector& BoxExtent, EAbilityFilterType FilterType, bool FilterDead)
+{
+    FilteredCharacters.Empty();
+    if (!IsValid(ContextCharacter)) return;
+
+    if (FilterType == EAbilityFilterType::Self || FilterType == EAbilityFilterType::SelfAndAllies)
+    {
+        FilteredCharacters.Emplace(ContextCharacter);
+        return;
+    }
+
+    if (const FAutobattlerSpatialHash* SpatialHash = GetCharacterSpatialHash(ContextCharacter))
+    {
+        SpatialHash->QueryBox(BoxOrigin, BoxExtent, [ContextCharacter, FilterType, FilterDead](const AAutobattlerCharacter* Candidate) {
+            return PassesCharacterFilter(ContextCharacter, Candidate, FilterType, FilterDead);
+        }, FilteredCharacters);
     }
 }
 
@@ -0,0 +1,157 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+/* Class header. */
+#include "Utility/AutobattlerStats.h"
+
+/* Autobattler includes. */
+#include "Core/AutobattlerManager.h"
+#include "Utility/AutobattlerFunctionLibrary.h"
+
+/* Engine includes. */
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+
+DEFINE_STAT(STAT_AutobattlerAIUpdate);
+DEFINE_STAT(STAT_AutobattlerAIScheduler);
+DEFINE_STAT(STAT_AutobattlerTargeting);
+DEFINE_STAT(STAT_AutobattlerEQSCallback);
+DEFINE_STAT(STAT_AutobattlerSkillExecution);
+DEFINE_STAT(STAT_AutobattlerDamage);
+DEFINE_STAT(STAT_AutobattlerStatusEffects);
+DEFINE_STAT(STAT_AutobattlerProjectiles);
+DEFINE_STAT(STAT_AutobattlerWinCheck);
+DEFINE_STAT(STAT_AutobattlerReplication);
+DEFINE_STAT(STAT_AutobattlerReplayRecording);
+DEFINE_STAT(STAT_AutobattlerSkillsExecuted);
+DEFINE_STAT(STAT_AutobattlerDamageEvents);
+DEFINE_STAT(STAT_AutobattlerAIUpdatesDeferred);
+
+int32 GAutobattlerLogDamage = 0;
+
+namespace AutobattlerStats
+{
+	FAutoConsoleVariableRef CVarLogDamage(
+		TEXT("Autobattler.LogDamage"),
+		GAutobattlerLogDamage,
+		TEXT("Whether every damage event is printed to the autobattler log. Only available if AUTOBATTLER_DAMAGE_LOG is compiled in.\n0: Off (default)\n1: On"),
+		ECVF_Cheat
+	);
+
+	FAutoConsoleCommandWithWorldAndArgs DumpBattleStatsCommand(
+		TEXT("Autobattler.DumpBattleStats"),
+		TEXT("Writes per-battle aggregates of this session to Saved/Profiling/Autobattler as CSV. Server only.\nAutobattler.DumpBattleStats [FileName]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (AAutobattlerManager* Manager = AAutobattlerManager::GetManager(World)) Manager->DumpBattleStats(Args.Num() > 0 ? Args[0] : FString());
+			else UAutobattlerFunctionLibrary::PrintErrorToLog(FString("Autobattler Stats : [DumpBattleStats] Could not get autobattler manager!"));
+		})
+	);
+}
+
+void FAutobattlerBattleStats::BeginBattle(double Now, int32 NumUnits)
+{
+	EndBattle(Now, EWhoWins::Nobody);
+
+	Current = FBattleSummary();
+	Current.BattleIndex = FinishedBattles.Num();
+	Current.PeakUnits = NumUnits;
+	BattleStartTime = Now;
+	FMemory::Memzero(AITickHistogram);
+	AITickMaxMicroseconds = 0.0f;
+	IsBattleActive = true;
+}
+
+void FAutobattlerBattleStats::EndBattle(double Now, EWhoWins Winner)
+{
+	if (!IsBattleActive) return;
+
+	FBattleSummary& Summary = FinishedBattles.Add_GetRef(SummarizeCurrent(Now));
+	Summary.Winner = Winner;
+
+	IsBattleActive = false;
+}
+
+void FAutobattlerBattleStats::RecordAITick(uint64 Cycles)
+{
+	if (!IsBattleActive) return;
+
+	const float Microseconds = static_cast<float>(FPlatformTime::ToMilliseconds64(Cycles) * 1000.0);
+	const int32 Bucket = FMath::Clamp(FMath::FloorToInt(FMath::Log2(Microseconds + 1.0f) * AITickBucketsPerOctave), 0, NumAITickBuckets - 1);
+	AITickHistogram[Bucket]++;
+	AITickMaxMicroseconds = FMath::Max(AITickMaxMicroseconds, Microseconds);
+	Current.NumAITicks++;
+}
+
+void FAutobattlerBattleStats::RecordProjectile(int32 NumInFlight)
+{
+	if (!IsBattleActive) return;
+
+	Current.NumProjectiles++;
+	Current.PeakProjectiles = FMath::Max(Current.PeakProjectiles, NumInFlight);
+}
+
+void FAutobattlerBattleStats::RecordDamage(float Damage)
+{
+	if (!IsBattleActive) return;
+
+	Current.NumDamageEvents++;
+	Current.TotalDamage += Damage;
+}
+
+bool FAutobattlerBattleStats::WriteCSV(const FString& FilePath, double Now) const
+{
+	TArray<FBattleSummary> Battles = FinishedBattles;
+	if (IsBattleActive) Battles.Add(SummarizeCurrent(Now));
+
+	FString CSV = TEXT("Battle,Winner,Duration,PeakUnits,Skills,SkillsPerSecond,Projectiles,PeakProjectiles,DamageEvents,TotalDamage,AITicks,AITickP50us,AITickP99us,AITickMaxus\n");
+	for (auto& Battle : Battles)
+	{
+		CSV += FString::Printf(TEXT("%d,%s,%.2f,%d,%d,%.2f,%d,%d,%d,%.1f,%d,%.2f,%.2f,%.2f\n"),
+			Battle.BattleIndex,
+			IsBattleActive && &Battle == &Battles.Last() ? TEXT("InProgress") : *UEnum::GetValueAsString(Battle.Winner),
+			Battle.Duration,
+			Battle.PeakUnits,
+			Battle.NumSkills,
+			Battle.SkillsPerSecond,
+			Battle.NumProjectiles,
+			Battle.PeakProjectiles,
+			Battle.NumDamageEvents,
+			Battle.TotalDamage,
+			Battle.NumAITicks,
+			Battle.AITickP50Microseconds,
+			Battle.AITickP99Microseconds,
+			Battle.AITickMaxMicroseconds
+		);
+	}
+
+	return FFileHelper::SaveStringToFile(CSV, *FilePath);
+}
+
+FAutobattlerBattleStats::FBattleSummary FAutobattlerBattleStats::SummarizeCurrent(double Now) const
+{
+	FBattleSummary Summary = Current;
+	Summary.Duration = static_cast<float>(FMath::Max(Now - BattleStartTime, 0.0));
+	Summary.SkillsPerSecond = Summary.Duration > 0.0f ? Summary.NumSkills / Summary.Duration : 0.0f;
+
+	Summary.AITickP50Microseconds = GetAITickPercentileMicroseconds(0.5f);
+	Summary.AITickP99Microseconds = GetAITickPercentileMicroseconds(0.99f);
+	Summary.AITickMaxMicroseconds = AITickMaxMicroseconds;
+
+	return Summary;
+}
+
+float FAutobattlerBattleStats::GetAITickPercentileMicroseconds(float Percentile) const
+{
+	if (Current.NumAITicks == 0) return 0.0f;
+
+	const uint32 Rank = static_cast<uint32>(FMath::Clamp(FMath::CeilToInt(Percentile * Current.NumAITicks), 1, Current.NumAITicks));
+	uint32 NumBelow = 0;
+	for (int32 Bucket = 0; Bucket < NumAITickBuckets; Bucket++)
+	{
+		NumBelow += AITickHistogram[Bucket];
+		if (NumBelow >= Rank) return FMath::Min(FMath::Pow(2.0f, static_cast<float>(Bucket + 1) / AITickBucketsPerOctave) - 1.0f, AITickMaxMicroseconds);
+	}
+
+	return AITickMaxMicroseconds;
+}
@@ -5,6 +5,7 @@
 
 #include "CoreMinimal.h"
 #include "AIController.h"
+#include "AI/AutobattlerAIScheduler.h"
 #include "EnvironmentQuery/EnvQueryManager.h"
 #include "EnvironmentQuery/EQSQueryResultSourceInterface.h"
 #include "EnvironmentQuery/EnvQueryTypes.h"
@@ -15,6 +16,7 @@ class AAutobattlerCharacter;
 class UAutobattlerSkill;
 class UBehaviorTree;
 class UBehaviorTreeComponent;
+class UGetTarget;
 class UEQSRenderingComponent;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnSkillExecuted, EAbilityType, AbilityExecuted);
@@ -53,8 +55,9 @@ private:
 	/* Holds current game phase. */
 	EAutobattlerPhase CurrentPhase;
 
-	/* Character listing of parent character. */
+	/* Character listing of parent character, and the handle of its baked definition. */
 	FName CharacterListingName;
+	int32 CharacterDefinitionHandle = INDEX_NONE;
 
 	/* Whether we want to execute an ability on the next cycle. */
 	bool IsAbilityQueued;
@@ -62,6 +65,10 @@ private:
 
 	/* Whether the AI should attempt an update. */
 	bool ShouldUpdate;
+
+	/* Whether native updates are run by the manager's AI scheduler rather than a timer, and whether the last update changed or lost target. */
+	bool UsesAIScheduler = false;
+	bool HasTargetChanged = false;
 	EAbilityType LastRelevantActionType;
 
 	/* Values which must be checked to see if they are still current per AI Update. */
@@ -73,9 +80,25 @@ private:
 	/* Actual move to location. */
 	FVector DesiredMoveToLocation;
 
+	/* Whether this character holds a cell reservation in the manager's grid pathfinder. */
+	bool HasGridReservation = false;
+
+	/* Targeting strategies without a native fast path, instantiated once per class and reused by every targeting update. */
+	UPROPERTY()
+	TMap<UClass*, UGetTarget*> CachedGetTargetInstances;
+
+	/* Reused by every targeting update, so filtering characters does not reallocate. */
+	TArray<AAutobattlerCharacter*> FilteredCharactersScratch;
+
+	/* How many targeting strategy objects this controller has created. Stops growing once every class it uses is cached. */
+	int32 NumGetTargetInstancesCreated = 0;
+
 	/* Marked as friend so it can update states. */
 	friend class AAutobattlerCharacter;
 
+	/* Marked as friend so it can run AI updates and read targets. */
+	friend class FAutobattlerAIScheduler;
+
 	/* EQS Debug. */
 	bool IsDebugEnabled;
 	FEnvQueryResult* LastQueryResult;
@@ -103,22 +126,41 @@ protected:
 	 */
 	virtual void BeginPlay() override;
 
+	/**
+	 * Removes this controller from the AI scheduler.
+	 * @param EndPlayReason Why play is ending.
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 /////////////////////////////////////////////////////////////////////////////////
 //// ACCESSORS
 /////////////////////////////////////////////////////////////////////////////////
 public:
 	/**
 	 * This should be called whenever the character is in the middle of doing something and so
-	 * should stop updating any properties. 
+	 * should stop updating any properties. Wakes the AI scheduler's update of this controller if set to true.
 	 * @param NewShouldUpdate True if AI updates should be fired, false otherwise.
 	 */
-	void SetShouldUpdate(bool NewShouldUpdate) { ShouldUpdate = NewShouldUpdate; }
+	void SetShouldUpdate(bool NewShouldUpdate);
 
 	/**
 	 * This should be called whenever the character's listing name changes.
 	 * @param NewListingName Listing name to set.
+	 * @param NewDefinitionHandle Handle of the baked definition of the listing, if already known.
 	 */ 
-	void SetCharacterListingName(const FName& NewListingName) { CharacterListingName = NewListingName; }
+	void SetCharacterListingName(const FName& NewListingName, int32 NewDefinitionHandle = INDEX_NONE) { CharacterListingName = NewListingName; CharacterDefinitionHandle = NewDefinitionHandle; }
+
+	/**
+	 * Getter for the character listing name of the parent character.
+	 * @return Listing name of the parent character.
+	 */
+	const FName& GetCharacterListingName() const { return CharacterListingName; }
+
+	/**
+	 * Gets the definition of the parent character by its cached handle.
+	 * @return Definition of the parent character, or nullptr if it does not exist.
+	 */
+	const FAutobattlerCharacterDefinition* GetCharacterDefinition();
 
 	/**
 	 * Setter for previous targeting properties.
@@ -188,6 +230,12 @@ public:
 	 */
 	const UAutobattlerSkill* GetRelevantSkill(EAbilityType SkillType);
 
+	/**
+	 * Gets how many targeting strategy objects this controller has created. Used to check targeting does not allocate UObjects per update.
+	 * @return Number of targeting strategy objects created.
+	 */
+	int32 GetNumGetTargetInstancesCreated() const { return NumGetTargetInstancesCreated; }
+
 	/**
 	 * Gets the last target character found by this AI controller.
 	 * @return Last target character found by this AI controller.
@@ -252,6 +300,36 @@ public:
 	 */
 	void ResetMovementState();
 
+private:
+	/**
+	 * Picks how often this controller should be updated by the AI scheduler, from the result of its last update.
+	 * @param Settings Update rates of the scheduler.
+	 * @return Tier of the next update.
+	 */
+	EAutobattlerAIUpdateTier GetAIUpdateTier(const FAutobattlerAIScheduler::FSettings& Settings) const;
+
+	/**
+	 * Schedules the next update with the AI scheduler after an update outside of it (e.g. from ResetState). Does nothing without the scheduler.
+	 */
+	void RescheduleAIUpdate();
+
+	/**
+	 * Moves one grid index towards the current target, using the manager's grid pathfinder rather than EQS.
+	 * Enemies are approached along the shared flow field; other targets, or steps another character has reserved, use A*.
+	 * Does nothing if UseGridPathfinding is disabled in the configuration.
+	 * @return Whether a move was started. If not, the caller should fall back to EQS.
+	 */
+	bool TryMoveAlongGrid();
+
+	/**
+	 * Gets this controller's instance of a targeting strategy, creating it the first time the class is used.
+	 * @param GetTargetClass Class of the targeting strategy.
+	 * @return The cached instance.
+	 */
+	UGetTarget* GetCachedGetTargetInstance(TSubclassOf<UGetTarget> GetTargetClass);
+
+public:
+
 	/**
 	 * Tries to get most relevant skill and executes it.
 	 * Stops AI updating.
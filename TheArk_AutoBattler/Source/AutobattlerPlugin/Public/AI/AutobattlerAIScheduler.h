@@ -0,0 +1,162 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AAutobattlerAIController;
+class AAutobattlerCharacter;
+class UAutobattlerConfiguration;
+
+/* How often an AI controller is updated by FAutobattlerAIScheduler. */
+enum class EAutobattlerAIUpdateTier : uint8
+{
+	High,   // Close to being in range of its target, stepping along the grid, or has just lost or changed target.
+	Low,    // Walking toward a target which is still far away, or has nothing to target.
+	Asleep  // Cannot update (acting, dead, or not fighting). Only woken by an event.
+};
+
+/**
+ * Server side scheduler of native AI updates. Replaces a looping timer per controller: every registered controller has a tier and the
+ * time its next update is due, and due updates are run oldest first, at most MaxUpdatesPerFrame of them and within FrameBudgetMs per frame.
+ * Updates which do not fit are run first on the next frame. Controllers which cannot update sleep until woken by an event
+ * (ResetState, their target dying, being revived), rather than being polled.
+ */
+class AUTOBATTLERPLUGIN_API FAutobattlerAIScheduler
+{
+public:
+	/* Update rates and budget, see the AI section of UAutobattlerConfiguration. */
+	struct FSettings
+	{
+		float HighRateInterval = 0.2f;
+		float LowRateInterval = 0.6f;
+		float PromotionDistance = 300.0f;
+		int32 MaxUpdatesPerFrame = 64;
+		float FrameBudgetMs = 1.0f;
+	};
+
+	/**
+	 * Picks the tier of a controller after an update. Shared with FAutobattlerSimulation, so both decide tiers the same way.
+	 * A unit is promoted to the high rate if it could walk to within PromotionDistance of its range before a low rate update is due.
+	 * Units stepping along the grid stay at the high rate however far they are, as they only move one cell per update.
+	 * @param CanUpdate Whether the controller can update at all.
+	 * @param HasTarget Whether the last update found a target.
+	 * @param TargetChanged Whether the last update found a different target than the one before (including losing it).
+	 * @param IsSteppingAlongGrid Whether the last update started a step to the next grid cell.
+	 * @param DistanceToRange How far the unit is from being in range of its target. Unused without a target.
+	 * @param MovementSpeed Movement speed of the unit.
+	 * @param Settings Update rates.
+	 * @return Tier to schedule the next update at.
+	 */
+	static EAutobattlerAIUpdateTier ChooseTier(bool CanUpdate, bool HasTarget, bool TargetChanged, bool IsSteppingAlongGrid, float DistanceToRange, float MovementSpeed, const FSettings& Settings);
+
+	/**
+	 * @return Seconds between updates at a tier. Asleep is never due.
+	 */
+	static double GetTierInterval(EAutobattlerAIUpdateTier Tier, const FSettings& Settings);
+
+	/**
+	 * Copies update rates and budget from the configuration asset.
+	 * @param Configuration Configuration asset to copy from.
+	 */
+	void ApplyConfiguration(const UAutobattlerConfiguration* Configuration);
+
+	/**
+	 * @return Update rates and budget in use.
+	 */
+	const FSettings& GetSettings() const { return Settings; }
+
+	/**
+	 * Adds a controller, asleep until it is rescheduled or woken. Does nothing if it is already registered.
+	 * @param Controller Controller to add.
+	 */
+	void Register(AAutobattlerAIController* Controller);
+
+	/**
+	 * Removes a controller. Safe to call while the scheduler is ticking.
+	 * @param Controller Controller to remove.
+	 */
+	void Unregister(AAutobattlerAIController* Controller);
+
+	/**
+	 * Schedules the next update of a controller which has just updated, at the tier it now wants.
+	 * @param Controller Controller which updated.
+	 * @param Now Current world time.
+	 */
+	void Reschedule(AAutobattlerAIController* Controller, double Now);
+
+	/**
+	 * Makes a controller's next update due now, at the high rate.
+	 * @param Controller Controller to wake.
+	 * @param Now Current world time.
+	 */
+	void Wake(AAutobattlerAIController* Controller, double Now);
+
+	/**
+	 * Moves a controller to the high rate, without delaying an update already due sooner. Does not wake sleeping controllers.
+	 * @param Controller Controller to promote.
+	 * @param Now Current world time.
+	 */
+	void Promote(AAutobattlerAIController* Controller, double Now);
+
+	/**
+	 * Wakes every controller whose current target is the given character, e.g. because it has just died.
+	 * @param Target Character being targeted.
+	 * @param Now Current world time.
+	 */
+	void WakeTargetersOf(const AAutobattlerCharacter* Target, double Now);
+
+	/**
+	 * Runs due updates, oldest first, until the per-frame count or time budget is used up. At least one update always runs.
+	 * @param Now Current world time.
+	 */
+	void Tick(double Now);
+
+	/**
+	 * Removes every controller.
+	 */
+	void Reset();
+
+	/**
+	 * @return Number of registered controllers.
+	 */
+	int32 Num() const { return Controllers.Num(); }
+
+	/**
+	 * @return Number of registered controllers at a tier.
+	 */
+	int32 GetNumAtTier(EAutobattlerAIUpdateTier Tier) const;
+
+	/**
+	 * @return Updates run, and due updates carried over to the next frame because the budget was used up, since the last Reset.
+	 */
+	int32 GetNumUpdates() const { return NumUpdates; }
+	int32 GetNumDeferred() const { return NumDeferred; }
+
+private:
+	/**
+	 * Removes an entry, moving the last entry into its place. Works for controllers which have already been destroyed.
+	 */
+	void RemoveEntry(const TWeakObjectPtr<AAutobattlerAIController>& Controller);
+
+	/**
+	 * Sets the tier of an entry and when its next update is due.
+	 */
+	void SetEntry(int32 Index, EAutobattlerAIUpdateTier Tier, double NextUpdateTime);
+
+	/* Registered controllers, with their tier and when their next update is due (parallel arrays). */
+	TArray<TWeakObjectPtr<AAutobattlerAIController>> Controllers;
+	TArray<EAutobattlerAIUpdateTier> Tiers;
+	TArray<double> NextUpdateTimes;
+
+	/* Index of every registered controller in the arrays above. */
+	TMap<TWeakObjectPtr<AAutobattlerAIController>, int32> IndicesByController;
+
+	/* Reused by every tick, so collecting due updates does not reallocate. */
+	TArray<TPair<double, TWeakObjectPtr<AAutobattlerAIController>>> DueScratch;
+
+	FSettings Settings;
+	int32 NumUpdates = 0;
+	int32 NumDeferred = 0;
+};
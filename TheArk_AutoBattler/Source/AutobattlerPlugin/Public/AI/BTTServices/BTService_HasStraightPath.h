@@ -36,6 +36,11 @@ public:
 	UPROPERTY(EditAnywhere, Category="Blackboard")
 	FBlackboardKeySelector HasStraightPathKey;
 
+	/* If true, and both ends are on the autobattler grid, the grid indices along the line are tested for characters instead of sweeping.
+	Off by default, since it ignores static geometry the sweep would hit. */
+	UPROPERTY(EditAnywhere, Category = "Has Straight Path")
+	bool UseGridOccupancy;
+
 	/* Radius of trace. */
 	UPROPERTY(EditAnywhere, Category = "Has Straight Path")
 	float SphereTraceRadius;
@@ -5,7 +5,18 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "AI/AutobattlerAIScheduler.h"
+#include "Core/AutobattlerReplicatedState.h"
+#include "Game/Grid/AutobattlerGridPathfinder.h"
+#include "Game/Grid/AutobattlerSpatialHash.h"
+#include "Game/Skills/AutobattlerEffectScheduler.h"
+#include "Game/Skills/AutobattlerProjectileSystem.h"
+#include "Game/Skills/AutobattlerSkillActorPool.h"
+#include "Simulation/AutobattlerBattleReplay.h"
+#include "Simulation/AutobattlerMatchupEvaluator.h"
+#include "Simulation/AutobattlerSimulation.h"
 #include "Types/AutobattlerStructs.h"
+#include "Utility/AutobattlerStats.h"
 #include "AutobattlerManager.generated.h"
 
 class AAutobattlerCharacter;
@@ -30,9 +41,9 @@ struct FIdentityConfiguration
 {
 	GENERATED_BODY()
 public:
-	/* Where on the grid are we allowed to deploy. Not relevant for player 0, aka the AI. */
+	/* Where on the grid are we allowed to deploy, one bit per grid index laid out as in AAutobattlerGrid::BuildIndexMask. Not relevant for player 0, aka the AI. */
 	UPROPERTY()
-	TArray<FIntPair> AllowedDeploymentIndicies;
+	TArray<uint32> DeploymentZoneMask;
 
 	/* The max budget for the identity. Budget, in the context of the autobattler, means a total number of "points," which each units cost. Entities (AI and players) cannot deploy
 	more than their budget can afford. */
@@ -44,6 +55,44 @@ public:
 	TMap<int32, FCharacterListing> Characters;
 };
 
+/* Internal structure describing a deployed character held in the manager's character registry. */
+USTRUCT()
+struct FRegisteredCharacter
+{
+	GENERATED_BODY()
+public:
+	/* The deployed character. */
+	UPROPERTY()
+	AAutobattlerCharacter* Character = nullptr;
+
+	/* Who owns the character. Cached so the character can still be unregistered while it is being destroyed. */
+	UPROPERTY()
+	EEntity WhoOwns = EEntity::AI;
+
+	/* Budget cost of the character when it was deployed. */
+	UPROPERTY()
+	int32 BudgetCost = 0;
+};
+
+/* Internal structure partitioning the registered characters of a single identity by alive/dead state. */
+USTRUCT()
+struct FCharacterRegistryPartition
+{
+	GENERATED_BODY()
+public:
+	/* IDs of deployed characters which are alive. */
+	UPROPERTY()
+	TSet<int32> AliveIDs;
+
+	/* IDs of deployed characters which are dead, but have not yet been removed from the battlefield. */
+	UPROPERTY()
+	TSet<int32> DeadIDs;
+
+	/* Sum of the budget costs of all deployed characters (alive or dead). */
+	UPROPERTY()
+	int32 DeployedBudget = 0;
+};
+
 /**
  * Actor of which there only should be one per game. Handles managing the autobattler. Most functionality is server-side only.
  */
@@ -136,6 +185,95 @@ private:
 	UPROPERTY()
 	TMap<EEntity, FIdentityConfiguration> IdentityConfigurations;
 
+	/* Server only. Who owns every character added for an identity, keyed by ID. Mirrors the identities' character maps. */
+	UPROPERTY()
+	TMap<int32, EEntity> OwnersByID;
+
+	/* Server only. Every deployed character keyed by its ID, so queries do not have to scan the world for characters. */
+	UPROPERTY()
+	TMap<int32, FRegisteredCharacter> CharacterRegistry;
+
+	/* Server only. IDs held in the character registry, partitioned by identity and alive/dead state. */
+	UPROPERTY()
+	TMap<EEntity, FCharacterRegistryPartition> CharacterRegistryPartitions;
+
+	/* Spatial hash over deployed characters, used for target acquisition. Rebuilt lazily, at most once per frame. */
+	FAutobattlerSpatialHash CharacterSpatialHash;
+
+	/* Frame on which the spatial hash was last rebuilt. */
+	uint64 CharacterSpatialHashFrame = 0;
+
+	/* Whether the spatial hash must be rebuilt on next use even if it was already built this frame (e.g. a character was removed). */
+	bool IsCharacterSpatialHashDirty = true;
+
+	/* Server only. Flow fields and A* over the grid, used to move characters. Occupancy is refreshed lazily, at most once per frame. */
+	FAutobattlerGridPathfinder GridPathfinder;
+
+	/* Frame on which grid pathfinder occupancy was last refreshed. */
+	uint64 GridPathfinderFrame = 0;
+
+	/* Server only. Every timed effect on deployed characters. */
+	FAutobattlerEffectScheduler EffectScheduler;
+
+	/* Server only. Every projectile in flight. */
+	FAutobattlerProjectileSystem ProjectileSystem;
+
+	/* Server only. Native AI updates of every controller, ticked during the fight. */
+	FAutobattlerAIScheduler AIScheduler;
+
+	/* Server only. Pooled skill executors and projectiles. */
+	UPROPERTY()
+	FAutobattlerSkillActorPool SkillActorPool;
+
+	/* Server only. Instance of WinConditionClass, created once and reused every time the win condition is checked. */
+	UPROPERTY()
+	UWinConditionBase* WinConditionInstance;
+
+	/* Rosters of every entity, replicated as a fast array so clients (including late joiners) only receive changes. */
+	UPROPERTY(Replicated)
+	FAutobattlerRosterArray ReplicatedRoster;
+
+	/* Budget, float and grid visibility state of every entity, replicated as a fast array. */
+	UPROPERTY(Replicated)
+	FAutobattlerEntityStateArray ReplicatedEntityStates;
+
+	/* Per-cell grid visibility, replicated as a fast array. Built lazily once the grid is known. */
+	UPROPERTY(Replicated)
+	FAutobattlerGridCellArray ReplicatedGridCells;
+
+	/* Server only. Bytes sent by the replicated state above, and bytes the multicast path sends (or would send) for the same changes. */
+	FAutobattlerReplicationStats ReplicationStats;
+
+	/* Client only. Whether the grid should be updated from the replicated cells on the next tick. */
+	bool IsReplicatedGridVisibilityDirty = false;
+
+	/* Server only. Characters spawned by a running replication soak benchmark, see BenchmarkReplicationSoak. */
+	TArray<TWeakObjectPtr<AAutobattlerCharacter>> SoakCharacters;
+
+	/* Server only. Timers driving the replication soak benchmark: changing characters, sampling, and ending it. */
+	FTimerHandle SoakChurnTimerHandle;
+	FTimerHandle SoakSampleTimerHandle;
+	FTimerHandle SoakEndTimerHandle;
+
+	/* Server only. Replication soak benchmark totals: samples taken, and summed per connection averages of each sample. */
+	int32 NumSoakSamples = 0;
+	double SoakBytesPerConnectionSum = 0.0;
+	double SoakGameThreadMsPerConnectionSum = 0.0;
+	int32 SoakMaxConnections = 0;
+
+	/* Server only. Recording of the current (or last) battle. */
+	FAutobattlerBattleReplay BattleReplay;
+
+	/* Server only. Seconds since character locations were last written to the battle replay. */
+	float ReplayFrameAccumulator = 0.0f;
+
+	/* Server only. Time spent recording the current (or last) battle, and the summed server frame time it lasted, in seconds. */
+	uint64 ReplayRecordingCycles = 0;
+	double ReplayBattleSeconds = 0.0;
+
+	/* Server only. Per-battle aggregates of this session, see DumpBattleStats. */
+	FAutobattlerBattleStats BattleStats;
+
 	/* Used to generate IDs  */
 	int32 IDDispenser;
 
@@ -167,12 +305,28 @@ public:
 	*/
 	void Setup(int32 InNumberOfPlayers);
 
+	/**
+	 * Points the replicated state at this manager, so it can notify it when changes arrive.
+	 */
+	virtual void PostInitProperties() override;
+
 protected:
 	/**
 	 * Initialises instance. Asserts if there are more than 2 of these in the world.
 	 */
 	virtual void BeginPlay() override;
 
+	/**
+	 * Unregisters from the world subsystem, so a streamed out or destroyed manager is no longer handed out.
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	/**
+	 * Ticks the effect scheduler and moves projectiles. Only enabled on the server, during the fight and while projectiles are in flight.
+	 */
+	virtual void Tick(float DeltaSeconds) override;
+
 private:
 	/**
 	 * SERVER-ONLY
@@ -187,7 +341,7 @@ private:
 /////////////////////////////////////////////////////////////////////////////////
 public:
 	/**
-	 * Static getter for the autobattler manager.
+	 * Static getter for the autobattler manager. Cached by UAutobattlerWorldSubsystem, so it is cheap to call.
 	 * @return The autobattler manager.
 	 */
 	UFUNCTION(BlueprintPure, Category = "Autobattler", meta = (WorldContext = "WorldContextObject"))
@@ -257,6 +411,78 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Autobattler")
 	void GetIDsOfDeployedCharacters(TArray<int32>& DeployedCharacterIDs, EEntity WhoOwns) const;
 
+	/**
+	 * Gets all deployed characters belonging to WhoOwns which are not dead.
+	 * @param AliveCharacters (OUT) Characters deployed who are owned by WhoOwns and are alive.
+	 * @param WhoOwns Identity who owns the characters.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Autobattler")
+	void GetAliveCharactersByEntity(TArray<AAutobattlerCharacter*>& AliveCharacters, EEntity WhoOwns) const;
+
+	/**
+	 * Gets every deployed character, regardless of who owns it or whether it is alive.
+	 * @param DeployedCharacters (OUT) All deployed characters.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Autobattler")
+	void GetAllDeployedCharacters(TArray<AAutobattlerCharacter*>& DeployedCharacters) const;
+
+	/**
+	 * Gets the spatial hash of deployed characters, rebuilding it first if it has not been built this frame.
+	 * Cells are sized and aligned to the autobattler grid.
+	 * @return Spatial hash of deployed characters.
+	 */
+	const FAutobattlerSpatialHash& GetCharacterSpatialHash();
+
+	/**
+	 * SERVER-ONLY
+	 * Gets the grid pathfinder, first refreshing its occupancy from alive characters if that has not been done this frame.
+	 * Flow fields are only rebuilt if a character has moved to another grid index since they were last read.
+	 * @return The grid pathfinder.
+	 */
+	FAutobattlerGridPathfinder& GetGridPathfinder();
+
+	/**
+	 * SERVER-ONLY
+	 * Gets the scheduler which ticks every timed effect (temporary stat and type changes, poison, repeating skills).
+	 * Effects on a character are cancelled when it dies, and all effects are dropped when the fight ends.
+	 * @return The effect scheduler.
+	 */
+	FAutobattlerEffectScheduler& GetEffectScheduler() { return EffectScheduler; }
+
+	/**
+	 * SERVER-ONLY
+	 * Gets the system which moves every projectile in flight. Ticking has to be enabled after adding a projectile outside of the fight.
+	 * @return The projectile system.
+	 */
+	FAutobattlerProjectileSystem& GetProjectileSystem() { return ProjectileSystem; }
+
+	/**
+	 * SERVER-ONLY
+	 * Gets the scheduler which runs native AI updates, if UseAIScheduler is set in the configuration. Controllers register themselves.
+	 * @return The AI scheduler.
+	 */
+	FAutobattlerAIScheduler& GetAIScheduler() { return AIScheduler; }
+
+	/**
+	 * @return Per-battle aggregates of this session. Only collected on the server.
+	 */
+	FAutobattlerBattleStats& GetBattleStats() { return BattleStats; }
+
+	/**
+	 * SERVER-ONLY
+	 * Gets the pool which skill executors and projectiles are taken from and returned to.
+	 * @return The skill actor pool.
+	 */
+	FAutobattlerSkillActorPool& GetSkillActorPool() { return SkillActorPool; }
+
+	/**
+	 * SERVER-ONLY
+	 * Gets how many skill actors have been spawned and how often the pool could serve a request.
+	 * @return Skill actor pool counters.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Autobattler|Debug")
+	FAutobattlerActorPoolStats GetSkillActorPoolStats() const { return SkillActorPool.GetStats(); }
+
 	/**
 	 * Getter for WhoOwns by a character ID.
 	 * @param ID Character ID
@@ -277,7 +503,7 @@ public:
 
 	/**
 	 * Server-only.
-	 * Checks to see if a deployment index is occupied by another (already deployed) character .
+	 * Checks to see if a deployment index is occupied by another (already deployed) character. Reads the grid's occupancy bitmap, no physics queries are made.
 	 * @param IndexToTest Index we want to check is occupied.
 	 * @return True if occupied, false if not occupied (always false on client).
 	 */
@@ -305,6 +531,30 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Autobattler")
 	bool GetCanPlayerDeployOnIndex(EEntity WhoOwns, const FIntPair& IndexToTest) const;
 
+	/**
+	 * Server-only.
+	 * Gets every index WhoOwns can deploy a character on right now, i.e. its deployment indicies which are not occupied.
+	 * @param WhoOwns "Owner" or player who checks where they can deploy.
+	 * @param LegalIndicies (OUT) Indicies which can be deployed on.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler")
+	void GetLegalDeploymentIndicies(EEntity WhoOwns, TArray<FIntPair>& LegalIndicies) const;
+
+	/**
+	 * Server-only.
+	 * Updates which grid index a deployed character occupies from its current location. Should be called after a character is moved during setup.
+	 * @param Character Character which was moved.
+	 */
+	void RefreshCharacterGridOccupancy(AAutobattlerCharacter* Character);
+
+	/**
+	 * Server-only.
+	 * Replicates whether a grid index is occupied, so clients can highlight it. Called by the grid whenever its occupancy changes.
+	 * @param GridIndex Grid index which changed.
+	 * @param IsOccupied Whether a character is deployed on it.
+	 */
+	void SetReplicatedGridCellOccupied(const FIntPair& GridIndex, bool IsOccupied);
+
 /////////////////////////////////////////////////////////////////////////////////
 //// GAME
 /////////////////////////////////////////////////////////////////////////////////
@@ -359,6 +609,50 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Autobattler")
 	bool RemoveDeploymentIndexForPlayer(EEntity WhoOwns, const FIntPair& IndexToRemove);
 
+	/**
+	 * SERVER-ONLY
+	 * Combines a rectangle of grid indicies with a player's deployment zone.
+	 * @param WhoOwns Which identity to change the deployment zone of.
+	 * @param Corner First corner of the rectangle (inclusive).
+	 * @param OppositeCorner Opposite corner of the rectangle (inclusive). The rectangle is clamped to the grid.
+	 * @param Operation How the rectangle is combined with the zone.
+	 * @return Whether the zone could be changed (requires a grid).
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler")
+	bool ModifyDeploymentZoneByRectangle(EEntity WhoOwns, const FIntPair& Corner, const FIntPair& OppositeCorner, EDeploymentZoneOperation Operation = EDeploymentZoneOperation::Add);
+
+	/**
+	 * SERVER-ONLY
+	 * Combines every grid index reachable from a start index (by orthogonal steps, without crossing the boundary) with a player's deployment zone.
+	 * @param WhoOwns Which identity to change the deployment zone of.
+	 * @param Start Grid index to fill from.
+	 * @param Boundary Grid indicies the fill may not cross.
+	 * @param Operation How the filled indicies are combined with the zone.
+	 * @return Whether the zone could be changed (requires a grid).
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler")
+	bool ModifyDeploymentZoneByFloodFill(EEntity WhoOwns, const FIntPair& Start, const TArray<FIntPair>& Boundary, EDeploymentZoneOperation Operation = EDeploymentZoneOperation::Add);
+
+	/**
+	 * SERVER-ONLY
+	 * Combines a set of grid indicies with a player's deployment zone. Invalid indicies are skipped.
+	 * @param WhoOwns Which identity to change the deployment zone of.
+	 * @param Indicies Grid indicies to combine with the zone.
+	 * @param Operation How the indicies are combined with the zone.
+	 * @return Whether the zone could be changed (requires a grid).
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler")
+	bool ModifyDeploymentZoneByIndicies(EEntity WhoOwns, const TArray<FIntPair>& Indicies, EDeploymentZoneOperation Operation = EDeploymentZoneOperation::Add);
+
+	/**
+	 * SERVER-ONLY
+	 * Gets every grid index in a player's deployment zone.
+	 * @param WhoOwns Which identity to get the deployment zone of.
+	 * @param OutIndicies (OUT) Grid indicies in the zone.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler")
+	void GetDeploymentZoneForPlayer(EEntity WhoOwns, TArray<FIntPair>& OutIndicies) const;
+
 	/**
 	 * SERVER-ONLY
 	 * Adds a character which can be deployed for a given identity.
@@ -462,6 +756,32 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Autobattler|AI")
 	bool GenerateAIFormation(const FName& FormationRowName, const TArray<FName>& WhiteList, const TArray<FName>& Blacklist, bool ClearPrevious = false);
 
+	/**
+	 * Deploys AI characters at the given grid indices, e.g. the placements of a report from EvaluateAIFormation.
+	 * @param Placements AI character IDs mapped to the grid index they should be deployed at.
+	 * @param ClearPrevious If true, AI characters already deployed are removed first.
+	 * @return Whether the formation was deployed.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler|AI")
+	bool DeployAIFormation(const TMap<int32, FIntPair>& Placements, bool ClearPrevious = false);
+
+	/**
+	 * SERVER-ONLY
+	 * Generates candidate AI formations the same way GenerateAIFormation does, simulates each of them against the currently
+	 * deployed player characters many times (see FAutobattlerMatchupEvaluator), and ranks them from hardest to easiest.
+	 * Nothing is deployed. Candidates which turn out identical are only evaluated once.
+	 * @param FormationRowName Formation to read from configuration.
+	 * @param WhiteList Characters with tags on whitelist will be considered for deployment.
+	 * @param Blacklist Characters with tags on blacklist will never be considered for deployment.
+	 * @param NumCandidates How many candidate formations to generate.
+	 * @param BattlesPerCandidate How many battles to simulate per candidate.
+	 * @param Seed Random seed. The same roster, formation and seed always produce the same reports.
+	 * @param Reports (OUT) One report per distinct candidate, hardest for the player first.
+	 * @return Whether the candidates could be generated and evaluated.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler|AI")
+	bool EvaluateAIFormation(const FName& FormationRowName, const TArray<FName>& WhiteList, const TArray<FName>& Blacklist, int32 NumCandidates, int32 BattlesPerCandidate, int32 Seed, TArray<FAutobattlerMatchupReport>& Reports);
+
 	/**
 	 * Generates a battle from a debug configuration (used for testing purposes).
 	 * @param DebugBattleRowName Row name of config from debug config datatable.
@@ -504,8 +824,8 @@ public:
 	void ClearStateForEntity(EEntity WhoOwns);
 
 	/**
-	 * Requests changing the visibility of the a grid for a given entity. Indicies shown
-	 * depending on their configuration.
+	 * Requests changing the visibility of the a grid for a given entity. Only indicies the entity
+	 * can currently deploy on are shown.
 	 * @param WhoOwns Entity we want change grid visualisation for.
 	 * @param bGridVisible Whether the grid is meant to be visible or not.
 	 */
@@ -549,6 +869,51 @@ private:
 	 */
 	void GenerateFormationTags(TArray<FName>& ChosenTags, const TArray<FTagRandomiserParameters>& RandomiserParams);
 
+/////////////////////////////////////////////////////////////////////////////////
+//// CHARACTER REGISTRY
+/////////////////////////////////////////////////////////////////////////////////
+private:
+	/**
+	 * SERVER-ONLY
+	 * Adds a deployed character to the character registry. If a character is already registered with the same ID, it is replaced.
+	 * @param Character Character to register.
+	 * @param ID ID to register the character under.
+	 * @param WhoOwns Who owns the character.
+	 */
+	void RegisterCharacter(AAutobattlerCharacter* Character, int32 ID, EEntity WhoOwns);
+
+	/**
+	 * SERVER-ONLY
+	 * Removes a character from the character registry.
+	 * @param ID ID of the character to unregister.
+	 * @param ExpectedCharacter If set, the entry is only removed if it refers to this character (guards against a stale character removing its redeployed replacement).
+	 * @return True if an entry was removed.
+	 */
+	bool UnregisterCharacter(int32 ID, const AAutobattlerCharacter* ExpectedCharacter = nullptr);
+
+	/**
+	 * SERVER-ONLY
+	 * Moves a registered character between the alive and dead partitions.
+	 * @param ID ID of the registered character.
+	 * @param IsDead Whether the character is now dead.
+	 */
+	void SetRegisteredCharacterDead(int32 ID, bool IsDead);
+
+	/**
+	 * Finds deployed characters by scanning every actor in the world. Used on clients, where the registry is not maintained.
+	 * @param DeployedCharacters (OUT) Characters deployed who are owned by WhoOwns.
+	 * @param WhoOwns Identity who owns the characters.
+	 * @param AliveOnly If true, dead characters are skipped.
+	 */
+	void GetDeployedCharactersFromWorld(TArray<AAutobattlerCharacter*>& DeployedCharacters, EEntity WhoOwns, bool AliveOnly) const;
+
+	/**
+	 * Finds a deployed character by scanning every actor in the world. Used on clients, where the registry is not maintained.
+	 * @param ID ID of the character.
+	 * @return The character with the given ID, or nullptr if none is deployed.
+	 */
+	AAutobattlerCharacter* FindDeployedCharacterInWorld(int32 ID) const;
+
 /////////////////////////////////////////////////////////////////////////////////
 //// NETWORKING
 /////////////////////////////////////////////////////////////////////////////////
@@ -644,6 +1009,200 @@ private:
 	UFUNCTION(NetMulticast, Reliable, Category = "Autobattler")
 	void Multicast_ClearInvalidCharacterPanels();
 
+	/**
+	 * @return Whether rosters, budgets, float state and grid visibility are sent as replicated state rather than multicasts.
+	 */
+	bool GetUsesFastArrayReplication() const;
+
+	/**
+	 * SERVER-ONLY
+	 * Announces a character added for a player, through the replicated roster or a multicast.
+	 */
+	void NotifyCharacterAdded(int32 ID, const FCharacterListing& NewCharacterListing, EEntity WhoOwns, bool DidGeneratePanelActor);
+
+	/**
+	 * SERVER-ONLY
+	 * Announces a character removed for a player. Returning to barracks leaves the roster unchanged, so it is always multicast.
+	 */
+	void NotifyCharacterRemoved(int32 ID, EEntity WhoOwns, bool WasReturnedToBarracks);
+
+	/**
+	 * SERVER-ONLY
+	 * Announces that a player has begun floating a character.
+	 */
+	void NotifyFloatBegun(EEntity WhoOwns, int32 CharacterID);
+
+	/**
+	 * SERVER-ONLY
+	 * Announces that a player's float has ended.
+	 * @param WasCancelled Whether the float was cancelled (rather than ending in a deployment).
+	 * @param FloatedCharacterListing Listing of the floated character, announced if cancelled.
+	 */
+	void NotifyFloatEnded(EEntity WhoOwns, int32 CharacterID, bool WasCancelled, const FCharacterListing& FloatedCharacterListing);
+
+	/**
+	 * SERVER-ONLY
+	 * Announces a new max budget for a player.
+	 */
+	void NotifyMaxBudgetChange(EEntity WhoOwns, int32 NewBudget);
+
+	/**
+	 * SERVER-ONLY
+	 * Changes which grid indicies a player sees, through the replicated grid cells or a multicast.
+	 * @param WhoOwns For which player to change visual state for.
+	 * @param Show Whether to show (true) or hide completely (false).
+	 * @param IndiciesToShow Which grid indicies to show if Show = true.
+	 */
+	void RequestIndexVisibilityChange(EEntity WhoOwns, bool Show, const TArray<FIntPair>& IndiciesToShow);
+
+	/**
+	 * SERVER-ONLY
+	 * Creates one replicated cell per grid index, if the grid size has changed since they were created.
+	 */
+	void EnsureReplicatedGridCells();
+
+	/**
+	 * Shows the grid indicies the local player should see, according to the replicated state. On clients, also highlights the
+	 * occupied indicies.
+	 */
+	void ApplyReplicatedGridVisibility();
+
+	/**
+	 * SERVER-ONLY
+	 * Counts the payload of a multicast towards the replication stats, once per connection it is sent to.
+	 * @param PayloadBytes Estimated size of the multicast's parameters.
+	 */
+	void RecordMulticastPayload(int32 PayloadBytes);
+
+	/**
+	 * SERVER-ONLY
+	 * Combines a mask with a player's deployment zone, a word at a time. Creates the identity configuration if needed.
+	 * @param WhoOwns Which identity to change the deployment zone of.
+	 * @param Mask Mask built by the grid.
+	 * @param Operation How the mask is combined with the zone.
+	 */
+	void ApplyDeploymentZoneMask(EEntity WhoOwns, const TArray<uint32>& Mask, EDeploymentZoneOperation Operation);
+
+	/**
+	 * SERVER-ONLY
+	 * Switches deployed characters to reduced replication if a fight has started with at least LargeBattleCharacterThreshold of them,
+	 * and back to default replication otherwise.
+	 */
+	void ApplyAdaptiveReplication();
+
+	/**
+	 * SERVER-ONLY
+	 * Changes health, location and animation state of every soak benchmark character, as a fight would.
+	 */
+	void ChurnReplicationSoak();
+
+	/**
+	 * SERVER-ONLY
+	 * Samples bytes sent and game thread time per client connection for the soak benchmark.
+	 */
+	void SampleReplicationSoak();
+
+	/**
+	 * SERVER-ONLY
+	 * Prints the soak benchmark averages, and removes its characters.
+	 */
+	void EndReplicationSoak();
+
+	/**
+	 * Replicates the fast array state.
+	 */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+public:
+	/**
+	 * Called on clients when a roster entry arrives. Broadcasts OnAddedCharacterForPlayer.
+	 */
+	void OnReplicatedRosterAdd(const FAutobattlerRosterItem& Item);
+
+	/**
+	 * Called on clients before a roster entry is removed. Broadcasts OnRemovedCharacterForPlayer.
+	 */
+	void OnReplicatedRosterRemove(const FAutobattlerRosterItem& Item);
+
+	/**
+	 * Called on clients when an entity's state arrives or changes. Broadcasts budget and float changes, and updates the grid.
+	 * Several changes between two net updates arrive as one, e.g. a float cancelled and another begun only announces the new float.
+	 */
+	void OnReplicatedEntityStateChange(FAutobattlerEntityStateItem& Item);
+
+	/**
+	 * Called on clients when grid cells change. The grid is updated once, on the next tick.
+	 */
+	void MarkReplicatedGridVisibilityDirty();
+
+	/**
+	 * Counts bytes written by a replicated fast array towards the replication stats.
+	 * @param NumBytes Bytes written to one connection.
+	 */
+	void RecordFastArrayBytes(int32 NumBytes) { ReplicationStats.RecordFastArrayBytes(NumBytes); }
+
+/////////////////////////////////////////////////////////////////////////////////
+//// REPLAYS
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * SERVER-ONLY
+	 * Records an event in the battle replay, if a battle is being recorded.
+	 * @param EventType What happened.
+	 * @param Source Character who caused the event, or nullptr.
+	 * @param Target Character affected by the event, or nullptr.
+	 * @param Value Event specific value (e.g. damage dealt, poison strength).
+	 */
+	void RecordBattleEvent(EAutobattlerSimulationEventType EventType, const AAutobattlerCharacter* Source, const AAutobattlerCharacter* Target, float Value);
+
+	/**
+	 * SERVER-ONLY
+	 * Records the current and max health of a character in the battle replay, if a battle is being recorded.
+	 * @param Character Character whose health changed.
+	 */
+	void RecordBattleHealth(const AAutobattlerCharacter* Character);
+
+	/**
+	 * SERVER-ONLY
+	 * Records the target an AI update picked for a character in the battle replay, if a battle is being recorded.
+	 * @param Character Character whose target changed.
+	 * @param Target Its new target, or nullptr if it has none.
+	 */
+	void RecordBattleTarget(const AAutobattlerCharacter* Character, const AAutobattlerCharacter* Target);
+
+	/**
+	 * @return Recording of the current (or last) battle. Only recorded on the server.
+	 */
+	FAutobattlerBattleReplay& GetBattleReplay() { return BattleReplay; }
+
+private:
+	/**
+	 * SERVER-ONLY
+	 * Starts recording the battle with every deployed character, if RecordBattles is enabled.
+	 */
+	void BeginBattleRecording();
+
+	/**
+	 * SERVER-ONLY
+	 * Adds a deployed character to the battle replay roster.
+	 * @param Character Deployed character.
+	 * @param WhoOwns Who owns the character.
+	 */
+	void RecordBattleCharacter(const AAutobattlerCharacter* Character, EEntity WhoOwns);
+
+	/**
+	 * SERVER-ONLY
+	 * Writes the locations of every living character which moved to the battle replay.
+	 */
+	void RecordBattleFrame();
+
+	/**
+	 * SERVER-ONLY
+	 * Stops recording the battle, if it is being recorded.
+	 * @param Winner Who won the battle.
+	 */
+	void EndBattleRecording(EWhoWins Winner);
+
 /////////////////////////////////////////////////////////////////////////////////
 //// DEBUG
 /////////////////////////////////////////////////////////////////////////////////
@@ -654,4 +1213,148 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Autobattler")
 	void PrintEntityConfigurationToLog(EEntity WhoOwns);
+
+	/**
+	 * SERVER-ONLY
+	 * Compares the character registry against scanning the world for characters, and prints timings to the autobattler log.
+	 * For each unit count, that many bare characters are spawned and registered, each query is timed on both paths,
+	 * then the characters are removed again. Intended for use from a debug menu only, as it spawns real actors.
+	 * @param UnitCounts Number of characters to benchmark with. If empty, 50, 500 and 5000 are used.
+	 * @param Iterations How many times each query is repeated per unit count.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler|Debug", meta = (AutoCreateRefTerm = "UnitCounts"))
+	void BenchmarkCharacterRegistry(const TArray<int32>& UnitCounts, int32 Iterations = 100);
+
+	/**
+	 * SERVER-ONLY
+	 * Runs targeting for the attack and ability of every deployed AI controlled character, and prints timings and how many
+	 * UObjects were created to the autobattler log. A warm-up pass runs first, so strategies cached per controller are not counted.
+	 * Targeting is expected to create no UObjects once warm.
+	 * @param Iterations How many times targeting is repeated for each character.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler|Debug")
+	void BenchmarkAITargeting(int32 Iterations = 100);
+
+	/**
+	 * SERVER-ONLY
+	 * Prints the bytes per second sent by the replicated roster, entity and grid state, next to the bytes per second the reliable multicasts
+	 * send (or would send, if fast array replication is enabled) for the same changes. Multicast bytes are estimated from their parameters.
+	 * @param Reset Whether to start a new measuring window afterwards.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler|Debug")
+	void PrintReplicationBandwidth(bool Reset = true);
+
+	/**
+	 * SERVER-ONLY
+	 * Soaks character replication: spawns characters from the first row of AllCharactersDataTable, then keeps changing their health, location
+	 * and animation state for the given duration. Every second, bytes sent and game thread time are sampled per client connection, and
+	 * averages are printed to the autobattler log at the end, after which the characters are removed again.
+	 * Run on a local dedicated server with simulated clients connected (e.g. PIE with several clients and "Run Under One Process" off,
+	 * or a -server instance with -nullrhi clients), then compare runs either side of LargeBattleCharacterThreshold.
+	 * @param NumCharacters How many characters to spawn. Reduced replication is used if this reaches LargeBattleCharacterThreshold.
+	 * @param Duration How long to run for, in seconds.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler|Debug")
+	void BenchmarkReplicationSoak(int32 NumCharacters = 200, float Duration = 30.0f);
+
+	/**
+	 * SERVER-ONLY
+	 * Saves the recording of the last battle to Saved/Replays.
+	 * @param FileName Name of the file, without extension.
+	 * @return Whether the recording was saved.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler|Debug")
+	bool SaveBattleReplay(const FString& FileName);
+
+	/**
+	 * SERVER-ONLY
+	 * Loads a recording from Saved/Replays, replacing the recording of the last battle. Fails while a battle is being recorded.
+	 * @param FileName Name of the file, without extension.
+	 * @return Whether a valid recording was loaded.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler|Debug")
+	bool LoadBattleReplay(const FString& FileName);
+
+	/**
+	 * SERVER-ONLY
+	 * Plays the recording of the last (or loaded) battle back headlessly, in 60 Hz frames each advancing Speed / 60 seconds of battle,
+	 * then seeks to its middle. No actors, AI or EQS queries are involved. Prints event counts, survivors and timings to the autobattler log.
+	 * @param Speed How many seconds of battle each second of playback covers.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler|Debug")
+	void PlayBackBattleReplay(float Speed = 100.0f);
+
+	/**
+	 * SERVER-ONLY
+	 * Prints the size of the recording of the last battle, its size per minute of battle, and the time spent recording it
+	 * as a share of the server frame time the battle lasted, to the autobattler log.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler|Debug")
+	void PrintBattleReplayStats();
+
+	/**
+	 * SERVER-ONLY
+	 * Writes per-battle aggregates of this session (units, skills per second, projectiles, damage, p50/p99 AI update cost) as CSV
+	 * to Saved/Profiling/Autobattler. Also available as the "Autobattler.DumpBattleStats [FileName]" console command.
+	 * @param FileName Name of the file, without extension. If empty, a timestamped name is used.
+	 * @return Whether the file was written.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler|Debug")
+	bool DumpBattleStats(const FString& FileName);
+
+	/**
+	 * SERVER-ONLY
+	 * Simulates a battle between all currently deployed characters without touching the world (see FAutobattlerSimulation),
+	 * and prints the outcome to the autobattler log. Useful for checking a matchup before advancing to the fight.
+	 * @param Seed Random seed. The same deployment and seed always simulate the same battle.
+	 * @param Result (OUT) Outcome and event log of the simulated battle.
+	 * @return Who won the simulated battle.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler|Debug")
+	EWhoWins SimulateCurrentBattle(int32 Seed, FAutobattlerSimulationResult& Result);
+
+	/**
+	 * SERVER-ONLY
+	 * Checks AI update tiers keep outcome parity with fixed rate updates: simulates all currently deployed characters with every seed,
+	 * once updating every AI at the high rate and once with update tiers, and prints how often the winner matches, the average difference
+	 * in duration and survivors, and AI updates run by each mode to the autobattler log. Also prints the live AI scheduler's tiers.
+	 * With grid pathfinding, characters are simulated stepping one grid cell per AI update, as the AI controller moves them.
+	 * @param NumSeeds How many seeds to simulate, starting from 0.
+	 * @return Share of seeds where both modes had the same winner, between 0 and 1.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler|Debug")
+	float CompareAIUpdateTiers(int32 NumSeeds = 64);
+
+	/**
+	 * SERVER-ONLY
+	 * Checks the simulation keeps parity with live battles: rebuilds the starting roster of the last (or loaded) battle recording from
+	 * AllCharactersDataTable, simulates it, and compares the winner and the sequence of events both record (skills triggered, damage,
+	 * heals, poison applied, deaths and ressurections, by type, source and target). Prints the first event where they diverge to the
+	 * autobattler log. Live battles do not draw from a seeded stream, so rolled values are not compared, and a battle is expected to
+	 * diverge once a roll (animation choice or critical hit) changes what happens next.
+	 * @param Seed Random seed for the simulation.
+	 * @return Whether the winner and every compared event matched.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler|Debug")
+	bool CompareReplayWithSimulation(int32 Seed = 0);
+
+private:
+	/**
+	 * Builds a simulation setup from all currently deployed characters, at their current locations.
+	 * @param Setup (OUT) Setup to add characters to.
+	 * @param IncludeAI If false, only characters not owned by the AI are added.
+	 * @return Whether the setup could be built (requires the configuration asset).
+	 */
+	bool BuildSimulationSetupFromBattlefield(FAutobattlerSimulationSetup& Setup, bool IncludeAI = true) const;
+
+	/**
+	 * Picks which AI characters to deploy and where, without deploying them.
+	 * @param FormationRowName Formation to read from configuration.
+	 * @param WhiteList Characters with tags on whitelist will be considered for deployment.
+	 * @param Blacklist Characters with tags on blacklist will never be considered for deployment.
+	 * @param Stream Random stream driving character selection and placement.
+	 * @param OutPlacements (OUT) AI character IDs mapped to the grid index they should be deployed at.
+	 * @return Whether a formation could be planned.
+	 */
+	bool PlanAIFormation(const FName& FormationRowName, const TArray<FName>& WhiteList, const TArray<FName>& Blacklist, FRandomStream& Stream, TMap<int32, FIntPair>& OutPlacements) const;
 };
@@ -0,0 +1,214 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "Types/AutobattlerStructs.h"
+#include "AutobattlerReplicatedState.generated.h"
+
+class AAutobattlerManager;
+struct FAutobattlerRosterArray;
+struct FAutobattlerEntityStateArray;
+struct FAutobattlerGridCellArray;
+
+/**
+ * Rolling byte counters used to compare the replicated state below against the reliable multicast path it replaces.
+ * Fast array bytes are measured as they are written, multicast bytes are estimated from their payload. Both are summed over every connection.
+ */
+struct AUTOBATTLERPLUGIN_API FAutobattlerReplicationStats
+{
+public:
+	/**
+	 * @param NumBytes Bytes written for a fast array to one connection.
+	 */
+	void RecordFastArrayBytes(int32 NumBytes) { FastArrayBytes += NumBytes; }
+
+	/**
+	 * @param NumBytes Estimated payload of a multicast, summed over every connection.
+	 */
+	void RecordMulticastBytes(int32 NumBytes) { MulticastBytes += NumBytes; }
+
+	/**
+	 * Gets bytes per second since the stats were last reset.
+	 * @param Now Current (real) time, in seconds.
+	 * @param OutFastArrayBytesPerSecond (OUT) Fast array bytes per second.
+	 * @param OutMulticastBytesPerSecond (OUT) Multicast bytes per second.
+	 */
+	void GetBytesPerSecond(double Now, float& OutFastArrayBytesPerSecond, float& OutMulticastBytesPerSecond) const;
+
+	/**
+	 * Clears the counters and starts a new measuring window.
+	 * @param Now Current (real) time, in seconds.
+	 */
+	void Reset(double Now);
+
+	/* Totals since the stats were last reset. */
+	int64 FastArrayBytes = 0;
+	int64 MulticastBytes = 0;
+
+	/* When the stats were last reset. */
+	double WindowStartTime = 0.0;
+};
+
+/* Replicated roster entry: a character an entity owns, whether deployed or not. */
+USTRUCT()
+struct FAutobattlerRosterItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+public:
+	/* Unique ID of the character. */
+	UPROPERTY()
+	int32 ID = 0;
+
+	/* Who owns the character. */
+	UPROPERTY()
+	EEntity WhoOwns = EEntity::AI;
+
+	/* Whether a character panel actor was generated when the character was added. */
+	UPROPERTY()
+	bool DidGeneratePanelActor = false;
+
+	/* The character itself. */
+	UPROPERTY()
+	FCharacterListing Listing;
+
+	void PreReplicatedRemove(const FAutobattlerRosterArray& InArraySerializer);
+	void PostReplicatedAdd(const FAutobattlerRosterArray& InArraySerializer);
+};
+
+/* Replicated rosters of every entity. */
+USTRUCT()
+struct FAutobattlerRosterArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+	TArray<FAutobattlerRosterItem> Items;
+
+	/* Manager owning this array, notified when items arrive on clients. */
+	AAutobattlerManager* Manager = nullptr;
+
+	/**
+	 * @return The roster entry of a character, or nullptr.
+	 */
+	const FAutobattlerRosterItem* FindByID(int32 ID) const { return Items.FindByPredicate([ID](const FAutobattlerRosterItem& Item) { return Item.ID == ID; }); }
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+};
+
+template<>
+struct TStructOpsTypeTraits<FAutobattlerRosterArray> : public TStructOpsTypeTraitsBase2<FAutobattlerRosterArray>
+{
+	enum { WithNetDeltaSerializer = true };
+};
+
+/* Replicated per-entity state: budget, floating character and whether its deployment grid is shown. */
+USTRUCT()
+struct FAutobattlerEntityStateItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+public:
+	/* Entity this state belongs to. */
+	UPROPERTY()
+	EEntity WhoOwns = EEntity::AI;
+
+	/* Max budget of the entity. */
+	UPROPERTY()
+	int32 MaxBudget = 0;
+
+	/* ID of the character the entity is floating, or INDEX_NONE. */
+	UPROPERTY()
+	int32 FloatingCharacterID = INDEX_NONE;
+
+	/* Whether the last float ended by being cancelled (rather than by deploying). */
+	UPROPERTY()
+	bool WasFloatCancelled = false;
+
+	/* Whether the entity's deployment grid is shown. Which cells are shown is held by the grid cells. */
+	UPROPERTY()
+	bool IsGridShown = false;
+
+	/* Client only. State last seen, so changes can be told apart. */
+	int32 LastMaxBudget = 0;
+	int32 LastFloatingCharacterID = INDEX_NONE;
+
+	void PostReplicatedAdd(const FAutobattlerEntityStateArray& InArraySerializer);
+	void PostReplicatedChange(const FAutobattlerEntityStateArray& InArraySerializer);
+};
+
+/* Replicated state of every entity. */
+USTRUCT()
+struct FAutobattlerEntityStateArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+	TArray<FAutobattlerEntityStateItem> Items;
+
+	/* Manager owning this array, notified when items change on clients. */
+	AAutobattlerManager* Manager = nullptr;
+
+	/**
+	 * Finds the state of an entity, adding it if it does not exist yet. Server-only.
+	 * @return The state. Mark it dirty after changing it.
+	 */
+	FAutobattlerEntityStateItem& FindOrAdd(EEntity WhoOwns);
+
+	/**
+	 * @return The state of an entity, or nullptr.
+	 */
+	const FAutobattlerEntityStateItem* Find(EEntity WhoOwns) const { return Items.FindByPredicate([WhoOwns](const FAutobattlerEntityStateItem& Item) { return Item.WhoOwns == WhoOwns; }); }
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+};
+
+template<>
+struct TStructOpsTypeTraits<FAutobattlerEntityStateArray> : public TStructOpsTypeTraitsBase2<FAutobattlerEntityStateArray>
+{
+	enum { WithNetDeltaSerializer = true };
+};
+
+/* Replicated state of a grid cell. */
+USTRUCT()
+struct FAutobattlerGridCellItem : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+public:
+	/* Grid index of the cell. */
+	UPROPERTY()
+	FIntPair GridIndex;
+
+	/* One bit per entity (1 << EEntity), set if the cell is shown to that entity while its grid is shown. */
+	UPROPERTY()
+	uint8 VisibleForMask = 0;
+
+	/* Whether a character is deployed on the cell, highlighted as occupied on clients. */
+	UPROPERTY()
+	bool IsOccupied = false;
+
+	void PostReplicatedAdd(const FAutobattlerGridCellArray& InArraySerializer);
+	void PostReplicatedChange(const FAutobattlerGridCellArray& InArraySerializer);
+};
+
+/* Replicated state of every grid cell. Only cells whose state changed are sent. */
+USTRUCT()
+struct FAutobattlerGridCellArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+	TArray<FAutobattlerGridCellItem> Items;
+
+	/* Manager owning this array, notified when items change on clients. */
+	AAutobattlerManager* Manager = nullptr;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+};
+
+template<>
+struct TStructOpsTypeTraits<FAutobattlerGridCellArray> : public TStructOpsTypeTraitsBase2<FAutobattlerGridCellArray>
+{
+	enum { WithNetDeltaSerializer = true };
+};
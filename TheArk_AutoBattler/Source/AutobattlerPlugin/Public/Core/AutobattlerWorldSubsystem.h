@@ -0,0 +1,92 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AutobattlerWorldSubsystem.generated.h"
+
+class AAutobattlerGrid;
+class AAutobattlerManager;
+class UAutobattlerConfiguration;
+
+/**
+ * Per-world cache of the autobattler manager, so looking it up (and the configuration asset and grid through it) does not
+ * iterate every actor in the world. The manager registers itself on BeginPlay and unregisters on EndPlay, which covers
+ * streaming levels out and PIE sessions ending; a new world always gets a new subsystem.
+ */
+UCLASS()
+class AUTOBATTLERPLUGIN_API UAutobattlerWorldSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+/////////////////////////////////////////////////////////////////////////////////
+//// SUBSYSTEM
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Static getter for the subsystem of a world.
+	 * @param WorldContextObject Any object in the world.
+	 * @return The subsystem, or nullptr if there is no world.
+	 */
+	static UAutobattlerWorldSubsystem* Get(const UObject* WorldContextObject);
+
+	/**
+	 * Drops the cached manager.
+	 */
+	virtual void Deinitialize() override;
+
+/////////////////////////////////////////////////////////////////////////////////
+//// MANAGER
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Caches the manager of this world. If another valid manager is already cached, it is kept and a warning is printed.
+	 * @param Manager Manager which has begun play.
+	 */
+	void RegisterManager(AAutobattlerManager* Manager);
+
+	/**
+	 * Clears the cached manager, if it is the given one.
+	 * @param Manager Manager which is ending play.
+	 */
+	void UnregisterManager(const AAutobattlerManager* Manager);
+
+	/**
+	 * Gets the cached manager. If none is registered yet (e.g. asked from an actor which began play before the manager),
+	 * the world is searched once and the result is cached.
+	 * @return The autobattler manager, or nullptr if there is none.
+	 */
+	AAutobattlerManager* GetManager();
+
+	/**
+	 * @return Configuration asset of the cached manager, or nullptr if there is no manager.
+	 */
+	const UAutobattlerConfiguration* GetConfigurationAsset();
+
+	/**
+	 * @return Grid of the cached manager, or nullptr if there is no manager.
+	 */
+	AAutobattlerGrid* GetGrid();
+
+/////////////////////////////////////////////////////////////////////////////////
+//// DEBUG
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Compares searching the world for the manager against the cached lookup, and prints timings to the autobattler log.
+	 * @param Iterations How many times each lookup is repeated.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler|Debug")
+	void BenchmarkManagerLookup(int32 Iterations = 10000);
+
+private:
+	/**
+	 * Searches the world for a valid manager.
+	 * @return The first valid manager found, or nullptr.
+	 */
+	AAutobattlerManager* FindManagerInWorld() const;
+
+	/* Manager of this world. Weak, so a manager destroyed without ending play is not handed out. */
+	TWeakObjectPtr<AAutobattlerManager> CachedManager;
+};
@@ -106,6 +106,42 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|Game", meta = (ClampMin = "1"))
 	float PoisonStrengthReductionRate;
 
+/////////////////////////////////////////////////////////////////////////////////
+//// POOLING
+/////////////////////////////////////////////////////////////////////////////////
+	/* How many skill executors (of the default class) the server spawns up front, so skills can reuse them instead of spawning actors. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|Pooling", meta = (ClampMin = "0"))
+	int32 PrewarmedExecuteSkillActors;
+
+	/* How many projectiles the server spawns up front, so projectile skills can reuse them instead of spawning actors. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|Pooling", meta = (ClampMin = "0"))
+	int32 PrewarmedProjectileActors;
+
+/////////////////////////////////////////////////////////////////////////////////
+//// NETWORKING
+/////////////////////////////////////////////////////////////////////////////////
+	/* Whether rosters, budgets, float state and grid visibility are replicated as fast arrays (only changes are sent, and late joiners receive
+	the current state), rather than as reliable multicasts. Can be turned off to compare bandwidth, see AAutobattlerManager::PrintReplicationBandwidth. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|Networking")
+	bool UseFastArrayReplication;
+
+	/* Once a fight has at least this many characters, they switch to reduced replication: a lower update frequency, and lower priority
+	when off screen, far away or dead. Set to 0 to always reduce, or a very high value to never reduce. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|Networking", meta = (ClampMin = 0))
+	int32 LargeBattleCharacterThreshold;
+
+	/* Net update frequency of characters while replication is reduced. Never raises the character's own frequency. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|Networking", meta = (ClampMin = 1.0))
+	float LargeBattleNetUpdateFrequency;
+
+	/* Minimum net update frequency characters fall back to while idle and replication is reduced. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|Networking", meta = (ClampMin = 0.1))
+	float LargeBattleMinNetUpdateFrequency;
+
+	/* While replication is reduced, characters further than this from a viewer lose priority with distance. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|Networking", meta = (ClampMin = 0.0))
+	float LargeBattleFullPriorityDistance;
+
 /////////////////////////////////////////////////////////////////////////////////
 //// AI
 /////////////////////////////////////////////////////////////////////////////////
@@ -121,6 +157,35 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|AI", meta = (EditCondition = "UseBehaviorTree"))
 	UBehaviorTree* AutobattlerBehaviorTree;
 
+	/* Whether characters move cell by cell using the grid pathfinder (flow fields, then A*), rather than EQS queries and sweeps. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|AI")
+	bool UseGridPathfinding;
+
+	/* Whether native AI updates are run by the manager's AI scheduler, at a rate depending on what each character is doing, rather than every
+	AIHighRateUpdateInterval on a timer per controller. See FAutobattlerAIScheduler. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|AI")
+	bool UseAIScheduler;
+
+	/* Seconds between AI updates of characters close to their target, or which have just lost or changed target. Also the fixed timer rate. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|AI", meta = (ClampMin = 0.01))
+	float AIHighRateUpdateInterval;
+
+	/* Seconds between AI updates of characters walking toward a target which is still far away. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|AI", meta = (EditCondition = "UseAIScheduler", ClampMin = 0.01))
+	float AILowRateUpdateInterval;
+
+	/* Characters which could get within this distance of their range before their next low rate update are updated at the high rate. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|AI", meta = (EditCondition = "UseAIScheduler", ClampMin = 0.0))
+	float AIPromotionDistance;
+
+	/* Most AI updates the scheduler runs per frame. Updates which do not fit run first on the next frame. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|AI", meta = (EditCondition = "UseAIScheduler", ClampMin = 1))
+	int32 AIMaxUpdatesPerFrame;
+
+	/* Milliseconds the scheduler may spend on AI updates per frame. At least one update always runs. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|AI", meta = (EditCondition = "UseAIScheduler", ClampMin = 0.0))
+	float AIUpdateFrameBudgetMs;
+
 	/* Default rotation of enemy characters when spawned. */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|AI")
 	FRotator EnemyCharacterRotation;
@@ -132,6 +197,21 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|Traces")
 	TEnumAsByte<ECollisionChannel> GridOccupancyCollisionChannel;
 
+/////////////////////////////////////////////////////////////////////////////////
+//// REPLAYS
+/////////////////////////////////////////////////////////////////////////////////
+	/* Whether the server records every battle, so it can be saved and played back later. See FAutobattlerBattleReplay. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|Replays")
+	bool RecordBattles;
+
+	/* How often (in seconds) character locations are written to the recording. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|Replays", meta = (EditCondition = "RecordBattles", ClampMin = 0.02))
+	float ReplayFrameInterval;
+
+	/* How often (in seconds) a full snapshot is written to the recording. Shorter intervals make seeking faster and recordings larger. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Autobattler Configuration|Replays", meta = (EditCondition = "RecordBattles", ClampMin = 0.5))
+	float ReplaySnapshotInterval;
+
 /////////////////////////////////////////////////////////////////////////////////
 //// DEBUG
 /////////////////////////////////////////////////////////////////////////////////
@@ -156,4 +236,87 @@ public:
 	 * @return The configuration asset, if defined in settings and loaded.
 	 */
 	static const UAutobattlerConfiguration* GetConfigurationAsset(const UObject* WorldContextObject);
+
+	virtual void PostLoad() override;
+
+	virtual void BeginDestroy() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+//// CHARACTER DEFINITIONS
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Gets a character definition baked from AllCharactersDataTable by its handle.
+	 * @param Handle Handle of the definition, see FindCharacterDefinitionHandle.
+	 * @return The definition, or nullptr if the handle is invalid.
+	 */
+	FORCEINLINE const FAutobattlerCharacterDefinition* GetCharacterDefinition(int32 Handle) const { return BakedCharacterDefinitions.IsValidIndex(Handle) ? &BakedCharacterDefinitions[Handle] : nullptr; }
+
+	/**
+	 * Gets the handle of a character definition from its row name in AllCharactersDataTable.
+	 * @param RowName Row name of the character.
+	 * @return Handle of the definition, or INDEX_NONE if there is no such row.
+	 */
+	int32 FindCharacterDefinitionHandle(const FName& RowName) const;
+
+	/**
+	 * Gets a character definition by handle, falling back to its row name if the handle is stale (e.g. the table was re-imported).
+	 * @param InOutHandle (IN/OUT) Cached handle of the definition. Updated if it had to be looked up again.
+	 * @param RowName Row name of the character.
+	 * @return The definition, or nullptr if there is no such row.
+	 */
+	const FAutobattlerCharacterDefinition* ResolveCharacterDefinition(int32& InOutHandle, const FName& RowName) const;
+
+	/**
+	 * Rebuilds the flat array of character definitions from AllCharactersDataTable. Done automatically on load, when the
+	 * table is changed and (in the editor) whenever the table itself is edited or re-imported.
+	 */
+	void BakeCharacterDefinitions();
+
+private:
+	/**
+	 * Binds BakeCharacterDefinitions to changes of AllCharactersDataTable, unbinding from the previously bound table.
+	 */
+	void BindCharactersDataTableChanged();
+
+	/* AllCharactersDataTable rows, copied into a flat array. A definition's handle is its index. */
+	UPROPERTY(Transient)
+	TArray<FAutobattlerCharacterDefinition> BakedCharacterDefinitions;
+
+	/* Row name of each baked definition, used to check handles are still current. */
+	TArray<FName> BakedCharacterRowNames;
+
+	/* Handle of each baked definition, keyed by row name. */
+	TMap<FName, int32> CharacterDefinitionHandles;
+
+	/* Table currently bound by BindCharactersDataTableChanged, and its delegate handle. */
+	TWeakObjectPtr<UDataTable> BoundCharactersDataTable;
+	FDelegateHandle CharactersDataTableChangedHandle;
+
+/////////////////////////////////////////////////////////////////////////////////
+//// DAMAGE MODIFIERS
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Gets how much a damage type is amplified/resisted by a resistance type, from the table baked from DamageModifierMap.
+	 * Combinations missing from DamageModifierMap resolve to 1 (resistances not applied).
+	 * @param DamageType Damage type being dealt.
+	 * @param ResistanceType Resistance type defending against the damage.
+	 * @return Multiplier to apply to the damage.
+	 */
+	FORCEINLINE float GetDamageModifier(EDamageType DamageType, EResistanceType ResistanceType) const { return BakedDamageModifiers[(uint8)DamageType][(uint8)ResistanceType]; }
+
+	/**
+	 * Rebuilds the baked damage modifier table from DamageModifierMap. Done automatically on load and when edited,
+	 * so only needs calling if DamageModifierMap is changed at runtime. Missing combinations are reported here, once.
+	 */
+	void BakeDamageModifiers();
+
+private:
+	/* DamageModifierMap flattened into a dense table, indexed by damage type then resistance type. */
+	float BakedDamageModifiers[(uint8)EDamageType::Count][(uint8)EResistanceType::Count];
 };
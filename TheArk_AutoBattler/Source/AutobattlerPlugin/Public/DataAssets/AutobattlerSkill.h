@@ -100,6 +100,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Skill Implementation", meta = (EditCondition = "OnSkillTriggerEnd==ESkillTriggerEnd::Projectile"))
 	FName ProjectileSocketSpawnName = FName("None");
 
+	/* How fast the projectile flies, in units per second. Must be positive, or the projectile would never arrive. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Skill Implementation", meta = (EditCondition = "OnSkillTriggerEnd==ESkillTriggerEnd::Projectile", ClampMin = "1.0", UIMin = "1.0"))
+	float ProjectileSpeed = 500.0f;
+
 	/* How long before the skill effect will "timeout" and disappear. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Skill Implementation", meta = (EditCondition = "OnSkillTriggerEnd==ESkillTriggerEnd::Effect"))
 	float EffectTimeout = 1.0f;
@@ -13,6 +13,8 @@ class UAutobattlerSkill;
 
 /**
  * Component responsible for skills which occur over a duration.
+ * Only spawned for custom derived classes (see UAutobattlerSkill::DurationSkillComponentClass); by default, duration skills
+ * are repeated by the manager's effect scheduler without creating a component.
  */
 UCLASS(ClassGroup=("Autobattler"))
 class AUTOBATTLERPLUGIN_API UDurationSkillComponent : public UActorComponent
@@ -38,7 +40,7 @@ public:
 	UDurationSkillComponent();
 
 	/**
-	 * Configures a skill which should last a duration.
+	 * Configures a skill which should last a duration, either on the effect scheduler or on a new custom duration component.
 	 * @param Target Target to initialise this skill on.
 	 * @param SkillAsset Asset which skill list will be executed on.
 	 * @param SkillOwner Character who executed this skill.
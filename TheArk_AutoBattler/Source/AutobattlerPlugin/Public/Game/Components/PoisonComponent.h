@@ -7,24 +7,18 @@
 #include "Components/ActorComponent.h"
 #include "PoisonComponent.generated.h"
 
+class AAutobattlerCharacter;
+
 /**
- * Component responsible for dealing poison damage to the character it is attached to.
+ * Component which poisons the character it is attached to.
+ * Poison itself is ticked by the manager's effect scheduler (see FAutobattlerEffectScheduler), so this component holds no state
+ * and is only kept so existing Blueprints can still apply poison through it.
  */
 UCLASS(ClassGroup=(Autobattler))
 class AUTOBATTLERPLUGIN_API UPoisonComponent : public UActorComponent
 {
 	GENERATED_BODY()
 /////////////////////////////////////////////////////////////////////////////////
-//// INTERNAL
-/////////////////////////////////////////////////////////////////////////////////
-private:
-	/* Timer handle used to manage poison counter. */
-	FTimerHandle PoisonTimerHandle;
-
-	/* How strong the poison currently is. */
-	float CurrentPoisonStrength;
-
-/////////////////////////////////////////////////////////////////////////////////
 //// API
 /////////////////////////////////////////////////////////////////////////////////
 public:
@@ -36,7 +30,11 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Autobattler")
 	void ApplyPoison(float PoisonStrength);
 
-private:
-	UFUNCTION()
-	void TickPoison();	
+	/**
+	 * Poisons a character through the manager's effect scheduler. Poisoning a character which is already poisoned adds to its poison strength.
+	 * @param Target Character to poison.
+	 * @param PoisonStrength How much damage the poison does per tick (reduced per tick)
+	 * @see AutobattlerConfiguration.
+	 */
+	static void ApplyPoisonToCharacter(AAutobattlerCharacter* Target, float PoisonStrength);
 };
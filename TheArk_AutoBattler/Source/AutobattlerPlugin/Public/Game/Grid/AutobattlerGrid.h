@@ -9,34 +9,11 @@
 #include "AutobattlerGrid.generated.h"
 
 class UDecalComponent;
+class UMaterial;
+class UMaterialInstanceDynamic;
 class UMaterialInterface;
 class USceneComponent;
-
-USTRUCT()
-struct FIndexInfo
-{
-	GENERATED_BODY()
-public:
-	/* Decal component at this grid index. */
-	UPROPERTY()
-	UDecalComponent* DecalComponent;
-
-	/* Actual grid index. */
-	UPROPERTY()
-	FIntPair GridLocation;
-
-	FIndexInfo()
-	{
-		DecalComponent = nullptr;
-		GridLocation = FIntPair();
-	}
-
-	FIndexInfo(UDecalComponent* NewDecalComponent, const FIntPair& NewGridLocation)
-	{
-		DecalComponent = NewDecalComponent;
-		GridLocation = NewGridLocation;
-	}
-};
+class UTexture2D;
 
 /**
  * Class which generates the grid to be used in the autobattler game. 
@@ -53,11 +30,18 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	USceneComponent* GridRoot;
 
+	/* Single decal drawing every cell of the grid. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	UDecalComponent* GridDecal;
+
 /////////////////////////////////////////////////////////////////////////////////
 //// CONFIGURATION
 /////////////////////////////////////////////////////////////////////////////////
 protected:
-	/* Material to use for the decal. */
+	/* Material to use for the decal. It is drawn once over the whole grid, and should draw each cell from the GridStateTexture parameter
+	(one texel per grid index, see CellStates), masking out cells which are not shown. GridSizeX, GridSizeY and CellPadding are also set.
+	A material lacking any of these parameters is drawn by one decal per cell instead, which only follows the Shown highlight.
+	CreateCellStateMaterial generates such a material. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Autobattler Grid")
 	UMaterialInterface* DefaultDecalMaterial;
 
@@ -77,7 +61,7 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Autobattler Grid")
 	float XYSize;
 
-	/* How much larger or smaller the decal material should be for the grid. */
+	/* How much larger or smaller each cell should be drawn, passed to the material as CellPadding (as a fraction of XYSize). */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Autobattler Grid")
 	float DecalShrinkFactor;
 
@@ -89,13 +73,35 @@ protected:
 //// INTERNAL
 /////////////////////////////////////////////////////////////////////////////////
 private:
-	/* Info about various properties present on a grid index. */
-	UPROPERTY(Replicated)
-	TArray<FIndexInfo> GridIndexInfo;
+	/* Dynamic instance of DefaultDecalMaterial, drawing the cell state texture. */
+	UPROPERTY(Transient)
+	UMaterialInstanceDynamic* GridMaterialInstance;
+
+	/* Cell state texture, uploaded from CellStates whenever highlights change. */
+	UPROPERTY(Transient)
+	UTexture2D* CellStateTexture;
+
+	/* Highlights of every grid index, 4 bytes (BGRA, see EGridHighlight) per index laid out like the occupancy bitmap (X * GridYSize + Y).
+	Built locally on every machine; which indicies are shown is replicated by the manager. */
+	TArray<uint8> CellStates;
+
+	/* One decal per grid index, laid out like CellStates, if DefaultDecalMaterial cannot read the cell state texture. Empty otherwise. */
+	UPROPERTY(Transient)
+	TArray<UDecalComponent*> CellDecals;
 
 	/* Locally changed variable as to whether the grid is currently hidden. */
 	bool IsCurrentlyHidden;
 
+	/* Server only. One bit per grid index (X * GridYSize + Y), set if a character is deployed on it. */
+	TArray<uint32> OccupancyBits;
+
+	/* Server only. ID and owner of the character deployed on each grid index (INDEX_NONE if none). */
+	TArray<int32> IndexOccupantIDs;
+	TArray<EEntity> IndexOccupantOwners;
+
+	/* Server only. Grid index each deployed character occupies, keyed by character ID. */
+	TMap<int32, int32> OccupiedIndexByID;
+
 /////////////////////////////////////////////////////////////////////////////////
 //// CONSTRUCTION
 /////////////////////////////////////////////////////////////////////////////////
@@ -111,6 +117,14 @@ public:
 	UFUNCTION(CallInEditor, Category = "Autobattler Grid")
 	void BuildGridInEditor();
 
+	/**
+	 * EDITOR-ONLY
+	 * Creates (or loads, if it exists) the M_GridCellStates decal material in the plugin's grid materials, which draws every cell from
+	 * the cell state texture, assigns it to DefaultDecalMaterial and rebuilds the grid. Save the grid or its blueprint to keep it.
+	 */
+	UFUNCTION(CallInEditor, Category = "Autobattler Grid")
+	void CreateCellStateMaterial();
+
 protected:
 	/**
 	 * Builds the grid if BuildGridOnBeginPlay is enabled. 
@@ -123,6 +137,21 @@ private:
 	 */
 	void BuildGrid();
 
+	/**
+	 * Whether a material can draw the grid from the cell state texture, i.e. has every parameter BuildGrid sets.
+	 * @param Material Material to test.
+	 * @return True if the material has the GridStateTexture, GridSizeX, GridSizeY and CellPadding parameters.
+	 */
+	static bool CanDrawCellStates(const UMaterialInterface* Material);
+
+#if WITH_EDITOR
+	/**
+	 * Builds the expressions of a decal material drawing the cell state texture, and compiles it.
+	 * @param Material New, empty material.
+	 */
+	static void BuildCellStateMaterial(UMaterial* Material);
+#endif
+
 	/**
 	 * Binds delegates from manager to show/hide grid under various circumstances
 	 * (see individual functions).
@@ -154,6 +183,20 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Autobattler Grid")
 	float GetGridHeight() const { return GridXSize * XYSize; }
 
+	/**
+	 * Getter for how many tiles there are on the x-axis.
+	 * @return Number of tiles on the x-axis.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Autobattler Grid")
+	int32 GetGridXSize() const { return GridXSize; }
+
+	/**
+	 * Getter for how many tiles there are on the y-axis.
+	 * @return Number of tiles on the y-axis.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Autobattler Grid")
+	int32 GetGridYSize() const { return GridYSize; }
+
 	/**
 	 * Getter for max z extent.
 	 * @return Grid max z extent (how far above/below an actor can be to be considered "on" grid).
@@ -196,6 +239,135 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Autobattler Grid")
 	bool GridIndexToLocation(const FIntPair& TestGridIndex, FVector& Location, FHitResult& HitResult, TEnumAsByte<ECollisionChannel> TraceChannel = ECollisionChannel::ECC_Visibility, bool TraceComplex = false) const;
 
+	/**
+	 * Gets the center of a grid index at the height of the grid, without tracing.
+	 * @param TestGridIndex Grid index we want to find the center of.
+	 * @return World location of the center of the grid index. Not meaningful if the index is invalid.
+	 */
+	FVector GetGridIndexCenter(const FIntPair& TestGridIndex) const;
+
+	/**
+	 * Gets every grid index whose center is within a horizontal distance of a location.
+	 * @param Location Location to measure from. Only its XY position is used.
+	 * @param Radius Maximum distance to the center of an index.
+	 * @param OutGridIndices (OUT) Grid indices in range.
+	 */
+	void GetIndicesInRadius(const FVector& Location, float Radius, TArray<FIntPair>& OutGridIndices) const;
+
+/////////////////////////////////////////////////////////////////////////////////
+//// OCCUPANCY
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * SERVER-ONLY
+	 * Clears occupancy and sizes it to the grid.
+	 */
+	void ResetOccupancy();
+
+	/**
+	 * SERVER-ONLY
+	 * Marks a grid index as occupied by a character. A character occupies at most one index, so its previous index is freed.
+	 * Highlights the index as occupied, and has the manager replicate that to clients.
+	 * @param GridIndex Grid index the character is deployed on.
+	 * @param CharacterID ID of the character.
+	 * @param WhoOwns Who owns the character.
+	 * @return False if the index is invalid or occupied by another character.
+	 */
+	bool SetIndexOccupant(const FIntPair& GridIndex, int32 CharacterID, EEntity WhoOwns);
+
+	/**
+	 * SERVER-ONLY
+	 * Frees the grid index occupied by a character, if any, and removes its occupied highlight.
+	 * @param CharacterID ID of the character.
+	 */
+	void ClearIndexOccupant(int32 CharacterID);
+
+	/**
+	 * SERVER-ONLY
+	 * Tests the occupancy bitmap. Only deployment, removal and death update it; characters moving during the fight do not.
+	 * @param GridIndex Grid index to test.
+	 * @return Whether a character is deployed on the index.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Autobattler Grid")
+	bool GetIsIndexOccupied(const FIntPair& GridIndex) const;
+
+	/**
+	 * SERVER-ONLY
+	 * Gets who is deployed on a grid index.
+	 * @param GridIndex Grid index to test.
+	 * @param OutCharacterID (OUT) ID of the character deployed on the index.
+	 * @param OutWhoOwns (OUT) Who owns that character.
+	 * @return Whether a character is deployed on the index.
+	 */
+	bool GetIndexOccupant(const FIntPair& GridIndex, int32& OutCharacterID, EEntity& OutWhoOwns) const;
+
+	/**
+	 * Builds a bitmask over the grid, laid out like the occupancy bitmap, from a list of grid indices. Invalid indices are skipped.
+	 * @param GridIndices Grid indices to set.
+	 * @param OutMask (OUT) The mask.
+	 */
+	void BuildIndexMask(const TArray<FIntPair>& GridIndices, TArray<uint32>& OutMask) const;
+
+	/**
+	 * SERVER-ONLY
+	 * Gets every grid index in a mask which is not occupied, a word of the bitmap at a time.
+	 * @param Mask Mask built by BuildIndexMask, e.g. a deployment zone.
+	 * @param OutGridIndices (OUT) Free grid indices in the mask.
+	 */
+	void GetFreeIndicesInMask(const TArray<uint32>& Mask, TArray<FIntPair>& OutGridIndices) const;
+
+	/**
+	 * Gets every grid index set in a mask, a word at a time.
+	 * @param Mask Mask built by BuildIndexMask or the functions below.
+	 * @param OutGridIndices (OUT) Grid indices in the mask.
+	 */
+	void GetIndicesInMask(const TArray<uint32>& Mask, TArray<FIntPair>& OutGridIndices) const;
+
+	/**
+	 * @param Mask Mask to test.
+	 * @param GridIndex Grid index to test.
+	 * @return Whether the index is valid and set in the mask.
+	 */
+	bool GetIsIndexInMask(const TArray<uint32>& Mask, const FIntPair& GridIndex) const;
+
+	/**
+	 * Sets or clears a single grid index in a mask, sizing the mask to the grid first if needed.
+	 * @param Mask (OUT) Mask to change.
+	 * @param GridIndex Grid index to change.
+	 * @param IsSet Whether to set or clear the index.
+	 * @return False if the index is invalid, or was already in the requested state.
+	 */
+	bool SetIndexInMask(TArray<uint32>& Mask, const FIntPair& GridIndex, bool IsSet) const;
+
+	/**
+	 * Builds a mask of every grid index in a rectangle. The rectangle is clamped to the grid, and its corners may be given in any order.
+	 * @param Corner First corner (inclusive).
+	 * @param OppositeCorner Opposite corner (inclusive).
+	 * @param OutMask (OUT) The mask.
+	 */
+	void BuildRectangleMask(const FIntPair& Corner, const FIntPair& OppositeCorner, TArray<uint32>& OutMask) const;
+
+	/**
+	 * Builds a mask of every grid index reachable from a start index by orthogonal steps, without stepping onto a boundary index.
+	 * @param Start Grid index to fill from. If it is invalid or on the boundary, the mask is empty.
+	 * @param BoundaryMask Mask of grid indices the fill may not enter.
+	 * @param OutMask (OUT) The mask.
+	 */
+	void BuildFloodFillMask(const FIntPair& Start, const TArray<uint32>& BoundaryMask, TArray<uint32>& OutMask) const;
+
+private:
+	/**
+	 * @return Bit index of a grid index in the occupancy bitmap, or INDEX_NONE if it is invalid.
+	 */
+	int32 GridIndexToBit(const FIntPair& GridIndex) const { return IsValidGridIndex(GridIndex) ? GridIndex.X * GridYSize + GridIndex.Y : INDEX_NONE; }
+
+	/**
+	 * Updates the occupied highlight of an index locally and in the manager's replicated grid cells.
+	 * @param Bit Bit index of the grid index.
+	 * @param IsOccupied Whether a character is deployed on it.
+	 */
+	void OnIndexOccupancyChanged(int32 Bit, bool IsOccupied);
+
 /////////////////////////////////////////////////////////////////////////////////
 //// UTILITY
 /////////////////////////////////////////////////////////////////////////////////
@@ -214,6 +386,42 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Autobattler Grid")
 	void ShowOnlyIndicies(const TArray<FIntPair>& IndiciesToShow);
 
+	/**
+	 * Highlights exactly the given indicies in one way, removing that highlight from every other index. Other highlights are kept.
+	 * Costs one pass over the grid and a single texture upload, however many indicies change.
+	 * @param GridIndices Grid indicies to highlight. Invalid indicies are skipped.
+	 * @param Highlight Which highlight to set.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler Grid")
+	void SetIndexHighlight(const TArray<FIntPair>& GridIndices, EGridHighlight Highlight);
+
+	/**
+	 * Removes a highlight from every index.
+	 * @param Highlight Which highlight to clear.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler Grid")
+	void ClearHighlight(EGridHighlight Highlight);
+
+	/**
+	 * Adds or removes a highlight on a single index, keeping every other index as it is. Uploads only if the index changed.
+	 * @param GridIndex Grid index to change.
+	 * @param Highlight Which highlight to change.
+	 * @param IsHighlighted Whether the index should have the highlight.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler Grid")
+	void SetSingleIndexHighlight(const FIntPair& GridIndex, EGridHighlight Highlight, bool IsHighlighted);
+
+private:
+	/**
+	 * @return Byte offset of a highlight within a cell's BGRA state, or INDEX_NONE.
+	 */
+	static int32 GetHighlightChannel(EGridHighlight Highlight);
+
+	/**
+	 * Copies CellStates to the cell state texture, or shows and hides the per-cell decals by the Shown highlight.
+	 */
+	void UploadCellStates();
+
 /////////////////////////////////////////////////////////////////////////////////
 //// NETWORKING
 /////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,218 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Types/AutobattlerStructs.h"
+
+/**
+ * Navigation-free pathfinding over the cells of the autobattler grid.
+ * For each side (players and AI) a flow field is built with Dijkstra's algorithm from every cell holding an enemy, so any unit can
+ * read its next step towards the nearest enemy without searching. Flow fields are rebuilt lazily, only after occupancy has changed.
+ * A* with cell reservations is offered for targets which are not covered by a flow field, and for steps another unit has claimed.
+ * Moving between cells costs 10 orthogonally and 14 diagonally.
+ */
+class AUTOBATTLERPLUGIN_API FAutobattlerGridPathfinder
+{
+public:
+	/* A character standing on a grid cell. */
+	struct FOccupant
+	{
+		FIntPair Cell;
+		EEntity WhoOwns;
+		int32 CharacterID;
+	};
+
+/////////////////////////////////////////////////////////////////////////////////
+//// CONSTRUCTION
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Default constructor.
+	 */
+	FAutobattlerGridPathfinder();
+
+	/**
+	 * Clears occupancy, reservations and flow fields, and sets the grid size.
+	 * @param NewSizeX How many cells on the x-axis.
+	 * @param NewSizeY How many cells on the y-axis.
+	 */
+	void Reset(int32 NewSizeX, int32 NewSizeY);
+
+	/**
+	 * Replaces the occupancy of every cell. Flow fields are only invalidated if a cell changed which side(s) stand on it.
+	 * Occupants outside of the grid are ignored.
+	 * @param Occupants Every (alive) character on the grid.
+	 * @return Whether flow fields were invalidated.
+	 */
+	bool UpdateOccupancy(const TArray<FOccupant>& Occupants);
+
+	/**
+	 * @return How many cells there are on the x-axis.
+	 */
+	int32 GetSizeX() const { return SizeX; }
+
+	/**
+	 * @return How many cells there are on the y-axis.
+	 */
+	int32 GetSizeY() const { return SizeY; }
+
+/////////////////////////////////////////////////////////////////////////////////
+//// FLOW FIELDS
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Gets the next cell to step onto to reach the nearest enemy. Cells holding allies are avoided where it is cheap to do so.
+	 * @param From Cell the unit is standing on.
+	 * @param WhoOwns Who owns the unit.
+	 * @param OutNextCell (OUT) Next cell to step onto. This is the enemy's cell once the unit is next to it.
+	 * @return False if From is invalid, already holds an enemy, or no enemy can be reached.
+	 */
+	bool GetNextStep(const FIntPair& From, EEntity WhoOwns, FIntPair& OutNextCell);
+
+	/**
+	 * Gets the cost of the cheapest path from a cell to the nearest enemy.
+	 * @param From Cell to measure from.
+	 * @param WhoOwns Who owns the unit.
+	 * @return Path cost, or INDEX_NONE if no enemy can be reached.
+	 */
+	int32 GetCostToNearestEnemy(const FIntPair& From, EEntity WhoOwns);
+
+/////////////////////////////////////////////////////////////////////////////////
+//// A* AND RESERVATIONS
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Finds the cheapest path between two cells, around cells which hold or are reserved by other characters.
+	 * The goal cell may be occupied (e.g. by the target).
+	 * @param From Cell the unit is standing on.
+	 * @param To Goal cell.
+	 * @param CharacterID Character looking for a path. Its own occupancy and reservation do not block it.
+	 * @param OutPath (OUT) Cells to step onto in order, excluding From and including To. Empty if From is To.
+	 * @return Whether a path was found.
+	 */
+	bool FindPath(const FIntPair& From, const FIntPair& To, int32 CharacterID, TArray<FIntPair>& OutPath);
+
+	/**
+	 * Reserves a cell for a character about to step onto it, replacing the character's previous reservation.
+	 * @param Cell Cell to reserve.
+	 * @param CharacterID Character reserving the cell.
+	 * @return False if the cell is invalid or already reserved by another character.
+	 */
+	bool ReserveCell(const FIntPair& Cell, int32 CharacterID);
+
+	/**
+	 * Releases the reservation held by a character, if any.
+	 * @param CharacterID Character whose reservation should be released.
+	 */
+	void ReleaseReservation(int32 CharacterID);
+
+	/**
+	 * @param Cell Cell to test.
+	 * @param CharacterID Character asking. Its own occupancy and reservation do not count.
+	 * @return Whether the cell is valid, and neither holds nor is reserved by another character.
+	 */
+	bool IsCellFree(const FIntPair& Cell, int32 CharacterID) const;
+
+	/**
+	 * Walks the cells a straight line between two cells crosses.
+	 * @param From Start cell (not tested).
+	 * @param To End cell (not tested).
+	 * @return Whether none of the cells in between hold a character.
+	 */
+	bool HasClearLine(const FIntPair& From, const FIntPair& To) const;
+
+	/**
+	 * @return Cost between two cells on an empty grid, in the same units as path and flow field costs.
+	 */
+	static int32 GetOctileDistance(const FIntPair& A, const FIntPair& B);
+
+/////////////////////////////////////////////////////////////////////////////////
+//// INTERNAL
+/////////////////////////////////////////////////////////////////////////////////
+private:
+	/* Occupancy flags of a cell. */
+	enum ECellFlags : uint8
+	{
+		PlayersSide = 1 << 0,
+		AISide      = 1 << 1
+	};
+
+	/* Flow field of one side. */
+	struct FFlowField
+	{
+		/* Cost to the nearest enemy per cell, or MAX_int32 if unreachable. */
+		TArray<int32> Costs;
+
+		/* Next cell towards the nearest enemy per cell, or INDEX_NONE. */
+		TArray<int32> NextCells;
+
+		/* Whether occupancy has changed since the field was built. */
+		bool IsDirty = true;
+	};
+
+	/* Entry of the open set shared by Dijkstra and A*. */
+	struct FOpenEntry
+	{
+		int32 Priority;
+		int32 Cell;
+
+		bool operator<(const FOpenEntry& Other) const { return Priority < Other.Priority; }
+	};
+
+	/**
+	 * @return Dense index of a cell, or INDEX_NONE if it is outside the grid.
+	 */
+	int32 ToIndex(const FIntPair& Cell) const { return Cell.X >= 0 && Cell.Y >= 0 && Cell.X < SizeX && Cell.Y < SizeY ? Cell.X * SizeY + Cell.Y : INDEX_NONE; }
+
+	/**
+	 * @return Cell at a dense index.
+	 */
+	FIntPair ToCell(int32 Index) const { return FIntPair(Index / SizeY, Index % SizeY); }
+
+	/**
+	 * @return Flow field index used by characters owned by WhoOwns.
+	 */
+	static int32 GetSideIndex(EEntity WhoOwns) { return WhoOwns == EEntity::AI ? 1 : 0; }
+
+	/**
+	 * Gets the flow field used by characters owned by WhoOwns, rebuilding it first if it is dirty.
+	 * @return The flow field.
+	 */
+	const FFlowField& GetFlowField(EEntity WhoOwns);
+
+	/**
+	 * Runs Dijkstra's algorithm outwards from every cell holding an enemy of a side.
+	 * @param SideIndex Side to build the field for.
+	 */
+	void BuildFlowField(int32 SideIndex);
+
+	/* Extra cost of stepping onto a cell which holds an ally, so units flow around each other rather than queue up. */
+	static constexpr int32 AllyOccupiedCost = 20;
+
+	/* Grid size. */
+	int32 SizeX;
+	int32 SizeY;
+
+	/* Per cell: side flags, how many characters stand on it, the first of them, and who has reserved it (or INDEX_NONE). */
+	TArray<uint8> CellFlags;
+	TArray<int32> CellOccupantCounts;
+	TArray<int32> CellFirstOccupants;
+	TArray<int32> CellReservations;
+
+	/* Reserved cell of each character holding a reservation. */
+	TMap<int32, int32> ReservationsByCharacter;
+
+	/* Flow fields for characters owned by players (0) and the AI (1). */
+	FFlowField FlowFields[2];
+
+	/* A* scratch arrays. A cell's scores are only valid if its stamp matches the current search. */
+	TArray<int32> SearchCosts;
+	TArray<int32> SearchParents;
+	TArray<uint32> SearchStamps;
+	uint32 CurrentSearchStamp;
+
+	/* Open set scratch array. */
+	TArray<FOpenEntry> OpenSet;
+};
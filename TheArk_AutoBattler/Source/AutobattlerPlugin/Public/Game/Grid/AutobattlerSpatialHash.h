@@ -0,0 +1,159 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Function.h"
+
+class AAutobattlerCharacter;
+
+/**
+ * Uniform spatial hash over autobattler characters, used for target acquisition.
+ * Cells are square on the XY plane and aligned to the autobattler grid, so one cell matches one grid tile. Cells are keyed by
+ * integer coordinates rather than stored densely, meaning characters which walk off the grid are still indexed.
+ * The hash holds plain pointers; it is expected to be rebuilt (see Rebuild) before characters are garbage collected.
+ */
+class AUTOBATTLERPLUGIN_API FAutobattlerSpatialHash
+{
+public:
+	/* Predicate used to filter characters during a query. Return true to accept the character. */
+	typedef TFunctionRef<bool(const AAutobattlerCharacter*)> FCharacterPredicate;
+
+/////////////////////////////////////////////////////////////////////////////////
+//// CONSTRUCTION
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Default constructor.
+	 */
+	FAutobattlerSpatialHash();
+
+	/**
+	 * Clears the hash and sets the cell layout.
+	 * @param NewCellSize X/Y size of each cell. Usually the grid XYSize.
+	 * @param NewOrigin World location cells are aligned to. Usually the grid actor location.
+	 */
+	void Reset(float NewCellSize, const FVector& NewOrigin);
+
+	/**
+	 * Rebuilds the hash from scratch. Invalid characters are skipped.
+	 * @param Characters Characters to index.
+	 */
+	void Rebuild(const TArray<AAutobattlerCharacter*>& Characters);
+
+/////////////////////////////////////////////////////////////////////////////////
+//// QUERIES
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Gets every accepted character within Radius of Origin (3D distance, matching a sphere sweep).
+	 * @param Origin Center of the query.
+	 * @param Radius Query radius.
+	 * @param Predicate Filters which characters can be returned.
+	 * @param OutCharacters (OUT) Characters within the radius, in no particular order.
+	 */
+	void QueryRadius(const FVector& Origin, float Radius, FCharacterPredicate Predicate, TArray<AAutobattlerCharacter*>& OutCharacters) const;
+
+	/**
+	 * Gets every accepted character inside an axis aligned box.
+	 * @param Origin Center of the box.
+	 * @param Extent Half size of the box.
+	 * @param Predicate Filters which characters can be returned.
+	 * @param OutCharacters (OUT) Characters inside the box, in no particular order.
+	 */
+	void QueryBox(const FVector& Origin, const FVector& Extent, FCharacterPredicate Predicate, TArray<AAutobattlerCharacter*>& OutCharacters) const;
+
+	/**
+	 * Gets the accepted character nearest to Origin. Searches outward ring by ring, stopping as soon as no further ring can hold a closer character.
+	 * @param Origin Location to measure distance from.
+	 * @param Predicate Filters which characters can be returned.
+	 * @param MaxRange Characters further than this are ignored. Negative means unlimited.
+	 * @return Nearest accepted character, or nullptr if there is none.
+	 */
+	AAutobattlerCharacter* QueryNearest(const FVector& Origin, FCharacterPredicate Predicate, float MaxRange = -1.0f) const;
+
+	/**
+	 * Gets up to Count accepted characters nearest to Origin.
+	 * @param Origin Location to measure distance from.
+	 * @param Count Maximum number of characters to return.
+	 * @param Predicate Filters which characters can be returned.
+	 * @param OutCharacters (OUT) Nearest characters, sorted nearest first.
+	 * @param MaxRange Characters further than this are ignored. Negative means unlimited.
+	 */
+	void QueryKNearest(const FVector& Origin, int32 Count, FCharacterPredicate Predicate, TArray<AAutobattlerCharacter*>& OutCharacters, float MaxRange = -1.0f) const;
+
+/////////////////////////////////////////////////////////////////////////////////
+//// ACCESSORS
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Getter for the number of indexed characters.
+	 * @return Number of indexed characters.
+	 */
+	int32 Num() const { return Entries.Num(); }
+
+	/**
+	 * Getter for the cell size.
+	 * @return X/Y size of each cell.
+	 */
+	float GetCellSize() const { return CellSize; }
+
+	/**
+	 * Converts a world location to the cell containing it.
+	 * @param Location World location.
+	 * @return Cell coordinates.
+	 */
+	FIntPoint LocationToCell(const FVector& Location) const;
+
+/////////////////////////////////////////////////////////////////////////////////
+//// INTERNAL
+/////////////////////////////////////////////////////////////////////////////////
+private:
+	/* A single indexed character. */
+	struct FEntry
+	{
+		AAutobattlerCharacter* Character;
+		FVector Location;
+		FIntPoint Cell;
+	};
+
+	/* All indexed characters, sorted so characters in the same cell are contiguous. */
+	TArray<FEntry> Entries;
+
+	/* Maps a cell to the first entry in that cell (X) and the number of entries in it (Y). */
+	TMap<FIntPoint, FIntPoint> CellRanges;
+
+	/* Bounds of all occupied cells, used to know when a ring search can stop. */
+	FIntPoint MinCell;
+	FIntPoint MaxCell;
+
+	/* X/Y size of each cell. */
+	float CellSize;
+
+	/* World location cells are aligned to. */
+	FVector Origin;
+
+	/**
+	 * Calls Visitor on every entry in cells within [CellMin, CellMax].
+	 * @param CellMin Min cell (inclusive).
+	 * @param CellMax Max cell (inclusive).
+	 * @param Visitor Called for each entry.
+	 */
+	void ForEachEntryInCells(const FIntPoint& CellMin, const FIntPoint& CellMax, TFunctionRef<void(const FEntry&)> Visitor) const;
+
+	/**
+	 * Calls Visitor on every entry in cells exactly Ring cells away (Chebyshev distance) from Center.
+	 * @param Center Center cell.
+	 * @param Ring Ring to visit. Ring 0 is only the center cell.
+	 * @param Visitor Called for each entry.
+	 */
+	void ForEachEntryInRing(const FIntPoint& Center, int32 Ring, TFunctionRef<void(const FEntry&)> Visitor) const;
+
+	/**
+	 * Gets the furthest ring from Center which can contain any entry.
+	 * @param Center Center cell.
+	 * @return Max ring which needs to be searched.
+	 */
+	int32 GetMaxRing(const FIntPoint& Center) const;
+};
@@ -53,6 +53,9 @@ private:
 	UPROPERTY()
 	AActor* LastMousedOverActor;
 
+	/* Grid index under the mouse, highlighted as hovered on the grid, or (-1, -1) if there is none. */
+	FIntPair HoveredGridIndex;
+
 	/* Mouse collision channel. */
 	UPROPERTY(Replicated)
 	TEnumAsByte<ECollisionChannel> MouseCollisionChannel;
@@ -138,6 +141,14 @@ public:
 	 */
 	void HandleMouseOverCharacter(bool RequestedByServer);
 
+private:
+	/**
+	 * Moves the grid's hovered highlight to the grid index under the mouse. Only done for the locally controlled pawn.
+	 * @param Hit Whether anything is under the mouse.
+	 * @param Location Location under the mouse.
+	 */
+	void UpdateHoveredGridIndex(bool Hit, const FVector& Location);
+
 /////////////////////////////////////////////////////////////////////////////////
 //// INPUT
 /////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,215 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Types/AutobattlerStructs.h"
+
+class AAutobattlerCharacter;
+class UAutobattlerSkill;
+
+/**
+ * Identifies an effect held by FAutobattlerEffectScheduler. A handle stays unique after its effect ends, so a stale handle
+ * never refers to a newer effect.
+ */
+struct AUTOBATTLERPLUGIN_API FAutobattlerEffectHandle
+{
+	/* Slot of the effect in the scheduler. */
+	int32 Slot = INDEX_NONE;
+
+	/* Generation of the slot when the effect was added. */
+	uint32 Generation = 0;
+
+	/**
+	 * @return Whether this handle was ever given out. Does not mean the effect is still active (see FAutobattlerEffectScheduler::IsActive).
+	 */
+	bool IsValid() const { return Slot != INDEX_NONE; }
+
+	bool operator==(const FAutobattlerEffectHandle& Other) const { return Slot == Other.Slot && Generation == Other.Generation; }
+	bool operator!=(const FAutobattlerEffectHandle& Other) const { return !(*this == Other); }
+};
+
+/**
+ * Server side store of every timed effect on autobattler characters (temporary stat and type changes, poison, repeating skills).
+ * Effects are stored as parallel arrays, and all of them are ticked in a single pass, instead of each effect owning a timer or component.
+ * Effects on a character which has been destroyed are dropped on their next tick.
+ */
+class AUTOBATTLERPLUGIN_API FAutobattlerEffectScheduler
+{
+public:
+	/* What an effect does when it fires. */
+	enum class EEffectType : uint8
+	{
+		StatModifier,       // Reverts a stat modification once, on expiry.
+		ResistanceOverride, // Restores a resistance type once, on expiry.
+		DamageTypeOverride, // Restores a damage type once, on expiry.
+		Poison,             // Deals damage every interval, losing strength each time, until no strength remains.
+		RepeatingSkill      // Executes a skill's effects on the target every interval, a number of times.
+	};
+
+/////////////////////////////////////////////////////////////////////////////////
+//// EFFECTS
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Schedules reverting a stat modification which has already been applied.
+	 * @param Target Character whose stat was modified.
+	 * @param StatToModify Which stat was modified.
+	 * @param ModifierScale By how much the stat was modified. The opposite is applied on expiry.
+	 * @param ExpiryDuration How long until the modification wears off.
+	 * @return Handle to the effect.
+	 */
+	FAutobattlerEffectHandle AddStatModifier(AAutobattlerCharacter* Target, EAutobattlerStatType StatToModify, float ModifierScale, float ExpiryDuration);
+
+	/**
+	 * Schedules restoring a resistance type which has been temporarily changed.
+	 * @param Target Character whose resistance type was changed.
+	 * @param PreviousResistanceType Resistance type to restore on expiry.
+	 * @param ExpiryDuration How long until the change wears off.
+	 * @return Handle to the effect.
+	 */
+	FAutobattlerEffectHandle AddResistanceOverride(AAutobattlerCharacter* Target, EResistanceType PreviousResistanceType, float ExpiryDuration);
+
+	/**
+	 * Schedules restoring a damage type which has been temporarily changed.
+	 * @param Target Character whose damage type was changed.
+	 * @param PreviousDamageType Damage type to restore on expiry.
+	 * @param ExpiryDuration How long until the change wears off.
+	 * @return Handle to the effect.
+	 */
+	FAutobattlerEffectHandle AddDamageTypeOverride(AAutobattlerCharacter* Target, EDamageType PreviousDamageType, float ExpiryDuration);
+
+	/**
+	 * Poisons a character. A character has at most one poison effect; poisoning a character which is already poisoned adds to its strength.
+	 * A new poison ticks on the next scheduler tick.
+	 * @param Target Character to poison.
+	 * @param PoisonStrength How much damage the poison deals on its next tick.
+	 * @param TickRate Time between poison ticks.
+	 * @param StrengthReductionRate How much strength the poison loses per tick.
+	 * @return Handle to the (possibly already existing) poison effect.
+	 */
+	FAutobattlerEffectHandle AddPoison(AAutobattlerCharacter* Target, float PoisonStrength, float TickRate, float StrengthReductionRate);
+
+	/**
+	 * Repeatedly executes the effects of a skill on a character.
+	 * @param Target Character to execute the skill effects on.
+	 * @param SkillAsset Skill whose effects are executed.
+	 * @param SkillOwner Character who executed the skill. The effect ends if this character is destroyed.
+	 * @param TargetingProperties Initial targeting properties.
+	 * @param Interval Time between executions.
+	 * @param NumRepetitions How many times the skill effects are executed.
+	 * @return Handle to the effect.
+	 */
+	FAutobattlerEffectHandle AddRepeatingSkill(AAutobattlerCharacter* Target, const UAutobattlerSkill* SkillAsset, AAutobattlerCharacter* SkillOwner, const FAbilityTargetingProperties& TargetingProperties, float Interval, int32 NumRepetitions);
+
+	/**
+	 * @param Handle Handle to check.
+	 * @return Whether the effect is still active.
+	 */
+	bool IsActive(const FAutobattlerEffectHandle& Handle) const { return ResolveHandle(Handle) != INDEX_NONE; }
+
+	/**
+	 * Ends an effect early.
+	 * @param Handle Effect to end.
+	 * @param ShouldRevert If true, temporary stat and type changes are reverted now rather than left in place.
+	 * @return Whether the effect was active.
+	 */
+	bool Cancel(const FAutobattlerEffectHandle& Handle, bool ShouldRevert = true);
+
+	/**
+	 * Ends every effect on a character early, e.g. because it died.
+	 * @param Target Character to end effects on.
+	 * @param ShouldRevert If true, temporary stat and type changes are reverted now rather than left in place.
+	 * @return How many effects were ended.
+	 */
+	int32 CancelAllOnTarget(const AAutobattlerCharacter* Target, bool ShouldRevert = true);
+
+	/**
+	 * Drops every effect without reverting anything, and restarts the clock.
+	 */
+	void Reset();
+
+	/**
+	 * @return How many effects are active.
+	 */
+	int32 Num() const { return Types.Num(); }
+
+/////////////////////////////////////////////////////////////////////////////////
+//// TICK
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Advances time and fires every effect which is due, as many times as it is due.
+	 * Effects added while ticking are first considered on the next tick.
+	 * @param DeltaTime Time elapsed since last tick.
+	 */
+	void Tick(float DeltaTime);
+
+/////////////////////////////////////////////////////////////////////////////////
+//// INTERNAL
+/////////////////////////////////////////////////////////////////////////////////
+private:
+	/* Cold data only needed when a repeating skill fires. */
+	struct FRepeatingSkillPayload
+	{
+		TWeakObjectPtr<const UAutobattlerSkill> SkillAsset;
+		TWeakObjectPtr<AAutobattlerCharacter> SkillOwner;
+		FAbilityTargetingProperties TargetingProperties;
+	};
+
+	/**
+	 * Adds an effect to the end of the dense arrays.
+	 * @return Handle to the new effect.
+	 */
+	FAutobattlerEffectHandle AddEffect(EEffectType Type, AAutobattlerCharacter* Target, float Delay, float Interval, float Magnitude, float MagnitudeDecay, uint8 Parameter, int32 RemainingRepetitions);
+
+	/**
+	 * @return Dense index of the effect, or INDEX_NONE if it is no longer active.
+	 */
+	int32 ResolveHandle(const FAutobattlerEffectHandle& Handle) const;
+
+	/**
+	 * Removes an effect by swapping the last effect into its place, and retires its handle.
+	 * @param DenseIndex Effect to remove.
+	 */
+	void RemoveEffect(int32 DenseIndex);
+
+	/**
+	 * Removes an effect, then reverts its temporary change if it has one.
+	 * @param DenseIndex Effect to end.
+	 */
+	void EndEffect(int32 DenseIndex);
+
+	/**
+	 * Fires an effect once. Scheduler state is updated before any game code runs, as game code may add or cancel effects.
+	 * @param DenseIndex Effect to fire.
+	 */
+	void FireEffect(int32 DenseIndex);
+
+	/* Current scheduler time. */
+	float CurrentTime = 0.0f;
+
+	/* Dense, parallel effect arrays. The hot loop in Tick only reads NextFireTimes. */
+	TArray<float> NextFireTimes;
+	TArray<EEffectType> Types;
+	TArray<TWeakObjectPtr<AAutobattlerCharacter>> Targets;
+	TArray<float> Intervals;
+	TArray<float> Magnitudes;
+	TArray<float> MagnitudeDecays;
+	TArray<uint8> Parameters;
+	TArray<int32> RemainingRepetitions;
+	TArray<FRepeatingSkillPayload> RepeatingSkillPayloads;
+	TArray<int32> DenseToSlot;
+
+	/* Handle indirection: slot to dense index (INDEX_NONE if free), slot generation, and free slots. */
+	TArray<int32> SlotToDense;
+	TArray<uint32> SlotGenerations;
+	TArray<int32> FreeSlots;
+
+	/* The poison effect of each poisoned character, so stacking poison does not need a search. */
+	TMap<TWeakObjectPtr<AAutobattlerCharacter>, FAutobattlerEffectHandle> PoisonByTarget;
+
+	/* Scratch array of effects due this tick. */
+	TArray<FAutobattlerEffectHandle> DueEffects;
+};
@@ -44,11 +44,8 @@ protected:
 //// INTERNAL
 /////////////////////////////////////////////////////////////////////////////////
 private:
-	/* Whether or not we should check if we are within range of the target. */
-	bool ShouldCheckDestination;
-
-	/* How far away for the target to be considered "hit." */
-	float MinDistanceToTarget;
+	/* Server only. Index of this projectile in the manager's projectile system, or INDEX_NONE if it is not moving. */
+	int32 ProjectileSystemIndex = INDEX_NONE;
 
 	/* Who/where this projectile is targeting. */
 	FAbilityTargetingProperties ProjectileTargetingProperties;
@@ -59,9 +56,18 @@ private:
 	/* Passed when the skill actually executes. */
 	const UAutobattlerSkill* SkillImplementationInternal;
 
-	/* Target of projectile movement. */
+	/* Client only. Target of projectile movement, if it is homing in on a component. */
 	USceneComponent* CurrentProjectileHomingTarget;
 
+	/* Client only. Target of projectile movement, if it is not homing in on a component. */
+	FVector CurrentProjectileTargetLocation;
+
+	/* Client only. Speed of projectile movement. */
+	float CurrentProjectileSpeed;
+
+	/* Moves projectiles on the server. */
+	friend class FAutobattlerProjectileSystem;
+
 /////////////////////////////////////////////////////////////////////////////////
 //// CONSTRUCTION
 /////////////////////////////////////////////////////////////////////////////////
@@ -79,30 +85,57 @@ public:
 	 */
 	void InitialiseProjectile(const UAutobattlerSkill* SkillImplementation, AAutobattlerCharacter* SkillOwner, const FAbilityTargetingProperties& TargetingProperties);
 
+/////////////////////////////////////////////////////////////////////////////////
+//// POOLING
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * SERVER-ONLY
+	 * Gets a projectile from the manager's skill actor pool, or spawns one if there is no manager.
+	 * @param WorldContextObject Object in the world to get the projectile in.
+	 * @param SpawnTransform Transform to place the projectile at.
+	 * @return The projectile, or nullptr if it could not be spawned.
+	 */
+	static AAutobattlerProjectile* AcquireFromPool(const UObject* WorldContextObject, const FTransform& SpawnTransform);
+
+	/**
+	 * Returns this projectile to the manager's skill actor pool, or destroys it if there is no manager.
+	 */
+	void ReleaseToPool();
+
+	/**
+	 * Called by the pool when this projectile is taken from it. Reactivates the projectile.
+	 */
+	virtual void OnAcquiredFromPool();
+
+	/**
+	 * Called by the pool when this projectile is returned to it. Stops, hides and detaches the projectile from its target.
+	 */
+	virtual void OnReleasedToPool();
+
 /////////////////////////////////////////////////////////////////////////////////
 //// PROJECTILE
 /////////////////////////////////////////////////////////////////////////////////
 public:	
 	/**
-	 * Checks to see if projectile is within range of its target.
-	 * @param DeltaTime Unused.
+	 * Moves the projectile towards its target on clients. On the server, projectiles are moved by the manager's projectile system instead.
+	 * @param DeltaTime Time elapsed since last tick.
 	 */
 	virtual void Tick(float DeltaTime) override;
 
 private:
 	/**
-	 * Updates visual components of this projectile for server and client.
+	 * Tells clients how the projectile looks and where it is flying, so they can move it themselves. It is the only launch and stop signal
+	 * clients get, so it is sent reliably, as a single call per launch and stop. Locations are quantized to whole units.
 	 * @param NewMesh Mesh to set.
 	 * @param NewParticleSystem Particle system to set.
+	 * @param ProjectileHomingTarget Component to home in on, or nullptr to fly to TargetLocation.
+	 * @param StartLocation Where the projectile starts from; pooled projectiles are moved rather than spawned, so clients are told explicitly.
+	 * @param TargetLocation Where the projectile flies to, if it has no homing target.
+	 * @param Speed Speed of the projectile. Zero stops the projectile.
 	 */
 	UFUNCTION(NetMulticast, Reliable)
-	void UpdateVisuals(UStaticMesh* NewMesh, UParticleSystem* NewParticleSystem);
-
-	/**
-	 * Ensures both client and server have correct targeting properties for projectiles.
-	 */
-	UFUNCTION(NetMulticast, Reliable)
-	void UpdateProjectileTarget(USceneComponent* ProjectileHomingTarget);
+	void UpdateProjectileFlight(UStaticMesh* NewMesh, UParticleSystem* NewParticleSystem, USceneComponent* ProjectileHomingTarget, const FVector_NetQuantize& StartLocation, const FVector_NetQuantize& TargetLocation, float Speed);
 
 	/**
 	 * Called when the projectile reaches its destination.
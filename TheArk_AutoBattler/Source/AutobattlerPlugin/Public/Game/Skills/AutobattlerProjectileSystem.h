@@ -0,0 +1,94 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AAutobattlerProjectile;
+class USceneComponent;
+
+/**
+ * Server side store of every projectile in flight. Projectiles are stored as parallel arrays and all of them are moved in a single pass,
+ * instead of each projectile actor ticking itself. The game thread is only called back for projectiles which arrive or lose their target.
+ */
+class AUTOBATTLERPLUGIN_API FAutobattlerProjectileSystem
+{
+/////////////////////////////////////////////////////////////////////////////////
+//// PROJECTILES
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Starts moving a projectile. A projectile which is already moving is restarted.
+	 * @param Projectile Projectile actor to move.
+	 * @param StartLocation Where the projectile starts from.
+	 * @param HomingTarget Component to home in on, or nullptr to fly to TargetLocation.
+	 * @param TargetLocation Where the projectile flies to, if it has no homing target.
+	 * @param Speed Speed of the projectile, in units per second.
+	 * @param MinDistanceToHit How close the projectile has to be to its target to arrive.
+	 */
+	void Add(AAutobattlerProjectile* Projectile, const FVector& StartLocation, USceneComponent* HomingTarget, const FVector& TargetLocation, float Speed, float MinDistanceToHit);
+
+	/**
+	 * Stops moving a projectile, without notifying it.
+	 * @param Projectile Projectile to stop.
+	 */
+	void Remove(AAutobattlerProjectile* Projectile);
+
+	/**
+	 * Stops moving every projectile, without notifying them.
+	 */
+	void Reset();
+
+	/**
+	 * @return How many projectiles are in flight.
+	 */
+	int32 Num() const { return Positions.Num(); }
+
+/////////////////////////////////////////////////////////////////////////////////
+//// TICK
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Moves every projectile, then notifies projectiles which have arrived (or whose homing target is gone).
+	 * Projectiles added while notifying are first moved on the next tick.
+	 * @param DeltaTime Time elapsed since last tick.
+	 * @param ShouldUpdateActors Whether projectile actors should be moved every tick. Not needed on a dedicated server, where
+	 * projectiles are not rendered and are only moved to their final position when they arrive.
+	 */
+	void Tick(float DeltaTime, bool ShouldUpdateActors);
+
+/////////////////////////////////////////////////////////////////////////////////
+//// INTERNAL
+/////////////////////////////////////////////////////////////////////////////////
+private:
+	/* A projectile to notify after moving, and which flight it was on, in case it is released and reused by an earlier notification. */
+	struct FFinishedFlight
+	{
+		TWeakObjectPtr<AAutobattlerProjectile> Projectile;
+		uint32 FlightID;
+		bool HasArrived;
+	};
+
+	/**
+	 * Removes a projectile by swapping the last projectile into its place.
+	 * @param Index Projectile to remove.
+	 */
+	void RemoveAt(int32 Index);
+
+	/* Dense, parallel projectile arrays. The hot loop in Tick only reads and writes the first four. */
+	TArray<FVector> Positions;
+	TArray<FVector> TargetLocations;
+	TArray<float> Speeds;
+	TArray<float> MinDistancesSquared;
+	TArray<TWeakObjectPtr<USceneComponent>> HomingTargets;
+	TArray<bool> HasHomingTargets;
+	TArray<TWeakObjectPtr<AAutobattlerProjectile>> Projectiles;
+	TArray<uint32> FlightIDs;
+
+	/* Used to tell flights of the same (pooled) projectile apart. */
+	uint32 NextFlightID = 0;
+
+	/* Scratch array of projectiles to notify this tick. */
+	TArray<FFinishedFlight> FinishedFlights;
+};
@@ -0,0 +1,136 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AutobattlerSkillActorPool.generated.h"
+
+class AAutobattlerProjectile;
+class AExecuteSkill;
+
+/* Internal structure holding the pooled (inactive) actors of one class. */
+USTRUCT()
+struct FAutobattlerPooledActors
+{
+	GENERATED_BODY()
+public:
+	/* Inactive actors, ready to be reused. */
+	UPROPERTY()
+	TArray<AActor*> Actors;
+};
+
+/* Counters describing how well the skill actor pool is doing. */
+USTRUCT(BlueprintType)
+struct FAutobattlerActorPoolStats
+{
+	GENERATED_BODY()
+public:
+	/* How many actors had to be spawned (including pre-warmed actors). */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 NumSpawned = 0;
+
+	/* How many requests were served by reusing a pooled actor. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 NumReused = 0;
+
+	/* How many actors were returned to the pool. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 NumReleased = 0;
+
+	/* How many actors are currently pooled. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 NumAvailable = 0;
+
+	/* Fraction of requests served from the pool. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	float HitRate = 0.0f;
+};
+
+/**
+ * Server side pool of skill executors and projectiles, so firing skills does not spawn and destroy replicated actors.
+ * Pooled actors stay alive (and replicated) but are hidden and inactive until they are acquired again.
+ */
+USTRUCT()
+struct FAutobattlerSkillActorPool
+{
+	GENERATED_BODY()
+public:
+	/**
+	 * Spawns actors up front so early skills do not have to.
+	 * @param World World to spawn in.
+	 * @param ExecuteSkillClass Class of executors to spawn.
+	 * @param NumExecuteSkills How many executors should be pooled at least.
+	 * @param NumProjectiles How many projectiles should be pooled at least.
+	 */
+	void Prewarm(UWorld* World, TSubclassOf<AExecuteSkill> ExecuteSkillClass, int32 NumExecuteSkills, int32 NumProjectiles);
+
+	/**
+	 * Gets an active executor, reusing a pooled one if possible.
+	 * @param World World to spawn in, if nothing is pooled.
+	 * @param ExecuteSkillClass Class of executor.
+	 * @param Transform Transform to place the executor at.
+	 * @return The executor, or nullptr if it could not be spawned.
+	 */
+	AExecuteSkill* AcquireExecuteSkill(UWorld* World, TSubclassOf<AExecuteSkill> ExecuteSkillClass, const FTransform& Transform);
+
+	/**
+	 * Gets an active projectile, reusing a pooled one if possible.
+	 * @param World World to spawn in, if nothing is pooled.
+	 * @param Transform Transform to place the projectile at.
+	 * @return The projectile, or nullptr if it could not be spawned.
+	 */
+	AAutobattlerProjectile* AcquireProjectile(UWorld* World, const FTransform& Transform);
+
+	/**
+	 * Deactivates an actor and returns it to the pool. Does nothing if it is already pooled.
+	 * @param Actor Executor or projectile which has finished.
+	 */
+	void Release(AActor* Actor);
+
+	/**
+	 * Destroys every pooled actor.
+	 */
+	void Empty();
+
+	/**
+	 * @return Pool usage counters.
+	 */
+	FAutobattlerActorPoolStats GetStats() const;
+
+private:
+	/**
+	 * Takes a pooled actor of the given class, or spawns a new one.
+	 * @return The actor, placed at Transform, or nullptr if it could not be spawned.
+	 */
+	AActor* Acquire(UWorld* World, UClass* ActorClass, const FTransform& Transform);
+
+	/**
+	 * @return Whether an actor is among the pooled actors of its class.
+	 */
+	bool IsPooled(const AActor* Actor) const;
+
+	/**
+	 * Deactivates an actor and adds it to the pooled actors of its class.
+	 * @param Actor Executor or projectile to pool.
+	 */
+	void AddToPool(AActor* Actor);
+
+	/**
+	 * Spawns an actor of the given class, and counts it.
+	 * @return The new actor, or nullptr if it could not be spawned.
+	 */
+	AActor* SpawnActor(UWorld* World, UClass* ActorClass, const FTransform& Transform);
+
+	/* Pooled actors keyed by class. */
+	UPROPERTY()
+	TMap<UClass*, FAutobattlerPooledActors> AvailableActors;
+
+	/* How many actors were asked for, pooled or not. */
+	int32 NumRequests = 0;
+
+	/* See FAutobattlerActorPoolStats. */
+	int32 NumSpawned = 0;
+	int32 NumReused = 0;
+	int32 NumReleased = 0;
+};
@@ -8,6 +8,8 @@
 #include "Types/AutobattlerStructs.h"
 #include "DealDamage.generated.h"
 
+class UAutobattlerConfiguration;
+
 /**
  * Skill implementation for dealing damage between Min and Max.
  */
@@ -39,4 +41,35 @@ public:
 	 * @param Location Unused. 
 	 */
 	virtual void ExecuteSkill_Implementation(AAutobattlerCharacter* SkillOwner, ESkillTargetingMode SkillTargetingMode, AAutobattlerCharacter* Target, const FVector& TargetLocation) override;
+
+	/**
+	 * Deals damage to many targets in one pass, e.g. everyone caught in an area of effect.
+	 * Same as calling ExecuteSkill on each target, but the configuration is only resolved once.
+	 * Skills whose ExecuteSkill is overriden in Blueprint should not be batched (see IsBatchable).
+	 * @param SkillOwner The character who executed this skill.
+	 * @param Targets Targets to deal damage to. Invalid targets are skipped.
+	 * @param IgnoredTarget Target to skip (usually the primary target, which has already been hit).
+	 */
+	void ApplyDamageBatch(AAutobattlerCharacter* SkillOwner, const TArray<AAutobattlerCharacter*>& Targets, const AAutobattlerCharacter* IgnoredTarget = nullptr);
+
+	/**
+	 * @return Whether ExecuteSkill still uses the native implementation, so ApplyDamageBatch behaves the same.
+	 */
+	bool IsBatchable() const;
+
+private:
+	/**
+	 * Rolls and deals damage to a single target.
+	 * @param SkillOwner The character who executed this skill.
+	 * @param Target Target to deal damage to.
+	 * @param ConfigurationAsset Configuration to read damage modifiers from, or nullptr to not apply resistances.
+	 */
+	void DealDamageToTarget(AAutobattlerCharacter* SkillOwner, AAutobattlerCharacter* Target, const UAutobattlerConfiguration* ConfigurationAsset) const;
+
+	/**
+	 * Gets the configuration asset if resistances should be applied.
+	 * @param SkillOwner The character who executed this skill.
+	 * @return The configuration asset, or nullptr if resistances should not be applied.
+	 */
+	const UAutobattlerConfiguration* GetResistanceConfiguration(const AAutobattlerCharacter* SkillOwner) const;
 };
@@ -124,25 +124,70 @@ public:
 	 */
 	virtual void InitialiseAsEffect(const UAutobattlerSkill* SkillImplementation, AAutobattlerCharacter* SkillOwner, const FAbilityTargetingProperties& TargetingProperties);
 
-private:
 	/**
-	 * Internal function for executing all given skill effects of a skill.
+	 * SERVER-ONLY
+	 * Executes a skill which triggers instantly. Skills using the default executor class are executed without an actor at all;
+	 * custom executor classes get a pooled executor, as they may rely on being an actor.
+	 * @param WorldContextObject Object in the world the skill is executed in.
+	 * @param SkillImplementation Skill to execute.
+	 * @param SkillOwner Character who "owns" (executed) the skill
+	 * @param TargetingProperties Properties which describe who/where is the target of the skill.
+	 * @param SkillTransform Where the skill is executed (the center of any area of effect).
+	 */
+	static void ExecuteInstant(const UObject* WorldContextObject, const UAutobattlerSkill* SkillImplementation, AAutobattlerCharacter* SkillOwner, const FAbilityTargetingProperties& TargetingProperties, const FTransform& SkillTransform);
+
+	/**
+	 * SERVER-ONLY
+	 * Executes all skill effects of a skill, without needing an executor actor.
 	 * @param SkillImplementation If initialising a skill, this is the skill implementation to use.
 	 * @param SkillOwner Character who "owns" (executed) the skill
 	 * @param TargetingProperties Properties which describe who/where is the target of the skill.
+	 * @param SkillLocation Center of any area of effect.
+	 */
+	static void ExecuteSkillList(const UAutobattlerSkill* SkillImplementation, AAutobattlerCharacter* SkillOwner, const FAbilityTargetingProperties& TargetingProperties, const FVector& SkillLocation);
+
+/////////////////////////////////////////////////////////////////////////////////
+//// POOLING
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * SERVER-ONLY
+	 * Gets an executor from the manager's skill actor pool, or spawns one if there is no manager.
+	 * @param WorldContextObject Object in the world to get the executor in.
+	 * @param ExecuteSkillClass Class of executor.
+	 * @param SkillTransform Transform to place the executor at.
+	 * @return The executor, or nullptr if it could not be spawned.
+	 */
+	static AExecuteSkill* AcquireFromPool(const UObject* WorldContextObject, TSubclassOf<AExecuteSkill> ExecuteSkillClass, const FTransform& SkillTransform);
+
+	/**
+	 * Returns this executor to the manager's skill actor pool, or destroys it if there is no manager.
 	 */
-	void ExecuteSkillList(const UAutobattlerSkill* SkillImplementation, AAutobattlerCharacter* SkillOwner, const FAbilityTargetingProperties& TargetingProperties);
+	void ReleaseToPool();
 
+	/**
+	 * Called by the pool when this executor is taken from it. Reactivates the executor.
+	 */
+	virtual void OnAcquiredFromPool();
+
+	/**
+	 * Called by the pool when this executor is returned to it. Stops and hides the executor.
+	 */
+	virtual void OnReleasedToPool();
+
+private:
 	/**
 	 * Updates skill visual components. Only relevant if skill type is effect.
 	 * @param NewMesh Mesh representation of skill.
 	 * @param NewTemplate Effect particle template.
+	 * @param EffectLocation Where the effect is shown; pooled executors are moved rather than spawned, so clients are told explicitly.
+	 * Quantized to whole units. Purely cosmetic, so it is sent unreliably.
 	 */
-	UFUNCTION(NetMulticast, Reliable)
-	void UpdateEffectVisuals(UStaticMesh* NewMesh, UParticleSystem* NewTemplate);
+	UFUNCTION(NetMulticast, Unreliable)
+	void UpdateEffectVisuals(UStaticMesh* NewMesh, UParticleSystem* NewTemplate, const FVector_NetQuantize& EffectLocation);
 
 	/**
-	 * Relevant only if skill type is effect. Destroys the skill after a cooldown.
+	 * Relevant only if skill type is effect. Returns the skill to the pool after a cooldown.
 	 */
 	UFUNCTION()
 	void OnEffectEnd();
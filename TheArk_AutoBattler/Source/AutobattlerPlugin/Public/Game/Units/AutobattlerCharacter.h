@@ -98,12 +98,16 @@ private:
 	/* Current game phase. */
 	EAutobattlerPhase CurrentGamePhase;
 
-	/* Health values for this character. */
-	UPROPERTY(ReplicatedUsing="OnRep_CurrentHealth")
+	/* Health values for this character. Server side values are exact; clients receive them rounded, see ReplicatedCurrentHealth. */
 	float CurrentHealth;
+	float MaxHealth;
+
+	/* Health rounded to whole points (as the health bar shows it), so changes too small to see are not replicated. */
+	UPROPERTY(ReplicatedUsing="OnRep_CurrentHealth")
+	uint16 ReplicatedCurrentHealth;
 
 	UPROPERTY(ReplicatedUsing="OnRep_MaxHealth")
-	float MaxHealth;
+	uint16 ReplicatedMaxHealth;
 
 	/* ID of identity owning this character, e.g. Player1, Player2, etc. */
 	UPROPERTY(ReplicatedUsing="OnRep_OwnerID")
@@ -119,10 +123,20 @@ private:
 
 	/* Charge value used by this character (if ability uses charges). */
 	UPROPERTY(ReplicatedUsing="OnRep_GainCharges")
-	int32 Charges;
+	uint8 Charges;
 
 	UPROPERTY(ReplicatedUsing="OnRep_MaxCharges")
-	int32 MaxCharges;
+	uint8 MaxCharges;
+
+	/* Action type shown by the animation instance. Replicated as state, so clients catch up with the latest value even if updates are skipped. */
+	UPROPERTY(ReplicatedUsing="OnRep_AnimationActionType")
+	EActionType AnimationActionType;
+
+	/* Server only. Whether this character replicates less often and at lower priority when off screen, far away or dead. */
+	bool UsesReducedReplication;
+
+	/* Server only. Beyond this distance from a viewer, priority falls off with distance while replication is reduced. */
+	float FullPriorityDistance;
 
 	/* Modifiers */
 	float AttackSpeedModifier;
@@ -154,6 +168,13 @@ public:
 	 */
 	void BuildCharacterFromListing(EEntity WhoOwns, int32 CharacterID, const FCharacterListing& CharacterListing);
 
+	/**
+	 * SERVER-ONLY
+	 * Switches between default replication and the reduced replication used in large battles, see UAutobattlerConfiguration::LargeBattleCharacterThreshold.
+	 * @param ShouldReduce Whether to replicate at the configured lower frequency and scale priority by visibility and distance.
+	 */
+	void SetUsesReducedReplication(bool ShouldReduce);
+
 protected:
 	/**
 	 * Binds delegates.
@@ -469,10 +490,10 @@ protected:
 	void UpdateHealthBar();
 
 	/**
-	 * Shows/hides health bars for both server and client.
+	 * Shows/hides health bars for both server and client. Unreliable; clients also hide the bar once the dead animation state arrives.
 	 * @param IsVisible True to show, false to hide.
 	 */
-	UFUNCTION(NetMulticast, Reliable)
+	UFUNCTION(NetMulticast, Unreliable)
 	void ToggleHealthBarVisibility(bool IsVisible);
 
 	/**
@@ -540,24 +561,50 @@ public:
 	void OnRep_OwnerID();
 
 	/**
-	 * Ensures both client and server know this character should perform a skill.
+	 * Applies the replicated animation action type.
+	 */
+	UFUNCTION()
+	void OnRep_AnimationActionType();
+
+	/**
+	 * Scales replication priority by whether the character is in front of the viewer, how far away it is and whether it is dead,
+	 * if replication is reduced. Otherwise uses the default priority.
+	 */
+	virtual float GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth) override;
+
+	/**
+	 * Ensures both client and server know this character should perform a skill. Purely cosmetic, so it is sent unreliably;
+	 * the action type it sets is also replicated as state.
 	 * @param Animation Animation being performed.
 	 * @param ActionSpeed Speed of the animation.
 	 * @param ActionType Whether this is an attack or skill.
 	 */
-	UFUNCTION(NetMulticast, Reliable)
+	UFUNCTION(NetMulticast, Unreliable)
 	void ReplicateExecuteAbilityAnimations(UAnimSequence* Animation, float ActionSpeed, EActionType ActionType);
 
 	/**
-	 * Sets the action type for animations only for both server and client.
+	 * Sets the action type for animations only. Called on the server, it is replicated to clients.
 	 * @param NewActionType Action Type to set. 
 	 */
-	UFUNCTION(NetMulticast, Reliable)
 	void SetAnimationActionType(EActionType NewActionType);
 
+private:
+	/**
+	 * SERVER-ONLY
+	 * Rounds health for replication, marking it dirty only if the rounded values changed.
+	 */
+	void UpdateReplicatedHealth();
+
+	/**
+	 * Sets the action type on the animation instance.
+	 * @param NewActionType Action Type to set.
+	 */
+	void ApplyAnimationActionType(EActionType NewActionType);
+
 	/* Mark as friend so we can request state changes from this character. */
 	friend class UAutobattlerAnimInstance;
 	friend class AAutobattlerAIController;
+	friend class FAutobattlerEffectScheduler;
 
 /////////////////////////////////////////////////////////////////////////////////
 //// DELEGATE BOUND
@@ -84,6 +84,14 @@ private:
 	/* How the deployment character should be offset from the center of the grid tile. */
 	FVector PlacementOffset;
 
+	/* Attack range of the previewed character, highlighted on the grid for its owner. */
+	UPROPERTY(Replicated)
+	float PreviewRange;
+
+	/* Who is placing this character. */
+	UPROPERTY(Replicated)
+	EEntity PreviewOwner;
+
 /////////////////////////////////////////////////////////////////////////////////
 //// CONSTRUCTION
 /////////////////////////////////////////////////////////////////////////////////
@@ -99,8 +107,9 @@ public:
 	 * @param PreviewAnimation Animation to use when previewing.
 	 * @param ID Relevant only for the server. Internal ID of this character.
 	 * @param BudgetCost How expensive this preview character is w.r.t. the budget (used for updating pending budget).
+	 * @param AttackRange Attack range of the previewed character, highlighted on the grid.
 	 */
-	void ConfigurePreviewCharacter(const FVector& DeploymentOffset, int32 ID, int32 BudgetCost);
+	void ConfigurePreviewCharacter(const FVector& DeploymentOffset, int32 ID, int32 BudgetCost, float AttackRange);
 
 protected:
 	/**
@@ -108,6 +117,12 @@ protected:
 	 */
 	virtual void BeginPlay() override;
 
+	/**
+	 * Removes the range highlight from the grid.
+	 * @param EndPlayReason Unused.
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 /////////////////////////////////////////////////////////////////////////////////
 //// ACCESSORS
 /////////////////////////////////////////////////////////////////////////////////
@@ -206,4 +221,11 @@ private:
 	 * @param CanPlace True for can place, false for cannot place.
 	 */
 	void UpdatePrimitiveComponentMaterials(bool CanPlace);
+
+	/**
+	 * Highlights the grid indicies within PreviewRange of the placement location as the range preview, or clears it.
+	 * Only done for the local player placing this character.
+	 * @param ShouldHighlight False to clear the highlight. It is also cleared while this character is hidden.
+	 */
+	void UpdateRangeHighlight(bool ShouldHighlight);
 };
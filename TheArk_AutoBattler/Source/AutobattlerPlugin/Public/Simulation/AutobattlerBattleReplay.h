@@ -0,0 +1,269 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Simulation/AutobattlerSimulation.h"
+#include "Types/AutobattlerEnums.h"
+
+/**
+ * Compact binary recording of a live battle, and headless playback of it.
+ * The server appends a record whenever a character is deployed, an AI update picks a new target, a skill triggers, health or max health
+ * changes or a character dies, and writes quantized locations of characters which moved at a fixed interval. Full snapshots are written
+ * periodically so playback can seek without replaying from the start. Playback only reads the recording back: no actors, AI or navigation are involved.
+ *
+ * Every record starts with its type (uint8) and time since the recording began in milliseconds (uint32). Characters are referred to by
+ * their index in the replay roster (uint16). Locations are stored in 2 unit steps relative to the grid origin (int16 per axis), so
+ * battles are limited to roughly 650 m either side of it. Data is written in native byte order.
+ */
+class AUTOBATTLERPLUGIN_API FAutobattlerBattleReplay
+{
+public:
+	/* State of a character at the current playback time. */
+	struct FCharacterState
+	{
+		int32 ID = INDEX_NONE;
+		EEntity WhoOwns = EEntity::AI;
+		FName CharacterRowName;
+		float MaxHealth = 0.0f;
+		float Health = 0.0f;
+		int32 TargetID = INDEX_NONE;
+		FVector Location = FVector::ZeroVector;
+		bool IsDeployed = false;
+		bool IsDead = false;
+	};
+
+/////////////////////////////////////////////////////////////////////////////////
+//// RECORDING
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Discards any previous data and starts a new recording.
+	 * @param Origin Location positions are stored relative to, usually the grid origin.
+	 * @param StartTime World time the battle started at. Every other time passed in is a world time too.
+	 * @param SnapshotInterval How often a full snapshot is written, in seconds.
+	 */
+	void BeginRecording(const FVector& Origin, float StartTime, float SnapshotInterval);
+
+	/**
+	 * Adds a character to the roster, or updates it if it was already recorded (e.g. it was redeployed).
+	 * @param Time World time.
+	 * @param ID Unique ID of the character.
+	 * @param WhoOwns Who owns the character.
+	 * @param CharacterRowName Row of the character in AllCharactersDataTable.
+	 * @param MaxHealth Max health of the character.
+	 * @param Health Current health of the character.
+	 * @param Location Location of the character.
+	 */
+	void RecordCharacter(float Time, int32 ID, EEntity WhoOwns, const FName& CharacterRowName, float MaxHealth, float Health, const FVector& Location);
+
+	/**
+	 * Records an event. Characters which are not in the roster are recorded as INDEX_NONE.
+	 * @param Time World time.
+	 * @param EventType What happened.
+	 * @param SourceID ID of the character who caused the event, or INDEX_NONE.
+	 * @param TargetID ID of the character affected by the event, or INDEX_NONE.
+	 * @param Value Event specific value.
+	 */
+	void RecordEvent(float Time, EAutobattlerSimulationEventType EventType, int32 SourceID, int32 TargetID, float Value);
+
+	/**
+	 * Records the health and max health of a character, if either changed.
+	 * @param Time World time.
+	 * @param ID ID of the character.
+	 * @param Health New health.
+	 * @param MaxHealth New max health.
+	 */
+	void RecordHealth(float Time, int32 ID, float Health, float MaxHealth);
+
+	/**
+	 * Records the target an AI update picked for a character, if it changed.
+	 * @param Time World time.
+	 * @param ID ID of the character.
+	 * @param TargetID ID of its new target, or INDEX_NONE if it has none (or targets a location).
+	 */
+	void RecordTarget(float Time, int32 ID, int32 TargetID);
+
+	/**
+	 * Buffers the location of a character for the next frame. Nothing is buffered if it moved less than the quantization step.
+	 * @param ID ID of the character.
+	 * @param Location Current location.
+	 */
+	void RecordLocation(int32 ID, const FVector& Location);
+
+	/**
+	 * Writes every location buffered since the last frame, and a snapshot if one is due.
+	 * @param Time World time.
+	 */
+	void RecordFrame(float Time);
+
+	/**
+	 * Writes the battle outcome and stops recording.
+	 * @param Time World time.
+	 * @param Winner Who won the battle.
+	 */
+	void EndRecording(float Time, EWhoWins Winner);
+
+	/**
+	 * @return Whether a battle is being recorded.
+	 */
+	bool GetIsRecording() const { return IsRecording; }
+
+	/**
+	 * @return Recorded data, e.g. to save to disk. Only complete once recording has ended.
+	 */
+	const TArray<uint8>& GetData() const { return Data; }
+
+/////////////////////////////////////////////////////////////////////////////////
+//// PLAYBACK
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Replaces the data with a saved recording and prepares it for playback.
+	 * @param Bytes Recorded data.
+	 * @return Whether the data is a valid recording. If not, the replay is left empty.
+	 */
+	bool LoadFromBytes(TArray<uint8>&& Bytes);
+
+	/**
+	 * Prepares the current data for playback, e.g. straight after recording. Playback starts at time 0.
+	 * @return Whether the data is a valid recording.
+	 */
+	bool BeginPlayback();
+
+	/**
+	 * Jumps to a time, starting from the last snapshot before it. No events are reported for the skipped records.
+	 * @param Time Time since the battle began, in seconds.
+	 */
+	void SeekTo(float Time);
+
+	/**
+	 * Applies every record up to the current playback time plus DeltaTime.
+	 * @param DeltaTime Seconds of battle to play back (i.e. already scaled by playback speed).
+	 * @param OutEvents (OUT) Optional. Events played back are appended to it.
+	 * @return False once the end of the recording has been reached.
+	 */
+	bool Advance(float DeltaTime, TArray<FAutobattlerSimulationEvent>* OutEvents = nullptr);
+
+	/**
+	 * @return Current playback time since the battle began, in seconds.
+	 */
+	float GetPlaybackTime() const { return PlaybackTime; }
+
+	/**
+	 * @return Length of the recorded battle, in seconds.
+	 */
+	float GetDuration() const { return Duration; }
+
+	/**
+	 * @return Who won the recorded battle.
+	 */
+	EWhoWins GetWinner() const { return Winner; }
+
+	/**
+	 * @return State of every character in the roster at the current playback time. Characters not deployed yet have IsDeployed unset.
+	 */
+	const TArray<FCharacterState>& GetCharacterStates() const { return States; }
+
+/////////////////////////////////////////////////////////////////////////////////
+//// INTERNAL
+/////////////////////////////////////////////////////////////////////////////////
+private:
+	/* Types of records. */
+	enum class ERecordType : uint8
+	{
+		Character,
+		Event,
+		Health,
+		Target,
+		Frame,
+		Snapshot,
+		End
+	};
+
+	/* A snapshot, found while preparing for playback. */
+	struct FSnapshotEntry
+	{
+		uint32 TimeMs;
+		int32 Offset;
+	};
+
+	/* Roster index used for characters not in the roster. */
+	static constexpr uint16 NoCharacter = MAX_uint16;
+
+	/* Size of a location quantization step. */
+	static constexpr float LocationQuantum = 2.0f;
+
+	/**
+	 * Appends the type and time of a record.
+	 */
+	void WriteRecordHeader(ERecordType Type, float Time);
+
+	/**
+	 * Writes a full snapshot of the recorded roster.
+	 */
+	void WriteSnapshot(float Time);
+
+	/**
+	 * @return Roster index of a character, or NoCharacter.
+	 */
+	uint16 GetRosterIndex(int32 ID) const;
+
+	/**
+	 * Quantizes a location relative to the origin.
+	 */
+	void QuantizeLocation(const FVector& Location, int16& OutX, int16& OutY) const;
+
+	/**
+	 * Reads the header, finds every snapshot, character and the outcome, and rewinds to the start.
+	 * @return Whether the data is a valid recording.
+	 */
+	bool IndexRecording();
+
+	/**
+	 * Clears character states and moves the read offset to the first record.
+	 */
+	void Rewind();
+
+	/**
+	 * Applies the record at the read offset and moves past it.
+	 * @param OutEvents (OUT) Optional. Events are appended to it.
+	 * @return False if the record is malformed.
+	 */
+	bool ApplyRecord(TArray<FAutobattlerSimulationEvent>* OutEvents);
+
+	/* Recorded data. */
+	TArray<uint8> Data;
+
+	/* Origin and outcome of the battle. */
+	FVector Origin = FVector::ZeroVector;
+	EWhoWins Winner = EWhoWins::Nobody;
+
+	/* Character states: recorded state while recording, played back state during playback. Indexed by roster index. */
+	TArray<FCharacterState> States;
+
+	/* Roster index of every recorded character, keyed by ID. */
+	TMap<int32, uint16> RosterIndicesByID;
+
+	/* Recording only. Locations written since the last frame, how many, and quantized locations last written per roster index. */
+	TArray<uint8> PendingFrame;
+	uint16 NumPendingLocations = 0;
+	TArray<FIntPoint> LastQuantizedLocations;
+
+	/* Recording only. World time the battle started at, snapshot interval and when the next snapshot is due (both in milliseconds). */
+	float StartTime = 0.0f;
+	uint32 SnapshotIntervalMs = 5000;
+	uint32 NextSnapshotMs = 0;
+	bool IsRecording = false;
+
+	/* Playback only. Roster as it is at the end of the recording, snapshots in time order, and offset of the first record. */
+	TArray<FCharacterState> FinalRoster;
+	TArray<FSnapshotEntry> Snapshots;
+	int32 FirstRecordOffset = 0;
+
+	/* Playback only. Offset of the next record to apply, playback time and recording length (in seconds). */
+	int32 ReadOffset = 0;
+	float PlaybackTime = 0.0f;
+	float Duration = 0.0f;
+};
@@ -0,0 +1,90 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Types/AutobattlerStructs.h"
+#include "AutobattlerMatchupEvaluator.generated.h"
+
+class FAutobattlerSimulationSetup;
+
+/* Aggregated outcome of simulating one candidate matchup many times. */
+USTRUCT(BlueprintType)
+struct FAutobattlerMatchupReport
+{
+	GENERATED_BODY()
+public:
+	/* Index of the candidate this report belongs to, in the order candidates were given. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 CandidateIndex = INDEX_NONE;
+
+	/* Seed the candidate was generated with, if it was generated (see AAutobattlerManager::EvaluateAIFormation). */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 CandidateSeed = 0;
+
+	/* AI character placements of the candidate, mapped from character ID to grid index. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	TMap<int32, FIntPair> Placements;
+
+	/* How many battles were simulated. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 NumBattles = 0;
+
+	/* Battle outcome counts. Draws are battles which timed out. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 AIWins = 0;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 PlayerWins = 0;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 Draws = 0;
+
+	/* Fraction of battles won by the AI, with a 95% (Wilson score) confidence interval. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	float AIWinRate = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	float AIWinRateLower = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	float AIWinRateUpper = 0.0f;
+
+	/* Mean battle length in simulated seconds, plus/minus the half width of its 95% confidence interval. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	float MeanBattleDuration = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	float BattleDurationConfidence = 0.0f;
+
+	/* Whether any skill in the matchup could only be approximated (see FAutobattlerSimulationSetup::GetIsApproximate). */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	bool IsApproximate = false;
+};
+
+/**
+ * Runs many headless battles for a set of candidate matchups across all worker threads, and aggregates the outcomes.
+ * Every candidate is simulated with the same sequence of seeds, so differences between candidates come from the
+ * candidates themselves rather than from luck.
+ */
+class AUTOBATTLERPLUGIN_API FAutobattlerMatchupEvaluator
+{
+public:
+	/**
+	 * Simulates every candidate NumBattles times. Battles are spread over the task graph as independent work items,
+	 * with results written to preallocated slots, so no locking happens while simulating.
+	 * For throughput, candidates should be built with Settings.RecordEvents disabled.
+	 * @param Candidates Matchups to evaluate.
+	 * @param NumBattles How many battles to simulate per candidate.
+	 * @param BaseSeed Seed used to derive the seed of each battle.
+	 * @param OutReports (OUT) One report per candidate, in candidate order. Placements and CandidateSeed are left for the caller.
+	 */
+	static void Evaluate(const TArray<FAutobattlerSimulationSetup>& Candidates, int32 NumBattles, int32 BaseSeed, TArray<FAutobattlerMatchupReport>& OutReports);
+
+	/**
+	 * Sorts reports from hardest to easiest for the player: highest AI win rate first, then shortest battles first.
+	 * @param Reports (IN/OUT) Reports to sort.
+	 */
+	static void RankByAIStrength(TArray<FAutobattlerMatchupReport>& Reports);
+};
@@ -0,0 +1,273 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Simulation/AutobattlerSimulationCore.h"
+#include "Types/AutobattlerEnums.h"
+#include "AutobattlerSimulation.generated.h"
+
+class UAutobattlerConfiguration;
+class UAutobattlerSkill;
+struct FAutobattlerCharacterDefinition;
+
+/* Everything the simulation can record in its event log (see FAutobattlerSimulationCore::EEventType). */
+UENUM(BlueprintType)
+enum class EAutobattlerSimulationEventType : uint8
+{
+	ActionStarted  UMETA(DisplayName = "Action Started"),
+	SkillTriggered UMETA(DisplayName = "Skill Triggered"),
+	Damage         UMETA(DisplayName = "Damage"),
+	Heal           UMETA(DisplayName = "Heal"),
+	PoisonApplied  UMETA(DisplayName = "Poison Applied"),
+	PoisonTick     UMETA(DisplayName = "Poison Tick"),
+	ChargeGained   UMETA(DisplayName = "Charge Gained"),
+	Died           UMETA(DisplayName = "Died"),
+	Ressurected    UMETA(DisplayName = "Ressurected"),
+	BattleEnded    UMETA(DisplayName = "Battle Ended"),
+	Count          UMETA(Hidden)
+};
+
+/* A single entry of the simulation event log. */
+USTRUCT(BlueprintType)
+struct FAutobattlerSimulationEvent
+{
+	GENERATED_BODY()
+public:
+	/* Simulated time (in seconds) at which the event happened. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	float Time;
+
+	/* What happened. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	EAutobattlerSimulationEventType EventType;
+
+	/* ID of the character who caused the event, or INDEX_NONE. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 SourceID;
+
+	/* ID of the character affected by the event, or INDEX_NONE. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 TargetID;
+
+	/* Event specific value (e.g. damage dealt, poison strength, remaining health). */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	float Value;
+
+	FAutobattlerSimulationEvent()
+	{
+		Time = 0.0f;
+		EventType = EAutobattlerSimulationEventType::Count;
+		SourceID = INDEX_NONE;
+		TargetID = INDEX_NONE;
+		Value = 0.0f;
+	}
+
+	FAutobattlerSimulationEvent(float NewTime, EAutobattlerSimulationEventType NewEventType, int32 NewSourceID, int32 NewTargetID, float NewValue)
+	{
+		Time = NewTime;
+		EventType = NewEventType;
+		SourceID = NewSourceID;
+		TargetID = NewTargetID;
+		Value = NewValue;
+	}
+};
+
+/* Values which control a simulation run which are not part of the configuration asset (see FAutobattlerSimulationCore::FSettings). */
+USTRUCT(BlueprintType)
+struct FAutobattlerSimulationSettings
+{
+	GENERATED_BODY()
+public:
+	/* Fixed time step (in seconds). */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.001"))
+	float TimeStep = 0.05f;
+
+	/* Battles lasting longer than this (in seconds) end with nobody winning. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1"))
+	float MaxBattleDuration = 180.0f;
+
+	/* How often each character re-evaluates its target, matching the AI controller's native update timer (or the AI scheduler's high rate). */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.01"))
+	float AIUpdateInterval = 0.2f;
+
+	/* Whether AI updates are scheduled in tiers, as FAutobattlerAIScheduler does, rather than every AIUpdateInterval. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool UseAIUpdateTiers = false;
+
+	/* How often characters far from their target re-evaluate it, if UseAIUpdateTiers is set. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.01"))
+	float AILowRateUpdateInterval = 0.6f;
+
+	/* Characters which could get within this distance of their range before a low rate update are updated every AIUpdateInterval. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float AIPromotionDistance = 300.0f;
+
+	/* If above zero, characters further than this from their target step this far toward it per AI update and then wait, as
+	AAutobattlerAIController does with grid pathfinding, rather than walking straight at it between updates. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float GridCellSize = 0.0f;
+
+	/* Used when a skill has no animations: time until the skill triggers at an action speed of 1. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float DefaultTriggerTime = 0.5f;
+
+	/* Used when a skill has no animations: time until the action ends at an action speed of 1. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float DefaultActionLength = 1.0f;
+
+	/* How long the ressurect animation lasts before the character is back at full health. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float RessurectDuration = 1.0f;
+
+	/* Capsule radius used when a character class does not define one. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float DefaultCapsuleRadius = 34.0f;
+
+	/* Whether the event log should be recorded. Disable when only the outcome matters. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool RecordEvents = true;
+};
+
+/* Outcome of a simulated battle. */
+USTRUCT(BlueprintType)
+struct FAutobattlerSimulationResult
+{
+	GENERATED_BODY()
+public:
+	/* Who won. Nobody means the battle timed out (or nobody was deployed on either side). */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	EWhoWins Winner = EWhoWins::Nobody;
+
+	/* How long the battle lasted in simulated seconds. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	float BattleDuration = 0.0f;
+
+	/* Number of fixed steps simulated. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 Steps = 0;
+
+	/* Number of AI updates run. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 AIUpdates = 0;
+
+	/* Characters alive at the end of the battle, per side. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 SurvivingPlayerCharacters = 0;
+
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 SurvivingAICharacters = 0;
+
+	/* Seed the battle was simulated with. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	int32 Seed = 0;
+
+	/* Everything which happened during the battle, in order. Empty if RecordEvents was disabled. */
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	TArray<FAutobattlerSimulationEvent> Events;
+};
+
+/**
+ * Immutable description of a battle which can be simulated, built from character definitions and the configuration asset.
+ * Building touches UObjects and must happen on the game thread; it converts assets into a plain FAutobattlerSimulationCore::FBattle,
+ * so once built a setup can be simulated any number of times, from any thread (see FAutobattlerSimulation).
+ */
+class AUTOBATTLERPLUGIN_API FAutobattlerSimulationSetup
+{
+/////////////////////////////////////////////////////////////////////////////////
+//// CONSTRUCTION
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Copies game rules (resistances, poison and projectile values) and AI update rates from the configuration asset.
+	 * Until a configuration is applied, resistances do not modify damage.
+	 * @param Configuration Configuration asset to copy from.
+	 */
+	void ApplyConfiguration(const UAutobattlerConfiguration* Configuration);
+
+	/**
+	 * Adds a deployed character to the battle. Skills are converted once and shared between characters using them.
+	 * @param Definition Definition to build the character from.
+	 * @param WhoOwns Which entity owns the character.
+	 * @param Location World location the character starts at.
+	 * @param ID ID of the character in the event log. INDEX_NONE uses the order characters were added in.
+	 * @return Whether the character was added.
+	 */
+	bool AddCharacter(const FAutobattlerCharacterDefinition& Definition, EEntity WhoOwns, const FVector& Location, int32 ID = INDEX_NONE);
+
+	/* Values not covered by the configuration asset. */
+	FAutobattlerSimulationSettings Settings;
+
+/////////////////////////////////////////////////////////////////////////////////
+//// ACCESSORS
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Getter for the number of characters in the battle.
+	 * @return Number of characters.
+	 */
+	int32 Num() const { return Battle.Characters.Num(); }
+
+	/**
+	 * Whether any skill uses behaviour the simulation can only approximate (Blueprint skill effects or
+	 * target implementations other than nearest/self). Such skills run as if they targeted the nearest character.
+	 * @return Whether the simulation is approximate.
+	 */
+	bool GetIsApproximate() const { return IsApproximate; }
+
+	/**
+	 * Getter for the converted battle, e.g. to run FAutobattlerSimulationCore directly.
+	 * @return Plain data description of the battle.
+	 */
+	const FAutobattlerSimulationCore::FBattle& GetBattle() const { return Battle; }
+
+/////////////////////////////////////////////////////////////////////////////////
+//// INTERNAL
+/////////////////////////////////////////////////////////////////////////////////
+private:
+	/* Characters, converted skills and game rules copied from the configuration asset. */
+	FAutobattlerSimulationCore::FBattle Battle;
+
+	/* Maps each skill asset to its index in Battle.Skills. */
+	TMap<const UAutobattlerSkill*, int32> SkillIndices;
+
+	/* See GetIsApproximate. */
+	bool IsApproximate = false;
+
+	/**
+	 * Gets the index of the simulated skill for a skill asset, converting it if needed.
+	 * @param Skill Skill asset to convert.
+	 * @return Index in Battle.Skills, or INDEX_NONE if Skill is null.
+	 */
+	int32 FindOrAddSkill(const UAutobattlerSkill* Skill);
+};
+
+/**
+ * Runs FAutobattlerSimulationCore on a setup, converting its settings and result to and from their reflected counterparts.
+ */
+class AUTOBATTLERPLUGIN_API FAutobattlerSimulation
+{
+public:
+	/**
+	 * Simulates a battle from start to finish. Thread safe as long as Setup is not modified while running.
+	 * @param Setup Battle to simulate.
+	 * @param Seed Random seed.
+	 * @param OutResult (OUT) Outcome and event log of the battle.
+	 */
+	static void Run(const FAutobattlerSimulationSetup& Setup, int32 Seed, FAutobattlerSimulationResult& OutResult);
+
+	/**
+	 * Converts settings to the plain data the core runs with.
+	 * @param Settings Settings to convert.
+	 * @return Converted settings.
+	 */
+	static FAutobattlerSimulationCore::FSettings ConvertSettings(const FAutobattlerSimulationSettings& Settings);
+
+	/**
+	 * Converts a result of the core to its reflected counterpart.
+	 * @param CoreResult Result to convert.
+	 * @param OutResult (OUT) Converted result.
+	 */
+	static void ConvertResult(const FAutobattlerSimulationCore::FResult& CoreResult, FAutobattlerSimulationResult& OutResult);
+};
@@ -0,0 +1,395 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Headless fixed time step simulation of an autobattler battle. Mirrors the in-engine combat rules (AI target selection and
+ * ranges, animation driven trigger/end timing, UDealDamage resistance and critical math, poison ticks, duration skills,
+ * cooldown and charge triggers, ressurection and the default win condition) without rendering, navigation or physics.
+ * Movement is a straight line at the character's movement speed and collision between characters is ignored.
+ * All randomness comes from a single seeded stream, so the same battle, settings and seed always produce the same result.
+ *
+ * This is the plain data core: it refers to no UObject, reflected or generated types, so it can be built and run without the
+ * object system. FAutobattlerSimulationSetup converts assets into an FBattle, and FAutobattlerSimulation converts settings and
+ * results to and from their reflected counterparts. Enums mirror the engine enums they are converted from value for value.
+ */
+class AUTOBATTLERPLUGIN_API FAutobattlerSimulationCore
+{
+public:
+	/* Everything the simulation can record in its event log (mirrors EAutobattlerSimulationEventType). */
+	enum class EEventType : uint8
+	{
+		ActionStarted,
+		SkillTriggered,
+		Damage,
+		Heal,
+		PoisonApplied,
+		PoisonTick,
+		ChargeGained,
+		Died,
+		Ressurected,
+		BattleEnded,
+		Count
+	};
+
+	/* Outcome of a battle (mirrors EWhoWins). */
+	enum class EWinner : uint8
+	{
+		Enemy,
+		Players,
+		Nobody
+	};
+
+	/* Shape a skill effect also hits secondary targets in (mirrors ESkillCollisionType). */
+	enum class ECollisionType : uint8
+	{
+		Single,
+		Sphere,
+		Box
+	};
+
+	/* Which characters a skill may target (mirrors EAbilityFilterType). */
+	enum class EFilterType : uint8
+	{
+		Self,
+		SelfAndAllies,
+		AlliesOnly,
+		Enemies,
+		All
+	};
+
+	/* Statistics a skill effect can modify (mirrors EAutobattlerStatType). */
+	enum class EStatType : uint8
+	{
+		MovementSpeed,
+		AttackSpeed,
+		SkillSpeed,
+		CriticalChance,
+		CriticalMultiplier,
+		MaxHealth,
+		AttackRange,
+		AbilityRange,
+		Count
+	};
+
+	/* Which built in skill implementation a simulated effect mirrors. */
+	enum class EEffectType : uint8
+	{
+		DealDamage,
+		Heal,
+		ApplyPoison,
+		Ressurect,
+		ModifyStat,
+		None
+	};
+
+	/* How a skill picks its primary target (mirrors the supported UGetTarget implementations). */
+	enum class ETargeting : uint8
+	{
+		None,
+		Self,
+		Nearest,
+		LowestHealth,
+		Furthest
+	};
+
+	/* What grants a character charges (mirrors the derived charge components). */
+	enum class EChargeSource : uint8
+	{
+		None,
+		ExecuteAbility,
+		ExecuteAttack,
+		LoseLife
+	};
+
+	/* Number of damage and resistance types (mirrors EDamageType::Count and EResistanceType::Count). */
+	static constexpr uint8 NumDamageTypes = 4;
+	static constexpr uint8 NumResistanceTypes = 4;
+
+	/* Values which control a simulation run, see FAutobattlerSimulationSettings. */
+	struct FSettings
+	{
+		float TimeStep = 0.05f;
+		float MaxBattleDuration = 180.0f;
+		float AIUpdateInterval = 0.2f;
+		bool UseAIUpdateTiers = false;
+		float AILowRateUpdateInterval = 0.6f;
+		float AIPromotionDistance = 300.0f;
+		float GridCellSize = 0.0f;
+		float DefaultTriggerTime = 0.5f;
+		float DefaultActionLength = 1.0f;
+		float RessurectDuration = 1.0f;
+		float DefaultCapsuleRadius = 34.0f;
+		bool RecordEvents = true;
+	};
+
+	/* A single entry of the event log, see FAutobattlerSimulationEvent. */
+	struct FEvent
+	{
+		float Time;
+		EEventType EventType;
+		int32 SourceID;
+		int32 TargetID;
+		float Value;
+	};
+
+	/* Outcome of a simulated battle, see FAutobattlerSimulationResult. */
+	struct FResult
+	{
+		EWinner Winner = EWinner::Nobody;
+		float BattleDuration = 0.0f;
+		int32 Steps = 0;
+		int32 AIUpdates = 0;
+		int32 SurvivingPlayerCharacters = 0;
+		int32 SurvivingAICharacters = 0;
+		int32 Seed = 0;
+		TArray<FEvent> Events;
+	};
+
+	/* Mirror of a USkillImplementation. */
+	struct FEffect
+	{
+		EEffectType Type = EEffectType::None;
+		float Min = 0.0f;
+		float Max = 1.0f;
+		bool AffectedByResistance = true;
+		bool CanBeCritical = true;
+		ECollisionType CollisionType = ECollisionType::Single;
+		EFilterType SecondaryTargetFilter = EFilterType::Self;
+		float CollisionRadius = 32.0f;
+		FVector BoxExtent = FVector(100.0f);
+		EStatType StatToModify = EStatType::Count;
+		bool IsPermanent = false;
+		float ExpiryTime = 5.0f;
+	};
+
+	/* Timing of a single skill animation at a play rate of 1: when its TriggerSkill notify fires, and its length. */
+	struct FAnimationTiming
+	{
+		float TriggerTime;
+		float Length;
+	};
+
+	/* Mirror of a UAutobattlerSkill (or UAutobattlerAbility). */
+	struct FSkill
+	{
+		TArray<FEffect> Effects;
+		TArray<FAnimationTiming> Animations;
+		float ActionSpeed = 1.0f;
+		float Range = 120.0f;
+		EFilterType PrimaryTargetFilter = EFilterType::Self;
+		ETargeting Targeting = ETargeting::Self;
+		bool IsProjectile = false;
+		float ProjectileSpeed = 500.0f;
+		bool HasDuration = false;
+		bool ActivatesImmediately = false;
+		float Interval = 1.0f;
+		int32 NumRepetitions = 3;
+		bool IsAbility = false;
+		bool UsesCharges = false;
+		bool StartOffCooldown = false;
+		float Cooldown = 5.0f;
+		EChargeSource ChargeSource = EChargeSource::None;
+		int32 ChargesNeededForTrigger = 1;
+	};
+
+	/* Starting state of a deployed character. */
+	struct FCharacter
+	{
+		int32 ID;
+		bool IsAI;
+		FVector Location;
+		float CapsuleRadius; /* Negative means FSettings::DefaultCapsuleRadius. */
+		float MaxHealth;
+		float MovementSpeed;
+		float CriticalChance;
+		float CriticalMultiplier;
+		uint8 DamageType;
+		uint8 ResistanceType;
+		int32 AttackIndex;
+		int32 AbilityIndex;
+	};
+
+	/* Everything which describes a battle: deployed characters, the skills they use and game rules. */
+	struct FBattle
+	{
+		/* All characters, in the order they were added. */
+		TArray<FCharacter> Characters;
+
+		/* All skills, indexed by FCharacter::AttackIndex and AbilityIndex. */
+		TArray<FSkill> Skills;
+
+		/* Damage modifier per damage and resistance type. Defaults to 1 (no modification). */
+		float ResistanceModifiers[NumDamageTypes][NumResistanceTypes];
+
+		float PoisonTickRate = 1.0f;
+		float PoisonStrengthReductionRate = 1.0f;
+		float ProjectileMinDistanceToHit = 32.0f;
+
+		FBattle();
+	};
+
+/////////////////////////////////////////////////////////////////////////////////
+//// SIMULATION API
+/////////////////////////////////////////////////////////////////////////////////
+public:
+	/**
+	 * Simulates a battle from start to finish. Thread safe as long as Battle is not modified while running.
+	 * @param InBattle Battle to simulate.
+	 * @param InSettings Time step, AI update rates and other values controlling the run.
+	 * @param Seed Random seed.
+	 * @param OutResult (OUT) Outcome and event log of the battle.
+	 */
+	static void Run(const FBattle& InBattle, const FSettings& InSettings, int32 Seed, FResult& OutResult);
+
+/////////////////////////////////////////////////////////////////////////////////
+//// INTERNAL
+/////////////////////////////////////////////////////////////////////////////////
+private:
+	/* What a simulated character is currently doing. */
+	enum class EState : uint8
+	{
+		Idle,
+		Acting,
+		Ressurecting,
+		Dead
+	};
+
+	/* Runtime state of a character. */
+	struct FCharacterState
+	{
+		FVector Location;
+		float MaxHealth;
+		float CurrentHealth;
+		float MovementSpeed;
+		float CriticalChance;
+		float CriticalMultiplier;
+		float AttackSpeedModifier = 0.0f;
+		float SkillSpeedModifier = 0.0f;
+		EState State = EState::Idle;
+		float NextAIUpdate = 0.0f;
+		int32 TargetIndex = INDEX_NONE;
+		float TargetRange = 0.0f;
+		bool IsSteppingAlongGrid = false;
+		FVector GridStepGoal = FVector::ZeroVector;
+		int32 ActingSkillIndex = INDEX_NONE;
+		bool ActingAsSkill = false;
+		bool HasTriggered = false;
+		float TriggerTime = 0.0f;
+		float EndTime = 0.0f;
+		bool IsAbilityQueued = false;
+		bool UsesAbilityOnly = false;
+		float CooldownEndTime = -1.0f;
+		int32 Charges = 0;
+		float PoisonStrength = 0.0f;
+		float NextPoisonTick = -1.0f;
+		bool CanRessurect = false;
+		bool HasRessurected = false;
+
+		bool GetIsDead() const { return State == EState::Dead || State == EState::Ressurecting; }
+	};
+
+	/* A projectile travelling toward its target. */
+	struct FProjectile
+	{
+		int32 OwnerIndex;
+		int32 TargetIndex;
+		int32 SkillIndex;
+		FVector Location;
+	};
+
+	/* A duration skill repeating on a target (mirrors UDurationSkillComponent). */
+	struct FDurationSkill
+	{
+		int32 OwnerIndex;
+		int32 TargetIndex;
+		int32 SkillIndex;
+		float NextActivation;
+		int32 NumIntervalsExpired;
+	};
+
+	/* A temporary stat modification waiting to expire. */
+	struct FStatExpiry
+	{
+		int32 TargetIndex;
+		EStatType Stat;
+		float ModifierScale;
+		float ExpiryTime;
+	};
+
+	const FBattle& Battle;
+	const FSettings& Settings;
+	FRandomStream Stream;
+	FResult& Result;
+	float Time;
+
+	TArray<FCharacterState> States;
+	TArray<FProjectile> Projectiles;
+	TArray<FDurationSkill> DurationSkills;
+	TArray<FStatExpiry> StatExpiries;
+
+	FAutobattlerSimulationCore(const FBattle& InBattle, const FSettings& InSettings, int32 Seed, FResult& InResult);
+
+	/* Runs the battle until somebody wins or it times out. */
+	void Simulate();
+
+	/* Advances the battle by one step. */
+	void Step(float DeltaTime);
+
+	/* Mirrors AAutobattlerAIController::AIUpdate. */
+	void AIUpdate(int32 CharacterIndex);
+
+	/* Mirrors AAutobattlerAIController::ExecuteSkill. */
+	void ExecuteSkill(int32 CharacterIndex);
+
+	/* Mirrors AAutobattlerAIController::ResetState. */
+	void ResetState(int32 CharacterIndex);
+
+	/* Mirrors FAutobattlerAIScheduler::Reschedule. Does nothing unless UseAIUpdateTiers is set. */
+	void ScheduleAIUpdate(int32 CharacterIndex, int32 PreviousTargetIndex);
+
+	/* Mirrors FAutobattlerAIScheduler::Promote. Does nothing unless UseAIUpdateTiers is set. */
+	void PromoteAIUpdate(int32 CharacterIndex);
+
+	/* Mirrors FAutobattlerAIScheduler::WakeTargetersOf. Does nothing unless UseAIUpdateTiers is set. */
+	void WakeAIUpdatesTargeting(int32 TargetIndex);
+
+	/* Mirrors AExecuteSkill::ExecuteSkillList. */
+	void ExecuteSkillList(int32 OwnerIndex, int32 SkillIndex, int32 TargetIndex);
+
+	/* Mirrors USkillImplementation::ExecuteSkill for each built in implementation. */
+	void ExecuteEffect(int32 OwnerIndex, const FEffect& Effect, int32 TargetIndex);
+
+	/* Mirrors AAutobattlerCharacter::SetCurrentHealth. */
+	void SetCurrentHealth(int32 CharacterIndex, float NewHealth);
+
+	/* Mirrors AAutobattlerCharacter::ModifyStatisticInternal. */
+	void ModifyStatistic(int32 CharacterIndex, EStatType Stat, float ModifierScale);
+
+	/* Mirrors AAutobattlerCharacter::GainCharge. */
+	void GainCharge(int32 CharacterIndex, EChargeSource Source);
+
+	/* Mirrors UPoisonComponent::TickPoison. */
+	void TickPoison(int32 CharacterIndex);
+
+	/* Stops projectiles aimed at a character which has just died (mirrors AAutobattlerProjectile::OnTargetCharacterStateChange). */
+	void DestroyProjectilesTargeting(int32 CharacterIndex);
+
+	/* Mirrors UWinConditionBase::CheckWinCondition. */
+	EWinner CheckWinCondition() const;
+
+	/* Gets the target of a skill (or INDEX_NONE), mirroring GetAbilityTargetingProperties. */
+	int32 FindTarget(int32 CharacterIndex, const FSkill& Skill) const;
+
+	/* Mirrors UAutobattlerFunctionLibrary::PassesCharacterFilter. */
+	bool PassesFilter(int32 ContextIndex, int32 CandidateIndex, EFilterType FilterType) const;
+
+	/* Gets the skill a character would currently use, or INDEX_NONE. */
+	int32 GetRelevantSkillIndex(int32 CharacterIndex) const;
+
+	/* Appends to the event log if enabled. */
+	void RecordEvent(EEventType EventType, int32 SourceIndex, int32 TargetIndex, float Value);
+};
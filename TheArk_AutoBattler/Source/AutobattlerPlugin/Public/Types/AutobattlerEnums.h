@@ -173,6 +173,27 @@ enum class EPlaceReason : uint8
 	Count              UMETA(Hidden)
 };
 
+/* Ways a grid index can be highlighted. Each has its own channel in the grid's cell state texture, so they can overlap. */
+UENUM(BlueprintType)
+enum class EGridHighlight : uint8
+{
+	Shown    UMETA(DisplayName = "Shown"),         // Red channel. Cells the local player may deploy on.
+	Occupied UMETA(DisplayName = "Occupied"),      // Green channel. Cells a character is deployed on.
+	Hovered  UMETA(DisplayName = "Hovered"),       // Blue channel. Cell under the local player's mouse.
+	Range    UMETA(DisplayName = "Range Preview"), // Alpha channel. Cells within attack range of the local player's preview character.
+	Count    UMETA(Hidden)
+};
+
+/* How a set of grid indicies is combined with a player's deployment zone. */
+UENUM(BlueprintType)
+enum class EDeploymentZoneOperation : uint8
+{
+	Add       UMETA(DisplayName = "Add"),       // Zone gains the indicies.
+	Remove    UMETA(DisplayName = "Remove"),    // Zone loses the indicies.
+	Intersect UMETA(DisplayName = "Intersect"), // Zone keeps only indicies also in the set.
+	Replace   UMETA(DisplayName = "Replace")    // Zone becomes the set.
+};
+
 /**
  * Shared enums in the autobattler.
  */
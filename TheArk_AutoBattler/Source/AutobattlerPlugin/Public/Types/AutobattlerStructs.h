@@ -250,6 +250,9 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	TArray<FName> ModifierTableRowNames;
 
+	/* Handle of the baked character definition, see UAutobattlerConfiguration::ResolveCharacterDefinition. Not replicated nor saved. */
+	int32 CharacterDefinitionHandle = INDEX_NONE;
+
 	FCharacterListing()
 	{
 		CharacterRowName = FName("None");
@@ -13,6 +13,7 @@ DECLARE_LOG_CATEGORY_EXTERN(LogAutobattler, Log, All);
 class AAutobattlerCharacter;
 class AAutobattlerGrid;
 class APawn;
+class FAutobattlerSpatialHash;
 class UBehaviorTreeComponent;
 class UBlackboardComponent;
 
@@ -86,11 +87,19 @@ public:
 public:
 	/**
 	 * Utility which tries to find the character definition for the character's datatable
-	 * definined in the AutobattlerConfiguration asset.
+	 * definined in the AutobattlerConfiguration asset. Reads the definitions baked by the configuration asset.
 	 * @param RowName Row name of the character.
 	 * @return The definition from that row name, or nullptr if such a row could not be found. 
 	 */
-	static FAutobattlerCharacterDefinition* GetCharacterDefinitionFromConfigurationDatatable(const UObject* WorldContextObject, const FName& RowName);
+	static const FAutobattlerCharacterDefinition* GetCharacterDefinitionFromConfigurationDatatable(const UObject* WorldContextObject, const FName& RowName);
+
+	/**
+	 * Same as GetCharacterDefinitionFromConfigurationDatatable, but indexes the baked definitions directly by a cached handle.
+	 * @param InOutHandle (IN/OUT) Cached handle of the definition. Resolved from RowName if invalid or stale.
+	 * @param RowName Row name of the character.
+	 * @return The definition, or nullptr if such a row could not be found.
+	 */
+	static const FAutobattlerCharacterDefinition* GetCharacterDefinitionByHandle(const UObject* WorldContextObject, int32& InOutHandle, const FName& RowName);
 
 	/**
 	 * Tries to get the blackboard component from the PawnOwner.
@@ -151,6 +160,57 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Autobattler Library", meta = (WorldContext = "WorldContextObject"))
 	static void GetCharactersFilteredInSphere(TArray<AAutobattlerCharacter*>& FilteredCharacters, AAutobattlerCharacter* ContextCharacter, TEnumAsByte<ECollisionChannel> CharacterCollisionObjectType, const FVector& SphereOrigin, float SphereRadius, EAbilityFilterType FilterType, bool FilterDead = true);
 
+	/**
+	 * Gets the character nearest to ContextCharacter filtered by FilterType, using the manager's spatial hash.
+	 * Self and SelfAndAllies return ContextCharacter, as GetCharactersFiltered does. Otherwise ContextCharacter is never returned.
+	 * @param ContextCharacter "Self." Usually the character who owns a skill or attack.
+	 * @param FilterType Which characters should be filtered.
+	 * @param FilterDead Whether characters which are dead should be filtered.
+	 * @param MaxRange Characters further than this are ignored. Negative means unlimited.
+	 * @return Nearest filtered character, or nullptr if there is none.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler Library")
+	static AAutobattlerCharacter* GetNearestCharacterFiltered(AAutobattlerCharacter* ContextCharacter, EAbilityFilterType FilterType, bool FilterDead = true, float MaxRange = -1.0f);
+
+	/**
+	 * Gets up to Count characters nearest to ContextCharacter filtered by FilterType, using the manager's spatial hash.
+	 * Self and SelfAndAllies return ContextCharacter, as GetCharactersFiltered does. Otherwise ContextCharacter is never returned.
+	 * @param FilteredCharacters (OUT) Nearest filtered characters, sorted nearest first.
+	 * @param ContextCharacter "Self." Usually the character who owns a skill or attack.
+	 * @param Count Maximum number of characters to return.
+	 * @param FilterType Which characters should be filtered.
+	 * @param FilterDead Whether characters which are dead should be filtered.
+	 * @param MaxRange Characters further than this are ignored. Negative means unlimited.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler Library")
+	static void GetNearestCharactersFiltered(TArray<AAutobattlerCharacter*>& FilteredCharacters, AAutobattlerCharacter* ContextCharacter, int32 Count, EAbilityFilterType FilterType, bool FilterDead = true, float MaxRange = -1.0f);
+
+	/**
+	 * Gets all characters whose location is within Radius of Origin, filtered by FilterType, using the manager's spatial hash.
+	 * Unlike GetCharactersFilteredInSphere, this tests character locations rather than sweeping against collision.
+	 * @param FilteredCharacters (OUT) All characters in the radius filtered by FilterType.
+	 * @param ContextCharacter "Self." Usually the character who owns a skill or attack.
+	 * @param Origin World location of query origin.
+	 * @param Radius Radius of the query.
+	 * @param FilterType Which characters should be filtered.
+	 * @param FilterDead Whether characters which are dead should be filtered.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler Library")
+	static void GetCharactersFilteredInRadius(TArray<AAutobattlerCharacter*>& FilteredCharacters, AAutobattlerCharacter* ContextCharacter, const FVector& Origin, float Radius, EAbilityFilterType FilterType, bool FilterDead = true);
+
+	/**
+	 * Gets all characters whose location is inside an axis aligned box, filtered by FilterType, using the manager's spatial hash.
+	 * Unlike GetCharactersFilteredInBox, this tests character locations rather than sweeping against collision.
+	 * @param FilteredCharacters (OUT) All characters in the box filtered by FilterType.
+	 * @param ContextCharacter "Self." Usually the character who owns a skill or attack.
+	 * @param BoxOrigin World location of box origin.
+	 * @param BoxExtent Extent of the box.
+	 * @param FilterType Which characters should be filtered.
+	 * @param FilterDead Whether characters which are dead should be filtered.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Autobattler Library")
+	static void GetCharactersFilteredInBounds(TArray<AAutobattlerCharacter*>& FilteredCharacters, AAutobattlerCharacter* ContextCharacter, const FVector& BoxOrigin, const FVector& BoxExtent, EAbilityFilterType FilterType, bool FilterDead = true);
+
 private:
 	/**
 	 * Internal use only. The actual "algorithm" for filtering characters, used by various filter functions.
@@ -162,6 +222,23 @@ private:
 	 */
 	static void CharacterFilterAlgorithm(TArray<AAutobattlerCharacter*>& FilteredCharacters, const TArray<AAutobattlerCharacter*>& CharacterToChooseFrom, AAutobattlerCharacter* ContextCharacter, EAbilityFilterType FilterType, bool FilterDead = true);
 
+	/**
+	 * Internal use only. Tests a single character against a filter. Self and SelfAndAllies are handled by the callers, which only ever return ContextCharacter for them.
+	 * @param ContextCharacter "Self." Usually the character who owns a skill or attack.
+	 * @param CandidateCharacter Character to test.
+	 * @param FilterType Which characters should be filtered.
+	 * @param FilterDead Whether characters which are dead should be filtered.
+	 * @return True if CandidateCharacter passes the filter.
+	 */
+	static bool PassesCharacterFilter(const AAutobattlerCharacter* ContextCharacter, const AAutobattlerCharacter* CandidateCharacter, EAbilityFilterType FilterType, bool FilterDead);
+
+	/**
+	 * Internal use only. Gets the spatial hash of deployed characters from the manager in ContextCharacter's world.
+	 * @param ContextCharacter Used to find the manager.
+	 * @return The spatial hash, or nullptr if there is no manager.
+	 */
+	static const FAutobattlerSpatialHash* GetCharacterSpatialHash(const AAutobattlerCharacter* ContextCharacter);
+
 /////////////////////////////////////////////////////////////////////////////////
 //// MATH
 /////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,177 @@
+// Copyright Juggler Games 2022 - 2023
+// Contributors: Robert Uszynski
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Stats/Stats.h"
+#include "Types/AutobattlerEnums.h"
+
+/////////////////////////////////////////////////////////////////////////////////
+//// STATS
+/////////////////////////////////////////////////////////////////////////////////
+/* Shown with "stat Autobattler". */
+DECLARE_STATS_GROUP(TEXT("Autobattler"), STATGROUP_Autobattler, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("AI Update"), STAT_AutobattlerAIUpdate, STATGROUP_Autobattler, AUTOBATTLERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("AI Scheduler"), STAT_AutobattlerAIScheduler, STATGROUP_Autobattler, AUTOBATTLERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Targeting"), STAT_AutobattlerTargeting, STATGROUP_Autobattler, AUTOBATTLERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("EQS Callback"), STAT_AutobattlerEQSCallback, STATGROUP_Autobattler, AUTOBATTLERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Skill Execution"), STAT_AutobattlerSkillExecution, STATGROUP_Autobattler, AUTOBATTLERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Damage"), STAT_AutobattlerDamage, STATGROUP_Autobattler, AUTOBATTLERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Status Effects"), STAT_AutobattlerStatusEffects, STATGROUP_Autobattler, AUTOBATTLERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Projectiles"), STAT_AutobattlerProjectiles, STATGROUP_Autobattler, AUTOBATTLERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Win Check"), STAT_AutobattlerWinCheck, STATGROUP_Autobattler, AUTOBATTLERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Replication"), STAT_AutobattlerReplication, STATGROUP_Autobattler, AUTOBATTLERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Replay Recording"), STAT_AutobattlerReplayRecording, STATGROUP_Autobattler, AUTOBATTLERPLUGIN_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Skills Executed"), STAT_AutobattlerSkillsExecuted, STATGROUP_Autobattler, AUTOBATTLERPLUGIN_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Damage Events"), STAT_AutobattlerDamageEvents, STATGROUP_Autobattler, AUTOBATTLERPLUGIN_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("AI Updates Deferred"), STAT_AutobattlerAIUpdatesDeferred, STATGROUP_Autobattler, AUTOBATTLERPLUGIN_API);
+
+/**
+ * Times a scope under one of the stats above. Cycle counters already show up in Unreal Insights when stats are compiled in;
+ * in builds without stats (Test, Shipping) a named Insights scope is emitted instead.
+ */
+#if STATS
+#define AUTOBATTLER_SCOPE_CYCLE_COUNTER(Stat) SCOPE_CYCLE_COUNTER(Stat)
+#else
+#define AUTOBATTLER_SCOPE_CYCLE_COUNTER(Stat) TRACE_CPUPROFILER_EVENT_SCOPE(Stat)
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+//// VERBOSE DAMAGE LOG
+/////////////////////////////////////////////////////////////////////////////////
+/* Whether the verbose damage log is compiled in. Off in shipping builds unless defined by the project. */
+#ifndef AUTOBATTLER_DAMAGE_LOG
+#define AUTOBATTLER_DAMAGE_LOG !UE_BUILD_SHIPPING
+#endif
+
+/* Whether the verbose damage log is enabled at runtime, see Autobattler.LogDamage. */
+extern AUTOBATTLERPLUGIN_API int32 GAutobattlerLogDamage;
+
+/**
+ * Prints a formatted message through UAutobattlerFunctionLibrary::PrintMessageToLog if Autobattler.LogDamage is set.
+ * Arguments are not evaluated otherwise, and the whole statement is compiled out if AUTOBATTLER_DAMAGE_LOG is 0.
+ */
+#if AUTOBATTLER_DAMAGE_LOG
+#define AUTOBATTLER_LOG_DAMAGE(Format, ...) do { if (GAutobattlerLogDamage != 0) UAutobattlerFunctionLibrary::PrintMessageToLog(FString::Printf(Format, ##__VA_ARGS__)); } while (0)
+#else
+#define AUTOBATTLER_LOG_DAMAGE(Format, ...) do { } while (0)
+#endif
+
+/////////////////////////////////////////////////////////////////////////////////
+//// BATTLE STATS
+/////////////////////////////////////////////////////////////////////////////////
+/**
+ * Per-battle aggregates, collected on the server between the start of a fight and its end.
+ * Finished battles are kept for the session, so they can be written out together with "Autobattler.DumpBattleStats".
+ */
+class AUTOBATTLERPLUGIN_API FAutobattlerBattleStats
+{
+public:
+	/* Aggregates of one battle. */
+	struct FBattleSummary
+	{
+		int32 BattleIndex = 0;
+		EWhoWins Winner = EWhoWins::Nobody;
+		float Duration = 0.0f;
+		int32 PeakUnits = 0;
+		int32 NumSkills = 0;
+		float SkillsPerSecond = 0.0f;
+		int32 NumProjectiles = 0;
+		int32 PeakProjectiles = 0;
+		int32 NumDamageEvents = 0;
+		float TotalDamage = 0.0f;
+		int32 NumAITicks = 0;
+		float AITickP50Microseconds = 0.0f;
+		float AITickP99Microseconds = 0.0f;
+		float AITickMaxMicroseconds = 0.0f;
+	};
+
+	/**
+	 * Starts collecting a battle, ending the previous one first if it is still running.
+	 * @param Now Current world time.
+	 * @param NumUnits Characters deployed when the battle starts.
+	 */
+	void BeginBattle(double Now, int32 NumUnits);
+
+	/**
+	 * Stops collecting and keeps the summary of the battle. Does nothing if no battle is running.
+	 * @param Now Current world time.
+	 * @param Winner Who won the battle.
+	 */
+	void EndBattle(double Now, EWhoWins Winner);
+
+	/**
+	 * @return Whether a battle is being collected.
+	 */
+	bool GetIsBattleActive() const { return IsBattleActive; }
+
+	/**
+	 * @param NumUnits Characters currently deployed.
+	 */
+	void RecordUnits(int32 NumUnits) { if (IsBattleActive) Current.PeakUnits = FMath::Max(Current.PeakUnits, NumUnits); }
+
+	/**
+	 * Counts a skill execution.
+	 */
+	void RecordSkill() { if (IsBattleActive) Current.NumSkills++; }
+
+	/**
+	 * Counts a launched projectile.
+	 * @param NumInFlight Projectiles in flight, including the new one.
+	 */
+	void RecordProjectile(int32 NumInFlight);
+
+	/**
+	 * Counts a damage event.
+	 * @param Damage Damage dealt.
+	 */
+	void RecordDamage(float Damage);
+
+	/**
+	 * Adds the cost of one AI update to a fixed size histogram, so long battles do not keep every sample.
+	 * @param Cycles Cycles the update took.
+	 */
+	void RecordAITick(uint64 Cycles);
+
+	/**
+	 * Writes every finished battle, and the current one if it is still running, as CSV.
+	 * @param FilePath File to write.
+	 * @param Now Current world time, used to summarise a battle which is still running.
+	 * @return Whether the file was written.
+	 */
+	bool WriteCSV(const FString& FilePath, double Now) const;
+
+	/**
+	 * @return Summaries of every finished battle.
+	 */
+	const TArray<FBattleSummary>& GetFinishedBattles() const { return FinishedBattles; }
+
+private:
+	/**
+	 * @return Summary of the current battle up to Now.
+	 */
+	FBattleSummary SummarizeCurrent(double Now) const;
+
+	/**
+	 * @return Upper bound of a percentile of the recorded AI update costs, in microseconds. Never above the slowest update.
+	 */
+	float GetAITickPercentileMicroseconds(float Percentile) const;
+
+	/* AI update costs are bucketed logarithmically in microseconds, with this many buckets per doubling (about 19% apart). */
+	static constexpr int32 AITickBucketsPerOctave = 4;
+	static constexpr int32 NumAITickBuckets = 20 * AITickBucketsPerOctave;
+
+	/* Battle being collected, its start time, and its AI update cost histogram and slowest update. */
+	FBattleSummary Current;
+	double BattleStartTime = 0.0;
+	uint32 AITickHistogram[NumAITickBuckets] = {};
+	float AITickMaxMicroseconds = 0.0f;
+	bool IsBattleActive = false;
+
+	/* Every finished battle this session. */
+	TArray<FBattleSummary> FinishedBattles;
+};
@@ -1,4 +1,6 @@
 #include "LineOfSightVisualisation.h"
 #include "Modules/ModuleManager.h"
+
+DEFINE_LOG_CATEGORY(LogLineOfSight);
  
 IMPLEMENT_GAME_MODULE(FDefaultGameModuleImpl, LineOfSightVisualisation)
\ No newline at end of file
@@ -3,3 +3,9 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogLineOfSight, Log, All);
+
+/* Shown with "stat LineOfSight". */
+DECLARE_STATS_GROUP(TEXT("LineOfSight"), STATGROUP_LineOfSight, STATCAT_Advanced);
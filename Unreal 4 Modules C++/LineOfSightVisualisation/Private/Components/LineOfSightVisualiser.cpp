@@ -1,9 +1,20 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Components/LineOfSightVisualiser.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
 #include "Interfaces/LineOfSightParameterInterface.h"
+#include "LineOfSightVisualisation.h"
 #include "Materials/Material.h"
 #include "ProceduralMeshComponent.h"
+#include "Subsystems/LineOfSightFogOfWarSubsystem.h"
+#include "Subsystems/LineOfSightSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Visualiser Update"), STAT_LineOfSightVisualiserUpdate, STATGROUP_LineOfSight);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Line Traces"), STAT_LineOfSightLineTraces, STATGROUP_LineOfSight);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Occluder Segments"), STAT_LineOfSightOccluderSegments, STATGROUP_LineOfSight);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Mesh Section Uploads"), STAT_LineOfSightMeshUploads, STATGROUP_LineOfSight);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Skipped Updates"), STAT_LineOfSightSkippedUpdates, STATGROUP_LineOfSight);
 
 ULineOfSightVisualiser::ULineOfSightVisualiser()
 {
@@ -16,6 +27,18 @@ ULineOfSightVisualiser::ULineOfSightVisualiser()
 	MinEdgeIdentifierDistance = 300.0f;
 	VisionInterpRate = 15.0f;
 	VisualisationType = EVisualisation::Peripheral;
+	bUseAsyncTraces = true;
+	bUseOccluderGeometry = false;
+	bSkipUnchangedUpdates = true;
+	bRevealsFogOfWar = false;
+	LastViewerResultVersion = 0;
+	CachedOccluderSignature = 0;
+	CachedOccluderVersion = 0;
+	CachedOccluderOrigin = FVector::ZeroVector;
+	CachedOccluderRadius = 0.0f;
+	bHasCachedOccluderSignature = false;
+	PolygonOrigin = FVector::ZeroVector;
+	PolygonVersion = 0;
 	TraceChannel = TEnumAsByte<ECollisionChannel>(ECollisionChannel::ECC_Visibility);
 }
 
@@ -30,6 +53,9 @@ void ULineOfSightVisualiser::DisableVisualisation()
 	SetComponentTickEnabled(false);
 	VisualisationMesh->SetHiddenInGame(true);
 	bWasObstacleDetectedInCurrentCycle = false;
+	PendingTraceBatch.bIsPending = false;
+	EdgeIntervalsToRefine.Reset();
+	++PolygonVersion;
 }
 
 void ULineOfSightVisualiser::ScaleVisibility_Implementation(float & Scale)
@@ -47,6 +73,59 @@ void ULineOfSightVisualiser::BeginPlay()
 	Params.AddIgnoredActor(GetOwner());
 
 	InitaliseMesh();
+
+	ULineOfSightSubsystem* Subsystem = GetLineOfSightSubsystem();
+	if (bHasBeenInitialised && Subsystem != nullptr)
+	{
+		Subsystem->RegisterViewer(this);
+	}
+
+	ULineOfSightFogOfWarSubsystem* FogOfWarSubsystem = GetFogOfWarSubsystem();
+	if (bHasBeenInitialised && FogOfWarSubsystem != nullptr)
+	{
+		FogOfWarSubsystem->RegisterRevealer(this);
+	}
+}
+
+void ULineOfSightVisualiser::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ULineOfSightSubsystem* Subsystem = GetLineOfSightSubsystem();
+	if (Subsystem != nullptr)
+	{
+		Subsystem->UnregisterViewer(this);
+	}
+
+	ULineOfSightFogOfWarSubsystem* FogOfWarSubsystem = GetFogOfWarSubsystem();
+	if (FogOfWarSubsystem != nullptr)
+	{
+		FogOfWarSubsystem->UnregisterRevealer(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool ULineOfSightVisualiser::GetViewParameters(FLineOfSightViewParameters & OutParameters) const
+{
+	const FVector2D Forward = bHasBeenInitialised ? FVector2D(GetOwner()->GetActorForwardVector()).GetSafeNormal() : FVector2D::ZeroVector;
+	if (!bUseOccluderGeometry || Forward.IsZero())
+	{
+		return false;
+	}
+
+	OutParameters.Origin = VisualisationMesh->GetComponentLocation();
+	OutParameters.Forward = Forward;
+	OutParameters.Radius = CurrentVisionRadius;
+	OutParameters.HalfAngle = NormalizedVisionAngle / 2.0f;
+	OutParameters.Channel = TraceChannel.GetValue();
+	OutParameters.Owner = GetOwner();
+	return true;
+}
+
+const TArray<FVector>& ULineOfSightVisualiser::GetVisualisationPolygon(FVector & OutOrigin) const
+{
+	static const TArray<FVector> EmptyPolygon;
+	OutOrigin = PolygonOrigin;
+	return bHasBeenInitialised && !VisualisationMesh->bHiddenInGame ? CurrentPoints : EmptyPolygon;
 }
 
 void ULineOfSightVisualiser::InitaliseMesh()
@@ -100,9 +179,12 @@ void ULineOfSightVisualiser::InitaliseMesh()
 	MeshDivisionAngle = 1.0f / CorrectedMeshResolution;
 	EdgeSubdivision = MeshDivisionAngle / (float)(SubdivisionCount);
 
-	TArray<FVector> DefaultMeshVerticies;
-	DefaultMeshVerticies.Init(FVector::ZeroVector, MinimalLoSPoints + 1);
-	CreateMeshSection(0, DefaultMeshVerticies);
+	TArray<int32> DefaultMeshTriangles;
+	DefaultSectionVertices.Init(FVector::ZeroVector, MinimalLoSPoints + 1);
+	CreateTriangleDataFromVertices(DefaultSectionVertices, DefaultMeshTriangles);
+	CreateMeshSection(0, DefaultSectionVertices, DefaultMeshTriangles);
+	AdditionalSectionVertices.Reset();
+	bIsAdditionalSectionVisible = false;
 	bHasBeenInitialised = true;
 
 	EnableVisualisation();
@@ -123,6 +205,7 @@ void ULineOfSightVisualiser::EnableVisualisation()
 		SetTickGroup(ETickingGroup::TG_LastDemotable);
 	}
 	VisualisationMesh->SetHiddenInGame(false);
+	++PolygonVersion;
 }
 
 void ULineOfSightVisualiser::UpdateVisualisation(float DeltaTime)
@@ -132,40 +215,351 @@ void ULineOfSightVisualiser::UpdateVisualisation(float DeltaTime)
 		return;
 	}
 
+	SCOPE_CYCLE_COUNTER(STAT_LineOfSightVisualiserUpdate);
+	const double UpdateStartTime = FPlatformTime::Seconds();
+
 	if (CurrentVisionRadius != TargetVisionRadius)
 	{
 		CurrentVisionRadius = FMath::FInterpConstantTo(CurrentVisionRadius, TargetVisionRadius, DeltaTime, VisionInterpRate);
 	}
 
 	LineTraceCount = 0;
-	bool bWasObstactleDetectedInPreviousCycle = bWasObstacleDetectedInCurrentCycle;
-	TArray<FVector> CurrentPoints;
+	OccluderSegmentCount = 0;
+	MeshUploadCount = 0;
+
+	// Solved by the subsystem together with every other viewer, which only solves views again once they change.
+	ULineOfSightSubsystem* Subsystem = bUseOccluderGeometry ? GetLineOfSightSubsystem() : nullptr;
+	const FLineOfSightViewerResult* ViewerResult = Subsystem != nullptr ? Subsystem->GetViewerResult(this) : nullptr;
+	if (ViewerResult != nullptr)
+	{
+		OccluderSegmentCount = ViewerResult->Segments.Num();
+		if (ViewerResult->Version != LastViewerResultVersion || bDoesMeshNeedToBeUpdated)
+		{
+			bDoesMeshNeedToBeUpdated = false;
+			LastViewerResultVersion = ViewerResult->Version;
+			GeneratePointsFromViewerResult(*ViewerResult, bWasObstacleDetectedInCurrentCycle, CurrentPoints);
+			UpdateMesh(CurrentPoints, ViewerResult->Origin);
+		}
+		else
+		{
+			INC_DWORD_STAT(STAT_LineOfSightSkippedUpdates);
+		}
+	}
+	else
+	{
+		UpdateVisualisationTraced();
+	}
 
-	GeneratePoints(bWasObstacleDetectedInCurrentCycle, CurrentPoints);
+	INC_DWORD_STAT_BY(STAT_LineOfSightLineTraces, LineTraceCount);
+	INC_DWORD_STAT_BY(STAT_LineOfSightOccluderSegments, OccluderSegmentCount);
+	INC_DWORD_STAT_BY(STAT_LineOfSightMeshUploads, MeshUploadCount);
+	LastUpdateMilliseconds = (float)((FPlatformTime::Seconds() - UpdateStartTime) * 1000.0);
 
-	UpdateMeshSection(0, CreateVertexDataFromPoints(CurrentPoints, true));
-	if (CurrentPoints.Num() > MinimalLoSPoints)
+	if (bEnableDebugMessages && GEngine != nullptr)
 	{
-		CreateMeshSection(1, CreateVertexDataFromPoints(CurrentPoints, false));
+		GEngine->AddOnScreenDebugMessage((uint64)GetUniqueID(), 0.0f, FColor::Cyan, FString::Printf(TEXT("%s : %d line traces, %d occluder segments, %d mesh uploads, %.3f ms"), *GetDebugName(GetOwner()), LineTraceCount, OccluderSegmentCount, MeshUploadCount, LastUpdateMilliseconds));
+	}
+}
+
+void ULineOfSightVisualiser::UpdateVisualisationTraced()
+{
+	CurrentViewState = GetViewState();
+	if (bSkipUnchangedUpdates && !IsMeshUpdateRequired())
+	{
+		INC_DWORD_STAT(STAT_LineOfSightSkippedUpdates);
+		return;
+	}
+	LastViewState = CurrentViewState;
+
+	if (bUseAsyncTraces)
+	{
+		UpdateVisualisationAsync();
 	}
 	else
 	{
-		VisualisationMesh->ClearMeshSection(1);
+		GeneratePoints(bWasObstacleDetectedInCurrentCycle, CurrentPoints);
+		UpdateMesh(CurrentPoints, VisualisationMesh->GetComponentLocation());
+	}
+}
+
+void ULineOfSightVisualiser::UpdateVisualisationAsync()
+{
+	if (ConsumeTraceBatch(BatchHits))
+	{
+		GeneratePointsFromTraceBatch(BatchHits, bWasObstacleDetectedInCurrentCycle, CurrentPoints);
+		UpdateMesh(CurrentPoints, PendingTraceBatch.Origin);
+
+		if (bSkipUnchangedUpdates && IsTraceBatchSettled())
+		{
+			return;
+		}
+	}
+
+	// Results arrive next frame, so the next update must not be skipped even if the view does not change.
+	SubmitTraceBatch();
+	bDoesMeshNeedToBeUpdated = true;
+}
+
+void ULineOfSightVisualiser::SubmitTraceBatch()
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	FLineOfSightTraceBatch& Batch = PendingTraceBatch;
+	Batch.Origin = VisualisationMesh->GetComponentLocation();
+	Batch.Forward = GetOwner()->GetActorForwardVector();
+	Batch.Up = GetOwner()->GetActorUpVector();
+	Batch.Radius = CurrentVisionRadius;
+	Batch.ViewState = CurrentViewState;
+	Batch.Angles.Reset();
+	Batch.Handles.Reset();
+	Batch.RefinedIntervals.Reset();
+
+	// Same angles as GeneratePoints, from the left edge of the arc to the right.
+	float CurrentTraceAngle = NormalizedVisionAngle / 2.0f;
+	for (int32 i = 0; i < MinimalLoSPoints; ++i)
+	{
+		Batch.Angles.Add(CurrentTraceAngle);
+		CurrentTraceAngle -= MeshDivisionAngle;
+	}
+	Batch.FanTraceCount = Batch.Angles.Num();
+
+	// Edges barely move between frames, so intervals which had one last frame are refined with this frame's fan.
+	const int32 RefinementTraceCount = GetRefinementTraceCount();
+	for (int32 Interval : EdgeIntervalsToRefine)
+	{
+		const float IntervalStartAngle = Batch.Angles[Interval - 1];
+		for (int32 i = 1; i <= RefinementTraceCount; ++i)
+		{
+			Batch.Angles.Add(IntervalStartAngle - (MeshDivisionAngle * (float)i / (float)(RefinementTraceCount + 1)));
+		}
+		Batch.RefinedIntervals.Add(Interval);
+	}
+
+	for (float TraceAngle : Batch.Angles)
+	{
+		FVector TraceEnd = Batch.Origin + (Batch.Forward.RotateAngleAxis(TraceAngle, Batch.Up) * Batch.Radius);
+		Batch.Handles.Add(World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Batch.Origin, TraceEnd, TraceChannel.GetValue(), Params));
+	}
+
+	LineTraceCount += Batch.Handles.Num();
+	Batch.bIsPending = true;
+}
+
+bool ULineOfSightVisualiser::ConsumeTraceBatch(TArray<FHitResult>& Hits)
+{
+	UWorld* World = GetWorld();
+	if (!PendingTraceBatch.bIsPending || World == nullptr)
+	{
+		return false;
+	}
+	PendingTraceBatch.bIsPending = false;
+
+	// Results are only kept for the frame after submission, so a batch which missed it is dropped and traced again.
+	Hits.Reset(PendingTraceBatch.Handles.Num());
+	for (const FTraceHandle& Handle : PendingTraceBatch.Handles)
+	{
+		FTraceDatum Datum;
+		if (!World->QueryTraceData(Handle, Datum))
+		{
+			return false;
+		}
+
+		if (Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit)
+		{
+			Hits.Add(Datum.OutHits[0]);
+		}
+		else
+		{
+			Hits.Add(FHitResult(Datum.Start, Datum.End));
+		}
+	}
+
+	return true;
+}
+
+bool ULineOfSightVisualiser::IsTraceBatchSettled() const
+{
+	return PendingTraceBatch.ViewState.Equals(CurrentViewState) && PendingTraceBatch.RefinedIntervals == EdgeIntervalsToRefine;
+}
+
+void ULineOfSightVisualiser::GeneratePointsFromTraceBatch(const TArray<FHitResult>& Hits, bool & bWasObstactleDetected, TArray<FVector>& Points)
+{
+	const FLineOfSightTraceBatch& Batch = PendingTraceBatch;
+	const int32 RefinementTraceCount = GetRefinementTraceCount();
+	bool bHasObstacleBeenDetected = false;
+	int32 RefinedIntervalIndex = 0;
+
+	Points.Reset();
+	EdgeIntervalsToRefine.Reset();
+
+	for (int32 i = 0; i < Batch.FanTraceCount; ++i)
+	{
+		const FHitResult& Hit = Hits[i];
+		if (!bHasObstacleBeenDetected)
+		{
+			bHasObstacleBeenDetected = Hit.bBlockingHit;
+		}
+
+		if (i > 0 && PerformEdgeTest(Hits[i - 1], Hit))
+		{
+			bHasObstacleBeenDetected = true;
+			EdgeIntervalsToRefine.Add(i);
+
+			while (RefinedIntervalIndex < Batch.RefinedIntervals.Num() && Batch.RefinedIntervals[RefinedIntervalIndex] < i)
+			{
+				++RefinedIntervalIndex;
+			}
+
+			// If this interval was refined, add both sides of every edge between consecutive traces across it. Otherwise the
+			// edge is new, and is refined next frame.
+			if (RefinedIntervalIndex < Batch.RefinedIntervals.Num() && Batch.RefinedIntervals[RefinedIntervalIndex] == i)
+			{
+				const int32 FirstRefinementTrace = Batch.FanTraceCount + (RefinedIntervalIndex * RefinementTraceCount);
+				int32 PreviousTrace = i - 1;
+				int32 LastAddedTrace = i - 1;
+
+				for (int32 j = 0; j <= RefinementTraceCount; ++j)
+				{
+					const int32 CurrentTrace = j < RefinementTraceCount ? FirstRefinementTrace + j : i;
+					if (PerformEdgeTest(Hits[PreviousTrace], Hits[CurrentTrace]))
+					{
+						if (PreviousTrace != LastAddedTrace)
+						{
+							Points.Add(BlockingTraceEnd(Hits[PreviousTrace]));
+						}
+
+						if (CurrentTrace != i)
+						{
+							Points.Add(BlockingTraceEnd(Hits[CurrentTrace]));
+							LastAddedTrace = CurrentTrace;
+						}
+					}
+					PreviousTrace = CurrentTrace;
+				}
+			}
+		}
+
+		Points.Add(BlockingTraceEnd(Hit));
+	}
+
+	bWasObstactleDetected = bHasObstacleBeenDetected;
+}
+
+void ULineOfSightVisualiser::GeneratePointsFromViewerResult(const FLineOfSightViewerResult & Result, bool & bWasObstactleDetected, TArray<FVector>& Points)
+{
+	const FVector2D Origin = FVector2D(Result.Origin);
+	const TArray<FLineOfSightVisibilitySolver::FVisibleInterval>& Intervals = Result.Intervals;
+
+	// Intervals are in ascending order and the fan is walked in descending order, as in GeneratePoints.
+	bool bHasObstacleBeenDetected = false;
+	int32 IntervalIndex = Intervals.Num() - 1;
+	float CurrentAngle = Result.HalfAngle;
+	Points.Reset();
+
+	for (int32 i = 0; i < MinimalLoSPoints; ++i)
+	{
+		// Both sides of every edge passed since the previous point, on the segments either side of it.
+		while (IntervalIndex > 0 && Intervals[IntervalIndex].StartAngle > CurrentAngle)
+		{
+			const FVector2D EdgeDirection = FLineOfSightVisibilitySolver::RotateDirection(Result.Forward, Intervals[IntervalIndex].StartAngle);
+			Points.Add(FVector(Origin + (EdgeDirection * Result.GetVisibleDistance(EdgeDirection, Intervals[IntervalIndex].SegmentIndex)), Result.Origin.Z));
+			--IntervalIndex;
+			Points.Add(FVector(Origin + (EdgeDirection * Result.GetVisibleDistance(EdgeDirection, Intervals[IntervalIndex].SegmentIndex)), Result.Origin.Z));
+		}
+
+		const int32 SegmentIndex = Intervals[IntervalIndex].SegmentIndex;
+		const FVector2D Direction = FLineOfSightVisibilitySolver::RotateDirection(Result.Forward, CurrentAngle);
+		Points.Add(FVector(Origin + (Direction * Result.GetVisibleDistance(Direction, SegmentIndex)), Result.Origin.Z));
+		if (!bHasObstacleBeenDetected)
+		{
+			bHasObstacleBeenDetected = SegmentIndex != INDEX_NONE;
+		}
+
+		CurrentAngle -= MeshDivisionAngle;
 	}
+
+	bWasObstactleDetected = bHasObstacleBeenDetected;
 }
 
-void ULineOfSightVisualiser::CreateMeshSection(const int32 SectionIndex, const TArray<FVector> Vertices)
+ULineOfSightSubsystem* ULineOfSightVisualiser::GetLineOfSightSubsystem() const
+{
+	UWorld* World = GetWorld();
+	return World != nullptr ? World->GetSubsystem<ULineOfSightSubsystem>() : nullptr;
+}
+
+ULineOfSightFogOfWarSubsystem* ULineOfSightVisualiser::GetFogOfWarSubsystem() const
+{
+	UWorld* World = GetWorld();
+	return World != nullptr ? World->GetSubsystem<ULineOfSightFogOfWarSubsystem>() : nullptr;
+}
+
+int32 ULineOfSightVisualiser::GetRefinementTraceCount() const
+{
+	return (1 << FMath::Clamp(SubdivisionCount, 1, 6)) - 1;
+}
+
+void ULineOfSightVisualiser::UpdateMesh(const TArray<FVector>& Points, const FVector& Origin)
+{
+	const int32 PreviousMeshUploadCount = MeshUploadCount;
+
+	if (CreateVertexDataFromPoints(Points, true, Origin, DefaultSectionVertices))
+	{
+		UpdateMeshSection(0, DefaultSectionVertices);
+	}
+
+	if (Points.Num() > MinimalLoSPoints)
+	{
+		// The section is only recreated when it has to grow, and then at least doubles, so it settles at the most points seen.
+		const int32 AdditionalVertexCount = Points.Num() - MinimalLoSPoints + 2;
+		if (AdditionalVertexCount > AdditionalSectionVertices.Num())
+		{
+			AdditionalSectionVertices.SetNumZeroed(FMath::Max(AdditionalVertexCount, AdditionalSectionVertices.Num() * 2));
+			CreateVertexDataFromPoints(Points, false, Origin, AdditionalSectionVertices);
+			CreateTriangleDataFromVertices(AdditionalSectionVertices, AdditionalSectionTriangles);
+			CreateMeshSection(1, AdditionalSectionVertices, AdditionalSectionTriangles);
+		}
+		else if (CreateVertexDataFromPoints(Points, false, Origin, AdditionalSectionVertices))
+		{
+			UpdateMeshSection(1, AdditionalSectionVertices);
+		}
+
+		if (!bIsAdditionalSectionVisible)
+		{
+			VisualisationMesh->SetMeshSectionVisible(1, true);
+			bIsAdditionalSectionVisible = true;
+		}
+	}
+	else if (bIsAdditionalSectionVisible)
+	{
+		VisualisationMesh->SetMeshSectionVisible(1, false);
+		bIsAdditionalSectionVisible = false;
+	}
+
+	// Vertices are relative to the origin, so a polygon which only moved uploads nothing.
+	if (MeshUploadCount != PreviousMeshUploadCount || !Origin.Equals(PolygonOrigin))
+	{
+		PolygonOrigin = Origin;
+		++PolygonVersion;
+	}
+}
+
+void ULineOfSightVisualiser::CreateMeshSection(const int32 SectionIndex, const TArray<FVector>& Vertices, const TArray<int32>& Triangles)
 {
 	TArray<FVector> Normals;
 	TArray<FVector2D> UVs;
 	TArray<FProcMeshTangent> Tangents;
 	TArray<FLinearColor> VertColors;
 
-	VisualisationMesh->CreateMeshSection_LinearColor(SectionIndex, Vertices, CreateTriangleDataFromVertices(Vertices), Normals, UVs, VertColors, Tangents, false);
+	VisualisationMesh->CreateMeshSection_LinearColor(SectionIndex, Vertices, Triangles, Normals, UVs, VertColors, Tangents, false);
 	VisualisationMesh->SetWorldRotation(FRotator(0.0f, 0.0f, 0.0f));
+	++MeshUploadCount;
 }
 
-void ULineOfSightVisualiser::UpdateMeshSection(const int32 SectionIndex, const TArray<FVector> Vertices)
+void ULineOfSightVisualiser::UpdateMeshSection(const int32 SectionIndex, const TArray<FVector>& Vertices)
 {
 	TArray<FVector> Normals;
 	TArray<FVector2D> UVs;
@@ -174,28 +568,25 @@ void ULineOfSightVisualiser::UpdateMeshSection(const int32 SectionIndex, const T
 
 	VisualisationMesh->UpdateMeshSection_LinearColor(SectionIndex, Vertices, Normals, UVs, VertColors, Tangents);
 	VisualisationMesh->SetWorldRotation(FRotator(0.0f, 0.0f, 0.0f));
+	++MeshUploadCount;
 }
 
-TArray<int32> ULineOfSightVisualiser::CreateTriangleDataFromVertices(const TArray<FVector> Vertices)
+void ULineOfSightVisualiser::CreateTriangleDataFromVertices(const TArray<FVector>& Vertices, TArray<int32>& Triangles)
 {
-	TArray<int32> ReturnVerticies;
-	ReturnVerticies.Init(0, (Vertices.Num() * 3) + 3);
+	Triangles.Init(0, (Vertices.Num() * 3) + 3);
 	for (int32 i = 0; i <= Vertices.Num() - 3; ++i)
 	{
-		ReturnVerticies[(i * 3)] = 0;
-		ReturnVerticies[((i * 3) + 1)] = i + 1;
-		ReturnVerticies[((i * 3) + 2)] = i + 2;
+		Triangles[(i * 3)] = 0;
+		Triangles[((i * 3) + 1)] = i + 1;
+		Triangles[((i * 3) + 2)] = i + 2;
 	}
-
-	return ReturnVerticies;
 }
 
-TArray<FVector> ULineOfSightVisualiser::CreateVertexDataFromPoints(const TArray<FVector> Points, const bool ShouldFocusOnDefaultVerticies)
+bool ULineOfSightVisualiser::CreateVertexDataFromPoints(const TArray<FVector>& Points, const bool ShouldFocusOnDefaultVerticies, const FVector& Origin, TArray<FVector>& Vertices)
 {
 	int32 FirstIndex = 0;
 	int32 LastIndex = 0;
-
-	TArray<FVector> LocalVertices;
+	bool bHasChanged = false;
 
 	if (ShouldFocusOnDefaultVerticies)
 	{
@@ -207,28 +598,30 @@ TArray<FVector> ULineOfSightVisualiser::CreateVertexDataFromPoints(const TArray<
 		LastIndex = Points.Num() - 1;
 	}
 
-	FVector MeshLocation = VisualisationMesh->GetComponentLocation();
-	// UProperty* Prop = this->GetClass()->FindPropertyByName(FName("LocalVertices"));
-	// const UArrayProperty* ArrayProp = Cast<const UArrayProperty>(Prop);
-
-	LocalVertices.Init(FVector::ZeroVector, LastIndex - FirstIndex + 2);
+	// Relative to where the points were traced from, so the mesh stays attached to the owner if tracing lags behind.
+	FVector MeshLocation = Origin;
 
-	for (int32 i = FirstIndex; i <= LastIndex; ++i)
+	// Vertex 0 is the origin. Vertices past the last point collapse onto it, leaving only degenerate triangles.
+	for (int32 i = 1; i < Vertices.Num(); ++i)
 	{
-		FVector Current = Points[i];
-		LocalVertices[i - FirstIndex + 1] = FVector(Current.X - MeshLocation.X, Current.Y - MeshLocation.Y, Current.Z - MeshLocation.Z);
+		const FVector Current = Points[FMath::Min(FirstIndex + i - 1, LastIndex)] - MeshLocation;
+		if (!Vertices[i].Equals(Current, KINDA_SMALL_NUMBER))
+		{
+			Vertices[i] = Current;
+			bHasChanged = true;
+		}
 	}
 
-	return LocalVertices;
+	return bHasChanged;
 }
 
 void ULineOfSightVisualiser::GeneratePoints(bool & bWasObstactleDetected, TArray<FVector>& Points)
 {
-	TArray<FVector> LocalPoints;
 	FHitResult PreviousHitResult;
 	float CurrentTraceAngle = NormalizedVisionAngle / 2.0f;
 	float PreviousTraceAngle = 0.0f;
 	bool bHasObstacleBeenDetected = false;
+	Points.Reset();
 
 	for (int32 i = 1; i <= MinimalLoSPoints; ++i)
 	{
@@ -239,8 +632,7 @@ void ULineOfSightVisualiser::GeneratePoints(bool & bWasObstactleDetected, TArray
 			if (bEdgeTest)
 			{
 				bHasObstacleBeenDetected = true;
-				TArray<FVector> EdgeFixes = ConstructEdgeFixApproximation(PreviousTraceAngle, PreviousHitResult);
-				LocalPoints.Append(EdgeFixes);
+				ConstructEdgeFixApproximation(PreviousTraceAngle, PreviousHitResult, Points);
 			}
 			else if (!bHasObstacleBeenDetected)
 			{
@@ -256,7 +648,7 @@ void ULineOfSightVisualiser::GeneratePoints(bool & bWasObstactleDetected, TArray
 		}
 
 		FVector BlockingPoint = BlockingTraceEnd(Hit);
-		LocalPoints.Add(BlockingPoint);
+		Points.Add(BlockingPoint);
 
 		PreviousHitResult = Hit;
 		PreviousTraceAngle = CurrentTraceAngle;
@@ -264,14 +656,11 @@ void ULineOfSightVisualiser::GeneratePoints(bool & bWasObstactleDetected, TArray
 	}
 
 	bWasObstactleDetected = bHasObstacleBeenDetected;
-	Points = LocalPoints;
 }
 
 FHitResult ULineOfSightVisualiser::SingleTrace(const float TraceAngle)
 {
 	FVector RotatedVector = VisualisationMesh->GetComponentLocation() + (GetOwner()->GetActorForwardVector().RotateAngleAxis(TraceAngle, GetOwner()->GetActorUpVector()) * CurrentVisionRadius);
-	TArray<AActor*> IgnoreActors;
-	IgnoreActors.Add(GetOwner());
 
 	FHitResult Hit;
 	Hit.Init();
@@ -283,12 +672,40 @@ FHitResult ULineOfSightVisualiser::SingleTrace(const float TraceAngle)
 	return Hit;
 }
 
-FVector ULineOfSightVisualiser::BlockingTraceEnd(FHitResult Hit)
+FVector ULineOfSightVisualiser::BlockingTraceEnd(const FHitResult & Hit)
 {
 	return Hit.bBlockingHit ? FVector(Hit.ImpactPoint.X, Hit.ImpactPoint.Y, Hit.ImpactPoint.Z) : FVector(Hit.TraceEnd.X, Hit.TraceEnd.Y, Hit.TraceEnd.Z);
 }
 
-bool ULineOfSightVisualiser::IsMeshUpdateRequired(const bool ObstacleDetectedInPrevCycle, const bool ObstacleDetectedInCurrentCycle)
+FLineOfSightViewState ULineOfSightVisualiser::GetViewState()
+{
+	FLineOfSightViewState ViewState;
+	ViewState.Origin = VisualisationMesh->GetComponentLocation();
+	ViewState.Rotation = GetOwner()->GetActorQuat();
+	ViewState.Radius = CurrentVisionRadius;
+
+	ULineOfSightSubsystem* Subsystem = GetLineOfSightSubsystem();
+	if (bSkipUnchangedUpdates && Subsystem != nullptr)
+	{
+		const uint32 OccluderVersion = Subsystem->GetDynamicOccluderVersion();
+		if (!bHasCachedOccluderSignature || OccluderVersion != CachedOccluderVersion || !ViewState.Origin.Equals(CachedOccluderOrigin, 0.1f)
+			|| !FMath::IsNearlyEqual(ViewState.Radius, CachedOccluderRadius, 0.1f))
+		{
+			CachedOccluderSignature = Subsystem->GetOccluderSignature(ViewState.Origin, ViewState.Radius, TraceChannel.GetValue(), Params);
+			CachedOccluderVersion = OccluderVersion;
+			CachedOccluderOrigin = ViewState.Origin;
+			CachedOccluderRadius = ViewState.Radius;
+			bHasCachedOccluderSignature = true;
+		}
+
+		ViewState.OccluderSignature = CachedOccluderSignature;
+		ViewState.bHasOccluderSignature = true;
+	}
+
+	return ViewState;
+}
+
+bool ULineOfSightVisualiser::IsMeshUpdateRequired()
 {
 	if (bDoesMeshNeedToBeUpdated)
 	{
@@ -296,17 +713,16 @@ bool ULineOfSightVisualiser::IsMeshUpdateRequired(const bool ObstacleDetectedInP
 		return true;
 	}
 
-	return (ObstacleDetectedInPrevCycle || ObstacleDetectedInCurrentCycle);
+	return !CurrentViewState.Equals(LastViewState);
 }
 
-bool ULineOfSightVisualiser::PerformEdgeTest(const FHitResult StartingHit, const FHitResult EndingHit)
+bool ULineOfSightVisualiser::PerformEdgeTest(const FHitResult & StartingHit, const FHitResult & EndingHit)
 {
 	return ((StartingHit.GetActor() != EndingHit.GetActor()) || (FMath::Abs(StartingHit.Distance - EndingHit.Distance) > MinEdgeIdentifierDistance));
 }
 
-TArray<FVector> ULineOfSightVisualiser::ConstructEdgeFixApproximation(const float StartingAngle, const FHitResult StartingHit)
+void ULineOfSightVisualiser::ConstructEdgeFixApproximation(const float StartingAngle, const FHitResult & StartingHit, TArray<FVector>& Points)
 {
-	TArray<FVector> NewPoints;
 	FHitResult CurrentHitResult;
 	FHitResult PreviousHitResult = StartingHit;
 	FVector StartingPoint = FVector::ZeroVector;
@@ -320,7 +736,7 @@ TArray<FVector> ULineOfSightVisualiser::ConstructEdgeFixApproximation(const floa
 
 		if (i > 1)
 		{
-			NewPoints.Add(StartingPoint);
+			Points.Add(StartingPoint);
 		}
 
 		CurrentHitResult = SingleTrace(CurrentTraceAngle);
@@ -336,23 +752,21 @@ TArray<FVector> ULineOfSightVisualiser::ConstructEdgeFixApproximation(const floa
 
 			if (bWasStartUpdated)
 			{
-				NewPoints.Add(UpdatedStartPointLocal);
+				Points.Add(UpdatedStartPointLocal);
 			}
 
 			if (bWasEndUpdated)
 			{
-				NewPoints.Add(UpdatedEndPointLocal);
+				Points.Add(UpdatedEndPointLocal);
 			}
 		}
 
 		PreviousTraceAngle = CurrentTraceAngle;
 		PreviousHitResult = CurrentHitResult;
 	}
-
-	return NewPoints;
 }
 
-void ULineOfSightVisualiser::RecalculateEdgePoints(const FHitResult StartingHit, const float StartingAngle, const float EndingAngle, 
+void ULineOfSightVisualiser::RecalculateEdgePoints(const FHitResult & StartingHit, const float StartingAngle, const float EndingAngle, 
 	const FVector StartingPoint, const FVector EndingPoint, bool & StartUpdated, FVector & UpdatedStartPoint, bool & EndUpdated, 
 	FVector & UpdatedEndPoint)
 {
@@ -0,0 +1,452 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Geometry/LineOfSightGeometry.h"
+#include "Algo/Sort.h"
+
+void FLineOfSightSegmentBVH::Build(TArray<FLineOfSightSegment>&& InSegments)
+{
+	Segments = MoveTemp(InSegments);
+	Nodes.Reset();
+
+	if (Segments.Num() > 0)
+	{
+		Nodes.Reserve(((Segments.Num() / MaxLeafSegments) + 1) * 2);
+		BuildNode(0, Segments.Num());
+	}
+}
+
+int32 FLineOfSightSegmentBVH::BuildNode(int32 FirstSegment, int32 NumSegments)
+{
+	FBox2D Bounds(ForceInit);
+	FBox2D CenterBounds(ForceInit);
+	for (int32 i = FirstSegment; i < FirstSegment + NumSegments; ++i)
+	{
+		Bounds += Segments[i].Start;
+		Bounds += Segments[i].End;
+		CenterBounds += (Segments[i].Start + Segments[i].End) * 0.5f;
+	}
+
+	const int32 NodeIndex = Nodes.AddUninitialized();
+	Nodes[NodeIndex].Bounds = Bounds;
+	Nodes[NodeIndex].RightChild = INDEX_NONE;
+	Nodes[NodeIndex].FirstSegment = FirstSegment;
+	Nodes[NodeIndex].NumSegments = NumSegments;
+
+	if (NumSegments <= MaxLeafSegments)
+	{
+		return NodeIndex;
+	}
+
+	// Median split along the longer axis of the segment centres.
+	const FVector2D Extent = CenterBounds.GetExtent();
+	const bool bSplitAlongX = Extent.X >= Extent.Y;
+	Algo::Sort(MakeArrayView(Segments.GetData() + FirstSegment, NumSegments), [bSplitAlongX](const FLineOfSightSegment& A, const FLineOfSightSegment& B)
+	{
+		return bSplitAlongX ? (A.Start.X + A.End.X) < (B.Start.X + B.End.X) : (A.Start.Y + A.End.Y) < (B.Start.Y + B.End.Y);
+	});
+
+	const int32 NumLeftSegments = NumSegments / 2;
+	Nodes[NodeIndex].NumSegments = 0;
+	BuildNode(FirstSegment, NumLeftSegments);
+	const int32 RightChild = BuildNode(FirstSegment + NumLeftSegments, NumSegments - NumLeftSegments);
+	Nodes[NodeIndex].RightChild = RightChild;
+
+	return NodeIndex;
+}
+
+void FLineOfSightSegmentBVH::QueryCircle(const FVector2D& Center, float Radius, TArray<int32>& OutSegmentIndices) const
+{
+	if (Nodes.Num() == 0)
+	{
+		return;
+	}
+
+	const float RadiusSquared = Radius * Radius;
+	TArray<int32, TInlineAllocator<64>> Stack;
+	Stack.Add(0);
+
+	while (Stack.Num() > 0)
+	{
+		const FNode& Node = Nodes[Stack.Pop(false)];
+		if (Node.Bounds.ComputeSquaredDistanceToPoint(Center) > RadiusSquared)
+		{
+			continue;
+		}
+
+		if (Node.NumSegments == 0)
+		{
+			Stack.Add(Node.RightChild);
+			Stack.Add(static_cast<int32>(&Node - Nodes.GetData()) + 1);
+			continue;
+		}
+
+		for (int32 i = Node.FirstSegment; i < Node.FirstSegment + Node.NumSegments; ++i)
+		{
+			const FVector2D ClosestPoint = FMath::ClosestPointOnSegment2D(Center, Segments[i].Start, Segments[i].End);
+			if (FVector2D::DistSquared(ClosestPoint, Center) <= RadiusSquared)
+			{
+				OutSegmentIndices.Add(i);
+			}
+		}
+	}
+}
+
+void FLineOfSightSegmentBVH::QueryBox(const FBox2D& Box, TArray<int32>& OutSegmentIndices) const
+{
+	if (Nodes.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<int32, TInlineAllocator<64>> Stack;
+	Stack.Add(0);
+
+	while (Stack.Num() > 0)
+	{
+		const FNode& Node = Nodes[Stack.Pop(false)];
+		if (!Node.Bounds.Intersect(Box))
+		{
+			continue;
+		}
+
+		if (Node.NumSegments == 0)
+		{
+			Stack.Add(Node.RightChild);
+			Stack.Add(static_cast<int32>(&Node - Nodes.GetData()) + 1);
+			continue;
+		}
+
+		for (int32 i = Node.FirstSegment; i < Node.FirstSegment + Node.NumSegments; ++i)
+		{
+			FBox2D SegmentBounds(ForceInit);
+			SegmentBounds += Segments[i].Start;
+			SegmentBounds += Segments[i].End;
+			if (SegmentBounds.Intersect(Box))
+			{
+				OutSegmentIndices.Add(i);
+			}
+		}
+	}
+}
+
+void FLineOfSightVisibilitySolver::Solve(const FVector2D& Origin, const FVector2D& Forward, float MinAngle, float MaxAngle, const TArray<FLineOfSightSegment>& Segments, TArray<FVisibleInterval>& OutIntervals)
+{
+	OutIntervals.Reset();
+	if (MaxAngle <= MinAngle)
+	{
+		return;
+	}
+
+	SweepOrigin = Origin;
+	SweepForward = Forward;
+	SweepSegments.Reset();
+	SweepEvents.Reset();
+	Heap.Reset();
+
+	for (int32 i = 0; i < Segments.Num(); ++i)
+	{
+		const FLineOfSightSegment& Segment = Segments[i];
+		const FVector2D StartDirection = Segment.Start - Origin;
+		const FVector2D EndDirection = Segment.End - Origin;
+
+		// Segments seen edge-on (or passing through the origin) cover no angle.
+		if (FMath::Abs(FVector2D::CrossProduct(StartDirection, EndDirection)) <= KINDA_SMALL_NUMBER)
+		{
+			continue;
+		}
+
+		float StartAngle = GetAngle(Forward, StartDirection);
+		float EndAngle = GetAngle(Forward, EndDirection);
+		FLineOfSightSegment Ordered = StartAngle <= EndAngle ? Segment : FLineOfSightSegment(Segment.End, Segment.Start);
+		if (StartAngle > EndAngle)
+		{
+			Swap(StartAngle, EndAngle);
+		}
+
+		// A segment behind the origin spans the seam at +-180 degrees, so it is split where the backward ray crosses it.
+		if (EndAngle - StartAngle > 180.0f)
+		{
+			float SeamDistance = 0.0f;
+			if (!IntersectRay(Origin, -Forward, Segment, SeamDistance))
+			{
+				continue;
+			}
+
+			const FVector2D SeamPoint = Origin - (Forward * SeamDistance);
+			SweepSegments.Add({ FLineOfSightSegment(Ordered.End, SeamPoint), i, EndAngle, 180.0f });
+			SweepSegments.Add({ FLineOfSightSegment(SeamPoint, Ordered.Start), i, -180.0f, StartAngle });
+		}
+		else
+		{
+			SweepSegments.Add({ Ordered, i, StartAngle, EndAngle });
+		}
+	}
+
+	// Only the part of each segment within the arc produces events.
+	for (int32 i = 0; i < SweepSegments.Num(); ++i)
+	{
+		const FSweepSegment& SweepSegment = SweepSegments[i];
+		if (SweepSegment.EndAngle <= MinAngle || SweepSegment.StartAngle >= MaxAngle)
+		{
+			continue;
+		}
+
+		SweepEvents.Add({ FMath::Max(SweepSegment.StartAngle, MinAngle), i, true });
+		SweepEvents.Add({ FMath::Min(SweepSegment.EndAngle, MaxAngle), i, false });
+	}
+
+	// Ends are handled before starts at the same angle, so segments sharing an endpoint are never compared at it.
+	Algo::Sort(SweepEvents, [](const FSweepEvent& A, const FSweepEvent& B)
+	{
+		return A.Angle != B.Angle ? A.Angle < B.Angle : (!A.bIsStart && B.bIsStart);
+	});
+
+	HeapPositions.Init(INDEX_NONE, SweepSegments.Num());
+
+	float IntervalStartAngle = MinAngle;
+	int32 EventIndex = 0;
+
+	// Segments starting at the beginning of the arc are active from the first interval.
+	while (EventIndex < SweepEvents.Num() && SweepEvents[EventIndex].Angle <= MinAngle)
+	{
+		ApplySweepEvent(SweepEvents[EventIndex++]);
+	}
+	int32 ClosestSweepIndex = Heap.Num() > 0 ? Heap[0] : INDEX_NONE;
+
+	while (EventIndex < SweepEvents.Num() && SweepEvents[EventIndex].Angle < MaxAngle)
+	{
+		const float EventAngle = SweepEvents[EventIndex].Angle;
+		while (EventIndex < SweepEvents.Num() && SweepEvents[EventIndex].Angle == EventAngle)
+		{
+			ApplySweepEvent(SweepEvents[EventIndex++]);
+		}
+
+		const int32 NewClosestSweepIndex = Heap.Num() > 0 ? Heap[0] : INDEX_NONE;
+		if (NewClosestSweepIndex != ClosestSweepIndex)
+		{
+			if (EventAngle > IntervalStartAngle)
+			{
+				OutIntervals.Add({ IntervalStartAngle, EventAngle, ClosestSweepIndex != INDEX_NONE ? SweepSegments[ClosestSweepIndex].SourceIndex : INDEX_NONE });
+				IntervalStartAngle = EventAngle;
+			}
+			ClosestSweepIndex = NewClosestSweepIndex;
+		}
+	}
+
+	OutIntervals.Add({ IntervalStartAngle, MaxAngle, ClosestSweepIndex != INDEX_NONE ? SweepSegments[ClosestSweepIndex].SourceIndex : INDEX_NONE });
+}
+
+void FLineOfSightVisibilitySolver::SplitAtIntersections(TArray<FLineOfSightSegment>& Segments)
+{
+	FLineOfSightSegmentBVH BVH;
+	BVH.Build(TArray<FLineOfSightSegment>(Segments));
+	const TArray<FLineOfSightSegment>& Sorted = BVH.GetSegments();
+
+	TArray<FLineOfSightSegment> SplitSegments;
+	SplitSegments.Reserve(Sorted.Num());
+	TArray<int32> Candidates;
+	TArray<float> SplitTimes;
+
+	for (int32 i = 0; i < Sorted.Num(); ++i)
+	{
+		const FLineOfSightSegment& Segment = Sorted[i];
+		const FVector2D Direction = Segment.End - Segment.Start;
+
+		FBox2D Bounds(ForceInit);
+		Bounds += Segment.Start;
+		Bounds += Segment.End;
+		Candidates.Reset();
+		BVH.QueryBox(Bounds, Candidates);
+
+		SplitTimes.Reset();
+		for (int32 Candidate : Candidates)
+		{
+			if (Candidate == i)
+			{
+				continue;
+			}
+
+			const FVector2D OtherDirection = Sorted[Candidate].End - Sorted[Candidate].Start;
+			const float Denominator = FVector2D::CrossProduct(Direction, OtherDirection);
+			if (FMath::Abs(Denominator) <= SMALL_NUMBER)
+			{
+				continue;
+			}
+
+			// Split this segment wherever another one crosses or touches its interior.
+			const FVector2D Offset = Sorted[Candidate].Start - Segment.Start;
+			const float Time = FVector2D::CrossProduct(Offset, OtherDirection) / Denominator;
+			const float OtherTime = FVector2D::CrossProduct(Offset, Direction) / Denominator;
+			if (Time > KINDA_SMALL_NUMBER && Time < 1.0f - KINDA_SMALL_NUMBER && OtherTime >= -KINDA_SMALL_NUMBER && OtherTime <= 1.0f + KINDA_SMALL_NUMBER)
+			{
+				SplitTimes.Add(Time);
+			}
+		}
+
+		SplitTimes.Sort();
+		FVector2D PieceStart = Segment.Start;
+		for (float Time : SplitTimes)
+		{
+			const FVector2D PieceEnd = Segment.Start + (Direction * Time);
+			if (!PieceStart.Equals(PieceEnd, KINDA_SMALL_NUMBER))
+			{
+				SplitSegments.Add(FLineOfSightSegment(PieceStart, PieceEnd));
+			}
+			PieceStart = PieceEnd;
+		}
+
+		if (!PieceStart.Equals(Segment.End, KINDA_SMALL_NUMBER))
+		{
+			SplitSegments.Add(FLineOfSightSegment(PieceStart, Segment.End));
+		}
+	}
+
+	Segments = MoveTemp(SplitSegments);
+}
+
+float FLineOfSightVisibilitySolver::GetAngle(const FVector2D& Forward, const FVector2D& Direction)
+{
+	return FMath::RadiansToDegrees(FMath::Atan2(FVector2D::CrossProduct(Forward, Direction), FVector2D::DotProduct(Forward, Direction)));
+}
+
+FVector2D FLineOfSightVisibilitySolver::RotateDirection(const FVector2D& Direction, float Angle)
+{
+	float Sin = 0.0f;
+	float Cos = 0.0f;
+	FMath::SinCos(&Sin, &Cos, FMath::DegreesToRadians(Angle));
+	return FVector2D((Cos * Direction.X) - (Sin * Direction.Y), (Sin * Direction.X) + (Cos * Direction.Y));
+}
+
+bool FLineOfSightVisibilitySolver::IntersectRay(const FVector2D& Origin, const FVector2D& Direction, const FLineOfSightSegment& Segment, float& OutDistance)
+{
+	const FVector2D SegmentDirection = Segment.End - Segment.Start;
+	const float Denominator = FVector2D::CrossProduct(Direction, SegmentDirection);
+	if (FMath::Abs(Denominator) <= SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	const FVector2D Offset = Segment.Start - Origin;
+	const float Distance = FVector2D::CrossProduct(Offset, SegmentDirection) / Denominator;
+	const float SegmentTime = FVector2D::CrossProduct(Offset, Direction) / Denominator;
+	if (Distance < 0.0f || SegmentTime < -KINDA_SMALL_NUMBER || SegmentTime > 1.0f + KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	OutDistance = Distance;
+	return true;
+}
+
+bool FLineOfSightVisibilitySolver::IsInFrontOf(int32 A, int32 B) const
+{
+	// Segments do not cross, so whichever is closer along any ray through both is closer along all of them.
+	const FSweepSegment& SegmentA = SweepSegments[A];
+	const FSweepSegment& SegmentB = SweepSegments[B];
+	const float Angle = (FMath::Max(SegmentA.StartAngle, SegmentB.StartAngle) + FMath::Min(SegmentA.EndAngle, SegmentB.EndAngle)) * 0.5f;
+	const FVector2D Direction = RotateDirection(SweepForward, Angle);
+
+	float DistanceA = 0.0f;
+	float DistanceB = 0.0f;
+	if (!IntersectRay(SweepOrigin, Direction, SegmentA.Segment, DistanceA))
+	{
+		DistanceA = FMath::Min(FVector2D::Distance(SweepOrigin, SegmentA.Segment.Start), FVector2D::Distance(SweepOrigin, SegmentA.Segment.End));
+	}
+	if (!IntersectRay(SweepOrigin, Direction, SegmentB.Segment, DistanceB))
+	{
+		DistanceB = FMath::Min(FVector2D::Distance(SweepOrigin, SegmentB.Segment.Start), FVector2D::Distance(SweepOrigin, SegmentB.Segment.End));
+	}
+
+	return DistanceA < DistanceB;
+}
+
+void FLineOfSightVisibilitySolver::ApplySweepEvent(const FSweepEvent& Event)
+{
+	if (Event.bIsStart)
+	{
+		HeapPush(Event.SweepIndex);
+	}
+	else
+	{
+		HeapRemove(Event.SweepIndex);
+	}
+}
+
+void FLineOfSightVisibilitySolver::HeapPush(int32 SweepIndex)
+{
+	HeapPositions[SweepIndex] = Heap.Add(SweepIndex);
+	HeapSiftUp(HeapPositions[SweepIndex]);
+}
+
+void FLineOfSightVisibilitySolver::HeapRemove(int32 SweepIndex)
+{
+	const int32 Position = HeapPositions[SweepIndex];
+	if (Position == INDEX_NONE)
+	{
+		return;
+	}
+
+	const int32 LastPosition = Heap.Num() - 1;
+	if (Position != LastPosition)
+	{
+		HeapSwap(Position, LastPosition);
+	}
+	Heap.Pop(false);
+	HeapPositions[SweepIndex] = INDEX_NONE;
+
+	// The last segment was moved into the removed one's place, and may belong above or below it.
+	if (Position < Heap.Num())
+	{
+		const int32 MovedSweepIndex = Heap[Position];
+		HeapSiftUp(Position);
+		HeapSiftDown(HeapPositions[MovedSweepIndex]);
+	}
+}
+
+void FLineOfSightVisibilitySolver::HeapSiftUp(int32 Position)
+{
+	while (Position > 0)
+	{
+		const int32 Parent = (Position - 1) / 2;
+		if (!IsInFrontOf(Heap[Position], Heap[Parent]))
+		{
+			break;
+		}
+
+		HeapSwap(Position, Parent);
+		Position = Parent;
+	}
+}
+
+void FLineOfSightVisibilitySolver::HeapSiftDown(int32 Position)
+{
+	while (true)
+	{
+		const int32 Left = (Position * 2) + 1;
+		const int32 Right = Left + 1;
+		int32 Closest = Position;
+
+		if (Left < Heap.Num() && IsInFrontOf(Heap[Left], Heap[Closest]))
+		{
+			Closest = Left;
+		}
+		if (Right < Heap.Num() && IsInFrontOf(Heap[Right], Heap[Closest]))
+		{
+			Closest = Right;
+		}
+		if (Closest == Position)
+		{
+			break;
+		}
+
+		HeapSwap(Position, Closest);
+		Position = Closest;
+	}
+}
+
+void FLineOfSightVisibilitySolver::HeapSwap(int32 PositionA, int32 PositionB)
+{
+	Swap(Heap[PositionA], Heap[PositionB]);
+	HeapPositions[Heap[PositionA]] = PositionA;
+	HeapPositions[Heap[PositionB]] = PositionB;
+}
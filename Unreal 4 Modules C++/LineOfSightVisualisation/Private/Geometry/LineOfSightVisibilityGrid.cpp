@@ -0,0 +1,345 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Geometry/LineOfSightVisibilityGrid.h"
+#include "LineOfSightVisualisation.h"
+#include "Misc/Crc.h"
+
+void FLineOfSightVisibilityGrid::Init(const FVector2D& InOrigin, float InCellSize, int32 InResolution)
+{
+	Origin = InOrigin;
+	CellSize = FMath::Max(InCellSize, KINDA_SMALL_NUMBER);
+	InvCellSize = 1.0f / CellSize;
+	TileResolution = FMath::Max(FMath::DivideAndRoundUp(InResolution, TileSize), 1);
+	Resolution = TileResolution * TileSize;
+
+	Visible.Reset();
+	Visible.SetNumZeroed(Resolution * Resolution);
+	Explored.Reset();
+	Explored.SetNumZeroed(Resolution * Resolution);
+	TileFlags.Init(TileDirty, TileResolution * TileResolution);
+	TileVisibleChecksums.Init(0, TileResolution * TileResolution);
+}
+
+void FLineOfSightVisibilityGrid::BeginVisibleUpdate()
+{
+	for (int32 TileIndex = 0; TileIndex < TileFlags.Num(); ++TileIndex)
+	{
+		if ((TileFlags[TileIndex] & TileVisible) == 0)
+		{
+			continue;
+		}
+
+		uint8* Row = Visible.GetData() + GetFirstCellOfTile(TileIndex);
+		for (int32 y = 0; y < TileSize; ++y, Row += Resolution)
+		{
+			FMemory::Memzero(Row, TileSize);
+		}
+		TileFlags[TileIndex] = (TileFlags[TileIndex] & ~TileVisible) | TileWasVisible;
+	}
+}
+
+void FLineOfSightVisibilityGrid::RasteriseFan(const FVector& FanOrigin, const TArray<FVector>& Points)
+{
+	if (Resolution == 0)
+	{
+		return;
+	}
+
+	const FVector2D GridFanOrigin = (FVector2D(FanOrigin) - Origin) * InvCellSize;
+	const int32 OriginColumn = FMath::FloorToInt(GridFanOrigin.X);
+	const int32 OriginRow = FMath::FloorToInt(GridFanOrigin.Y);
+	if (OriginColumn >= 0 && OriginColumn < Resolution && OriginRow >= 0 && OriginRow < Resolution)
+	{
+		Visible[OriginRow * Resolution + OriginColumn] = 255;
+		FlagTiles(OriginRow, OriginColumn, OriginColumn, TileVisible);
+	}
+
+	FVector2D PreviousPoint = FVector2D::ZeroVector;
+	for (int32 i = 0; i < Points.Num(); ++i)
+	{
+		const FVector2D Point = (FVector2D(Points[i]) - Origin) * InvCellSize;
+		if (i > 0)
+		{
+			RasteriseTriangle(GridFanOrigin, PreviousPoint, Point);
+		}
+		PreviousPoint = Point;
+	}
+}
+
+void FLineOfSightVisibilityGrid::RasteriseTriangle(const FVector2D& A, const FVector2D& B, const FVector2D& C)
+{
+	// Wound counter-clockwise, so a cell centre is inside when it is to the left of every edge.
+	const float Area = (B - A) ^ (C - A);
+	if (FMath::IsNearlyZero(Area))
+	{
+		return;
+	}
+	const FVector2D Corners[3] = { A, Area > 0.0f ? B : C, Area > 0.0f ? C : B };
+
+	const float MinY = FMath::Min3(A.Y, B.Y, C.Y);
+	const float MaxY = FMath::Max3(A.Y, B.Y, C.Y);
+	const int32 FirstRow = FMath::Max(FMath::CeilToInt(MinY - 0.5f), 0);
+	const int32 LastRow = FMath::Min(FMath::FloorToInt(MaxY - 0.5f), Resolution - 1);
+
+	for (int32 Row = FirstRow; Row <= LastRow; ++Row)
+	{
+		// Every edge bounds the row on one side, so the cells inside form a single span.
+		const float Y = Row + 0.5f;
+		float Left = 0.0f;
+		float Right = (float)Resolution;
+		for (int32 Edge = 0; Edge < 3; ++Edge)
+		{
+			const FVector2D& Start = Corners[Edge];
+			const FVector2D Delta = Corners[(Edge + 1) % 3] - Start;
+			const float Offset = Delta.X * (Y - Start.Y);
+			if (Delta.Y < 0.0f)
+			{
+				Left = FMath::Max(Left, Start.X + Offset / Delta.Y);
+			}
+			else if (Delta.Y > 0.0f)
+			{
+				Right = FMath::Min(Right, Start.X + Offset / Delta.Y);
+			}
+			else if (Offset < 0.0f)
+			{
+				Right = -1.0f;
+			}
+		}
+
+		const int32 FirstColumn = FMath::Max(FMath::CeilToInt(Left - 0.5f), 0);
+		const int32 LastColumn = FMath::Min(FMath::FloorToInt(Right - 0.5f), Resolution - 1);
+		if (FirstColumn <= LastColumn)
+		{
+			FMemory::Memset(Visible.GetData() + Row * Resolution + FirstColumn, 255, LastColumn - FirstColumn + 1);
+			FlagTiles(Row, FirstColumn, LastColumn, TileVisible);
+		}
+	}
+}
+
+void FLineOfSightVisibilityGrid::EndVisibleUpdate()
+{
+	for (int32 TileIndex = 0; TileIndex < TileFlags.Num(); ++TileIndex)
+	{
+		uint8& Flags = TileFlags[TileIndex];
+		if ((Flags & (TileVisible | TileWasVisible)) == 0)
+		{
+			continue;
+		}
+		Flags &= ~TileWasVisible;
+
+		// Tiles are cleared and filled again on every update, so only a checksum tells whether they changed.
+		const int32 FirstCell = GetFirstCellOfTile(TileIndex);
+		uint32 Checksum = 0;
+		for (int32 y = 0; y < TileSize; ++y)
+		{
+			Checksum = FCrc::MemCrc32(Visible.GetData() + FirstCell + y * Resolution, TileSize, Checksum);
+		}
+		if (Checksum == TileVisibleChecksums[TileIndex])
+		{
+			continue;
+		}
+		TileVisibleChecksums[TileIndex] = Checksum;
+		Flags |= TileDirty;
+
+		if ((Flags & TileVisible) == 0)
+		{
+			continue;
+		}
+		Flags |= TileExplored;
+
+		for (int32 y = 0; y < TileSize; ++y)
+		{
+			const uint8* VisibleRow = Visible.GetData() + FirstCell + y * Resolution;
+			uint16* ExploredRow = Explored.GetData() + FirstCell + y * Resolution;
+			for (int32 x = 0; x < TileSize; ++x)
+			{
+				ExploredRow[x] = FMath::Max<uint16>(ExploredRow[x], VisibleRow[x] * 257);
+			}
+		}
+	}
+}
+
+void FLineOfSightVisibilityGrid::DecayExplored(float Factor)
+{
+	// 16.16 fixed point, so a factor of 1 leaves every value unchanged without overflowing.
+	const uint32 FixedFactor = (uint32)(FMath::Clamp(Factor, 0.0f, 1.0f) * 65536.0f);
+	if (FixedFactor >= 65536)
+	{
+		return;
+	}
+
+	for (int32 TileIndex = 0; TileIndex < TileFlags.Num(); ++TileIndex)
+	{
+		uint8& Flags = TileFlags[TileIndex];
+		if ((Flags & TileExplored) == 0)
+		{
+			continue;
+		}
+
+		// Only changes of the uploaded (upper) byte make the tile dirty.
+		const int32 FirstCell = GetFirstCellOfTile(TileIndex);
+		uint32 Changed = 0;
+		uint32 Remaining = 0;
+		for (int32 y = 0; y < TileSize; ++y)
+		{
+			const uint8* VisibleRow = Visible.GetData() + FirstCell + y * Resolution;
+			uint16* ExploredRow = Explored.GetData() + FirstCell + y * Resolution;
+			for (int32 x = 0; x < TileSize; ++x)
+			{
+				const uint32 Previous = ExploredRow[x];
+				const uint32 Decayed = FMath::Max((Previous * FixedFactor) >> 16, VisibleRow[x] * 257u);
+				ExploredRow[x] = (uint16)Decayed;
+				Changed |= (Previous ^ Decayed) >> 8;
+				Remaining |= Decayed;
+			}
+		}
+
+		if (Changed != 0)
+		{
+			Flags |= TileDirty;
+		}
+		if (Remaining == 0)
+		{
+			Flags &= ~TileExplored;
+		}
+	}
+}
+
+int32 FLineOfSightVisibilityGrid::GetCellIndex(const FVector& Location) const
+{
+	const int32 Column = FMath::FloorToInt((Location.X - Origin.X) * InvCellSize);
+	const int32 Row = FMath::FloorToInt((Location.Y - Origin.Y) * InvCellSize);
+	if (Column < 0 || Column >= Resolution || Row < 0 || Row >= Resolution)
+	{
+		return INDEX_NONE;
+	}
+	return Row * Resolution + Column;
+}
+
+void FLineOfSightVisibilityGrid::ConsumeDirtyTiles(TArray<int32>& OutTiles)
+{
+	OutTiles.Reset();
+	for (int32 TileIndex = 0; TileIndex < TileFlags.Num(); ++TileIndex)
+	{
+		if ((TileFlags[TileIndex] & TileDirty) != 0)
+		{
+			OutTiles.Add(TileIndex);
+			TileFlags[TileIndex] &= ~TileDirty;
+		}
+	}
+}
+
+void FLineOfSightVisibilityGrid::CopyTile(int32 TileIndex, uint8* OutData) const
+{
+	const int32 FirstCell = GetFirstCellOfTile(TileIndex);
+	for (int32 y = 0; y < TileSize; ++y)
+	{
+		const uint8* VisibleRow = Visible.GetData() + FirstCell + y * Resolution;
+		const uint16* ExploredRow = Explored.GetData() + FirstCell + y * Resolution;
+		for (int32 x = 0; x < TileSize; ++x)
+		{
+			OutData[x * 2] = VisibleRow[x];
+			OutData[x * 2 + 1] = (uint8)(ExploredRow[x] >> 8);
+		}
+		OutData += TileSize * 2;
+	}
+}
+
+void FLineOfSightVisibilityGrid::FlagTiles(int32 Row, int32 FirstColumn, int32 LastColumn, uint8 Flag)
+{
+	uint8* RowFlags = TileFlags.GetData() + (Row / TileSize) * TileResolution;
+	for (int32 TileColumn = FirstColumn / TileSize; TileColumn <= LastColumn / TileSize; ++TileColumn)
+	{
+		RowFlags[TileColumn] |= Flag;
+	}
+}
+
+int32 FLineOfSightVisibilityGrid::GetFirstCellOfTile(int32 TileIndex) const
+{
+	return (TileIndex / TileResolution) * TileSize * Resolution + (TileIndex % TileResolution) * TileSize;
+}
+
+void FLineOfSightVisibilityGrid::RunBenchmark(int32 NumViewers, int32 NumUpdates)
+{
+	// Cones similar to a default visualiser, on a map of fixed size, so higher resolutions cover every cone with more cells.
+	const float WorldSize = 51200.0f;
+	const float ViewRadius = 2000.0f;
+	const float ViewAngle = 90.0f;
+	const int32 NumPoints = 129;
+	NumViewers = FMath::Max(NumViewers, 1);
+	NumUpdates = FMath::Max(NumUpdates, 1);
+
+	for (const int32 BenchmarkResolution : { 256, 1024 })
+	{
+		FLineOfSightVisibilityGrid Grid;
+		Grid.Init(FVector2D::ZeroVector, WorldSize / BenchmarkResolution, BenchmarkResolution);
+
+		FRandomStream Random(BenchmarkResolution);
+		TArray<FVector> ViewerOrigins;
+		TArray<float> ViewerHeadings;
+		for (int32 i = 0; i < NumViewers; ++i)
+		{
+			ViewerOrigins.Add(FVector(Random.FRandRange(0.0f, WorldSize), Random.FRandRange(0.0f, WorldSize), 0.0f));
+			ViewerHeadings.Add(Random.FRandRange(-180.0f, 180.0f));
+		}
+
+		TArray<TArray<FVector>> ViewerPoints;
+		ViewerPoints.SetNum(NumViewers);
+		TArray<int32> DirtyTiles;
+		TArray<uint8> TileData;
+		double RasteriseSeconds = 0.0;
+		double DecaySeconds = 0.0;
+		double CopySeconds = 0.0;
+		int64 TotalDirtyTiles = 0;
+
+		for (int32 Update = 0; Update < NumUpdates; ++Update)
+		{
+			// Every viewer turns and walks a little, with some of its outline occluded.
+			for (int32 i = 0; i < NumViewers; ++i)
+			{
+				ViewerHeadings[i] += 2.0f;
+				const FVector Forward = FVector::ForwardVector.RotateAngleAxis(ViewerHeadings[i], FVector::UpVector);
+				ViewerOrigins[i] += Forward * 20.0f;
+				ViewerOrigins[i].X = FMath::Fmod(ViewerOrigins[i].X + WorldSize, WorldSize);
+				ViewerOrigins[i].Y = FMath::Fmod(ViewerOrigins[i].Y + WorldSize, WorldSize);
+
+				ViewerPoints[i].Reset();
+				for (int32 Point = 0; Point < NumPoints; ++Point)
+				{
+					const float Angle = ViewAngle / 2.0f - Point * ViewAngle / (NumPoints - 1);
+					const float Distance = ViewRadius * (Random.FRand() < 0.2f ? Random.FRandRange(0.3f, 1.0f) : 1.0f);
+					ViewerPoints[i].Add(ViewerOrigins[i] + Forward.RotateAngleAxis(Angle, FVector::UpVector) * Distance);
+				}
+			}
+
+			const double RasteriseStartTime = FPlatformTime::Seconds();
+			Grid.BeginVisibleUpdate();
+			for (int32 i = 0; i < NumViewers; ++i)
+			{
+				Grid.RasteriseFan(ViewerOrigins[i], ViewerPoints[i]);
+			}
+			Grid.EndVisibleUpdate();
+
+			const double DecayStartTime = FPlatformTime::Seconds();
+			Grid.DecayExplored(0.99f);
+
+			const double CopyStartTime = FPlatformTime::Seconds();
+			Grid.ConsumeDirtyTiles(DirtyTiles);
+			TileData.SetNumUninitialized(DirtyTiles.Num() * TileBytes, false);
+			for (int32 i = 0; i < DirtyTiles.Num(); ++i)
+			{
+				Grid.CopyTile(DirtyTiles[i], TileData.GetData() + i * TileBytes);
+			}
+			const double EndTime = FPlatformTime::Seconds();
+
+			RasteriseSeconds += DecayStartTime - RasteriseStartTime;
+			DecaySeconds += CopyStartTime - DecayStartTime;
+			CopySeconds += EndTime - CopyStartTime;
+			TotalDirtyTiles += DirtyTiles.Num();
+		}
+
+		UE_LOG(LogLineOfSight, Display, TEXT("Fog of war %dx%d, %d viewers, %d updates: rasterise %.3f ms, decay %.3f ms, copy %.3f ms (%.1f dirty tiles of %d) per update"),
+			BenchmarkResolution, BenchmarkResolution, NumViewers, NumUpdates, RasteriseSeconds * 1000.0 / NumUpdates, DecaySeconds * 1000.0 / NumUpdates,
+			CopySeconds * 1000.0 / NumUpdates, (double)TotalDirtyTiles / NumUpdates, Grid.TileFlags.Num());
+	}
+}
@@ -0,0 +1,223 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/LineOfSightFogOfWarSubsystem.h"
+#include "Components/LineOfSightVisualiser.h"
+#include "Engine/Texture2D.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "LineOfSightVisualisation.h"
+
+DECLARE_CYCLE_STAT(TEXT("Fog Of War Tick"), STAT_LineOfSightFogOfWarTick, STATGROUP_LineOfSight);
+DECLARE_CYCLE_STAT(TEXT("Fog Of War Rasterise"), STAT_LineOfSightFogOfWarRasterise, STATGROUP_LineOfSight);
+DECLARE_CYCLE_STAT(TEXT("Fog Of War Decay"), STAT_LineOfSightFogOfWarDecay, STATGROUP_LineOfSight);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Fog Of War Tiles Uploaded"), STAT_LineOfSightFogOfWarTilesUploaded, STATGROUP_LineOfSight);
+
+namespace LineOfSightFogOfWar
+{
+	FAutoConsoleCommandWithArgs BenchmarkCommand(
+		TEXT("LineOfSight.BenchmarkFogOfWar"),
+		TEXT("Rasterises moving synthetic viewers into fog of war grids of 256x256 and 1024x1024 cells, and logs the average time of each step.\nLineOfSight.BenchmarkFogOfWar [Viewers = 32] [Updates = 200]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args)
+		{
+			const int32 NumViewers = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 32;
+			const int32 NumUpdates = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 200;
+			FLineOfSightVisibilityGrid::RunBenchmark(NumViewers, NumUpdates);
+		})
+	);
+}
+
+void ULineOfSightFogOfWarSubsystem::Deinitialize()
+{
+	Revealers.Empty();
+	Grid = FLineOfSightVisibilityGrid();
+	FogOfWarTexture = nullptr;
+
+	Super::Deinitialize();
+}
+
+void ULineOfSightFogOfWarSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_LineOfSightFogOfWarTick);
+
+	if (Grid.GetResolution() == 0)
+	{
+		ConfigureGrid(GridOrigin, CellSize, GridResolution);
+	}
+
+	if (UpdateRevealers() || bIsRasterisationRequired)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_LineOfSightFogOfWarRasterise);
+		bIsRasterisationRequired = false;
+
+		Grid.BeginVisibleUpdate();
+		for (const FRevealer& Revealer : Revealers)
+		{
+			if (Revealer.bWasRevealing)
+			{
+				FVector FanOrigin;
+				const TArray<FVector>& Points = Revealer.Visualiser->GetVisualisationPolygon(FanOrigin);
+				if (Points.Num() > 0)
+				{
+					Grid.RasteriseFan(FanOrigin, Points);
+				}
+			}
+		}
+		Grid.EndVisibleUpdate();
+	}
+
+	TimeSinceDecay += DeltaTime;
+	if (ExploredHalfLife > 0.0f && TimeSinceDecay >= ExploredDecayInterval)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_LineOfSightFogOfWarDecay);
+		Grid.DecayExplored(FMath::Pow(0.5f, TimeSinceDecay / ExploredHalfLife));
+		TimeSinceDecay = 0.0f;
+	}
+
+	UploadDirtyTiles();
+}
+
+bool ULineOfSightFogOfWarSubsystem::IsTickable() const
+{
+	// Nothing is allocated until a revealer actually reveals, so worlds whose visualisers never do cost nothing.
+	if (Grid.GetResolution() > 0)
+	{
+		return Revealers.Num() > 0;
+	}
+
+	return Revealers.ContainsByPredicate([](const FRevealer& Revealer) { return Revealer.Visualiser.IsValid() && Revealer.Visualiser->bRevealsFogOfWar; });
+}
+
+ETickableTickType ULineOfSightFogOfWarSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+UWorld* ULineOfSightFogOfWarSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId ULineOfSightFogOfWarSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULineOfSightFogOfWarSubsystem, STATGROUP_Tickables);
+}
+
+void ULineOfSightFogOfWarSubsystem::ConfigureGrid(FVector2D InGridOrigin, float InCellSize, int32 InGridResolution)
+{
+	Grid.Init(InGridOrigin, InCellSize, FMath::Clamp(InGridResolution, 1, 4096));
+	GridOrigin = Grid.GetOrigin();
+	CellSize = Grid.GetCellSize();
+	GridResolution = Grid.GetResolution();
+
+	// A dedicated server draws nothing, so it only keeps the grid for gameplay to look cells up.
+	const UWorld* World = GetWorld();
+	if (World != nullptr && World->GetNetMode() == NM_DedicatedServer)
+	{
+		FogOfWarTexture = nullptr;
+	}
+	else
+	{
+		FogOfWarTexture = UTexture2D::CreateTransient(GridResolution, GridResolution, PF_R8G8);
+		FogOfWarTexture->SRGB = false;
+		FogOfWarTexture->Filter = TextureFilter::TF_Bilinear;
+		FogOfWarTexture->AddressX = TextureAddress::TA_Clamp;
+		FogOfWarTexture->AddressY = TextureAddress::TA_Clamp;
+		FogOfWarTexture->UpdateResource();
+	}
+
+	// Every tile of a new grid is dirty, so the whole texture is uploaded on the next tick.
+	bIsRasterisationRequired = true;
+	TimeSinceDecay = 0.0f;
+}
+
+void ULineOfSightFogOfWarSubsystem::RegisterRevealer(ULineOfSightVisualiser* Revealer)
+{
+	if (Revealer == nullptr || Revealers.ContainsByPredicate([Revealer](const FRevealer& Other) { return Other.Visualiser == Revealer; }))
+	{
+		return;
+	}
+
+	Revealers.AddDefaulted_GetRef().Visualiser = Revealer;
+}
+
+void ULineOfSightFogOfWarSubsystem::UnregisterRevealer(ULineOfSightVisualiser* Revealer)
+{
+	const int32 Index = Revealers.IndexOfByPredicate([Revealer](const FRevealer& Other) { return Other.Visualiser == Revealer; });
+	if (Index != INDEX_NONE)
+	{
+		bIsRasterisationRequired |= Revealers[Index].bWasRevealing;
+		Revealers.RemoveAtSwap(Index, 1, false);
+	}
+}
+
+bool ULineOfSightFogOfWarSubsystem::IsLocationVisible(const FVector& Location) const
+{
+	const int32 CellIndex = Grid.GetCellIndex(Location);
+	return CellIndex != INDEX_NONE && Grid.IsCellVisible(CellIndex);
+}
+
+float ULineOfSightFogOfWarSubsystem::GetLocationExplored(const FVector& Location) const
+{
+	const int32 CellIndex = Grid.GetCellIndex(Location);
+	return CellIndex != INDEX_NONE ? Grid.GetCellExplored(CellIndex) : 0.0f;
+}
+
+bool ULineOfSightFogOfWarSubsystem::IsActorVisible(const AActor* Actor) const
+{
+	return Actor != nullptr && IsLocationVisible(Actor->GetActorLocation());
+}
+
+bool ULineOfSightFogOfWarSubsystem::UpdateRevealers()
+{
+	bool bHasChanged = false;
+	for (int32 i = Revealers.Num() - 1; i >= 0; --i)
+	{
+		FRevealer& Revealer = Revealers[i];
+		const ULineOfSightVisualiser* Visualiser = Revealer.Visualiser.Get();
+		if (Visualiser == nullptr)
+		{
+			bHasChanged |= Revealer.bWasRevealing;
+			Revealers.RemoveAtSwap(i, 1, false);
+			continue;
+		}
+
+		const bool bIsRevealing = Visualiser->bRevealsFogOfWar;
+		if (bIsRevealing != Revealer.bWasRevealing || (bIsRevealing && Visualiser->GetPolygonVersion() != Revealer.PolygonVersion))
+		{
+			bHasChanged = true;
+		}
+		Revealer.bWasRevealing = bIsRevealing;
+		Revealer.PolygonVersion = Visualiser->GetPolygonVersion();
+	}
+
+	return bHasChanged;
+}
+
+void ULineOfSightFogOfWarSubsystem::UploadDirtyTiles()
+{
+	Grid.ConsumeDirtyTiles(DirtyTilesScratch);
+	if (DirtyTilesScratch.Num() == 0 || FogOfWarTexture == nullptr)
+	{
+		return;
+	}
+	INC_DWORD_STAT_BY(STAT_LineOfSightFogOfWarTilesUploaded, DirtyTilesScratch.Num());
+
+	// Tiles are packed one below the other, and freed by the render thread once it has copied them.
+	const int32 TileSize = FLineOfSightVisibilityGrid::TileSize;
+	const int32 TileResolution = Grid.GetTileResolution();
+	uint8* TileData = (uint8*)FMemory::Malloc(DirtyTilesScratch.Num() * FLineOfSightVisibilityGrid::TileBytes);
+	FUpdateTextureRegion2D* Regions = new FUpdateTextureRegion2D[DirtyTilesScratch.Num()];
+	for (int32 i = 0; i < DirtyTilesScratch.Num(); ++i)
+	{
+		const int32 TileIndex = DirtyTilesScratch[i];
+		Grid.CopyTile(TileIndex, TileData + i * FLineOfSightVisibilityGrid::TileBytes);
+		Regions[i] = FUpdateTextureRegion2D((TileIndex % TileResolution) * TileSize, (TileIndex / TileResolution) * TileSize, 0, i * TileSize, TileSize, TileSize);
+	}
+
+	FogOfWarTexture->UpdateTextureRegions(0, DirtyTilesScratch.Num(), Regions, TileSize * 2, 2, TileData, [](uint8* SrcData, const FUpdateTextureRegion2D* SrcRegions)
+	{
+		FMemory::Free(SrcData);
+		delete[] SrcRegions;
+	});
+}
@@ -0,0 +1,750 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/LineOfSightSubsystem.h"
+#include "Async/ParallelFor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/Pawn.h"
+#include "Kismet/GameplayStatics.h"
+#include "LineOfSightVisualisation.h"
+#include "PhysicsEngine/BodySetup.h"
+
+DECLARE_CYCLE_STAT(TEXT("Static Occluder Extraction"), STAT_LineOfSightStaticOccluderExtraction, STATGROUP_LineOfSight);
+DECLARE_CYCLE_STAT(TEXT("Gather Occluders"), STAT_LineOfSightGatherOccluders, STATGROUP_LineOfSight);
+DECLARE_CYCLE_STAT(TEXT("Visibility Service Tick"), STAT_LineOfSightServiceTick, STATGROUP_LineOfSight);
+DECLARE_CYCLE_STAT(TEXT("Visibility Service Solve"), STAT_LineOfSightServiceSolve, STATGROUP_LineOfSight);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Viewers Solved"), STAT_LineOfSightViewersSolved, STATGROUP_LineOfSight);
+
+float FLineOfSightViewerResult::GetVisibleDistance(const FVector2D& Direction, int32 SegmentIndex) const
+{
+	if (SegmentIndex == INDEX_NONE)
+	{
+		return Radius;
+	}
+
+	// Directions along an edge may miss its segment by a rounding error, in which case the nearer end of it is used.
+	const FLineOfSightSegment& Segment = Segments[SegmentIndex];
+	float Distance = 0.0f;
+	if (!FLineOfSightVisibilitySolver::IntersectRay(FVector2D(Origin), Direction, Segment, Distance))
+	{
+		Distance = FMath::Min(FVector2D::Distance(FVector2D(Origin), Segment.Start), FVector2D::Distance(FVector2D(Origin), Segment.End));
+	}
+
+	return FMath::Min(Distance, Radius);
+}
+
+int32 FLineOfSightViewerResult::FindInterval(float Angle) const
+{
+	if (Intervals.Num() == 0 || Angle < -HalfAngle || Angle > HalfAngle)
+	{
+		return INDEX_NONE;
+	}
+
+	// The last interval starting at or before the angle.
+	int32 Low = 0;
+	int32 High = Intervals.Num() - 1;
+	while (Low < High)
+	{
+		const int32 Middle = (Low + High + 1) / 2;
+		if (Intervals[Middle].StartAngle <= Angle)
+		{
+			Low = Middle;
+		}
+		else
+		{
+			High = Middle - 1;
+		}
+	}
+
+	return Low;
+}
+
+bool FLineOfSightViewerResult::IsPointVisible(const FVector& Point) const
+{
+	if (Version == 0)
+	{
+		return false;
+	}
+
+	const FVector2D Offset = FVector2D(Point) - FVector2D(Origin);
+	const float Distance = Offset.Size();
+	if (Distance > Radius)
+	{
+		return false;
+	}
+	if (Distance <= KINDA_SMALL_NUMBER)
+	{
+		return true;
+	}
+
+	const FVector2D Direction = Offset / Distance;
+	const int32 IntervalIndex = FindInterval(FLineOfSightVisibilitySolver::GetAngle(Forward, Direction));
+	return IntervalIndex != INDEX_NONE && Distance <= GetVisibleDistance(Direction, Intervals[IntervalIndex].SegmentIndex);
+}
+
+void ULineOfSightSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &ULineOfSightSubsystem::OnLevelsChanged);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &ULineOfSightSubsystem::OnLevelsChanged);
+
+	if (UWorld* World = GetWorld())
+	{
+		ActorSpawnedHandle = World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &ULineOfSightSubsystem::OnActorSpawned));
+	}
+}
+
+void ULineOfSightSubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+	if (UWorld* World = GetWorld())
+	{
+		World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	}
+	StaticOccluders.Empty();
+	DynamicOccluders.Empty();
+	UnslicedOccluders.Empty();
+	Viewers.Empty();
+	ViewerIndices.Empty();
+
+	Super::Deinitialize();
+}
+
+void ULineOfSightSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_LineOfSightServiceTick);
+
+	UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	const double Now = World->GetTimeSeconds();
+	const APawn* Player = UGameplayStatics::GetPlayerPawn(World, 0);
+	const FVector PlayerLocation = Player != nullptr ? Player->GetActorLocation() : FVector::ZeroVector;
+
+	for (int32 i = Viewers.Num() - 1; i >= 0; --i)
+	{
+		if (!Viewers[i].Visualiser.IsValid())
+		{
+			RemoveViewer(Viewers[i].Visualiser);
+		}
+	}
+
+	// Everything touching the world (overlaps, slicing movable occluders, building static occluders) is done on the game thread.
+	const uint32 OccluderVersion = GetDynamicOccluderVersion();
+	ViewersToSolveScratch.Reset();
+	for (int32 i = 0; i < Viewers.Num(); ++i)
+	{
+		FViewer& Viewer = Viewers[i];
+		const ULineOfSightVisualiser* Visualiser = Viewer.Visualiser.Get();
+
+		FLineOfSightViewParameters Parameters;
+		if (Now < Viewer.NextUpdateTime || !Visualiser->GetViewParameters(Parameters))
+		{
+			continue;
+		}
+		Viewer.NextUpdateTime = Now + GetViewerUpdateInterval(Parameters.Origin, PlayerLocation, Player != nullptr);
+
+		GetStaticOccluders(Parameters.Origin.Z, Parameters.Channel);
+
+		// Nothing in the world could have changed the view, so there is no need to look for nearby movable occluders either.
+		if (Viewer.Result.Version > 0 && OccluderVersion == Viewer.DynamicOccluderVersion && Parameters.Equals(Viewer.Parameters))
+		{
+			continue;
+		}
+
+		const FCollisionQueryParams QueryParams(FName("LoS Occluders"), false, Parameters.Owner);
+		const uint32 OccluderSignature = FindMovableOccluders(Parameters.Origin, Parameters.Radius, Parameters.Channel, QueryParams, MovableOccludersScratch);
+		Viewer.DynamicOccluderVersion = OccluderVersion;
+		if (Viewer.Result.Version > 0 && OccluderSignature == Viewer.OccluderSignature && Parameters.Equals(Viewer.Parameters))
+		{
+			continue;
+		}
+
+		Viewer.Parameters = Parameters;
+		Viewer.OccluderSignature = OccluderSignature;
+		Viewer.MovableSegments.Reset();
+		for (const UPrimitiveComponent* Component : MovableOccludersScratch)
+		{
+			if (!SliceComponent(Component, Parameters.Origin.Z, Viewer.MovableSegments))
+			{
+				WarnUnslicedOccluder(Component);
+			}
+		}
+
+		ViewersToSolveScratch.Add(i);
+	}
+
+	SolvedViewerCount = ViewersToSolveScratch.Num();
+	INC_DWORD_STAT_BY(STAT_LineOfSightViewersSolved, SolvedViewerCount);
+
+	SCOPE_CYCLE_COUNTER(STAT_LineOfSightServiceSolve);
+	ParallelFor(ViewersToSolveScratch.Num(), [this](int32 i)
+	{
+		SolveViewer(Viewers[ViewersToSolveScratch[i]]);
+	});
+}
+
+bool ULineOfSightSubsystem::IsTickable() const
+{
+	return Viewers.Num() > 0;
+}
+
+ETickableTickType ULineOfSightSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+UWorld* ULineOfSightSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId ULineOfSightSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULineOfSightSubsystem, STATGROUP_Tickables);
+}
+
+void ULineOfSightSubsystem::RegisterViewer(ULineOfSightVisualiser* Viewer)
+{
+	if (Viewer == nullptr || ViewerIndices.Contains(Viewer))
+	{
+		return;
+	}
+
+	ViewerIndices.Add(Viewer, Viewers.Num());
+	Viewers.AddDefaulted_GetRef().Visualiser = Viewer;
+}
+
+void ULineOfSightSubsystem::UnregisterViewer(ULineOfSightVisualiser* Viewer)
+{
+	RemoveViewer(Viewer);
+}
+
+const FLineOfSightViewerResult* ULineOfSightSubsystem::GetViewerResult(const ULineOfSightVisualiser* Viewer) const
+{
+	const int32* Index = ViewerIndices.Find(const_cast<ULineOfSightVisualiser*>(Viewer));
+	return Index != nullptr && Viewers[*Index].Result.Version > 0 ? &Viewers[*Index].Result : nullptr;
+}
+
+bool ULineOfSightSubsystem::IsPointVisibleFromViewer(const ULineOfSightVisualiser* Viewer, const FVector& Point) const
+{
+	const FLineOfSightViewerResult* Result = GetViewerResult(Viewer);
+	return Result != nullptr && Result->IsPointVisible(Point);
+}
+
+bool ULineOfSightSubsystem::IsActorVisibleFromViewer(const ULineOfSightVisualiser* Viewer, const AActor* Actor) const
+{
+	const FLineOfSightViewerResult* Result = GetViewerResult(Viewer);
+	if (Result == nullptr || Actor == nullptr)
+	{
+		return false;
+	}
+
+	const FVector Location = Actor->GetActorLocation();
+	if (Result->IsPointVisible(Location))
+	{
+		return true;
+	}
+
+	FVector BoundsOrigin;
+	FVector BoundsExtent;
+	Actor->GetActorBounds(true, BoundsOrigin, BoundsExtent);
+	return Result->IsPointVisible(BoundsOrigin + FVector(BoundsExtent.X, 0.0f, 0.0f)) || Result->IsPointVisible(BoundsOrigin - FVector(BoundsExtent.X, 0.0f, 0.0f))
+		|| Result->IsPointVisible(BoundsOrigin + FVector(0.0f, BoundsExtent.Y, 0.0f)) || Result->IsPointVisible(BoundsOrigin - FVector(0.0f, BoundsExtent.Y, 0.0f));
+}
+
+void ULineOfSightSubsystem::GetViewersOfActor(const AActor* Actor, TArray<ULineOfSightVisualiser*>& OutViewers) const
+{
+	OutViewers.Reset();
+	for (const FViewer& Viewer : Viewers)
+	{
+		ULineOfSightVisualiser* Visualiser = Viewer.Visualiser.Get();
+		if (Visualiser != nullptr && Visualiser->GetOwner() != Actor && IsActorVisibleFromViewer(Visualiser, Actor))
+		{
+			OutViewers.Add(Visualiser);
+		}
+	}
+}
+
+void ULineOfSightSubsystem::GatherOccluders(const FVector& Origin, float Radius, ECollisionChannel Channel, const FCollisionQueryParams& QueryParams, TArray<FLineOfSightSegment>& OutSegments)
+{
+	SCOPE_CYCLE_COUNTER(STAT_LineOfSightGatherOccluders);
+
+	OutSegments.Reset();
+	UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	const FLineOfSightSegmentBVH& Static = GetStaticOccluders(Origin.Z, Channel);
+	SegmentIndicesScratch.Reset();
+	Static.QueryCircle(FVector2D(Origin), Radius, SegmentIndicesScratch);
+	for (int32 SegmentIndex : SegmentIndicesScratch)
+	{
+		OutSegments.Add(Static.GetSegments()[SegmentIndex]);
+	}
+
+	// Movable occluders are sliced where they are now, at the exact height of the origin.
+	const int32 StaticSegmentCount = OutSegments.Num();
+	FindMovableOccluders(Origin, Radius, Channel, QueryParams, MovableOccludersScratch);
+	for (const UPrimitiveComponent* Component : MovableOccludersScratch)
+	{
+		if (!SliceComponent(Component, Origin.Z, OutSegments))
+		{
+			WarnUnslicedOccluder(Component);
+		}
+	}
+
+	if (OutSegments.Num() > StaticSegmentCount)
+	{
+		FLineOfSightVisibilitySolver::SplitAtIntersections(OutSegments);
+	}
+}
+
+uint32 ULineOfSightSubsystem::GetOccluderSignature(const FVector& Origin, float Radius, ECollisionChannel Channel, const FCollisionQueryParams& QueryParams)
+{
+	return FindMovableOccluders(Origin, Radius, Channel, QueryParams, MovableOccludersScratch);
+}
+
+uint32 ULineOfSightSubsystem::GetDynamicOccluderVersion()
+{
+	UpdateDynamicOccluders();
+	return DynamicOccluderVersion;
+}
+
+void ULineOfSightSubsystem::InvalidateStaticOccluders()
+{
+	StaticOccluders.Empty();
+	++StaticOccluderVersion;
+
+	// Occluder signatures include the static version.
+	++DynamicOccluderVersion;
+}
+
+int32 ULineOfSightSubsystem::GetStaticSegmentCount() const
+{
+	int32 SegmentCount = 0;
+	for (const auto& Pair : StaticOccluders)
+	{
+		SegmentCount += Pair.Value.Num();
+	}
+
+	return SegmentCount;
+}
+
+bool ULineOfSightSubsystem::SliceComponent(const UPrimitiveComponent* Component, float Height, TArray<FLineOfSightSegment>& OutSegments)
+{
+	const FBox Bounds = Component->Bounds.GetBox();
+	if (Height < Bounds.Min.Z || Height > Bounds.Max.Z)
+	{
+		return true;
+	}
+
+	const UInstancedStaticMeshComponent* InstancedComponent = Cast<UInstancedStaticMeshComponent>(Component);
+	const UBodySetup* BodySetup = InstancedComponent != nullptr ? (InstancedComponent->GetStaticMesh() != nullptr ? InstancedComponent->GetStaticMesh()->BodySetup : nullptr)
+		: const_cast<UPrimitiveComponent*>(Component)->GetBodySetup();
+
+	// Queries against these use triangle meshes or heightfields, which are not sliced.
+	if (BodySetup == nullptr || BodySetup->AggGeom.GetElementCount() == 0 || BodySetup->GetCollisionTraceFlag() == ECollisionTraceFlag::CTF_UseComplexAsSimple)
+	{
+		return false;
+	}
+
+	if (InstancedComponent != nullptr)
+	{
+		for (int32 i = 0; i < InstancedComponent->GetInstanceCount(); ++i)
+		{
+			FTransform InstanceTransform;
+			if (InstancedComponent->GetInstanceTransform(i, InstanceTransform, true))
+			{
+				SliceBodySetup(BodySetup, InstanceTransform, Height, OutSegments);
+			}
+		}
+		return true;
+	}
+
+	SliceBodySetup(BodySetup, Component->GetComponentTransform(), Height, OutSegments);
+	return true;
+}
+
+const FLineOfSightSegmentBVH& ULineOfSightSubsystem::GetStaticOccluders(float Height, ECollisionChannel Channel)
+{
+	const FIntPoint Key = GetSliceKey(Height, Channel);
+	if (const FLineOfSightSegmentBVH* Cached = StaticOccluders.Find(Key))
+	{
+		return *Cached;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_LineOfSightStaticOccluderExtraction);
+
+	const float SliceHeight = Key.X * SliceHeightTolerance;
+	TArray<FLineOfSightSegment> Segments;
+	TArray<UPrimitiveComponent*> Components;
+
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		Components.Reset();
+		It->GetComponents<UPrimitiveComponent>(Components);
+
+		for (UPrimitiveComponent* Component : Components)
+		{
+			// Stationary components cannot move either, so they are cached with the static ones.
+			if (Component->Mobility != EComponentMobility::Movable && IsOccluder(Component, Channel))
+			{
+				if (!SliceComponent(Component, SliceHeight, Segments))
+				{
+					WarnUnslicedOccluder(Component);
+				}
+			}
+		}
+	}
+
+	// Overlapping shapes cross each other, and the visibility sweep needs segments which only meet at endpoints.
+	FLineOfSightVisibilitySolver::SplitAtIntersections(Segments);
+
+	FLineOfSightSegmentBVH& Occluders = StaticOccluders.Add(Key);
+	Occluders.Build(MoveTemp(Segments));
+	return Occluders;
+}
+
+void ULineOfSightSubsystem::SolveViewer(FViewer& Viewer) const
+{
+	const FLineOfSightViewParameters& Parameters = Viewer.Parameters;
+	FLineOfSightViewerResult& Result = Viewer.Result;
+	Result.Origin = Parameters.Origin;
+	Result.Forward = Parameters.Forward;
+	Result.Radius = Parameters.Radius;
+	Result.HalfAngle = Parameters.HalfAngle;
+	Result.Segments.Reset();
+
+	if (const FLineOfSightSegmentBVH* Static = StaticOccluders.Find(GetSliceKey(Parameters.Origin.Z, Parameters.Channel)))
+	{
+		Viewer.SegmentIndices.Reset();
+		Static->QueryCircle(FVector2D(Parameters.Origin), Parameters.Radius, Viewer.SegmentIndices);
+		for (int32 SegmentIndex : Viewer.SegmentIndices)
+		{
+			Result.Segments.Add(Static->GetSegments()[SegmentIndex]);
+		}
+	}
+
+	if (Viewer.MovableSegments.Num() > 0)
+	{
+		Result.Segments.Append(Viewer.MovableSegments);
+		FLineOfSightVisibilitySolver::SplitAtIntersections(Result.Segments);
+	}
+
+	Viewer.Solver.Solve(FVector2D(Parameters.Origin), Parameters.Forward, -Parameters.HalfAngle, Parameters.HalfAngle, Result.Segments, Result.Intervals);
+	++Result.Version;
+}
+
+float ULineOfSightSubsystem::GetViewerUpdateInterval(const FVector& Origin, const FVector& PlayerLocation, bool bHasPlayer) const
+{
+	if (!bHasPlayer || MinimalRateDistance <= FullRateDistance)
+	{
+		return 0.0f;
+	}
+
+	const float Alpha = (FVector::Dist(Origin, PlayerLocation) - FullRateDistance) / (MinimalRateDistance - FullRateDistance);
+	return Alpha > 0.0f ? FMath::Min(Alpha, 1.0f) * MaxUpdateInterval : 0.0f;
+}
+
+uint32 ULineOfSightSubsystem::FindMovableOccluders(const FVector& Origin, float Radius, ECollisionChannel Channel, const FCollisionQueryParams& QueryParams, TArray<const UPrimitiveComponent*>& OutComponents)
+{
+	OutComponents.Reset();
+	uint32 Signature = HashCombine(StaticOccluderVersion, (uint32)Channel);
+
+	UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return Signature;
+	}
+
+	OverlapsScratch.Reset();
+	World->OverlapMultiByChannel(OverlapsScratch, Origin, FQuat::Identity, Channel, FCollisionShape::MakeSphere(Radius), QueryParams);
+
+	// Summed rather than combined in order, as overlaps are not returned in a stable order.
+	for (const FOverlapResult& Overlap : OverlapsScratch)
+	{
+		const UPrimitiveComponent* Component = Overlap.GetComponent();
+		if (Component != nullptr && Component->Mobility == EComponentMobility::Movable && IsOccluder(Component, Channel))
+		{
+			Signature += HashCombine(GetTypeHash(Component), GetPlacementHash(Component));
+			OutComponents.Add(Component);
+		}
+	}
+
+	return Signature;
+}
+
+void ULineOfSightSubsystem::UpdateDynamicOccluders()
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr || DynamicOccludersCheckedFrame == GFrameCounter)
+	{
+		return;
+	}
+	DynamicOccludersCheckedFrame = GFrameCounter;
+
+	if (!bHasFoundDynamicOccluders)
+	{
+		for (TActorIterator<AActor> It(World); It; ++It)
+		{
+			AddDynamicOccluders(*It);
+		}
+		bHasFoundDynamicOccluders = true;
+		++DynamicOccluderVersion;
+		return;
+	}
+
+	// Collision is hashed too, as enabling or disabling it makes a component appear or disappear as an occluder.
+	bool bHasChanged = false;
+	for (int32 i = DynamicOccluders.Num() - 1; i >= 0; --i)
+	{
+		const UPrimitiveComponent* Component = DynamicOccluders[i].Component.Get();
+		if (Component == nullptr || Component->Mobility != EComponentMobility::Movable)
+		{
+			DynamicOccluders.RemoveAtSwap(i, 1, false);
+			bHasChanged = true;
+			continue;
+		}
+
+		const uint32 StateHash = HashCombine(GetPlacementHash(Component), HashCombine((uint32)Component->GetCollisionEnabled(), (uint32)Component->IsRegistered()));
+		if (StateHash != DynamicOccluders[i].StateHash)
+		{
+			DynamicOccluders[i].StateHash = StateHash;
+			bHasChanged = true;
+		}
+	}
+
+	if (bHasChanged)
+	{
+		++DynamicOccluderVersion;
+	}
+}
+
+void ULineOfSightSubsystem::AddDynamicOccluders(const AActor* Actor)
+{
+	TArray<const UPrimitiveComponent*, TInlineAllocator<8>> Components;
+	Actor->GetComponents<const UPrimitiveComponent>(Components);
+	for (const UPrimitiveComponent* Component : Components)
+	{
+		if (Component->Mobility == EComponentMobility::Movable)
+		{
+			FDynamicOccluder& Occluder = DynamicOccluders.AddDefaulted_GetRef();
+			Occluder.Component = Component;
+			Occluder.StateHash = HashCombine(GetPlacementHash(Component), HashCombine((uint32)Component->GetCollisionEnabled(), (uint32)Component->IsRegistered()));
+		}
+	}
+}
+
+void ULineOfSightSubsystem::OnActorSpawned(AActor* Actor)
+{
+	// Actors spawned before the first search are found by it.
+	if (bHasFoundDynamicOccluders && Actor != nullptr)
+	{
+		AddDynamicOccluders(Actor);
+		++DynamicOccluderVersion;
+	}
+}
+
+uint32 ULineOfSightSubsystem::GetPlacementHash(const UPrimitiveComponent* Component)
+{
+	const FQuat Rotation = Component->GetComponentQuat();
+	return HashCombine(GetTypeHash(Component->GetComponentLocation()), HashCombine(FCrc::MemCrc32(&Rotation, sizeof(FQuat)), GetTypeHash(Component->GetComponentScale())));
+}
+
+void ULineOfSightSubsystem::RemoveViewer(const TWeakObjectPtr<ULineOfSightVisualiser>& Viewer)
+{
+	int32 Index = INDEX_NONE;
+	if (!ViewerIndices.RemoveAndCopyValue(Viewer, Index))
+	{
+		return;
+	}
+
+	Viewers.RemoveAtSwap(Index, 1, false);
+
+	// The last viewer was moved into the removed one's place.
+	if (Viewers.IsValidIndex(Index))
+	{
+		ViewerIndices.Add(Viewers[Index].Visualiser, Index);
+	}
+}
+
+FIntPoint ULineOfSightSubsystem::GetSliceKey(float Height, ECollisionChannel Channel)
+{
+	return FIntPoint(FMath::RoundToInt(Height / SliceHeightTolerance), (int32)Channel);
+}
+
+void ULineOfSightSubsystem::OnLevelsChanged(ULevel* Level, UWorld* World)
+{
+	if (World == GetWorld())
+	{
+		InvalidateStaticOccluders();
+
+		// Movable components of the level are searched for again.
+		DynamicOccluders.Reset();
+		bHasFoundDynamicOccluders = false;
+	}
+}
+
+void ULineOfSightSubsystem::WarnUnslicedOccluder(const UPrimitiveComponent* Component)
+{
+	bool bIsAlreadyWarned = false;
+	UnslicedOccluders.Add(Component, &bIsAlreadyWarned);
+	if (!bIsAlreadyWarned)
+	{
+		UE_LOG(LogLineOfSight, Warning, TEXT("%s only has complex collision, so it does not occlude line of sight solved against occluder geometry. Add simple collision to it, or trace instead."),
+			*Component->GetPathName());
+	}
+}
+
+bool ULineOfSightSubsystem::IsOccluder(const UPrimitiveComponent* Component, ECollisionChannel Channel)
+{
+	return CollisionEnabledHasQuery(Component->GetCollisionEnabled()) && Component->GetCollisionResponseToChannel(Channel) == ECollisionResponse::ECR_Block;
+}
+
+void ULineOfSightSubsystem::SliceBodySetup(const UBodySetup* BodySetup, const FTransform& Transform, float Height, TArray<FLineOfSightSegment>& OutSegments)
+{
+	if (BodySetup == nullptr)
+	{
+		return;
+	}
+
+	const FKAggregateGeom& AggGeom = BodySetup->AggGeom;
+	const float MaxScale = Transform.GetMaximumAxisScale();
+	TArray<FVector> HullPoints;
+
+	for (const FKBoxElem& Box : AggGeom.BoxElems)
+	{
+		const FTransform BoxTransform = Box.GetTransform() * Transform;
+		HullPoints.Reset();
+		for (int32 Corner = 0; Corner < 8; ++Corner)
+		{
+			const FVector LocalCorner(Corner & 1 ? Box.X : -Box.X, Corner & 2 ? Box.Y : -Box.Y, Corner & 4 ? Box.Z : -Box.Z);
+			HullPoints.Add(BoxTransform.TransformPosition(LocalCorner * 0.5f));
+		}
+		SliceConvex(HullPoints, Height, OutSegments);
+	}
+
+	// A slice through a sphere is a circle, approximated by a polygon.
+	for (const FKSphereElem& Sphere : AggGeom.SphereElems)
+	{
+		const FVector Center = Transform.TransformPosition(Sphere.Center);
+		const float Radius = Sphere.Radius * MaxScale;
+		const float HeightOffset = Height - Center.Z;
+		if (FMath::Abs(HeightOffset) >= Radius)
+		{
+			continue;
+		}
+
+		const float SliceRadius = FMath::Sqrt((Radius * Radius) - (HeightOffset * HeightOffset));
+		const int32 SideCount = 16;
+		FVector2D PreviousPoint = FVector2D(Center) + FVector2D(SliceRadius, 0.0f);
+		for (int32 Side = 1; Side <= SideCount; ++Side)
+		{
+			const FVector2D Point = FVector2D(Center) + FLineOfSightVisibilitySolver::RotateDirection(FVector2D(SliceRadius, 0.0f), (360.0f * Side) / SideCount);
+			OutSegments.Add(FLineOfSightSegment(PreviousPoint, Point));
+			PreviousPoint = Point;
+		}
+	}
+
+	// Capsules are sampled as rings around both end spheres, which bound them as a convex hull.
+	for (const FKSphylElem& Sphyl : AggGeom.SphylElems)
+	{
+		const FTransform SphylTransform = Sphyl.GetTransform() * Transform;
+		HullPoints.Reset();
+		for (float EndOffset : { -0.5f * Sphyl.Length, 0.5f * Sphyl.Length })
+		{
+			HullPoints.Add(SphylTransform.TransformPosition(FVector(0.0f, 0.0f, EndOffset + (EndOffset < 0.0f ? -Sphyl.Radius : Sphyl.Radius))));
+			for (float Latitude : { -45.0f, 0.0f, 45.0f })
+			{
+				const float RingRadius = Sphyl.Radius * FMath::Cos(FMath::DegreesToRadians(Latitude));
+				const float RingOffset = EndOffset + (Sphyl.Radius * FMath::Sin(FMath::DegreesToRadians(Latitude)));
+				for (int32 Side = 0; Side < 8; ++Side)
+				{
+					const FVector2D RingPoint = FLineOfSightVisibilitySolver::RotateDirection(FVector2D(RingRadius, 0.0f), 45.0f * Side);
+					HullPoints.Add(SphylTransform.TransformPosition(FVector(RingPoint.X, RingPoint.Y, RingOffset)));
+				}
+			}
+		}
+		SliceConvex(HullPoints, Height, OutSegments);
+	}
+
+	for (const FKConvexElem& Convex : AggGeom.ConvexElems)
+	{
+		const FTransform ConvexTransform = Convex.GetTransform() * Transform;
+		HullPoints.Reset();
+		for (const FVector& Vertex : Convex.VertexData)
+		{
+			HullPoints.Add(ConvexTransform.TransformPosition(Vertex));
+		}
+		SliceConvex(HullPoints, Height, OutSegments);
+	}
+}
+
+void ULineOfSightSubsystem::SliceConvex(const TArray<FVector>& HullPoints, float Height, TArray<FLineOfSightSegment>& OutSegments)
+{
+	// Every line between two hull points crossing the plane meets it inside the slice, and the hull edges among them meet it
+	// on the outline, so the outline is the 2D convex hull of all of these crossings.
+	TArray<FVector2D, TInlineAllocator<64>> Crossings;
+	for (int32 i = 0; i < HullPoints.Num(); ++i)
+	{
+		const FVector& A = HullPoints[i];
+		for (int32 j = i + 1; j < HullPoints.Num(); ++j)
+		{
+			const FVector& B = HullPoints[j];
+			if ((A.Z - Height) * (B.Z - Height) > 0.0f || A.Z == B.Z)
+			{
+				continue;
+			}
+
+			const float Alpha = (Height - A.Z) / (B.Z - A.Z);
+			Crossings.Add(FVector2D(FMath::Lerp(A, B, Alpha)));
+		}
+	}
+
+	if (Crossings.Num() < 3)
+	{
+		return;
+	}
+
+	// Andrew's monotone chain.
+	Crossings.Sort([](const FVector2D& A, const FVector2D& B)
+	{
+		return A.X != B.X ? A.X < B.X : A.Y < B.Y;
+	});
+
+	TArray<FVector2D, TInlineAllocator<64>> Hull;
+	for (int32 Pass = 0; Pass < 2; ++Pass)
+	{
+		const int32 PassStart = Hull.Num();
+		for (int32 i = 0; i < Crossings.Num(); ++i)
+		{
+			const FVector2D& Point = Crossings[Pass == 0 ? i : Crossings.Num() - 1 - i];
+			while (Hull.Num() >= PassStart + 2 && FVector2D::CrossProduct(Hull.Last() - Hull.Last(1), Point - Hull.Last(1)) <= KINDA_SMALL_NUMBER)
+			{
+				Hull.Pop(false);
+			}
+			Hull.Add(Point);
+		}
+		Hull.Pop(false);
+	}
+
+	if (Hull.Num() < 3)
+	{
+		return;
+	}
+
+	for (int32 i = 0; i < Hull.Num(); ++i)
+	{
+		OutSegments.Add(FLineOfSightSegment(Hull[i], Hull[(i + 1) % Hull.Num()]));
+	}
+}
@@ -5,8 +5,11 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "Interfaces/VisibilityScalingInterface.h"
+#include "WorldCollision.h"
 #include "LineOfSightVisualiser.generated.h"
 
+struct FLineOfSightViewerResult;
+
 UENUM(BlueprintType)
 enum class EVisualisation : uint8
 {
@@ -14,6 +17,77 @@ enum class EVisualisation : uint8
 	Full       UMETA(DisplayName = "Full")
 };
 
+/* The state of the owner and its surroundings a visualisation is built from. If it is unchanged, so is the visualisation. */
+struct FLineOfSightViewState
+{
+	FVector Origin = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	float Radius = 0.0f;
+
+	/* See ULineOfSightSubsystem::GetOccluderSignature. Only valid if bHasOccluderSignature. */
+	uint32 OccluderSignature = 0;
+	bool bHasOccluderSignature = false;
+
+	/**
+	 * Whether two states would produce the same visualisation, ignoring differences too small to be seen.
+	 * @param Other - The state to compare to.
+	 * @return Whether the states are equal. Never true if either has no occluder signature.
+	 */
+	bool Equals(const FLineOfSightViewState& Other) const
+	{
+		return bHasOccluderSignature && Other.bHasOccluderSignature && OccluderSignature == Other.OccluderSignature
+			&& Origin.Equals(Other.Origin, 0.1f) && Rotation.Equals(Other.Rotation, 1.e-4f) && FMath::IsNearlyEqual(Radius, Other.Radius, 0.1f);
+	}
+};
+
+/* Where a visualiser sees from, as solved by ULineOfSightSubsystem. */
+struct FLineOfSightViewParameters
+{
+	FVector Origin = FVector::ZeroVector;
+	FVector2D Forward = FVector2D(1.0f, 0.0f);
+	float Radius = 0.0f;
+	float HalfAngle = 0.0f;
+	ECollisionChannel Channel = ECollisionChannel::ECC_Visibility;
+
+	/* Ignored by occluder queries. Only valid for the frame the parameters were retrieved in. */
+	const AActor* Owner = nullptr;
+
+	/**
+	 * Whether two sets of parameters would be solved to the same result, ignoring differences too small to be seen.
+	 * @param Other - The parameters to compare to.
+	 * @return Whether the parameters are equal.
+	 */
+	bool Equals(const FLineOfSightViewParameters& Other) const
+	{
+		return Channel == Other.Channel && Owner == Other.Owner && Origin.Equals(Other.Origin, 0.1f) && Forward.Equals(Other.Forward, 1.e-4f)
+			&& FMath::IsNearlyEqual(Radius, Other.Radius, 0.1f) && FMath::IsNearlyEqual(HalfAngle, Other.HalfAngle);
+	}
+};
+
+/* A set of asynchronous line traces submitted in the same frame, and the state of the owner they were traced from. */
+struct FLineOfSightTraceBatch
+{
+	/* Location, axes and vision radius the traces were made with. */
+	FVector Origin;
+	FVector Forward;
+	FVector Up;
+	float Radius;
+
+	/* Angle and handle of every trace. Fan traces come first, followed by the refinement traces of each refined interval. */
+	TArray<float> Angles;
+	TArray<FTraceHandle> Handles;
+	int32 FanTraceCount;
+
+	/* Fan intervals refined by this batch in ascending order, each given as the index of the fan trace ending it. */
+	TArray<int32> RefinedIntervals;
+
+	/* The view state when the batch was submitted. Only set if updates of unchanged views are skipped. */
+	FLineOfSightViewState ViewState;
+
+	/* Whether the batch has been submitted and not consumed yet. */
+	bool bIsPending = false;
+};
+
 UCLASS( ClassGroup=(LineOfSightVisualisation), meta=(BlueprintSpawnableComponent) )
 class LINEOFSIGHTVISUALISATION_API ULineOfSightVisualiser : public UActorComponent, public IVisibilityScalingInterface
 {
@@ -58,6 +132,29 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Visualisation Configuration")
 	EVisualisation VisualisationType;
 
+	/* Whether traces are submitted as asynchronous batches and consumed on the next frame, rather than traced on the game thread.
+	The mesh lags one frame behind, but the game thread never waits for traces. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Visualisation Configuration")
+	bool bUseAsyncTraces;
+
+	/* Whether the visualisation is solved exactly against occluder geometry sliced at the owner's height, rather than traced.
+	ULineOfSightSubsystem solves every such visualiser together once per frame, and answers gameplay visibility queries from
+	the same results. Static geometry is sliced once per level and needs no traces. Assumes the owner's up axis is world up.
+	Only simple collision is sliced: components with only complex collision (meshes using complex collision as simple, BSP,
+	landscape) are seen through, both by the mesh and by visibility queries, and a warning naming each is logged. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Visualisation Configuration")
+	bool bUseOccluderGeometry;
+
+	/* Whether updates are skipped while the owner's transform, the vision radius and every nearby movable occluder are unchanged.
+	Asynchronous traces stop once the edges they found have been refined. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Visualisation Configuration")
+	bool bSkipUnchangedUpdates;
+
+	/* Whether the visualisation reveals the fog of war of ULineOfSightFogOfWarSubsystem. Set it on every visualiser of the player's
+	side, so the area they see together is rasterised into one grid. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Visualisation Configuration")
+	bool bRevealsFogOfWar;
+
 	/* The trace channel to use when performing line traces */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Visualisation Configuration")
 	TEnumAsByte<ECollisionChannel> TraceChannel;
@@ -84,6 +181,55 @@ private:
 	/* The number of line traces being performed at a given frame. Used for profiling and debug. */
 	int32 LineTraceCount;
 
+	/* Game thread time spent on the last update, in milliseconds. Used for profiling and debug. */
+	float LastUpdateMilliseconds;
+
+	/* Asynchronous traces submitted last frame, consumed this frame. */
+	FLineOfSightTraceBatch PendingTraceBatch;
+
+	/* Fan intervals in which the last consumed batch detected an edge. They are refined by the next batch. */
+	TArray<int32> EdgeIntervalsToRefine;
+
+	/* The number of occluder segments the last update was solved against. Used for profiling and debug. */
+	int32 OccluderSegmentCount;
+
+	/* The number of mesh sections uploaded (or created, if their buffers had to grow) by the last update. Used for profiling and debug. */
+	int32 MeshUploadCount;
+
+	/* The view state of the current update, and of the last update which changed the mesh. */
+	FLineOfSightViewState CurrentViewState;
+	FLineOfSightViewState LastViewState;
+
+	/* Points of the current update, reused by every update. */
+	TArray<FVector> CurrentPoints;
+
+	/* Hit results of the last consumed trace batch, reused by every update. */
+	TArray<FHitResult> BatchHits;
+
+	/* Vertices of both mesh sections, as last uploaded. The first section always has MinimalLoSPoints + 1 vertices. The second only
+	grows, and vertices past the last point are collapsed onto it, so its triangles are never rebuilt unless it grows. */
+	TArray<FVector> DefaultSectionVertices;
+	TArray<FVector> AdditionalSectionVertices;
+	TArray<int32> AdditionalSectionTriangles;
+
+	/* Whether the second mesh section is shown. It is hidden rather than cleared when there are no additional points. */
+	bool bIsAdditionalSectionVisible;
+
+	/* Version of the ULineOfSightSubsystem result the mesh was last built from. */
+	uint32 LastViewerResultVersion;
+
+	/* The last occluder signature, and the occluder version, origin and radius it was found at. Found again only when one of them
+	changes, so a stationary viewer does not overlap the world every frame. */
+	uint32 CachedOccluderSignature;
+	uint32 CachedOccluderVersion;
+	FVector CachedOccluderOrigin;
+	float CachedOccluderRadius;
+	bool bHasCachedOccluderSignature;
+
+	/* Origin of the fan of points the mesh was last built from, and a version incremented whenever the shown polygon changes. */
+	FVector PolygonOrigin;
+	uint32 PolygonVersion;
+
 	/* The number of points required to be created given mesh resolution and vision angle. Is higher
 	at greater vision angles and mesh resolutions. */
 	int32 MinimalLoSPoints;
@@ -138,12 +284,66 @@ public:
 	 */
 	virtual void ScaleVisibility_Implementation(float& Scale) override;
 
+	/**
+	 * Gets where this visualiser currently sees from, for ULineOfSightSubsystem to solve.
+	 * @param OutParameters - (mutable) Set to the view parameters.
+	 * @return False if the visualisation is not initialised or not solved against occluder geometry.
+	 */
+	bool GetViewParameters(FLineOfSightViewParameters &OutParameters) const;
+
+	/**
+	 * Gets the polygon currently shown by the visualisation, as a fan of points around an origin.
+	 * @param OutOrigin - (mutable) Set to the origin of the fan.
+	 * @return The outline of the fan in world space, in order. Empty if the visualisation is not shown.
+	 */
+	const TArray<FVector>& GetVisualisationPolygon(FVector &OutOrigin) const;
+
+	/**
+	 * Gets the version of the shown polygon, which changes whenever the polygon does.
+	 * @return The polygon version.
+	 */
+	uint32 GetPolygonVersion() const { return PolygonVersion; }
+
+	/**
+	 * Gets the number of line traces performed (or submitted, if asynchronous) by the last update.
+	 * @return Line traces of the last update.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Visualisation Profiling")
+	int32 GetLineTraceCount() const { return LineTraceCount; }
+
+	/**
+	 * Gets the number of occluder segments the last update was solved against, if it used occluder geometry.
+	 * @return Occluder segments of the last update.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Visualisation Profiling")
+	int32 GetOccluderSegmentCount() const { return OccluderSegmentCount; }
+
+	/**
+	 * Gets the number of mesh sections uploaded by the last update. Zero if the update was skipped or nothing changed.
+	 * @return Mesh section uploads of the last update.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Visualisation Profiling")
+	int32 GetMeshUploadCount() const { return MeshUploadCount; }
+
+	/**
+	 * Gets the game thread time spent on the last update.
+	 * @return Time of the last update in milliseconds.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Visualisation Profiling")
+	float GetLastUpdateMilliseconds() const { return LastUpdateMilliseconds; }
+
 protected:
 	/** 
 	 * Begin rendering the mesh.
 	 */
 	virtual void BeginPlay() override;
 
+	/**
+	 * Stops being solved by ULineOfSightSubsystem.
+	 * @param EndPlayReason - Why play has ended. Unused.
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 private:
 	/** 
 	 * Initalise the procedural mesh to its initial state. Does nothing if the owner of this component does not
@@ -164,34 +364,109 @@ private:
 	 */
 	void UpdateVisualisation(float DeltaTime);
 
+	/**
+	 * Updates the visualisation from line traces, unless the view is unchanged and updates of unchanged views are skipped.
+	 */
+	void UpdateVisualisationTraced();
+
+	/**
+	 * Builds the mesh from the traces submitted last frame, if their results are available, then submits this frame's traces.
+	 */
+	void UpdateVisualisationAsync();
+
+	/**
+	 * Submits the fan traces for the owner's current state, and refinement traces for every interval in EdgeIntervalsToRefine.
+	 */
+	void SubmitTraceBatch();
+
+	/**
+	 * Retrieves the results of PendingTraceBatch. The batch is no longer pending afterwards, even if results were missing.
+	 * @param Hits - (mutable) One hit result per trace, in the order of PendingTraceBatch.Angles.
+	 * @return Whether results were available for every trace.
+	 */
+	bool ConsumeTraceBatch(TArray<FHitResult> &Hits);
+
+	/**
+	 * Whether the results of PendingTraceBatch are final: the view has not changed since it was submitted, and it refined every
+	 * interval it found an edge in.
+	 * @return Whether no further traces are needed while the view is unchanged.
+	 */
+	bool IsTraceBatchSettled() const;
+
+	/**
+	 * Generates points to draw Line of Sight to from the results of PendingTraceBatch, and finds the intervals to refine next.
+	 * @param Hits - Results of PendingTraceBatch.
+	 * @param bWasObstactleDetected - (mutable) Whether or not an obstacle was detected.
+	 * @param Points - (mutable) The list of points to draw LoS to.
+	 */
+	void GeneratePointsFromTraceBatch(const TArray<FHitResult> &Hits, bool &bWasObstactleDetected, TArray<FVector> &Points);
+
+	/**
+	 * Generates points to draw Line of Sight to from a result solved by ULineOfSightSubsystem, using the same fan of angles as
+	 * GeneratePoints with both sides of every visible edge inserted between them.
+	 * @param Result - The solved visibility of this visualiser.
+	 * @param bWasObstactleDetected - (mutable) Whether or not an obstacle was detected.
+	 * @param Points - (mutable) The list of points to draw LoS to.
+	 */
+	void GeneratePointsFromViewerResult(const FLineOfSightViewerResult &Result, bool &bWasObstactleDetected, TArray<FVector> &Points);
+
+	/**
+	 * Gets the line of sight subsystem of this component's world.
+	 * @return The subsystem, or nullptr if there is none.
+	 */
+	class ULineOfSightSubsystem* GetLineOfSightSubsystem() const;
+
+	/**
+	 * Gets the fog of war subsystem of this component's world.
+	 * @return The subsystem, or nullptr if there is none.
+	 */
+	class ULineOfSightFogOfWarSubsystem* GetFogOfWarSubsystem() const;
+
+	/**
+	 * Gets how many evenly spaced traces refine a fan interval containing an edge when tracing asynchronously. This is the number
+	 * of angles bisection could visit in SubdivisionCount steps, as bisection depends on the result of each trace.
+	 * @return Number of refinement traces per interval.
+	 */
+	int32 GetRefinementTraceCount() const;
+
+	/**
+	 * Updates both mesh sections from the given points. Only sections whose vertices changed are uploaded.
+	 * @param Points - The points to draw LoS to.
+	 * @param Origin - The location the points were traced from.
+	 */
+	void UpdateMesh(const TArray<FVector> &Points, const FVector &Origin);
+
 	/**
 	 * Creates a singular triangular section of the procedural mesh.
 	 * @param SectionIndex - The "i-th" triangle of the mesh.
-	 * @param Verticies - An array of vectors whose length MUST be a multiple of 3.
+	 * @param Vertices - The vertices of the section.
+	 * @param Triangles - The triangle indices of the section, see CreateTriangleDataFromVertices.
 	 */
-	void CreateMeshSection(const int32 SectionIndex, const TArray<FVector> Vertices);
+	void CreateMeshSection(const int32 SectionIndex, const TArray<FVector> &Vertices, const TArray<int32> &Triangles);
 
 	/** 
 	 * Updates a singular triangular section of the procedural mesh.
 	 * @param SectionIndex - The "i-th" triangle of the mesh. If this section does not exist, the update does nothing.
-	 * @param Vertices - An array of vectors whose length MUST be a multiple of 3. Updates the section of the mesh.
+	 * @param Vertices - The vertices of the section. Must be as many as the section was created with.
 	 */
-	void UpdateMeshSection(const int32 SectionIndex, const TArray<FVector> Vertices);
+	void UpdateMeshSection(const int32 SectionIndex, const TArray<FVector> &Vertices);
 
 	/**
-	 * Creates an int32 TArray of triangle indicies from a FVector TArray.
-	 * @param Verticies - An array of FVector representing a triangle. Length must be a multiple of 3.
-	 * @return An array of triangle vertex indicies.
+	 * Creates triangle indices fanning out from the first vertex over the rest.
+	 * @param Vertices - The vertices to build triangles over.
+	 * @param Triangles - (mutable) Set to the triangle vertex indices.
 	 */
-	TArray<int32> CreateTriangleDataFromVertices(const TArray<FVector> Vertices);
+	void CreateTriangleDataFromVertices(const TArray<FVector> &Vertices, TArray<int32> &Triangles);
 
 	/**
-	 * Creates a FVector TArray of vertices from trace points.
-	 * @param TracePoints - The trace points from which to build vertex data from.
+	 * Writes the vertices of a mesh section from trace points, in place. Vertices past the last point are collapsed onto it.
+	 * @param Points - The trace points from which to build vertex data from.
 	 * @param ShouldFocusOnDefaultVerticies - Whether these vertices are being built as an additional section or not.
-	 * @return A FVector TArray which contains the new vertex data.
+	 * @param Origin - The location the points were traced from. Vertices are relative to it.
+	 * @param Vertices - (mutable) The vertices of the section, already sized to it.
+	 * @return Whether any vertex changed.
 	 */
-	TArray<FVector> CreateVertexDataFromPoints(const TArray<FVector> Points, const bool ShouldFocusOnDefaultVerticies);
+	bool CreateVertexDataFromPoints(const TArray<FVector> &Points, const bool ShouldFocusOnDefaultVerticies, const FVector &Origin, TArray<FVector> &Vertices);
 
 	/**
 	 * Generates points to draw Line of Sight to based on the current spatial parameters.
@@ -213,12 +488,21 @@ private:
 	 * @param Hit - The FHitResult to test.
 	 * @return Either Hit.ImpactPoint or Hit.Trace head, depending on whether there was a blocking hit or not.
 	 */
-	FVector BlockingTraceEnd(FHitResult Hit);
+	FVector BlockingTraceEnd(const FHitResult &Hit);
+
+	/**
+	 * Gets the current view state. The occluder signature is only computed if updates of unchanged views are skipped, and is reused
+	 * while the view has not moved and the subsystem's dynamic occluder version is unchanged.
+	 * @return The view state.
+	 */
+	FLineOfSightViewState GetViewState();
 
 	/**
-	 * DEPRECATED 
+	 * Whether the visualisation has to be updated, because it was forced or CurrentViewState differs from the last update's.
+	 * Clears bDoesMeshNeedToBeUpdated.
+	 * @return Whether the mesh should be updated.
 	 */
-	bool IsMeshUpdateRequired(const bool ObstacleDetectedInPrevCycle, const bool ObstacleDetectedInCurrentCycle);
+	bool IsMeshUpdateRequired();
 
 	/** 
 	 * Tests for the presence of an edge between two hit results.
@@ -226,16 +510,16 @@ private:
 	 * @param EndingHit - The second hit result.
 	 * @return Whether or not an edge is present between the two hit results.
 	 */
-	bool PerformEdgeTest(const FHitResult StartingHit, const FHitResult EndingHit);
+	bool PerformEdgeTest(const FHitResult &StartingHit, const FHitResult &EndingHit);
 
 	/**
 	 * Performs a subdivision between the previous and current point and finds (to an approximation)
 	 * the locations of the edges between them.
 	 * @param StartingAngle - The angle between the StartingHit and the desired next point.
 	 * @param StartingHit - The starting hit result.
-	 * @return A TArray<FVector> of additional points representing edge locations.
+	 * @param Points - (mutable) Additional points representing edge locations are appended to it.
 	 */
-	TArray<FVector> ConstructEdgeFixApproximation(const float StartingAngle, const FHitResult StartingHit);
+	void ConstructEdgeFixApproximation(const float StartingAngle, const FHitResult &StartingHit, TArray<FVector> &Points);
 
 	/**
 	 * Calculates (to greater accuracy) edge points within a subdivided sector, specified by the first 5 parameters.
@@ -250,7 +534,7 @@ private:
 	 * @param EndUpdated - True if the end point was updated.
 	 * @param UpdatedEndPoint - Updated if the ending point was updated, otherwise == EndingPoint.
 	 */
-	void RecalculateEdgePoints(const FHitResult StartingHit, const float StartingAngle, const float EndingAngle, const FVector StartingPoint, const FVector EndingPoint, bool &StartUpdated, FVector &UpdatedStartPoint, bool &EndUpdated, FVector &UpdatedEndPoint);
+	void RecalculateEdgePoints(const FHitResult &StartingHit, const float StartingAngle, const float EndingAngle, const FVector StartingPoint, const FVector EndingPoint, bool &StartUpdated, FVector &UpdatedStartPoint, bool &EndUpdated, FVector &UpdatedEndPoint);
 
 	/**
 	 * Performs A % B, returns 0 if B == 0
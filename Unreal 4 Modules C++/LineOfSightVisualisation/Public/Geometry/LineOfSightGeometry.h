@@ -0,0 +1,188 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/* A 2D segment of an occluder's outline, sliced from collision at a given height. */
+struct FLineOfSightSegment
+{
+	FVector2D Start;
+	FVector2D End;
+
+	FLineOfSightSegment() : Start(FVector2D::ZeroVector), End(FVector2D::ZeroVector) {}
+	FLineOfSightSegment(const FVector2D& InStart, const FVector2D& InEnd) : Start(InStart), End(InEnd) {}
+};
+
+/* Bounding volume hierarchy over 2D segments. Built once, then queried by area. */
+class LINEOFSIGHTVISUALISATION_API FLineOfSightSegmentBVH
+{
+public:
+	/**
+	 * Builds the hierarchy, replacing any previous segments.
+	 * @param InSegments - The segments to build over. Their order is changed.
+	 */
+	void Build(TArray<FLineOfSightSegment>&& InSegments);
+
+	/**
+	 * Finds every segment whose bounds overlap a circle.
+	 * @param Center - Center of the circle.
+	 * @param Radius - Radius of the circle.
+	 * @param OutSegmentIndices - (mutable) Indices into GetSegments() are appended to it.
+	 */
+	void QueryCircle(const FVector2D& Center, float Radius, TArray<int32>& OutSegmentIndices) const;
+
+	/**
+	 * Finds every segment whose bounds overlap a box.
+	 * @param Box - The box to test.
+	 * @param OutSegmentIndices - (mutable) Indices into GetSegments() are appended to it.
+	 */
+	void QueryBox(const FBox2D& Box, TArray<int32>& OutSegmentIndices) const;
+
+	/**
+	 * @return Every segment, in hierarchy order.
+	 */
+	const TArray<FLineOfSightSegment>& GetSegments() const { return Segments; }
+
+	/**
+	 * @return Number of segments.
+	 */
+	int32 Num() const { return Segments.Num(); }
+
+private:
+	/* A node of the hierarchy. Leaves have NumSegments > 0; the left child of an inner node directly follows it. */
+	struct FNode
+	{
+		FBox2D Bounds;
+		int32 RightChild;
+		int32 FirstSegment;
+		int32 NumSegments;
+	};
+
+	/**
+	 * Builds the node over a range of segments, and its children.
+	 * @return Index of the node.
+	 */
+	int32 BuildNode(int32 FirstSegment, int32 NumSegments);
+
+	/* The most segments a leaf may hold. */
+	static constexpr int32 MaxLeafSegments = 4;
+
+	TArray<FLineOfSightSegment> Segments;
+	TArray<FNode> Nodes;
+};
+
+/**
+ * Computes exactly what is visible from a point among 2D segments, with an angular sweep over segment endpoints in O(n log n).
+ * Angles are in degrees around the up axis relative to a forward direction, matching FVector::RotateAngleAxis with an up axis of +Z.
+ * Segments must not cross each other (see SplitAtIntersections), but may share endpoints.
+ */
+class LINEOFSIGHTVISUALISATION_API FLineOfSightVisibilitySolver
+{
+public:
+	/* A range of angles over which the same segment is closest, or INDEX_NONE if none is. */
+	struct FVisibleInterval
+	{
+		float StartAngle;
+		float EndAngle;
+		int32 SegmentIndex;
+	};
+
+	/**
+	 * Finds the closest segment over every angle between MinAngle and MaxAngle.
+	 * @param Origin - The point visibility is computed from.
+	 * @param Forward - Direction angles are relative to. Must be normalised.
+	 * @param MinAngle - First angle of the arc, at least -180.
+	 * @param MaxAngle - Last angle of the arc, at most 180.
+	 * @param Segments - The segments which may block visibility.
+	 * @param OutIntervals - (mutable) Set to the visible intervals in ascending order, covering the whole arc.
+	 */
+	void Solve(const FVector2D& Origin, const FVector2D& Forward, float MinAngle, float MaxAngle, const TArray<FLineOfSightSegment>& Segments, TArray<FVisibleInterval>& OutIntervals);
+
+	/**
+	 * Splits segments where they cross each other, so they only ever meet at endpoints.
+	 * @param Segments - (mutable) The segments to split.
+	 */
+	static void SplitAtIntersections(TArray<FLineOfSightSegment>& Segments);
+
+	/**
+	 * Gets the angle of a direction relative to forward.
+	 * @param Forward - Direction of angle 0.
+	 * @param Direction - The direction to measure.
+	 * @return Angle in degrees, between -180 and 180.
+	 */
+	static float GetAngle(const FVector2D& Forward, const FVector2D& Direction);
+
+	/**
+	 * Rotates a direction by an angle, as FVector::RotateAngleAxis does around +Z.
+	 * @param Direction - The direction to rotate.
+	 * @param Angle - Angle in degrees.
+	 * @return The rotated direction.
+	 */
+	static FVector2D RotateDirection(const FVector2D& Direction, float Angle);
+
+	/**
+	 * Intersects a ray with a segment.
+	 * @param Origin - Origin of the ray.
+	 * @param Direction - Direction of the ray. Must be normalised.
+	 * @param Segment - The segment to intersect.
+	 * @param OutDistance - (mutable) Distance along the ray to the intersection, if there is one.
+	 * @return Whether the ray hits the segment.
+	 */
+	static bool IntersectRay(const FVector2D& Origin, const FVector2D& Direction, const FLineOfSightSegment& Segment, float& OutDistance);
+
+private:
+	/* A segment prepared for the sweep, spanning StartAngle to EndAngle (StartAngle < EndAngle). */
+	struct FSweepSegment
+	{
+		FLineOfSightSegment Segment;
+		int32 SourceIndex;
+		float StartAngle;
+		float EndAngle;
+	};
+
+	/* A segment starting or ending at an angle. */
+	struct FSweepEvent
+	{
+		float Angle;
+		int32 SweepIndex;
+		bool bIsStart;
+	};
+
+	/**
+	 * Whether sweep segment A is in front of B as seen from Origin. Only meaningful if both overlap the same ray.
+	 */
+	bool IsInFrontOf(int32 A, int32 B) const;
+
+	/**
+	 * Adds a segment to or removes it from the heap of active segments.
+	 */
+	void ApplySweepEvent(const FSweepEvent& Event);
+
+	/**
+	 * Adds a segment to the heap of active segments.
+	 */
+	void HeapPush(int32 SweepIndex);
+
+	/**
+	 * Removes a segment from the heap of active segments, if it is in it.
+	 */
+	void HeapRemove(int32 SweepIndex);
+
+	/**
+	 * Restores heap order around a position.
+	 */
+	void HeapSiftUp(int32 Position);
+	void HeapSiftDown(int32 Position);
+	void HeapSwap(int32 PositionA, int32 PositionB);
+
+	/* Reused by every solve, so solving does not reallocate. */
+	FVector2D SweepOrigin;
+	FVector2D SweepForward;
+	TArray<FSweepSegment> SweepSegments;
+	TArray<FSweepEvent> SweepEvents;
+
+	/* Binary heap of active sweep segments (closest first), and the position of every sweep segment in it or INDEX_NONE. */
+	TArray<int32> Heap;
+	TArray<int32> HeapPositions;
+};
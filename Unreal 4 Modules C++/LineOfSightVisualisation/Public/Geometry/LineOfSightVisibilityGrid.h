@@ -0,0 +1,151 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * World-aligned grid of what can currently be seen and what has been explored, rasterised on the CPU from line of sight polygons.
+ * Cells are square and laid out in rows along +X, row after row along +Y, matching a texture whose U axis is world X.
+ *
+ * The grid is split into square tiles. Every update of the visible cells only clears the tiles which were visible before and only
+ * marks tiles dirty whose contents actually changed, so uploading the grid only ever copies changed tiles. Rows of triangles are
+ * filled as contiguous spans and tiles are combined with branch-free loops over contiguous cells, which compilers vectorise.
+ */
+class LINEOFSIGHTVISUALISATION_API FLineOfSightVisibilityGrid
+{
+public:
+	/* Width and height of a tile, in cells. The resolution is always a multiple of it. */
+	static constexpr int32 TileSize = 32;
+
+	/* Bytes of a tile copied by CopyTile: the visible and explored value of every cell. */
+	static constexpr int32 TileBytes = TileSize * TileSize * 2;
+
+	/**
+	 * Allocates the grid with nothing visible or explored, and every tile dirty.
+	 * @param InOrigin - World location of the corner of the first cell.
+	 * @param InCellSize - World size of a cell.
+	 * @param InResolution - Cells along each axis, rounded up to a multiple of TileSize.
+	 */
+	void Init(const FVector2D& InOrigin, float InCellSize, int32 InResolution);
+
+	/**
+	 * Starts an update of the visible cells, clearing every tile which was visible.
+	 */
+	void BeginVisibleUpdate();
+
+	/**
+	 * Marks the cells covered by a fan of triangles visible. Only valid between BeginVisibleUpdate and EndVisibleUpdate.
+	 * @param FanOrigin - The shared corner of every triangle. Its cell is always marked, so even very narrow fans are seen.
+	 * @param Points - The outline of the fan in order. Only their horizontal position is used.
+	 */
+	void RasteriseFan(const FVector& FanOrigin, const TArray<FVector>& Points);
+
+	/**
+	 * Marks the cells whose centres are covered by a triangle visible, in either winding.
+	 * @param A, B, C - Corners of the triangle, in cells.
+	 */
+	void RasteriseTriangle(const FVector2D& A, const FVector2D& B, const FVector2D& C);
+
+	/**
+	 * Ends an update of the visible cells. Tiles whose visible cells changed are marked dirty, and their visible cells explored.
+	 */
+	void EndVisibleUpdate();
+
+	/**
+	 * Decays explored cells which are not visible, exponentially towards unexplored. Tiles which changed are marked dirty.
+	 * @param Factor - Explored values are multiplied by this, between 0 and 1.
+	 */
+	void DecayExplored(float Factor);
+
+	/**
+	 * Gets the cell containing a location.
+	 * @param Location - The location. Only its horizontal position is used.
+	 * @return Index of the cell, or INDEX_NONE if the location is outside the grid.
+	 */
+	int32 GetCellIndex(const FVector& Location) const;
+
+	/**
+	 * @return Whether a cell is visible. The cell must be valid.
+	 */
+	bool IsCellVisible(int32 CellIndex) const { return Visible[CellIndex] != 0; }
+
+	/**
+	 * @return How explored a cell is, from 0 (never or long ago) to 1 (visible now). The cell must be valid.
+	 */
+	float GetCellExplored(int32 CellIndex) const { return Explored[CellIndex] / 65535.0f; }
+
+	/**
+	 * Finds the dirty tiles and marks them clean.
+	 * @param OutTiles - (mutable) Set to the indices of the dirty tiles.
+	 */
+	void ConsumeDirtyTiles(TArray<int32>& OutTiles);
+
+	/**
+	 * Copies a tile row by row, as pairs of visible (0 or 255) and explored (0 to 255) bytes per cell.
+	 * @param TileIndex - The tile to copy.
+	 * @param OutData - (mutable) At least TileBytes bytes the tile is written to.
+	 */
+	void CopyTile(int32 TileIndex, uint8* OutData) const;
+
+	/**
+	 * @return Cells along each axis.
+	 */
+	int32 GetResolution() const { return Resolution; }
+
+	/**
+	 * @return Tiles along each axis.
+	 */
+	int32 GetTileResolution() const { return TileResolution; }
+
+	/**
+	 * @return World location of the corner of the first cell.
+	 */
+	const FVector2D& GetOrigin() const { return Origin; }
+
+	/**
+	 * @return World size of a cell.
+	 */
+	float GetCellSize() const { return CellSize; }
+
+	/**
+	 * Rasterises synthetic viewers moving over grids of 256 and 1024 cells, and logs the average time of each step.
+	 * @param NumViewers - Viewers rasterised every update.
+	 * @param NumUpdates - Updates timed per resolution.
+	 */
+	static void RunBenchmark(int32 NumViewers, int32 NumUpdates);
+
+private:
+	/* Flags of a tile. */
+	enum ETileFlags : uint8
+	{
+		TileDirty = 1 << 0,
+		TileVisible = 1 << 1,
+		TileExplored = 1 << 2,
+		TileWasVisible = 1 << 3
+	};
+
+	/**
+	 * Sets a flag on the tiles of a row containing a span of cells.
+	 */
+	void FlagTiles(int32 Row, int32 FirstColumn, int32 LastColumn, uint8 Flag);
+
+	/**
+	 * @return Index of the first cell of a tile.
+	 */
+	int32 GetFirstCellOfTile(int32 TileIndex) const;
+
+	FVector2D Origin = FVector2D::ZeroVector;
+	float CellSize = 1.0f;
+	float InvCellSize = 1.0f;
+	int32 Resolution = 0;
+	int32 TileResolution = 0;
+
+	/* Per cell: 255 if visible, otherwise 0; and how explored it is, from 0 to 65535. */
+	TArray<uint8> Visible;
+	TArray<uint16> Explored;
+
+	/* Per tile: ETileFlags, and a checksum of its visible cells when they were last compared. */
+	TArray<uint8> TileFlags;
+	TArray<uint32> TileVisibleChecksums;
+};
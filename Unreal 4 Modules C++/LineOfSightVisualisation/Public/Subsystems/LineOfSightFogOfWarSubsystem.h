@@ -0,0 +1,174 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Geometry/LineOfSightVisibilityGrid.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "LineOfSightFogOfWarSubsystem.generated.h"
+
+class ULineOfSightVisualiser;
+class UTexture2D;
+
+/**
+ * Fog of war of a world. The polygons of every ULineOfSightVisualiser which reveals the fog of war are rasterised together into a
+ * world-aligned grid, whenever any of them changes. Cells seen before stay explored, fading exponentially once they are no longer
+ * visible. Changed tiles of the grid are uploaded to a texture each frame, with visibility in the red channel and exploration in
+ * the green channel, for materials to draw the fog with; gameplay looks cells up directly, e.g. to hide enemies in the fog.
+ */
+UCLASS()
+class LINEOFSIGHTVISUALISATION_API ULineOfSightFogOfWarSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+/* VARIABLES */
+public:
+	/* World location of the corner of the grid, at the lowest X and Y. Set with ConfigureGrid. */
+	UPROPERTY(BlueprintReadOnly, Category = "Fog Of War")
+	FVector2D GridOrigin = FVector2D(-25600.0f, -25600.0f);
+
+	/* World size of a cell of the grid. Set with ConfigureGrid. */
+	UPROPERTY(BlueprintReadOnly, Category = "Fog Of War")
+	float CellSize = 100.0f;
+
+	/* Cells along each axis of the grid and texels along each axis of the texture. Set with ConfigureGrid. */
+	UPROPERTY(BlueprintReadOnly, Category = "Fog Of War")
+	int32 GridResolution = 512;
+
+	/* Seconds for an explored cell which is no longer visible to fade to half. Explored cells never fade if zero. */
+	UPROPERTY(BlueprintReadWrite, Category = "Fog Of War")
+	float ExploredHalfLife = 30.0f;
+
+	/* Seconds between decays of explored cells. Decaying touches every explored tile, so it is not done every frame. */
+	UPROPERTY(BlueprintReadWrite, Category = "Fog Of War")
+	float ExploredDecayInterval = 0.1f;
+
+private:
+	/* The grid uploaded as an R8G8 texture. Never created on a dedicated server. */
+	UPROPERTY(Transient)
+	UTexture2D* FogOfWarTexture = nullptr;
+
+/* --- FUNCTIONS --- */
+public:
+	/**
+	 * Frees the grid and the texture.
+	 */
+	virtual void Deinitialize() override;
+
+	/**
+	 * Rasterises the revealers if any of them changed, decays explored cells and uploads the changed tiles.
+	 * @param DeltaTime - The time between this and the last frame.
+	 */
+	virtual void Tick(float DeltaTime) override;
+
+	/**
+	 * Only ticks once any revealer reveals, then while there are revealers, and never for the class default object.
+	 */
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Places the grid, clearing everything visible and explored. Uses the defaults once anything reveals if it is never called.
+	 * @param InGridOrigin - World location of the corner of the grid, at the lowest X and Y.
+	 * @param InCellSize - World size of a cell.
+	 * @param InGridResolution - Cells along each axis, rounded up to a multiple of 32 and at most 4096.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Fog Of War")
+	void ConfigureGrid(FVector2D InGridOrigin, float InCellSize, int32 InGridResolution);
+
+	/**
+	 * Adds a visualiser, which reveals the fog of war whenever its bRevealsFogOfWar is set. Does nothing if it is already registered.
+	 * @param Revealer - The visualiser to add.
+	 */
+	void RegisterRevealer(ULineOfSightVisualiser* Revealer);
+
+	/**
+	 * Removes a visualiser, hiding what it revealed on the next tick.
+	 * @param Revealer - The visualiser to remove.
+	 */
+	void UnregisterRevealer(ULineOfSightVisualiser* Revealer);
+
+	/**
+	 * Whether a location is currently visible to any revealer, in O(1).
+	 * @param Location - The location. Only its horizontal position is used.
+	 * @return Whether the cell containing the location is visible. False outside the grid.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Fog Of War")
+	bool IsLocationVisible(const FVector& Location) const;
+
+	/**
+	 * Gets how explored a location is, in O(1).
+	 * @param Location - The location. Only its horizontal position is used.
+	 * @return From 0 (never or long ago) to 1 (visible now). Zero outside the grid.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Fog Of War")
+	float GetLocationExplored(const FVector& Location) const;
+
+	/**
+	 * Whether an actor is currently visible to any revealer, by the cell containing its location. Enemies for which this is false
+	 * can be hidden.
+	 * @param Actor - The actor to test.
+	 * @return Whether the actor is visible. False if it is null or outside the grid.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Fog Of War")
+	bool IsActorVisible(const AActor* Actor) const;
+
+	/**
+	 * Gets the fog of war texture. Visibility (0 or 1) is in red and exploration in green. A world location maps to the UV
+	 * (Location.XY - GridOrigin) / GetGridWorldSize().
+	 * @return The texture, or nullptr until the grid is configured and always on a dedicated server.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Fog Of War")
+	UTexture2D* GetFogOfWarTexture() const { return FogOfWarTexture; }
+
+	/**
+	 * Gets the world size of the grid along each axis.
+	 * @return World size of the grid.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Fog Of War")
+	float GetGridWorldSize() const { return Grid.GetResolution() * Grid.GetCellSize(); }
+
+	/**
+	 * Gets the grid, for looking cells up directly from C++.
+	 * @return The grid.
+	 */
+	const FLineOfSightVisibilityGrid& GetGrid() const { return Grid; }
+
+private:
+	/* A registered visualiser, and whether it revealed which version of its polygon on the last rasterisation. */
+	struct FRevealer
+	{
+		TWeakObjectPtr<ULineOfSightVisualiser> Visualiser;
+		uint32 PolygonVersion = 0;
+		bool bWasRevealing = false;
+	};
+
+	/**
+	 * Finds whether any revealer changed since the last rasterisation, removing destroyed revealers.
+	 * @return Whether the visible cells must be rasterised again.
+	 */
+	bool UpdateRevealers();
+
+	/**
+	 * Uploads the dirty tiles of the grid to the texture.
+	 */
+	void UploadDirtyTiles();
+
+	/* Every registered visualiser. */
+	TArray<FRevealer> Revealers;
+
+	/* What is visible and explored. */
+	FLineOfSightVisibilityGrid Grid;
+
+	/* Whether the visible cells must be rasterised again although no revealer changed, e.g. after the grid was configured. */
+	bool bIsRasterisationRequired = false;
+
+	/* Seconds since explored cells were last decayed. */
+	float TimeSinceDecay = 0.0f;
+
+	/* Reused by every upload. */
+	TArray<int32> DirtyTilesScratch;
+};
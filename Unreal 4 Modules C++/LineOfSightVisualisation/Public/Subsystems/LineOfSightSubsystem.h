@@ -0,0 +1,373 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/LineOfSightVisualiser.h"
+#include "Geometry/LineOfSightGeometry.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "WorldCollision.h"
+#include "LineOfSightSubsystem.generated.h"
+
+/* What a viewer can see, as solved by ULineOfSightSubsystem. Everything is projected onto the horizontal plane. */
+struct LINEOFSIGHTVISUALISATION_API FLineOfSightViewerResult
+{
+	/* The view parameters the result was solved for. */
+	FVector Origin = FVector::ZeroVector;
+	FVector2D Forward = FVector2D(1.0f, 0.0f);
+	float Radius = 0.0f;
+	float HalfAngle = 0.0f;
+
+	/* The occluders around the viewer, and the closest of them over every angle of the view in ascending order. */
+	TArray<FLineOfSightSegment> Segments;
+	TArray<FLineOfSightVisibilitySolver::FVisibleInterval> Intervals;
+
+	/* Incremented every time the result is solved again. Zero if it has never been solved. */
+	uint32 Version = 0;
+
+	/**
+	 * Finds how far the viewer can see in a direction.
+	 * @param Direction - Normalised direction from the origin.
+	 * @param SegmentIndex - Index of the closest segment in that direction, or INDEX_NONE if there is none.
+	 * @return Distance to the segment, limited to the radius.
+	 */
+	float GetVisibleDistance(const FVector2D& Direction, int32 SegmentIndex) const;
+
+	/**
+	 * Finds the visible interval containing an angle, in O(log n).
+	 * @param Angle - Angle relative to Forward.
+	 * @return Index of the interval, or INDEX_NONE if the angle is outside the view.
+	 */
+	int32 FindInterval(float Angle) const;
+
+	/**
+	 * Whether a point can be seen by the viewer.
+	 * @param Point - The point to test. Only its horizontal position is used.
+	 * @return Whether the point is within the view and nothing occludes it.
+	 */
+	bool IsPointVisible(const FVector& Point) const;
+};
+
+/**
+ * Shared visibility service of a world. Owns the occluders line of sight is computed against: static collision is sliced into
+ * 2D segments once per slice height and trace channel, and kept in a segment BVH until a level is streamed in or out; movable
+ * occluders are sliced when a view is solved. Only simple collision (boxes, spheres, capsules and convex hulls) is sliced, so
+ * components with only complex collision (meshes using complex collision as simple, BSP, landscape) do not occlude. A warning
+ * naming each such component is logged once.
+ *
+ * Every ULineOfSightVisualiser solved against occluder geometry registers as a viewer. Once per frame, viewers which are due and
+ * whose view or nearby movable occluders changed are solved together across worker threads. Viewers further from the player are
+ * due less often. The results are used both to build cone meshes and to answer gameplay visibility queries.
+ */
+UCLASS()
+class LINEOFSIGHTVISUALISATION_API ULineOfSightSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+/* VARIABLES */
+public:
+	/* Viewers closer than this to the player are solved every frame. */
+	UPROPERTY(BlueprintReadWrite, Category = "Line Of Sight")
+	float FullRateDistance = 2000.0f;
+
+	/* Viewers at least this far from the player are solved every MaxUpdateInterval seconds. The interval scales linearly in between. */
+	UPROPERTY(BlueprintReadWrite, Category = "Line Of Sight")
+	float MinimalRateDistance = 8000.0f;
+
+	/* The longest time between solves of a viewer, in seconds. */
+	UPROPERTY(BlueprintReadWrite, Category = "Line Of Sight")
+	float MaxUpdateInterval = 0.5f;
+
+/* --- FUNCTIONS --- */
+public:
+	/**
+	 * Starts listening for levels being added to or removed from the world.
+	 * @param Collection - The collection this subsystem belongs to.
+	 */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/**
+	 * Stops listening for level changes and frees every cached occluder.
+	 */
+	virtual void Deinitialize() override;
+
+	/**
+	 * Solves every viewer which is due and has changed.
+	 * @param DeltaTime - The time between this and the last frame. Unused.
+	 */
+	virtual void Tick(float DeltaTime) override;
+
+	/**
+	 * Only ticks while there are viewers, and never for the class default object.
+	 */
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Adds a viewer, solved from the next frame on whenever it provides view parameters. Does nothing if it is already registered.
+	 * @param Viewer - The viewer to add.
+	 */
+	void RegisterViewer(ULineOfSightVisualiser* Viewer);
+
+	/**
+	 * Removes a viewer and its result.
+	 * @param Viewer - The viewer to remove.
+	 */
+	void UnregisterViewer(ULineOfSightVisualiser* Viewer);
+
+	/**
+	 * Gets the latest result of a viewer.
+	 * @param Viewer - The viewer.
+	 * @return The result, or nullptr if the viewer is not registered or has never been solved.
+	 */
+	const FLineOfSightViewerResult* GetViewerResult(const ULineOfSightVisualiser* Viewer) const;
+
+	/**
+	 * Whether a point can be seen by a viewer, according to its latest result.
+	 * @param Viewer - The viewer.
+	 * @param Point - The point to test. Only its horizontal position is used.
+	 * @return Whether the point is visible. False if the viewer has never been solved.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Line Of Sight")
+	bool IsPointVisibleFromViewer(const ULineOfSightVisualiser* Viewer, const FVector& Point) const;
+
+	/**
+	 * Whether any part of an actor can be seen by a viewer, according to its latest result. Tests the actor's location and the
+	 * horizontal extremes of its bounds.
+	 * @param Viewer - The viewer.
+	 * @param Actor - The actor to test.
+	 * @return Whether the actor is visible. False if the viewer has never been solved.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Line Of Sight")
+	bool IsActorVisibleFromViewer(const ULineOfSightVisualiser* Viewer, const AActor* Actor) const;
+
+	/**
+	 * Finds every viewer which can see an actor, e.g. every guard and camera which can see the player.
+	 * @param Actor - The actor to test.
+	 * @param OutViewers - (mutable) Set to the viewers which can see the actor. Viewers owned by the actor are excluded.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Line Of Sight")
+	void GetViewersOfActor(const AActor* Actor, TArray<ULineOfSightVisualiser*>& OutViewers) const;
+
+	/**
+	 * Gets the number of viewers solved on the last frame. Used for profiling and debug.
+	 * @return Viewers solved on the last frame.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Line Of Sight")
+	int32 GetSolvedViewerCount() const { return SolvedViewerCount; }
+
+	/**
+	 * Gets the number of registered viewers.
+	 * @return Registered viewers.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Line Of Sight")
+	int32 GetViewerCount() const { return Viewers.Num(); }
+
+	/**
+	 * Gathers every occluder segment within a radius, sliced at the height of the origin. Static segments come from the cache (built
+	 * on first use) and movable ones are sliced from their current collision. The result never contains crossing segments.
+	 * @param Origin - Center of the query. Its height is the slice height.
+	 * @param Radius - Radius of the query.
+	 * @param Channel - Only components blocking this channel occlude.
+	 * @param QueryParams - Parameters of the overlap finding movable occluders, e.g. ignored actors.
+	 * @param OutSegments - (mutable) Set to the occluder segments.
+	 */
+	void GatherOccluders(const FVector& Origin, float Radius, ECollisionChannel Channel, const FCollisionQueryParams& QueryParams, TArray<FLineOfSightSegment>& OutSegments);
+
+	/**
+	 * Hashes the placement of every movable occluder within a radius, and the version of the static occluders. The signature only
+	 * changes if an occluder visible from the origin could have moved, appeared or disappeared.
+	 * @param Origin - Center of the query.
+	 * @param Radius - Radius of the query.
+	 * @param Channel - Only components blocking this channel occlude.
+	 * @param QueryParams - Parameters of the overlap finding movable occluders, e.g. ignored actors.
+	 * @return The signature.
+	 */
+	uint32 GetOccluderSignature(const FVector& Origin, float Radius, ECollisionChannel Channel, const FCollisionQueryParams& QueryParams);
+
+	/**
+	 * Gets the version of the world's occluders. It changes whenever a movable component moves, appears, disappears or changes its
+	 * collision, or the static occluders are invalidated, so an occluder signature taken at the same version, origin and radius is
+	 * still valid. Checked at most once per frame by reading the placement of every movable component, without any overlap query.
+	 * @return The version.
+	 */
+	uint32 GetDynamicOccluderVersion();
+
+	/**
+	 * Frees every cached static occluder, so they are sliced again on next use. Call after moving static geometry at runtime.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Line Of Sight")
+	void InvalidateStaticOccluders();
+
+	/**
+	 * Gets the number of cached static occluder segments, over every slice height and channel.
+	 * @return Number of cached segments.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Line Of Sight")
+	int32 GetStaticSegmentCount() const;
+
+	/**
+	 * Slices the simple collision of a component at a height.
+	 * @param Component - The component to slice.
+	 * @param Height - World height of the slice.
+	 * @param OutSegments - (mutable) The outline of every collision shape crossing the slice is appended to it.
+	 * @return False if the component crosses the slice but only has complex collision, which is not sliced.
+	 */
+	static bool SliceComponent(const class UPrimitiveComponent* Component, float Height, TArray<FLineOfSightSegment>& OutSegments);
+
+private:
+	/* A registered viewer, its latest result and the state it was solved from. */
+	struct FViewer
+	{
+		TWeakObjectPtr<ULineOfSightVisualiser> Visualiser;
+		FLineOfSightViewParameters Parameters;
+		uint32 OccluderSignature = 0;
+		uint32 DynamicOccluderVersion = 0;
+		double NextUpdateTime = 0.0;
+		FLineOfSightViewerResult Result;
+
+		/* Used while solving, each viewer has its own so viewers can be solved in parallel. */
+		FLineOfSightVisibilitySolver Solver;
+		TArray<FLineOfSightSegment> MovableSegments;
+		TArray<int32> SegmentIndices;
+	};
+
+	/**
+	 * Solves a viewer from its parameters and movable segments. Thread safe as long as no static occluders are added meanwhile.
+	 */
+	void SolveViewer(FViewer& Viewer) const;
+
+	/**
+	 * Gets the time between solves of a viewer at a location.
+	 * @param Origin - The viewer's location.
+	 * @param PlayerLocation - The location of the player, if there is one.
+	 * @param bHasPlayer - Whether there is a player.
+	 * @return Seconds between solves. Zero to solve every frame.
+	 */
+	float GetViewerUpdateInterval(const FVector& Origin, const FVector& PlayerLocation, bool bHasPlayer) const;
+
+	/**
+	 * Finds the movable occluders within a radius, and hashes their placement and the version of the static occluders.
+	 * @param OutComponents - (mutable) Set to the movable occluders.
+	 * @return The signature, see GetOccluderSignature.
+	 */
+	uint32 FindMovableOccluders(const FVector& Origin, float Radius, ECollisionChannel Channel, const FCollisionQueryParams& QueryParams, TArray<const UPrimitiveComponent*>& OutComponents);
+
+	/* A movable component which may occlude, and the hash of its placement and collision when it was last checked. */
+	struct FDynamicOccluder
+	{
+		TWeakObjectPtr<const UPrimitiveComponent> Component;
+		uint32 StateHash = 0;
+	};
+
+	/**
+	 * Checks every movable component for changes, at most once per frame, and increments DynamicOccluderVersion if any changed.
+	 * Finds the movable components of the world on first use.
+	 */
+	void UpdateDynamicOccluders();
+
+	/**
+	 * Starts tracking the movable components of an actor.
+	 * @param Actor - The actor.
+	 */
+	void AddDynamicOccluders(const AActor* Actor);
+
+	/**
+	 * Tracks the movable components of actors spawned after the world was searched.
+	 * @param Actor - The spawned actor.
+	 */
+	void OnActorSpawned(AActor* Actor);
+
+	/**
+	 * Hashes the location, rotation and scale of a component.
+	 * @param Component - The component.
+	 * @return The hash.
+	 */
+	static uint32 GetPlacementHash(const UPrimitiveComponent* Component);
+
+	/**
+	 * Removes a viewer, moving the last viewer into its place. Works for viewers which have already been destroyed.
+	 */
+	void RemoveViewer(const TWeakObjectPtr<ULineOfSightVisualiser>& Viewer);
+
+	/**
+	 * Gets the key static occluders of a slice height and channel are cached under.
+	 */
+	static FIntPoint GetSliceKey(float Height, ECollisionChannel Channel);
+
+	/**
+	 * Gets the static occluders of a slice height and channel, slicing every static component of the world if they are not cached.
+	 * @param Height - World height of the slice.
+	 * @param Channel - Only components blocking this channel occlude.
+	 * @return The cached occluders.
+	 */
+	const FLineOfSightSegmentBVH& GetStaticOccluders(float Height, ECollisionChannel Channel);
+
+	/**
+	 * Invalidates the static occluders when a level of this world is added or removed.
+	 * @param Level - The level. Unused.
+	 * @param World - The world the level belongs to.
+	 */
+	void OnLevelsChanged(ULevel* Level, UWorld* World);
+
+	/**
+	 * Logs a warning, once per component, that a component crossing a slice only has complex collision and does not occlude.
+	 * @param Component - The component.
+	 */
+	void WarnUnslicedOccluder(const UPrimitiveComponent* Component);
+
+	/**
+	 * Whether a component occludes line of sight on a channel.
+	 */
+	static bool IsOccluder(const class UPrimitiveComponent* Component, ECollisionChannel Channel);
+
+	/**
+	 * Slices the body setup of a component, or of one of its instances, placed with a transform.
+	 */
+	static void SliceBodySetup(const class UBodySetup* BodySetup, const FTransform& Transform, float Height, TArray<FLineOfSightSegment>& OutSegments);
+
+	/**
+	 * Slices a convex shape given by points on its hull, appending the outline of the slice.
+	 */
+	static void SliceConvex(const TArray<FVector>& HullPoints, float Height, TArray<FLineOfSightSegment>& OutSegments);
+
+	/* Heights static occluders are sliced at are rounded to this, so viewers at nearly the same height share a slice. */
+	static constexpr float SliceHeightTolerance = 10.0f;
+
+	/* Static occluders per slice height (in multiples of SliceHeightTolerance) and channel. */
+	TMap<FIntPoint, FLineOfSightSegmentBVH> StaticOccluders;
+
+	/* Incremented whenever the static occluders are invalidated. */
+	uint32 StaticOccluderVersion = 0;
+
+	/* Every movable component of the world, whether they were searched for yet, and the frame they were last checked on. */
+	TArray<FDynamicOccluder> DynamicOccluders;
+	bool bHasFoundDynamicOccluders = false;
+	uint64 DynamicOccludersCheckedFrame = 0;
+
+	/* See GetDynamicOccluderVersion. */
+	uint32 DynamicOccluderVersion = 0;
+
+	/* Components which were warned about not being sliced. */
+	TSet<TWeakObjectPtr<const UPrimitiveComponent>> UnslicedOccluders;
+
+	/* Registered viewers, and the index of each in Viewers. */
+	TArray<FViewer> Viewers;
+	TMap<TWeakObjectPtr<ULineOfSightVisualiser>, int32> ViewerIndices;
+
+	/* Number of viewers solved on the last frame. */
+	int32 SolvedViewerCount = 0;
+
+	/* Reused by every query and tick, so gathering occluders does not reallocate. */
+	TArray<int32> SegmentIndicesScratch;
+	TArray<FOverlapResult> OverlapsScratch;
+	TArray<const UPrimitiveComponent*> MovableOccludersScratch;
+	TArray<int32> ViewersToSolveScratch;
+
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+	FDelegateHandle ActorSpawnedHandle;
+};